@@ -147,9 +147,12 @@ namespace JAUS
         Service::ID::Set GetServiceSet() const;
         // Gets the component ID.
         inline Address GetComponentID() const { return mComponentID; }
+        // Gets the Services that receive a type of message.
+        const Service::List* GetMessageRoute(const UShort messageCode) const;
         // Prints the status information for all services.
         virtual void PrintStatus() const;
     private:
+        void UpdateMessageRoutes();
         static void CheckServiceStatusEvent(void* args);
         static void CheckCoreServicesStatusEvent(void* args);
         Address mComponentID;                   ///< Component ID.
@@ -158,6 +161,9 @@ namespace JAUS
         Time::Stamp mCoreServicesCheckTimeMs;   ///< The last time core Services were checked.
         Transport* mpTransportService;          ///< Transport service.
         Service::Map mServices;                 ///< Component services.
+        std::map<std::string, std::set<UShort> > mServiceMessageCodes;  ///< Message codes received by each Service.
+        std::map<UShort, Service::List> mMessageRoutes;                 ///< Services to deliver each message code to.
+        Service::List mDefaultMessageRoute;                             ///< Services that receive all message codes.
         CxUtils::Timer mCheckServiceTimer;      ///< Timer object for checking Service status.
         CxUtils::Timer mCheckCoreServicesTimer; ///< Timer object for updating core services.
         Events* mpEventsService;                ///< Pointer to the events Service.
@@ -55,6 +55,8 @@
 
 namespace JAUS
 {
+    class RequestControlResponse;
+
     ////////////////////////////////////////////////////////////////////////////////////
     ///
     ///   \class AccessControl
@@ -71,6 +73,7 @@ namespace JAUS
     ////////////////////////////////////////////////////////////////////////////////////
     class JAUS_CORE_DLL AccessControl : public Events::Child
     {
+        friend class RequestControlResponse;
     public:
         ////////////////////////////////////////////////////////////////////////////////////
         ///
@@ -150,6 +153,11 @@ namespace JAUS
         bool RequestComponentControl(const Address& id, 
                                      const bool reacquire = true,
                                      const unsigned int waitTimeMs = Service::DefaultWaitMs);
+        // Method called to take control of a component without blocking (check or wait on the handle returned).
+        AsyncResponse::Ptr RequestComponentControlAsync(const Address& id,
+                                                        const bool reacquire = true,
+                                                        AsyncResponse::Callback* callback = NULL,
+                                                        const unsigned int waitTimeMs = Service::DefaultWaitMs);
         // Method to release control
         bool ReleaseComponentControl(const Address& id,
                                      const unsigned int waitTimeMs = Service::DefaultWaitMs);
@@ -222,6 +230,7 @@ namespace JAUS
         SharedMutex mCallbacksMutex;                    ///<  Mutex for thread protection of callbacks.
     private:
         void EraseComponentControlInfo(const Address& id);
+        void ProcessControlAccepted(const Address& id, const bool reacquire);
     };
 }
 
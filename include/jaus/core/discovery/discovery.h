@@ -52,6 +52,7 @@
 #include "jaus/core/discovery/reportidentification.h"
 #include "jaus/core/discovery/reportservices.h"
 #include "jaus/core/discovery/reportsubsystemlist.h"
+#include <boost/unordered_map.hpp>
 
 namespace JAUS
 {
@@ -78,6 +79,72 @@ namespace JAUS
         const static std::string Name; ///< String name of the Service.
         ////////////////////////////////////////////////////////////////////////////////////
         ///
+        ///   \class Snapshot
+        ///   \brief Version of the system configuration that is never modified
+        ///          after it is published.
+        ///
+        ///   Readers get the current Snapshot without locking or copying.  When
+        ///   Discovery data changes a new Snapshot is published, sharing the
+        ///   Subsystem data that did not change with the previous one.  Do not
+        ///   modify the contents.
+        ///
+        ///   Each Snapshot also contains an index of the components providing
+        ///   each service.  Only the entries for services of the subsystems that
+        ///   changed are copied when the Snapshot is published, all others are
+        ///   shared with the previous one.
+        ///
+        ////////////////////////////////////////////////////////////////////////////////////
+        class JAUS_CORE_DLL Snapshot
+        {
+        public:
+            typedef boost::shared_ptr<const Snapshot> Ptr;
+            ////////////////////////////////////////////////////////////////////////////////////
+            ///
+            ///   \class Providers
+            ///   \brief Components that have a service, sorted by ID, and the
+            ///          version of the service each one has.
+            ///
+            ////////////////////////////////////////////////////////////////////////////////////
+            class JAUS_CORE_DLL Providers
+            {
+            public:
+                Address::List mComponents;      ///<  Components with the service (sorted).
+                std::vector<double> mVersions;  ///<  Version of the service for each component.
+            };
+            // Providers are shared by Snapshots until the components with the service change.
+            typedef boost::unordered_map<Service::ID::Handle, boost::shared_ptr<const Providers> > ServiceIndex;
+            Snapshot() : mVersion(0) {}
+            ~Snapshot() {}
+            // Gets the components with a service (no copies, valid while the Snapshot is held).
+            const Address::List& GetComponentsWithService(const std::string& serviceName) const;
+            // Gets the components with a service (no copies, valid while the Snapshot is held).
+            const Address::List& GetComponentsWithService(const Service::ID::Handle service) const;
+            // Gets the components with a service and the versions they have (NULL if none).
+            const Providers* GetProviders(const Service::ID::Handle service) const;
+            UInt mVersion;              ///<  Increases each time a Snapshot is published.
+            Subsystem::Map mSystem;     ///<  System configuration.
+            ServiceIndex mServices;     ///<  Components in mSystem by service name Handle.
+        };
+        ////////////////////////////////////////////////////////////////////////////////////
+        ///
+        ///   \class Changes
+        ///   \brief Differences between two Snapshots of the system, given to
+        ///          Discovery callbacks.
+        ///
+        ////////////////////////////////////////////////////////////////////////////////////
+        class JAUS_CORE_DLL Changes
+        {
+        public:
+            Changes() {}
+            ~Changes() {}
+            bool IsEmpty() const { return mSubsystems.size() == 0; }
+            Address::List mAdded;           ///<  Components discovered.
+            Address::List mRemoved;         ///<  Components lost.
+            Address::List mChanged;         ///<  Components with new identification, services, authority, or status.
+            std::set<UShort> mSubsystems;   ///<  Subsystems with any changes.
+        };
+        ////////////////////////////////////////////////////////////////////////////////////
+        ///
         ///   \class Callback
         ///   \brief Callback class used to be notified when a Subsystem is discovered,
         ///          updated, or disconnects from system.
@@ -90,6 +157,8 @@ namespace JAUS
             Callback() {}
             virtual ~Callback() {}  
             virtual void ProcessSystemState(const Subsystem::Map& system){};
+            // Called with the current system and what changed since the last call (calls ProcessSystemState by default).
+            virtual void ProcessSystemChanges(const Snapshot::Ptr& system, const Changes& changes) { ProcessSystemState(system->mSystem); }
         };
         typedef std::map<UShort, std::string> List; ///<  List of discovered subsystems.
         Discovery();
@@ -106,6 +175,8 @@ namespace JAUS
         virtual void Receive(const Message* message);  
         // Creates messages associated with the events service.
         virtual Message* CreateMessage(const UShort messageCode) const;
+        // Adds authority and status reports to the messages received.
+        virtual void GetReceivedMessageCodes(std::set<UShort>& messageCodes) const;
         // When called verifies that no subscriptions have been lost.
         virtual void CheckServiceStatus(const unsigned int timeSinceLastCheckMs);
         // Method called when an Event has been signaled, generates an Event message.
@@ -137,16 +208,26 @@ namespace JAUS
         std::string GetNodeIdentification() const { return mNodeIdentification; }
         // Gets this subsystem identification.
         std::string GetComponentIdentification() const { return mComponentIdentification; }
+        // Enables only querying peers again when their configuration generation changes.
+        void EnableIncrementalDiscovery(const bool enable = true, const unsigned int maxBackoffMs = 60000);
+        // Returns true if incremental discovery is enabled.
+        bool IsIncrementalDiscoveryEnabled() const { return mIncrementalDiscoveryFlag; }
+        // Gets the configuration generation advertised by this component (incremental discovery).
+        UInt GetConfigurationGeneration() const { return mGeneration; }
         // Gets a list of subsystems by name and ID.
         List GetSubsystemList() const;
         // Gets a list of subsystems (that are Vehicles) by name and ID.
         List GetVehicleList() const;
         // Gets a list of component IDs with a service.
         Address::List GetComponentsWithService(const std::string& serviceName) const;
+        // Gets component IDs with a service, reusing the storage of the list given.
+        void GetComponentsWithService(const std::string& serviceName, Address::List& components) const;
         // Gets a copy of a specific subsystem configuration.
         Subsystem::Ptr GetSubsystem(const UShort id) const;
         // Gets a copy of a specific subsystem configuration.
         Subsystem::Ptr GetSubsystem(const Address& id) const { return GetSubsystem(id.mSubsystem); }
+        // Gets the last time data was received from a component or subsystem (node and component 0), 0 if unknown.
+        Time::Stamp GetLastHeardTimeMs(const Address& id) const;
         // Gets a copy of vehicle data discovered for a subsystem.
         Vehicle::Ptr GetVehicle(const UShort id) const;
         // Gets a copy of vehicle data discovered for a subsystem.
@@ -175,6 +256,8 @@ namespace JAUS
                                   const Vehicle::Info* info);
         // Gets copy of all the Subsystem data
         void GetSubsystems(Subsystem::Map& subsystems) const;
+        // Gets the current system configuration without copying (includes ignored subsystems).
+        Snapshot::Ptr GetSnapshot() const;
         // Gets copy of all the Vehicle data
         void GetVehicles(Vehicle::Map& vehicles) const;
         // Register to receive updates of subsystems (add or removes callback).
@@ -190,13 +273,40 @@ namespace JAUS
         // Gets the set of subsystems you want to discover (if empty, all are discovered).
         std::set<UShort> GetSubsystemsToDiscover() const;
     private:
+        ////////////////////////////////////////////////////////////////////////////////////
+        ///
+        ///   \class Peer
+        ///   \brief Configuration generation of a component responding to
+        ///          discovery queries, used for incremental discovery.
+        ///
+        ////////////////////////////////////////////////////////////////////////////////////
+        class Peer
+        {
+        public:
+            Peer() : mGeneration(0), mBackoffMs(0), mNextQueryTimeMs(0) {}
+            UInt mGeneration;               ///<  Last configuration generation reported.
+            unsigned int mBackoffMs;        ///<  Time between queries while generation is unchanged.
+            Time::Stamp mNextQueryTimeMs;   ///<  Time to query the peer even if generation is unchanged.
+            Address::Set mComponents;       ///<  Components in the last configuration reported.
+        };
+        // Updates peer generation, returns true if the peer must be queried (call with mSubsystemDataMutex locked).
+        bool CheckPeerGeneration(const Address& peer, const UInt generation, const bool haveConfiguration);
+        // Publishes a new Snapshot with the current data of subsystems (call with mSubsystemDataMutex locked).
+        void PublishSnapshot(const std::set<UShort>& subsystems);
+        // Publishes a new Snapshot with the current data of a subsystem (call with mSubsystemDataMutex locked).
+        void PublishSnapshot(const UShort subsystem);
+        // Publishes a new Snapshot if the shared data of a subsystem changed (call with mSubsystemDataMutex locked).
+        void PublishIfChanged(const UShort subsystem);
         volatile bool mDiscoverSubsystemsFlag;  ///<  If true, subsystems are also discovered.
         volatile bool mTriggerCallbacksFlag;    ///<  If true, trigger discovery callbacks.
         SharedMutex mSubsystemDataMutex;        ///<  Mutex for protection of subsystem data.
         SharedMutex mCallbacksMutex;            ///<  Mutex for protection of callback data.
+        SharedMutex mSubsystemsToDiscoverMutex; ///<  Mutex for protection of subsystems to discover.
         unsigned int mBroadcastDelayMs;         ///<  Time between broadcasts in ms.
         Time::Stamp mBroadcastTimeMs;           ///<  The last time a discovery query was broadcast.
-        Subsystem::Map mSystem;                 ///<  System configuration.
+        Subsystem::Map mSystem;                 ///<  System configuration (working copy).
+        Snapshot::Ptr mSnapshot;                ///<  Published system configuration (use boost::atomic_load/store).
+        Snapshot::Ptr mCallbackSnapshot;        ///<  Snapshot last given to callbacks.
         Callback::Set mCallbacks;               ///<  Discovery callbacks.
         std::string mComponentIdentification;   ///<  Identification string of the component [255 char max].
         std::string mNodeIdentification;        ///<  Identification string of the node [255 char max].
@@ -204,6 +314,12 @@ namespace JAUS
         Subsystem::Type mSubsystemType;         ///<  Subsystem type information.
         Address::Set mSubsystemList;            ///<  List of components broadcasting globally for subsystem discovery.
         std::set<UShort> mSubsystemsToDiscover; ///<  Subsystems to discover.
+        volatile bool mIncrementalDiscoveryFlag;///<  If true, peers are only queried when their generation changes.
+        unsigned int mMaxBackoffMs;             ///<  Maximum time between queries of peers with unchanged generation.
+        volatile UInt mGeneration;              ///<  Configuration generation advertised by this component.
+        std::map<Address, Peer> mPeers;         ///<  Peers by component ID (protected by mSubsystemDataMutex).
+        std::map<UShort, Time::Stamp> mSubsystemHeardMs;   ///<  Last time data was received from a subsystem (not published).
+        std::map<Address, Time::Stamp> mComponentHeardMs;  ///<  Last time data was received from a component (not published).
     };
 }
 
@@ -84,6 +84,10 @@ namespace JAUS
         QueryType GetQueryType() const { return mQueryType; }
         IdentificationType GetType() const { return mIdentificationType; }
         std::string GetIdentification() const { return mIdentification; }
+        // Sets the configuration generation (0 = not sent, JAUS++ extension).
+        void SetGeneration(const UInt generation) { mGeneration = generation; }
+        // Gets the configuration generation (0 if not sent).
+        UInt GetGeneration() const { return mGeneration; }
         virtual bool IsCommand() const { return false; }
         virtual int WriteMessageBody(Packet& packet) const;
         virtual int ReadMessageBody(const Packet& packet);
@@ -100,6 +104,7 @@ namespace JAUS
         QueryType mQueryType;                   ///<  Type of query the report is responding to.
         IdentificationType mIdentificationType; ///<  Type of subsystem, node type, or component type.
         std::string mIdentification;            ///<  Identification name [up to 255 characters].
+        UInt mGeneration;                       ///<  Configuration generation of the sender (0 if not sent).
     };
 }
 
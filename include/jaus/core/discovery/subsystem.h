@@ -86,7 +86,7 @@ namespace JAUS
             int mStatus;                    ///< Status of the component (init, standby, etc.) -1 if not set.
             std::string mIdentification;    ///< Identification string for component.
             Service::ID::Set mServices;     ///< Component services.
-            Time mUpdateTime;               ///< Last time we received heartbeat/data from the component.
+            Time mUpdateTime;               ///< Time the component was added (see Discovery::GetLastHeardTimeMs for liveness).
         };
         typedef boost::shared_ptr<JAUS::Subsystem> Ptr;
         typedef std::map<Byte, Component::Set> Configuration;
@@ -42,11 +42,18 @@
 
 #include "jaus/core/service.h"
 #include "jaus/core/transport/transport.h"
+#include "jaus/core/transport/asyncresponse.h"
 #include <cxutils/timer.h>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 #include <map>
+#include <queue>
 
 namespace JAUS
 {
+    class ConfirmEventRequest;
+    class CreateEventResponse;
+
     ////////////////////////////////////////////////////////////////////////////////////
     ///
     ///   \class Events
@@ -62,6 +69,7 @@ namespace JAUS
     ////////////////////////////////////////////////////////////////////////////////////
     class JAUS_CORE_DLL Events : public Service
     {
+        friend class CreateEventResponse;
     public:
         const static std::string Name; ///< String name of the Service.
         // Type of Events
@@ -98,6 +106,34 @@ namespace JAUS
         private:
             double mTriggerTimeSeconds; ///< Trigger time in seconds.
             Service* mpEventService;    ///< The service needed for the event.
+            const List* mpSharedSubscriptions; ///< Subscriptions using the same report data (during generation).
+            UInt mScheduleID;           ///< ID of the periodic deadline scheduled for the event.
+        };
+        ////////////////////////////////////////////////////////////////////////////////////
+        ///
+        ///   \class TimingStatistics
+        ///   \brief Statistics on how well Periodic events are meeting their
+        ///          deadlines.
+        ///
+        ///   Jitter is the time between when a Periodic event was due and when
+        ///   it was generated.  A missed deadline is a period that was skipped
+        ///   entirely because the event was generated too late.
+        ///
+        ////////////////////////////////////////////////////////////////////////////////////
+        class JAUS_CORE_DLL TimingStatistics
+        {
+        public:
+            TimingStatistics() { Clear(); }
+            ~TimingStatistics() {}
+            void Clear()
+            {
+                mEventsGenerated = mMissedDeadlines = 0;
+                mMeanJitterMs = mMaxJitterMs = 0.0;
+            }
+            unsigned int mEventsGenerated;  ///< Number of Periodic events generated.
+            unsigned int mMissedDeadlines;  ///< Number of Periodic deadlines skipped.
+            double mMeanJitterMs;           ///< Mean jitter in ms.
+            double mMaxJitterMs;            ///< Largest jitter in ms.
         };
         ////////////////////////////////////////////////////////////////////////////////////
         ///
@@ -177,6 +213,18 @@ namespace JAUS
                                   const double desiredPeriodicRate = 1.0,         // Update rate desired.
                                   const double minimumPeriodicRate = 0.9,         // Minimum rate acceptable (slightly less for rounding error).
                                   const unsigned int waitTimeMs = DefaultWaitMs); // How long to wait for confirmation. 
+        // Request an Every Change Event without blocking (check or wait on the handle returned).
+        AsyncResponse::Ptr RequestEveryChangeEventAsync(const Address& provider,
+                                                        const Message* query,
+                                                        AsyncResponse::Callback* callback = NULL,
+                                                        const unsigned int waitTimeMs = Service::DefaultWaitMs);
+        // Request a Periodic Event without blocking (check or wait on the handle returned).
+        AsyncResponse::Ptr RequestPeriodicEventAsync(const Address& provider,
+                                                     const Message* query,
+                                                     const double desiredPeriodicRate = 1.0,
+                                                     const double minimumPeriodicRate = 0.9,
+                                                     AsyncResponse::Callback* callback = NULL,
+                                                     const unsigned int waitTimeMs = Service::DefaultWaitMs);
         // Signals the Events service that the type of data has changed.
         void SignalEvent(const UShort reportMessageCode, const bool changeOnly = true);
         // Signals the Events service that the type of data has changed.
@@ -218,10 +266,53 @@ namespace JAUS
         void RegisterCallback(Events::Callback* callback);
         // Prints status about the service.
         virtual void PrintStatus() const;
+        // Gets timing statistics for Periodic events.
+        TimingStatistics GetTimingStatistics(const bool reset = false);
     private:
+        ////////////////////////////////////////////////////////////////////////////////////
+        ///
+        ///   \class Deadline
+        ///   \brief Time a Periodic event must next be generated at, stored in
+        ///          a min-heap so only events that are due are visited.
+        ///
+        ////////////////////////////////////////////////////////////////////////////////////
+        class Deadline
+        {
+        public:
+            Deadline() : mTimeSeconds(0), mKey(0), mScheduleID(0) {}
+            // Used to order the heap so the earliest deadline is on top.
+            bool operator<(const Deadline& deadline) const { return mTimeSeconds > deadline.mTimeSeconds; }
+            double mTimeSeconds;    ///< Time the event is due in seconds.
+            UInt mKey;              ///< Key of the event in the events map.
+            UInt mScheduleID;       ///< Must match the subscription, otherwise it is stale.
+        };
         bool CancelSubscription(Subscription& sub, const unsigned int waitTimeMs);
-        static void PeriodicEvent(void* args);
-        CxUtils::Timer mPeriodicTimer;      ///<  Timer object used for periodic events.
+        Byte ReserveRequestID();
+        void ReleaseRequestID(const Byte requestID);
+        void AddSubscription(const Address& provider,
+                             const Message* query,
+                             const Events::Type type,
+                             const ConfirmEventRequest& confirm);
+        AsyncResponse::Ptr RequestEventAsync(const Address& provider,
+                                             const Message* query,
+                                             const Events::Type type,
+                                             const double desiredPeriodicRate,
+                                             const double minimumPeriodicRate,
+                                             AsyncResponse::Callback* callback,
+                                             const unsigned int waitTimeMs);
+        void GenerateEvents(const Subscription::List& subscriptions) const;
+        static bool IsSameReport(const Subscription& first, const Packet& firstQuery,
+                                 const Subscription& second, const Packet& secondQuery);
+        static const Subscription::List* GetSharedSubscriptions(const Subscription& info) { return info.mpSharedSubscriptions; }
+        void SchedulePeriodicEvent(const UInt key, Subscription& subscription);
+        void GeneratePeriodicEvents(const std::vector<Deadline>& due, const double fireTimeSeconds);
+        static void PeriodicEventThread(void* args);
+        Thread mPeriodicThread;                     ///<  Thread used to generate periodic events.
+        boost::mutex mScheduleMutex;                ///<  Mutex for periodic event deadlines.
+        boost::condition_variable mScheduleCondition; ///<  Wakes periodic thread when deadlines change.
+        std::priority_queue<Deadline> mSchedule;    ///<  Periodic event deadlines (earliest on top).
+        UInt mNextScheduleID;                       ///<  Next ID to give a scheduled deadline.
+        TimingStatistics mTimingStatistics;         ///<  Periodic event timing statistics.
         SharedMutex mEventsMutex;           ///<  Mutex for thread protection of event data.
         Subscription::Map  mEvents;         ///<  Events being produced.
         Subscription::List mSubscriptions;  ///<  Events being subscribed to.
@@ -103,6 +103,7 @@ namespace JAUS
         {
         public:
             const static Byte Normal       = 0;   ///<  Normal message (other values are reserved by standard).
+            const static Byte Compressed   = 1;   ///<  Multi-packet stream with zlib compressed payload (JAUS++ extension).
         };  
         ////////////////////////////////////////////////////////////////////////////////////
         ///
@@ -143,15 +144,19 @@ namespace JAUS
         public:
             const static Byte None          = 0;    ///<  No header compression.
             const static Byte Request       = 1;    ///<  Request header compression.
+            const static Byte Engaged       = 2;    ///<  Header compression engaged (receiver stored header).
+            const static Byte Compressed    = 3;    ///<  Compressed header.
         };
         static const UShort MinSize    = 14;                       ///<  Minimum header size.
         static const UShort PayloadOffset = MinSize - USHORT_SIZE; ///<  Offset from start of general header to payload.
         static const UShort MaxPacketSize = JAUS_USHORT_MAX;       ///<  Maximum packet size including header.
+        static const UShort DestinationOffset = 4;                 ///<  Offset from start of general header to destination ID.
         typedef std::vector<Header> List;                          ///<  Vector of Header data.
         Header();
         Header(const Header& header);
         ~Header();
         int Write(Packet& packet) const;
+        int WriteRouting(Packet& packet, const unsigned int startPos) const;
         int Read(const Packet& packet);
         bool IsValid(std::string* errorMessage) const;
         Header& operator=(const Header& header);
@@ -164,7 +169,7 @@ namespace JAUS
         Byte mBroadcastFlag;    ///<  Broadcast flag.
         Byte mAckNackFlag;      ///<  ACK/NACK flag.
         Byte mControlFlag;      ///<  Data control flags (single or mulit-packet streams).
-        Byte mCompressionFlag;  ///<  Header compression bits (header compression not supported by JAUS++).
+        Byte mCompressionFlag;  ///<  Header compression bits (only used by JUDP, see HeaderCompression).
 
     };
 }
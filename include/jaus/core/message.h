@@ -145,7 +145,8 @@ namespace JAUS
                                       const UShort maxPayloadSize = 1437, 
                                       const Packet* transportHeader = NULL,
                                       const UShort startingSequenceNumber = 0,
-                                      const Byte broadcastFlag = 0) const;
+                                      const Byte broadcastFlag = 0,
+                                      const unsigned int compressionThreshold = 0) const;
         // Reads/De-serialize data from Packet, and overwrites internal members.
         virtual int Read(const Packet &packet, const Packet* transportHeader = NULL);
         // Reads messages from a multi-packet stream.  Only overload for optimization purposes.
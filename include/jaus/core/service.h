@@ -42,6 +42,8 @@
 #define __JAUS_CORE_SERVICE__H
 
 #include "jaus/core/message.h"
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 #include <string>
 #include <set>
 #include <map>
@@ -72,29 +74,56 @@ namespace JAUS
         ///   interface.  Service Identifiers are based on a Uniform Resource Identifier
         ///   (URI), and are specified for each service by the SAE JAUS standard.
         ///
+        ///   Names are interned in a global table, so each ID also has an integer
+        ///   Handle that is the same for the same name.  Comparisons use the
+        ///   Handle, the name is kept for serialization and display.  Names
+        ///   read from messages are only interned up to a limit, IDs read after
+        ///   that have no Handle and are compared by name.
+        ///
         ////////////////////////////////////////////////////////////////////////////////////
         class JAUS_CORE_DLL ID
         {
         public:
             typedef std::vector<ID> List;
             typedef std::set<ID> Set;
+            typedef UInt Handle;
+            static const Handle NoHandle = 0;   // Handle of an empty name.
+            static const unsigned int MaxReadNames = 1024;  // Names from Read that are interned.
             ID(const std::string& name = "", const double verion = 1.0);
             ID(const ID& id);
             ~ID();
             int Write(Packet& packet) const;
             int Read(const Packet& packet);
             void Clear();
+            // Sets the name of the service (and its Handle).
+            void SetName(const std::string& name);
+            // Gets the name of the service.
+            inline const std::string& GetName() const { return mName; }
+            // Gets the interned handle for the service name (NoHandle if not interned).
+            inline Handle GetHandle() const { return mHandle; }
             std::string ToString(const bool nameOnly = true, const bool trim = true) const;
             ID& operator=(const ID& id);
-            bool operator<(const ID& id) const { return mName < id.mName; }
-            std::string mName;      ///<  Name of the service.
+            bool operator<(const ID& id) const;
+            bool operator==(const ID& id) const { return !(*this < id) && !(id < *this); }
+            bool operator!=(const ID& id) const { return !(*this == id); }
+            // Gets the Handle for a name, adding it to the table if needed.
+            static Handle Intern(const std::string& name);
+            // Gets the Handle for a name, NoHandle if it was never interned.
+            static Handle Find(const std::string& name);
+            // Gets the name for a Handle.
+            static const std::string& GetName(const Handle handle);
             double mVersion;        ///<  Version number.
+        private:
+            std::string mName;      ///<  Name of the service.
+            Handle mHandle;         ///<  Interned name.
         };
         static const int NoBroadcast     = 0;   // No broadcasting over IP (default)
         static const int LocalBroadcast  = 1;   // Use local broadcast transport layer options for sending.
         static const int GlobalBroadcast = 2;   // Use global broadcast transport layer options for sending.
         static const unsigned int DefaultWaitMs = 250;
+        static const unsigned int DefaultSignaledUpdatePeriodMs = 10; // Update period when waiting for signals.
         typedef std::map<std::string, Service*> Map;
+        typedef std::vector<Service*> List;
         // Constructor, initializes ID, and any parent service we inherit from.
         Service(const ID& serviceIdentifier, const ID& parentServiceIdentifier);
         // Destructor.
@@ -124,6 +153,8 @@ namespace JAUS
         virtual void Receive(const Message* message);  
         // Create a message based on the message code.
         virtual Message* CreateMessage(const UShort messageCode) const = 0;
+        // Gets the message codes processed by Receive (empty set means all messages).
+        virtual void GetReceivedMessageCodes(std::set<UShort>& messageCodes) const;
         // Gets the Service ID information.
         inline ID GetServiceID() const { return mServiceID; }
         // Sets the compondent ID.
@@ -172,9 +203,12 @@ namespace JAUS
         bool IsServiceShuttingDown() const { return mShutdownServiceFlag; }
         // Method that can be run in a thread to periodically call UpdateServiceEvent method.
         static void ServiceUpdateThreadFunc(void* servicePointer);
+        // Wakes an update thread waiting for work (see mServiceUpdateSignalFlag).
+        void SignalServiceUpdate();
     protected:
         void StartServiceUpdateEventThread();
         void StopServiceUpdateEventThread();
+        bool WaitForServiceUpdate(const unsigned int timeoutMs);
         void PushMessageToChildren(const Message* message);
         Map GetChildServices();
         const Map GetChildServices() const;
@@ -188,6 +222,7 @@ namespace JAUS
         Thread mServiceUpdateThread;        ///<  Thread for the service to perform updates within.
         unsigned int mServiceUpdateThreadDelayMs;   ///<  Delay time within the services updates in ms.
         volatile bool mSingleThreadModeFlag;        ///<  Running in single thread mode?
+        volatile bool mServiceUpdateSignalFlag;     ///<  If true, update threads sleep until signaled or the update period ends.
     private:
         volatile bool mServiceEnabledFlag;  ///<  If true, the service is ON, otherwise OFF.
         Service::ID mServiceID;       ///<  Service identifier.
@@ -195,6 +230,9 @@ namespace JAUS
         Map mJausChildServices;       ///<  Child services (inherit from this Service 1-to-N).
         Service* mpJausParentService; ///<  Parent service (Service interface we inherit from).
         Transport* mpTransportService;///<  Pointer to the transport service.
+        boost::mutex mServiceUpdateMutex;                   ///<  Mutex for update signals.
+        boost::condition_variable mServiceUpdateCondition;  ///<  Wakes update threads when signaled.
+        unsigned int mServiceUpdateSignals;                 ///<  Number of signals not yet handled.
     };
 }
 
@@ -0,0 +1,137 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file asyncresponse.h
+///  \brief This file contains the AsyncResponse class which is used to
+///  wait for, or be called back with, the response to a message without
+///  blocking the thread that sent it.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#ifndef __JAUS_CORE_TRANSPORT_ASYNC_RESPONSE__H
+#define __JAUS_CORE_TRANSPORT_ASYNC_RESPONSE__H
+
+#include "jaus/core/transport/transport.h"
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace JAUS
+{
+    ////////////////////////////////////////////////////////////////////////////////////
+    ///
+    ///   \class AsyncResponse
+    ///   \brief Handle (future) for a message sent using Transport::SendAsync.
+    ///
+    ///   The sending thread does not block.  The handle can be polled (IsDone),
+    ///   waited on (Wait), or a Callback can be given to be notified when the
+    ///   response arrives, the wait time ends, or the Transport shuts down.  The
+    ///   handle keeps itself alive until then, so callers may drop their copy
+    ///   of the pointer.
+    ///
+    ///   Services derive from this class and override OnResponse to process
+    ///   the response (e.g. add an event subscription) before the request is
+    ///   marked done.
+    ///
+    ////////////////////////////////////////////////////////////////////////////////////
+    class JAUS_CORE_DLL AsyncResponse : public Transport::ResponseCallback
+    {
+    public:
+        typedef boost::shared_ptr<AsyncResponse> Ptr;
+        ////////////////////////////////////////////////////////////////////////////////////
+        ///
+        ///   \class Callback
+        ///   \brief Callback made by a Transport processing thread once a request is
+        ///          done, it must not block.
+        ///
+        ////////////////////////////////////////////////////////////////////////////////////
+        class JAUS_CORE_DLL Callback
+        {
+        public:
+            Callback() {}
+            virtual ~Callback() {}
+            // Called once the request is done (check IsSuccessful).
+            virtual void ProcessAsyncResponse(const AsyncResponse::Ptr& response) = 0;
+        };
+        AsyncResponse(Callback* callback = NULL);
+        virtual ~AsyncResponse();
+        // Sends a message, the handle is kept until a response to the message is received.
+        static bool Send(const Transport* transport,
+                         const AsyncResponse::Ptr& handle,
+                         const Message* message,
+                         const unsigned int waitTimeMs = Service::DefaultWaitMs);
+        // Sends a message, the handle is kept until one of the possible responses is received.
+        static bool Send(const Transport* transport,
+                         const AsyncResponse::Ptr& handle,
+                         const Message* message,
+                         const std::set<UShort>& responseCodes,
+                         const unsigned int waitTimeMs = Service::DefaultWaitMs);
+        // Waits until the request is done (0 = INFINITE), returns true if done.
+        bool Wait(const unsigned int waitTimeMs = 0) const;
+        // Returns true once a response was received, or the wait time ended.
+        bool IsDone() const;
+        // Returns true if done and the response was accepted.
+        bool IsSuccessful() const;
+        // Gets the response (NULL if none or not done yet).
+        const Message* GetResponse() const;
+        // Gets the ID given by Transport::SendAsync.
+        UInt GetID() const;
+        // Stops waiting for a response, no callback is made.
+        bool Cancel();
+        // Called by the Transport with the response (NULL on timeout or shutdown).
+        virtual void ProcessResponse(const UInt id, const Message* response);
+    protected:
+        // Processes the response (NULL on timeout or cancel) before the request is done, true if successful.
+        virtual bool OnResponse(const Message* response) { return response != NULL; }
+        // Called once when the request is done for any reason (including a failed send).
+        virtual void OnFinish(const bool success) {}
+    private:
+        AsyncResponse(const AsyncResponse& response);
+        AsyncResponse& operator=(const AsyncResponse& response);
+        // Marks the request done, and releases the handle.
+        Ptr Finish(const UInt id, const Message* response, const bool success);
+        mutable boost::mutex mMutex;                        ///<  Mutex for thread protection.
+        mutable boost::condition_variable mDoneCondition;   ///<  Notifies waiting threads when done.
+        const Transport* mpTransport;   ///<  Transport the message was sent with.
+        Callback* mpCallback;           ///<  Callback to make when done.
+        Ptr mSelf;                      ///<  Keeps the handle alive while waiting for a response.
+        UInt mID;                       ///<  ID from Transport::SendAsync.
+        bool mDoneFlag;                 ///<  If true, request is done.
+        bool mSuccessFlag;              ///<  If true, response was accepted.
+        Message* mpResponse;            ///<  Copy of response received.
+    };
+}
+
+#endif
+/*  End of File */
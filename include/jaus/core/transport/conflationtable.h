@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file conflationtable.h
+///  \brief This file contains the ConflationTable class which is used
+///  to keep only the newest state report from a source in the receive queue.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#ifndef __JAUS_CORE_TRANSPORT_CONFLATION_TABLE__H
+#define __JAUS_CORE_TRANSPORT_CONFLATION_TABLE__H
+
+#include "jaus/core/header.h"
+#include <set>
+#include <map>
+
+namespace JAUS
+{
+    ////////////////////////////////////////////////////////////////////////////////////
+    ///
+    ///   \class ConflationTable
+    ///   \brief Latest value table for state reports (e.g. Report Global Pose)
+    ///          waiting in a receive queue.
+    ///
+    ///   Conflation is enabled per message code.  Packets are keyed by source,
+    ///   message code, and event ID (Event messages are keyed by the report
+    ///   they contain).  Only one packet per key is queued.  If a newer packet
+    ///   with the same key arrives before the queued one is processed, its data
+    ///   is stored in the table instead, and copied over the queued packet when
+    ///   it is removed from the queue.  A consumer that falls behind then always
+    ///   gets the freshest state, and queue memory is bounded by the number of
+    ///   keys.
+    ///
+    ////////////////////////////////////////////////////////////////////////////////////
+    class JAUS_CORE_DLL ConflationTable
+    {
+    public:
+        static const unsigned int DefaultTimeoutMs = 1000;  ///<  Default time before a queued packet is assumed lost.
+        /** Identifies the state a packet reports. */
+        class JAUS_CORE_DLL Key
+        {
+        public:
+            Key() : mSource(0), mMessageCode(0), mEventID(0), mEventFlag(false) {}
+            ~Key() {}
+            bool operator<(const Key& key) const;
+            UInt mSource;           ///<  Source component ID.
+            UShort mMessageCode;    ///<  Message code (report code for Event messages).
+            Byte mEventID;          ///<  Event ID if the report is part of an Event message.
+            bool mEventFlag;        ///<  If true, the report is part of an Event message.
+        };
+        ConflationTable();
+        ~ConflationTable();
+        // Enables conflation of a message type (or report type sent as an Event).
+        void Enable(const UShort messageCode, const bool enable = true);
+        // Returns true if a message type is conflated.
+        bool IsEnabled(const UShort messageCode) const;
+        // Gets the key of a packet, false if the message type is not conflated.
+        bool GetKey(const Packet& packet, const Header& header, Key& key) const;
+        // Stores the packet, returns true if it must be queued, false if it replaced a queued one.
+        bool Update(const Key& key, const Packet& packet);
+        // Called when a queued packet could not be queued (so it is not waited on).
+        void Cancel(const Key& key);
+        // Called when a queued packet is removed, copies newer data over it.
+        bool Take(const Key& key, Packet& packet);
+        // Sets how long a packet can be queued before it is assumed lost.
+        void SetTimeoutMs(const unsigned int timeoutMs) { mTimeoutMs = timeoutMs; }
+        // Removes all stored data.
+        void Clear();
+        /** Gets the number of packets replaced by newer data. */
+        unsigned int GetConflatedCount() const { return mConflatedCount; }
+        // Gets the number of keys in the table.
+        unsigned int GetKeyCount() const;
+    private:
+        /** Newest data for a key. */
+        struct Entry
+        {
+            Entry() : mQueuedFlag(false), mUpdatedFlag(false), mQueueTimeSeconds(0) {}
+            Packet mLatest;             ///<  Newest packet received while one was queued.
+            bool mQueuedFlag;           ///<  If true, a packet with this key is queued.
+            bool mUpdatedFlag;          ///<  If true, mLatest is newer than the queued packet.
+            double mQueueTimeSeconds;   ///<  Time the packet was queued.
+        };
+        Mutex mMutex;                           ///<  Mutex for thread protection.
+        volatile bool mEnabledFlag;             ///<  If true, at least one message type is conflated.
+        std::set<UShort> mMessageCodes;         ///<  Message types conflated.
+        std::map<Key, Entry> mEntries;          ///<  Newest data by key.
+        volatile unsigned int mTimeoutMs;       ///<  Time before a queued packet is assumed lost.
+        volatile unsigned int mConflatedCount;  ///<  Number of packets replaced by newer data.
+    };
+}
+
+#endif
+/*  End of File */
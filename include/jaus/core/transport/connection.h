@@ -41,6 +41,7 @@
 
 #include "jaus/core/message.h"
 #include "jaus/core/service.h"
+#include "jaus/core/transport/trafficshaper.h"
 #include <set>
 #include <cxutils/networking/ip4address.h>
 #include <boost/shared_ptr.hpp>
@@ -49,6 +50,7 @@ namespace JAUS
 {
     typedef CxUtils::IP4Address IP4Address; ///<  Forward type defintion.
     class NodeManager;  // Forward
+    class Reactor;      // Forward
 
     ////////////////////////////////////////////////////////////////////////////////////
     ///
@@ -61,6 +63,8 @@ namespace JAUS
     class JAUS_CORE_DLL Connection
     {
         friend class NodeManager;
+        friend class Reactor;
+        friend class TrafficShaper;
     public:
         typedef boost::shared_ptr<Connection> Ptr;  ///<  Connection pointer.
         typedef std::map<UInt, Ptr> Map;            ///<  Connection map.
@@ -146,6 +150,13 @@ namespace JAUS
                 mTotalBytesReceived = 0;
                 mBytesSent = 0;
                 mTotalBytesSent = 0;
+                mHeaderBytesSaved = 0;
+                mTotalHeaderBytesSaved = 0;
+                mRateLimit = 0;
+                mQueuedBytes = 0;
+                mMaxQueuedBytes = 0;
+                mPacketsDropped = 0;
+                mTotalPacketsDropped = 0;
             }
             Statistics& operator=(const Statistics& stats)
             {
@@ -163,6 +174,13 @@ namespace JAUS
                     mTotalBytesReceived = stats.mTotalBytesReceived;
                     mBytesSent = stats.mBytesSent;
                     mTotalBytesSent = stats.mTotalBytesSent;
+                    mHeaderBytesSaved = stats.mHeaderBytesSaved;
+                    mTotalHeaderBytesSaved = stats.mTotalHeaderBytesSaved;
+                    mRateLimit = stats.mRateLimit;
+                    mQueuedBytes = stats.mQueuedBytes;
+                    mMaxQueuedBytes = stats.mMaxQueuedBytes;
+                    mPacketsDropped = stats.mPacketsDropped;
+                    mTotalPacketsDropped = stats.mTotalPacketsDropped;
                 }
                 return *this;
             }
@@ -177,6 +195,13 @@ namespace JAUS
             unsigned int mTotalBytesSent;           ///<  Total bytes sent.
             unsigned int mBytesReceived;            ///<  Number of bytes received since last check.
             unsigned int mTotalBytesReceived;       ///<  Total bytes received.
+            unsigned int mHeaderBytesSaved;         ///<  Bytes saved by header compression since last check.
+            unsigned int mTotalHeaderBytesSaved;    ///<  Total bytes saved by header compression.
+            unsigned int mRateLimit;                ///<  Outgoing rate limit in bytes per second (0 = none).
+            unsigned int mQueuedBytes;              ///<  Bytes waiting for the rate limit.
+            unsigned int mMaxQueuedBytes;           ///<  Most bytes waiting for the rate limit at once.
+            unsigned int mPacketsDropped;           ///<  Packets dropped by the rate limit since last check.
+            unsigned int mTotalPacketsDropped;      ///<  Total packets dropped by the rate limit.
         };
         ////////////////////////////////////////////////////////////////////////////////////
         ///
@@ -280,6 +305,12 @@ namespace JAUS
         virtual unsigned int GetTransportOverheadInBytes() const = 0;
         /** Method indicates if the connection is send only (doesn't receive) */
         virtual bool IsSendOnly() const { return false; }
+        /** Method indicates UpdateConnection blocks until data arrives, so no delay
+            is needed between updates in multi-threaded mode. */
+        virtual bool WaitsForData() const { return false; }
+        /** Gets the OS descriptor data is received on, so that readiness can be
+            multiplexed by a Reactor (-1 if the connection has none). */
+        virtual int GetDescriptor() const { return -1; }
         /** Gets the recommend maximum packet size for the transport. */
         virtual unsigned int GetMaximumPacketSizeInBytes() const { return 1500; }
         /** Creates a parameters object for initialization. */
@@ -346,6 +377,10 @@ namespace JAUS
         virtual Time::Stamp GetUpdateTimeUtcMs() const { return mUpdateTimeMs; }
         /** Sets the node manager pointer. */
         void SetNodeManager(NodeManager* nm);
+        // Limits the rate data is sent, use 0 for no limit.
+        void SetRateLimit(const unsigned int bytesPerSecond,
+                          const unsigned int burstBytes = 0,
+                          const unsigned int maxQueuedBytes = 0);
         /** Updates the connection update time. */
         void SignalConnectionUpdate(unsigned int bytesReceived = 0)
         {
@@ -365,6 +400,13 @@ namespace JAUS
         virtual bool SendToCallbacks(const Packet& jausPacket,
                                      const Header& jausHeader,
                                      const Connection::Info* sourceInfo);
+        // Sends, queues, or drops a packet based on the rate limit (see TrafficShaper).
+        int ShapeTraffic(const Packet& packet, const Header& header) const;
+        /** Sends a packet the rate limit has allowed (by default uses SendPacket). */
+        virtual bool TransmitPacket(const Packet& packet,
+                                    const Header& packetHeader) const { return SendPacket(packet, packetHeader); }
+        // Sends a packet that was waiting for the rate limit.
+        void SendQueuedPacket(const Packet& packet, const Header& packetHeader) const;
         int mTransportType;                         ///<  Connection type (e.g. JTCP, JUDP, JSerial)
         Address mID;                                ///<  ID of the JAUS component the connection is for.
         Address mSourceID;                          ///<  ID of the JAUS component the connection is from.
@@ -381,6 +423,8 @@ namespace JAUS
         volatile Time::Stamp mUpdateTimeMs;         ///<  Last time UTC in ms that data was received.
         NodeManager* mpManager;                     ///<  Connection manager.
         unsigned int mConnectionNumber;             ///<  Connection number.
+        Reactor* mpReactor;                         ///<  Reactor updating the connection when data is ready (NULL if polled).
+        TrafficShaper::Ptr mpShaper;                ///<  Limits outgoing data rate (shared by connections on the same socket).
     private:
         static unsigned int ConnectionCounter;  ///<  For generated a unique connection ID.
         Callback::Set mCallbacks;               ///<  Pointer to the callback objects receiving data.
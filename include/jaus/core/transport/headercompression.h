@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file headercompression.h
+///  \brief This file contains the table of header templates used to
+///  compress/expand JAUS general transport headers for JUDP.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#ifndef __JAUS_CORE_TRANSPORT_HEADER_COMPRESSION__H
+#define __JAUS_CORE_TRANSPORT_HEADER_COMPRESSION__H
+
+#include "jaus/core/header.h"
+#include "jaus/core/time.h"
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <vector>
+#include <map>
+
+namespace JAUS
+{
+    ////////////////////////////////////////////////////////////////////////////////////
+    ///
+    ///   \class HeaderCompression
+    ///   \brief Keeps the header templates sent to and received from peers, used
+    ///          to replace repeated JAUS general header data with a reference.
+    ///
+    ///   A template is the data control/priority flags, destination, source,
+    ///   and message code of a packet (TemplateSize bytes).  Packets using header
+    ///   compression have an HC number and HC length field after the data
+    ///   size in the general header:
+    ///
+    ///   - Compression::Request - Full packet, the receiver stores the template
+    ///     under the HC number and replies with Compression::Engaged.
+    ///   - Compression::Engaged - Reply containing the stored template, after
+    ///     which the sender uses compressed headers.
+    ///   - Compression::Compressed - The template is left out of the packet,
+    ///     and restored by the receiver using the HC number.
+    ///
+    ///   Templates are sent again every RefreshTimeMs so a receiver that lost
+    ///   them recovers.  One table is shared by all JUDP connections using the
+    ///   same socket, since receivers identify templates by source address and
+    ///   HC number.
+    ///
+    ////////////////////////////////////////////////////////////////////////////////////
+    class JAUS_CORE_DLL HeaderCompression
+    {
+    public:
+        typedef boost::shared_ptr<HeaderCompression> Ptr;
+        static const unsigned int FieldsSize = 2;           ///<  Size of HC number and HC length fields.
+        static const unsigned int CompressedHeaderSize = 5; ///<  Size of a general header with HC fields, up to the data flags.
+        static const unsigned int FlagsOffset = 3;          ///<  Offset of data flags (start of template) in header.
+        static const unsigned int TemplateSize = 11;        ///<  Flags, destination, source, and message code.
+        static const unsigned int MaxTemplates = 255;       ///<  Number of HC numbers available (0 is not used).
+        static const unsigned int RefreshTimeMs = 1000;     ///<  How often templates are sent again.
+        HeaderCompression();
+        ~HeaderCompression();
+        bool Compress(const Packet& packet, Packet& output);
+        int Expand(const unsigned char* data,
+                   const unsigned int length,
+                   const std::string& source,
+                   Packet& packet,
+                   Packet& reply);
+    private:
+        /** Template sent to a receiver. */
+        class Template
+        {
+        public:
+            Template() : mEngagedFlag(false), mRequestTimeMs(0), mUsedTimeMs(0) {}
+            std::string mData;              ///<  Template data.
+            bool mEngagedFlag;              ///<  True if the receiver has stored the template.
+            Time::Stamp mRequestTimeMs;     ///<  Last time the template was sent.
+            Time::Stamp mUsedTimeMs;        ///<  Last time the template was used.
+        };
+        Mutex mMutex;                                       ///<  Mutex for thread protection of tables.
+        std::map<std::string, Byte> mNumbers;               ///<  HC number of templates sent.
+        std::vector<Template> mTemplates;                   ///<  Templates sent (index is HC number - 1).
+        std::map<std::pair<std::string, Byte>, std::string> mReceived; ///<  Templates received by source address and HC number.
+    };
+}
+
+#endif
+/*  End of File */
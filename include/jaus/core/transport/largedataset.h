@@ -36,26 +36,40 @@
 ///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
 ///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ///
-////////////////////////////////////////////////////////////////////////////////////
-#ifndef __JAUS_CORE_LARGE_DATA_SET__H
-#define __JAUS_CORE_LARGE_DATA_SET__H
-
-#include "jaus/core/header.h"
-#include "jaus/core/time.h"
-#include <map>
-
-namespace JAUS
-{
+////////////////////////////////////////////////////////////////////////////////////
+#ifndef __JAUS_CORE_LARGE_DATA_SET__H
+#define __JAUS_CORE_LARGE_DATA_SET__H
+
+#include "jaus/core/header.h"
+#include "jaus/core/time.h"
+#include <map>
+
+namespace JAUS
+{
     ////////////////////////////////////////////////////////////////////////////////////
     ///
     ///   \class LargeDataSet
     ///   \brief Data structure for storing multi-packet sequence data and
     ///          merging/splitting up data packets.
     ///
-    ////////////////////////////////////////////////////////////////////////////////////
-    class JAUS_CORE_DLL LargeDataSet
-    {
-    public:        
+    ///   Packets received are copied directly to their final position in a
+    ///   single buffer (mBuffer), which is sized from the first and last
+    ///   packets of the sequence.  Once complete, mBuffer contains the merged
+    ///   message in the same format produced by MergeLargeDataSet, so a message
+    ///   can be read from it without any additional copies.  Packets received
+    ///   before the first packet of the sequence are held in mStream until
+    ///   their position is known.
+    ///
+    ///   Payloads may be compressed with zlib when a multi-packet stream is
+    ///   created.  Compressed streams are marked with a message type of
+    ///   Header::MessageType::Compressed, and the payload starts with the
+    ///   uncompressed size (UInt) followed by the zlib data.  They are
+    ///   decompressed once complete, or when merged.
+    ///
+    ////////////////////////////////////////////////////////////////////////////////////
+    class JAUS_CORE_DLL LargeDataSet
+    {
+    public:        
         ////////////////////////////////////////////////////////////////////////////////////
         ///
         ///   \class Key
@@ -67,56 +81,81 @@ namespace JAUS
         public:
             Key(const Address& src = Address(),
                 const UShort code = 0,
-                const UInt pv = 0);
+                const UInt pv = 0);
             Key(const Key& key);
-            ~Key();
+            ~Key();
             void Update() const;
             bool operator<(const Key& key) const;
-            bool operator<=(const Key& key) const;
+            bool operator<=(const Key& key) const;
             Key& operator=(const Key& key);
             Address mSourceID;           ///<  Message source Address.
             UShort mMessageCode;    ///<  Type of message stored in data set.
             ULong mPresenceVector;  ///<  Presence vector associated with message data.
-            Byte mIdentifier;       ///<  Additional identifier for multiple multi-packet streams.
+            Byte mIdentifier;       ///<  Additional identifier for multiple multi-packet streams.
             Packet mKey;            ///<  Serialized version of key data (for fast comparisons).
-        };
-        typedef std::map<UShort, Packet> Stream;
-        typedef std::map<LargeDataSet::Key, LargeDataSet*> Map;
-        LargeDataSet();
-        ~LargeDataSet();
-        void Clear();
-        bool AddPacket(const Packet& message);
-        bool AddPacket(const Header& header, 
-                       const UShort messageCode, 
-                       const Packet& packet);
-        static void CreateLargeDataSet(const Header& header,
-                                       const UShort messageCode,
-                                       const Packet& payload,
-                                       Packet::List& stream,
-                                       Header::List& streamHeaders,
-                                       const Packet* transportHeader = NULL,
-                                       const UShort maxPayloadSize = 1437,
-                                       const UShort startingSequenceNumber = 0);
-        static bool MergeLargeDataSet(Header& header,
-                                      UShort& messageCode,
-                                      Packet& payload,
-                                      const Packet::List& stream,
-                                      const Packet* transportHeader = NULL);
-        static bool MergeLargeDataSet(Header& header,
-                                      UShort& messageCode,
-                                      Packet& payload,
-                                      const Stream& stream,
-                                      const Packet* transportHeader = NULL);
-        Header mHeader;                 ///<  Message header information.
-        UShort mMessageCode;            ///<  Message type.
-        bool mHaveLastFlag;             ///<  True if the last packet has been received.
-        bool mCompleteFlag;             ///<  If true, the large data set is complete.
-        Stream mStream;                 ///<  The multi-packet stream sequence collected.
-        std::set<UShort> mMissing;      ///<  Missing packet in in the stream sequence.
-        Time::Stamp mUpdateTimeMs;      ///<  The last time data was added to the stream.
-    };
-}
-
-#endif
-
-/* End of File */
+        };
+        typedef std::map<UShort, Packet> Stream;
+        typedef std::map<LargeDataSet::Key, LargeDataSet*> Map;
+        static const unsigned int DataOffset = Header::PayloadOffset + USHORT_SIZE; ///<  Offset of payload data in merged buffer.
+        static const unsigned int MaxDecompressedSize = 64*1024*1024;              ///<  Largest payload accepted when decompressing.
+        LargeDataSet();
+        ~LargeDataSet();
+        void Clear();
+        bool AddPacket(const Packet& message);
+        bool AddPacket(const Header& header, 
+                       const UShort messageCode, 
+                       const Packet& packet);
+        unsigned int GetMemoryUsage() const;
+        bool GetMissingPackets(UShort& reference,
+                               std::vector<UShort>& ranges,
+                               const unsigned int maxRanges = 64) const;
+        static void CreateLargeDataSet(const Header& header,
+                                       const UShort messageCode,
+                                       const Packet& payload,
+                                       Packet::List& stream,
+                                       Header::List& streamHeaders,
+                                       const Packet* transportHeader = NULL,
+                                       const UShort maxPayloadSize = 1437,
+                                       const UShort startingSequenceNumber = 0,
+                                       const unsigned int compressionThreshold = 0);
+        static bool CompressPayload(const Packet& payload, Packet& compressed);
+        static bool DecompressPayload(const Packet& compressed,
+                                      const unsigned int offset,
+                                      Packet& payload,
+                                      const unsigned int maxSize = MaxDecompressedSize);
+        static bool MergeLargeDataSet(Header& header,
+                                      UShort& messageCode,
+                                      Packet& payload,
+                                      const Packet::List& stream,
+                                      const Packet* transportHeader = NULL);
+        static bool MergeLargeDataSet(Header& header,
+                                      UShort& messageCode,
+                                      Packet& payload,
+                                      const Stream& stream,
+                                      const Packet* transportHeader = NULL);
+        Header mHeader;                 ///<  Message header information.
+        UShort mMessageCode;            ///<  Message type.
+        bool mHaveLastFlag;             ///<  True if the last packet has been received.
+        bool mCompleteFlag;             ///<  If true, the large data set is complete.
+        bool mHaveFirstFlag;            ///<  True if the first packet has been received.
+        UShort mFirstSequenceNumber;    ///<  Sequence number of the first packet.
+        UShort mLastSequenceNumber;     ///<  Sequence number of the last packet.
+        unsigned int mPacketDataSize;   ///<  Size of data in each packet (except the last).
+        unsigned int mNumReceived;      ///<  Number of packets copied into the buffer.
+        std::vector<bool> mReceived;    ///<  Bitmap of packets received (index from first packet).
+        Packet mBuffer;                 ///<  Merged message data (header, message code, payload).
+        Stream mStream;                 ///<  Packets received before the first packet.
+        Time::Stamp mUpdateTimeMs;      ///<  The last time data was added to the stream.
+        Time::Stamp mNackTimeMs;        ///<  The last time missing packets were requested.
+        unsigned int mNumNacks;         ///<  Number of times missing packets were requested.
+        unsigned int mMemoryLimit;      ///<  Most memory in bytes the data set may use (0 = no limit).
+    protected:
+        bool CopyPacket(const Header& header, const Packet& packet);
+        static bool DecompressMergedPayload(Packet& merged,
+                                            const unsigned int maxSize = MaxDecompressedSize);
+    };
+}
+
+#endif
+
+/* End of File */
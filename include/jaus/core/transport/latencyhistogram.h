@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file latencyhistogram.h
+///  \brief This file contains the definition of the LatencyHistogram class
+///  used to measure message delivery latency.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#ifndef __JAUS_CORE_TRANSPORT_LATENCY_HISTOGRAM__H
+#define __JAUS_CORE_TRANSPORT_LATENCY_HISTOGRAM__H
+
+#include "jaus/core/types.h"
+#include <boost/atomic.hpp>
+#include <string>
+#include <vector>
+
+namespace JAUS
+{
+    ////////////////////////////////////////////////////////////////////////////////////
+    ///
+    ///   \class LatencyHistogram
+    ///   \brief Lock-free histogram of latency samples, used to show worst case
+    ///          and percentile delivery times of messages under load.
+    ///
+    ///   Bucket 0 counts samples under 1 us, and bucket i counts samples from
+    ///   2^(i-1) us up to 2^i us.  The last bucket counts everything larger.
+    ///
+    ////////////////////////////////////////////////////////////////////////////////////
+    class JAUS_CORE_DLL LatencyHistogram
+    {
+    public:
+        static const unsigned int Buckets = 26;     ///<  Number of buckets (last is >= ~16 s).
+        /** Copy of histogram data. */
+        class JAUS_CORE_DLL Statistics
+        {
+        public:
+            Statistics() { Clear(); }
+            ~Statistics() {}
+            void Clear()
+            {
+                mCounts.assign(Buckets, 0);
+                mSamples = 0;
+                mTotalUs = 0;
+                mMaxUs = 0;
+            }
+            // Gets the upper limit of the bucket containing a percentile (0 to 100) of samples.
+            unsigned int GetPercentileUs(const double percentile) const;
+            // Gets the average latency in microseconds.
+            double GetMeanUs() const { return mSamples > 0 ? (double)mTotalUs/mSamples : 0.0; }
+            // Creates a single line summary.
+            std::string ToString() const;
+            std::vector<unsigned int> mCounts;  ///<  Number of samples in each bucket.
+            unsigned int mSamples;              ///<  Number of samples.
+            unsigned long long mTotalUs;        ///<  Sum of samples in microseconds.
+            unsigned int mMaxUs;                ///<  Largest sample in microseconds.
+        };
+        LatencyHistogram();
+        ~LatencyHistogram();
+        // Adds a sample.
+        void Add(const double latencySeconds);
+        // Gets a copy of the histogram.
+        Statistics GetStatistics() const;
+        // Removes all samples.
+        void Clear();
+        // Gets the upper limit of a bucket in microseconds.
+        static unsigned int GetBucketLimitUs(const unsigned int bucket);
+    private:
+        LatencyHistogram(const LatencyHistogram& histogram);
+        LatencyHistogram& operator=(const LatencyHistogram& histogram);
+        boost::atomic<unsigned int> mCounts[Buckets];   ///<  Number of samples in each bucket.
+        boost::atomic<unsigned int> mSamples;           ///<  Number of samples.
+        boost::atomic<unsigned long long> mTotalUs;     ///<  Sum of samples in microseconds.
+        boost::atomic<unsigned int> mMaxUs;             ///<  Largest sample in microseconds.
+    };
+}
+
+#endif
+/*  End of File */
@@ -40,10 +40,15 @@
 #define __JAUS_CORE_TRANSPORT_NODE_MANAGER__H
 
 #include "jaus/core/transport/connection.h"
+#include "jaus/core/transport/reactor.h"
+#include "jaus/core/transport/routingtable.h"
+#include <boost/thread/tss.hpp>
 
 
 namespace JAUS
 {
+    class UDP;  // Forward
+
     ////////////////////////////////////////////////////////////////////////////////////
     ///
     ///   \class NodeManager
@@ -55,6 +60,7 @@ namespace JAUS
     class JAUS_CORE_DLL NodeManager : public Connection::Callback
     {
         friend class TCP;
+        friend class UDP;
     public:
         /** Data structure for NodeManager settings. */
         class JAUS_CORE_DLL Parameters
@@ -82,6 +88,26 @@ namespace JAUS
             void SetNetworkInterface(const IP4Address& ip) { mNetworkInterface = ip; }
             /** Sets the multicast options. */
             void SetMulticast(const IP4Address& ip, const unsigned char ttl = 255) { mMulticastIP = ip; mTimeToLive = ttl; }
+            /** Sets if components host shared memory as lock-free rings, and if the receiver
+                should block waiting for data (wakeup) instead of polling. */
+            void SetSharedMemoryRings(const bool enable = true, const bool wakeup = true) { mSharedMemoryRingsFlag = enable; mSharedMemoryWakeupFlag = wakeup; }
+            /** Sets if network connections are updated by an event-driven Reactor (epoll) using
+                a fixed number of threads, instead of polling in threads (if multi-threaded). */
+            void SetEventDriven(const bool enable = true, const unsigned int threads = Reactor::DefaultThreads) { mEventDrivenFlag = enable; mEventThreads = threads; }
+            /** Sets the max number of UDP datagrams received/sent per system call, small packets
+                are also combined into one datagram per destination.  0 or 1 disables batching. */
+            void SetUdpBatchSize(const unsigned int size = 16) { mUdpBatchSize = size; }
+            /** Sets if JUDP packets are sent using header compression (repeated header
+                data is replaced by a reference once the receiver has stored it). */
+            void SetUdpHeaderCompression(const bool enable = true) { mUdpHeaderCompressionFlag = enable; }
+            /** Sets the outgoing rate limit for each network socket (0 = no limit).  Data
+                beyond the rate is queued, and dropped once maxQueuedBytes are waiting. */
+            void SetRateLimit(const unsigned int bytesPerSecond,
+                              const unsigned int burstBytes = 0,
+                              const unsigned int maxQueuedBytes = 256*1024)
+            {
+                mRateLimit = bytesPerSecond; mRateLimitBurst = burstBytes; mRateLimitQueueSize = maxQueuedBytes;
+            }
             /** Gets map of custom/user defined connections. */
             std::map<Address, Connection::Info> GetCustomConnections() const { return mCustomConnections; }
             /** Returns true if single thread mode enabled. */
@@ -100,6 +126,24 @@ namespace JAUS
             IP4Address GetMulticastIP() const { return mMulticastIP; }
             /** Gets the multicast TTL. */
             unsigned char GetMulticastTLL() const { return mTimeToLive; }
+            /** Returns true if components host shared memory as lock-free rings. */
+            bool UseSharedMemoryRings() const { return mSharedMemoryRingsFlag; }
+            /** Returns true if shared memory rings use wakeup instead of polling. */
+            bool UseSharedMemoryWakeup() const { return mSharedMemoryWakeupFlag; }
+            /** Returns true if network connections are updated by an event-driven Reactor. */
+            bool IsEventDriven() const { return mEventDrivenFlag; }
+            /** Gets the number of threads used by the Reactor. */
+            unsigned int GetEventThreads() const { return mEventThreads; }
+            /** Gets the max number of UDP datagrams received/sent per system call (0 or 1 is off). */
+            unsigned int GetUdpBatchSize() const { return mUdpBatchSize; }
+            /** Returns true if JUDP packets are sent using header compression. */
+            bool UseUdpHeaderCompression() const { return mUdpHeaderCompressionFlag; }
+            /** Gets the outgoing rate limit for network connections in bytes per second (0 = none). */
+            unsigned int GetRateLimit() const { return mRateLimit; }
+            /** Gets the bytes a network connection can send at once under the rate limit. */
+            unsigned int GetRateLimitBurst() const { return mRateLimitBurst; }
+            /** Gets the bytes that can wait for the rate limit before packets are dropped. */
+            unsigned int GetRateLimitQueueSize() const { return mRateLimitQueueSize; }
         protected:
             bool mSingleThreadModeFlag;         ///<  If true, operate in single thread mode (default is false).
             bool mIsTcpDefaultFlag;             ///<  Is TCP the default network connection type? (false = default)
@@ -110,6 +154,15 @@ namespace JAUS
             IP4Address mMulticastIP;            ///<  Multicast group.
             IP4Address mNetworkInterface;       ///<  Network interface to use.
             unsigned char mTimeToLive;          ///<  Time to Live TTL for UDP.
+            bool mSharedMemoryRingsFlag;        ///<  If true, components host shared memory as rings (default is false).
+            bool mSharedMemoryWakeupFlag;       ///<  If true, shared memory rings wake the receiver instead of polling.
+            bool mEventDrivenFlag;              ///<  If true, use a Reactor for network connections (default is false).
+            unsigned int mEventThreads;         ///<  Number of threads used by the Reactor.
+            unsigned int mUdpBatchSize;         ///<  UDP datagrams per system call (0 or 1 disables batching).
+            bool mUdpHeaderCompressionFlag;     ///<  If true, JUDP packets use header compression (default is false).
+            unsigned int mRateLimit;            ///<  Outgoing rate limit of network connections in bytes per second (0 = none).
+            unsigned int mRateLimitBurst;       ///<  Burst size for the rate limit in bytes (0 = 1/10 second).
+            unsigned int mRateLimitQueueSize;   ///<  Bytes waiting for the rate limit before packets are dropped.
         };
         NodeManager(const bool singleThreadMode = false);
         virtual ~NodeManager();
@@ -124,10 +177,14 @@ namespace JAUS
         virtual bool GetStatistics(Connection::Statistics::List& local,
                                    Connection::Statistics::List& remote);
         bool SetConnectionsPerThread(const unsigned int limit = 5);
+        void FlushPackets();
         NodeManager::Parameters* GetSettings() { return &mSettings; }
         const NodeManager::Parameters* GetSettings() const { return &mSettings; }
     protected:
+        void PublishRoutes();
+        void AddToFlush(const Connection::Ptr& connection);
         virtual bool AddConnection(Connection* connection);
+        void ApplyRateLimit(Connection* connection) const;
         bool CreateNewConnection(const Address& id,
                                  const Connection::Info* info,
                                  const Connection* originator,
@@ -151,6 +208,7 @@ namespace JAUS
         Connection::Map mSharedMemoryConnections;   ///<  Connections to local components via shared memory.
         Connection::Map mUdpConnections;            ///<  UDP Connections discovered.
         Connection::Map mTcpConnections;            ///<  TCP Connections.
+        RoutingTable::Ptr mRoutes;                  ///<  Current routes (read with atomic_load, no lock).
 
         static SharedMutex mFixedConnectionsMutex;                       ///<  Mutex for fixed connections.
         static std::map<Address, Connection::Info> mFixedConnections;    ///<  Fixed/default connections to maintain.
@@ -167,6 +225,8 @@ namespace JAUS
         Connection::Thread  mTcpServerUpdateThread;   ///<  Manages the TCP Server
         Connection::Thread  mUdpServerUpdateThread;   ///<  Manages the UDP Server
         std::set<Connection::Thread*> mUpdateThreads; ///<  Connection refreshers.
+        Reactor mReactor;                             ///<  Event-driven connection updates (if enabled).
+        boost::thread_specific_ptr<std::vector<Connection::Ptr> > mFlushList; ///<  Connections with packets batched by routing (per thread).
     };
 }
 
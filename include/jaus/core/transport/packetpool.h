@@ -0,0 +1,146 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file packetpool.h
+///  \brief This file contains a thread-safe pool of re-usable
+///  packet buffers.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#ifndef __JAUS_CORE_TRANSPORT_PACKET_POOL__H
+#define __JAUS_CORE_TRANSPORT_PACKET_POOL__H
+
+#include "jaus/core/types.h"
+#include <boost/lockfree/stack.hpp>
+#include <boost/atomic.hpp>
+
+namespace JAUS
+{
+    ////////////////////////////////////////////////////////////////////////////////////
+    ///
+    ///   \class PacketPool
+    ///   \brief Lock-free pool of Packet buffers that are recycled between
+    ///          receiving, queuing, de-serializing, and sending data so that
+    ///          memory is not allocated for each message.
+    ///
+    ///   Buffers keep whatever memory they reserved while in use, so once the
+    ///   pool has warmed up no heap allocations are made.  Use GetStatistics to
+    ///   verify this (mTotalCreated stops increasing).
+    ///
+    ////////////////////////////////////////////////////////////////////////////////////
+    class JAUS_CORE_DLL PacketPool
+    {
+    public:
+        static const unsigned int DefaultMaxBuffers = 4096;   ///<  Default maximum number of unused buffers kept.
+        /** Allocation statistics for the pool. */
+        class JAUS_CORE_DLL Statistics
+        {
+        public:
+            Statistics() { Clear(); }
+            ~Statistics() {}
+            void Clear()
+            {
+                mInUse = 0;
+                mAvailable = 0;
+                mTotalCreated = 0;
+                mTotalAcquired = 0;
+                mTotalReleased = 0;
+                mTotalDiscarded = 0;
+            }
+            unsigned int mInUse;            ///<  Number of buffers currently in use.
+            unsigned int mAvailable;        ///<  Number of unused buffers in the pool.
+            unsigned int mTotalCreated;     ///<  Total buffers allocated (heap allocations).
+            unsigned int mTotalAcquired;    ///<  Total buffers taken from the pool.
+            unsigned int mTotalReleased;    ///<  Total buffers returned to the pool.
+            unsigned int mTotalDiscarded;   ///<  Total buffers deleted because the pool was full.
+        };
+        ////////////////////////////////////////////////////////////////////////////////////
+        ///
+        ///   \class Buffer
+        ///   \brief Scoped buffer, acquires a packet from a pool on construction and
+        ///          returns it on destruction.
+        ///
+        ////////////////////////////////////////////////////////////////////////////////////
+        class JAUS_CORE_DLL Buffer
+        {
+        public:
+            Buffer(PacketPool& pool) : mpPool(&pool), mpPacket(pool.Acquire()) {}
+            ~Buffer() { mpPool->Release(mpPacket); }
+            inline Packet* Get() const { return mpPacket; }
+            inline Packet* operator->() const { return mpPacket; }
+            inline Packet& operator*() const { return *mpPacket; }
+        private:
+            Buffer(const Buffer& buffer);
+            Buffer& operator=(const Buffer& buffer);
+            PacketPool* mpPool;     ///<  Pool the buffer belongs to.
+            Packet* mpPacket;       ///<  Packet buffer.
+        };
+        PacketPool(const unsigned int maxBuffers = DefaultMaxBuffers,
+                   const unsigned int bufferSize = 0);
+        ~PacketPool();
+        // Gets an empty packet from the pool (creates one if none available).
+        Packet* Acquire();
+        // Returns a packet to the pool.
+        void Release(Packet* packet);
+        // Pre-allocates buffers so that they are ready for use.
+        void Reserve(const unsigned int count);
+        // Sets the maximum number of unused buffers kept in the pool.
+        void SetMaxBuffers(const unsigned int maxBuffers) { mMaxBuffers = maxBuffers; }
+        // Gets the maximum number of unused buffers kept in the pool.
+        unsigned int GetMaxBuffers() const { return mMaxBuffers; }
+        // Gets the number of bytes reserved in newly created buffers.
+        unsigned int GetBufferSize() const { return mBufferSize; }
+        // Gets a copy of the pool statistics.
+        Statistics GetStatistics() const;
+        // Resets the acquire, release, create, and discard counters.
+        void ClearStatistics();
+    private:
+        PacketPool(const PacketPool& pool);
+        PacketPool& operator=(const PacketPool& pool);
+        // Creates a new packet buffer.
+        Packet* Create();
+        boost::lockfree::stack<Packet*> mBuffers;   ///<  Unused packet buffers.
+        boost::atomic<unsigned int> mMaxBuffers;    ///<  Maximum unused buffers kept.
+        const unsigned int mBufferSize;             ///<  Bytes reserved in new buffers.
+        boost::atomic<unsigned int> mInUse;         ///<  Buffers currently in use.
+        boost::atomic<unsigned int> mAvailable;     ///<  Buffers available in the pool.
+        boost::atomic<unsigned int> mTotalCreated;  ///<  Total buffers created.
+        boost::atomic<unsigned int> mTotalAcquired; ///<  Total buffers acquired.
+        boost::atomic<unsigned int> mTotalReleased; ///<  Total buffers released.
+        boost::atomic<unsigned int> mTotalDiscarded;///<  Total buffers deleted on release.
+    };
+}
+
+#endif
+/*  End of File */
@@ -0,0 +1,164 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file packetqueue.h
+///  \brief This file contains a bounded, lock-free, multi-producer
+///  queue of pooled packet buffers used by the Transport Service.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#ifndef __JAUS_CORE_TRANSPORT_PACKET_QUEUE__H
+#define __JAUS_CORE_TRANSPORT_PACKET_QUEUE__H
+
+#include "jaus/core/transport/packetpool.h"
+#include <boost/lockfree/queue.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace JAUS
+{
+    ////////////////////////////////////////////////////////////////////////////////////
+    ///
+    ///   \class PacketQueue
+    ///   \brief Bounded queue of packet data shared between connection threads
+    ///          (producers) and the Transport message processing threads (consumers).
+    ///
+    ///   Packets are copied into buffers from a PacketPool on Push, and the buffer
+    ///   itself is handed to the consumer on Pop, so no locks are taken and no
+    ///   memory is allocated once the pool has warmed up.  Buffers returned by Pop
+    ///   must be given back using Release.
+    ///
+    ///   When the queue is full, the OverflowPolicy determines if the oldest
+    ///   packet is discarded (default), the new packet is discarded, or the
+    ///   producer waits for room.
+    ///
+    ////////////////////////////////////////////////////////////////////////////////////
+    class JAUS_CORE_DLL PacketQueue
+    {
+    public:
+        static const unsigned int DefaultCapacity = 1024;  ///<  Default number of packets that can be queued.
+        /** Behavior of Push when the queue is full. */
+        enum OverflowPolicy
+        {
+            DropOldest = 0,     ///<  Discard the oldest packet in the queue.
+            DropNewest,         ///<  Discard the packet being pushed.
+            Block               ///<  Wait until space is available (or shutdown).
+        };
+        /** Queue statistics used for sizing. */
+        class JAUS_CORE_DLL Statistics
+        {
+        public:
+            Statistics() { Clear(); }
+            ~Statistics() {}
+            void Clear()
+            {
+                mCapacity = 0;
+                mDepth = 0;
+                mMaxDepth = 0;
+                mTotalPushed = 0;
+                mTotalPopped = 0;
+                mTotalDropped = 0;
+            }
+            unsigned int mCapacity;         ///<  Maximum number of packets queued.
+            unsigned int mDepth;            ///<  Number of packets currently queued.
+            unsigned int mMaxDepth;         ///<  Highest depth reached.
+            unsigned int mTotalPushed;      ///<  Total packets added to the queue.
+            unsigned int mTotalPopped;      ///<  Total packets removed from the queue.
+            unsigned int mTotalDropped;     ///<  Total packets discarded because queue was full.
+        };
+        PacketQueue(const unsigned int capacity = DefaultCapacity,
+                    const OverflowPolicy policy = DropOldest,
+                    PacketPool* pool = NULL);
+        ~PacketQueue();
+        // Copies the packet into a pooled buffer and adds it to the queue.
+        bool Push(const Packet& packet);
+        // Removes the oldest packet from the queue (NULL if empty), use Release when done.
+        Packet* Pop(double* pushTimeSeconds = NULL);
+        // Returns a buffer received from Pop back to the pool.
+        void Release(Packet* packet) { mpPool->Release(packet); }
+        // Discards all queued packets.
+        void Clear();
+        // Sets the maximum number of packets that can be queued.
+        void SetCapacity(const unsigned int capacity);
+        // Gets the maximum number of packets that can be queued.
+        unsigned int GetCapacity() const { return mCapacity; }
+        // Sets what to do when the queue is full.
+        void SetOverflowPolicy(const OverflowPolicy policy) { mOverflowPolicy = policy; }
+        // Gets what to do when the queue is full.
+        OverflowPolicy GetOverflowPolicy() const { return (OverflowPolicy)mOverflowPolicy.load(); }
+        // Releases any producers waiting on a full queue (Block policy).
+        void SignalShutdown(const bool shutdown = true);
+        // Gets the number of packets in the queue.
+        unsigned int Size() const { return mDepth; }
+        // Returns true if nothing is queued.
+        bool IsEmpty() const { return mDepth == 0; }
+        // Gets a copy of the queue statistics.
+        Statistics GetStatistics() const;
+        // Resets the max depth, push, pop, and drop counters.
+        void ClearStatistics();
+    private:
+        PacketQueue(const PacketQueue& queue);
+        PacketQueue& operator=(const PacketQueue& queue);
+        /** Queued packet buffer and the time it was pushed. */
+        struct Entry
+        {
+            Packet* mpPacket;           ///<  Packet buffer.
+            double mPushTimeSeconds;    ///<  Time of Push (CxUtils::Timer::GetTimeSeconds).
+        };
+        // Updates the max depth counter.
+        void UpdateMaxDepth(const unsigned int depth);
+        // Waits until the queue has room or shutdown is signaled (Block policy).
+        void WaitForSpace();
+        // Wakes producers waiting for room (if any).
+        void SignalSpace(const bool all = false);
+        boost::scoped_ptr<PacketPool> mpOwnedPool;      ///<  Pool created if one is not shared with the queue.
+        PacketPool* mpPool;                             ///<  Pool of packet buffers.
+        boost::lockfree::queue<Entry> mQueue;           ///<  Queue of packets to process.
+        boost::atomic<unsigned int> mCapacity;          ///<  Maximum queue depth.
+        boost::atomic<int> mOverflowPolicy;             ///<  What to do when full.
+        boost::atomic<bool> mShutdownFlag;              ///<  If true, stop waiting for space.
+        boost::atomic<unsigned int> mDepth;             ///<  Number of packets queued (or being queued).
+        boost::atomic<unsigned int> mMaxDepth;          ///<  Highest depth reached.
+        boost::atomic<unsigned int> mTotalPushed;       ///<  Total packets pushed.
+        boost::atomic<unsigned int> mTotalPopped;       ///<  Total packets popped.
+        boost::atomic<unsigned int> mTotalDropped;      ///<  Total packets discarded.
+        boost::atomic<unsigned int> mWaiters;           ///<  Producers waiting for room (Block policy).
+        boost::mutex mSpaceMutex;                       ///<  Mutex for mSpaceCondition.
+        boost::condition_variable mSpaceCondition;      ///<  Signaled when packets are removed.
+    };
+}
+
+#endif
+/*  End of File */
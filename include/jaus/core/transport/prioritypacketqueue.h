@@ -0,0 +1,112 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file prioritypacketqueue.h
+///  \brief This file contains the definition of the PriorityPacketQueue class
+///  which queues received packets in lanes by JAUS priority.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#ifndef __JAUS_CORE_TRANSPORT_PRIORITY_PACKET_QUEUE__H
+#define __JAUS_CORE_TRANSPORT_PRIORITY_PACKET_QUEUE__H
+
+#include "jaus/core/transport/packetqueue.h"
+
+namespace JAUS
+{
+    ////////////////////////////////////////////////////////////////////////////////////
+    ///
+    ///   \class PriorityPacketQueue
+    ///   \brief Set of PacketQueue lanes, one for each Header::Priority value, so
+    ///          that Safety Critical and High priority packets are not stuck
+    ///          behind bulk data.
+    ///
+    ///   Pop returns packets from the highest priority lane that has data.  To
+    ///   keep lower priority lanes from starving, once a waiting lane has been
+    ///   passed over StarvationLimit times, it is served next.  Each lane has
+    ///   its own capacity, so bulk data filling a lane never causes higher
+    ///   priority packets to be dropped.
+    ///
+    ////////////////////////////////////////////////////////////////////////////////////
+    class JAUS_CORE_DLL PriorityPacketQueue
+    {
+    public:
+        static const unsigned int Lanes = 4;                    ///<  One lane per Header::Priority value.
+        static const unsigned int DefaultStarvationLimit = 64;  ///<  Default times a waiting lane can be passed over.
+        PriorityPacketQueue(const unsigned int capacity = PacketQueue::DefaultCapacity,
+                            const PacketQueue::OverflowPolicy policy = PacketQueue::DropOldest,
+                            PacketPool* pool = NULL);
+        ~PriorityPacketQueue();
+        // Copies the packet into the lane for the priority.
+        bool Push(const Packet& packet, const Byte priority);
+        // Removes the next packet to process (NULL if empty), use Release when done.
+        Packet* Pop(Byte* priority = NULL, double* pushTimeSeconds = NULL);
+        // Returns a buffer received from Pop back to the pool.
+        void Release(Packet* packet) { mLanes[0]->Release(packet); }
+        // Discards all queued packets.
+        void Clear();
+        // Sets the maximum number of packets that can be queued in each lane.
+        void SetCapacity(const unsigned int capacity);
+        // Sets what to do when a lane is full.
+        void SetOverflowPolicy(const PacketQueue::OverflowPolicy policy);
+        // Sets how many times a waiting lane can be passed over before it is served.
+        void SetStarvationLimit(const unsigned int limit) { mStarvationLimit = limit; }
+        // Releases any producers waiting on a full lane (Block policy).
+        void SignalShutdown(const bool shutdown = true);
+        // Gets the number of packets in all lanes.
+        unsigned int Size() const;
+        // Returns true if nothing is queued.
+        bool IsEmpty() const { return Size() == 0; }
+        // Returns true if High or Safety Critical packets are queued.
+        bool HasUrgent() const;
+        // Gets statistics for all lanes combined.
+        PacketQueue::Statistics GetStatistics() const;
+        // Gets statistics for the lane of a priority.
+        PacketQueue::Statistics GetStatistics(const Byte priority) const;
+        // Resets the max depth, push, pop, and drop counters.
+        void ClearStatistics();
+    private:
+        PriorityPacketQueue(const PriorityPacketQueue& queue);
+        PriorityPacketQueue& operator=(const PriorityPacketQueue& queue);
+        // Pops from a lane, updating starvation counters.
+        Packet* PopLane(const unsigned int lane, double* pushTimeSeconds);
+        boost::scoped_ptr<PacketPool> mpOwnedPool;          ///<  Pool created if one is not shared with the queue.
+        boost::scoped_ptr<PacketQueue> mLanes[Lanes];       ///<  Queues indexed by priority.
+        boost::atomic<unsigned int> mPassedOver[Lanes];     ///<  Times a waiting lane was passed over.
+        boost::atomic<unsigned int> mStarvationLimit;       ///<  Times a waiting lane can be passed over.
+    };
+}
+
+#endif
+/*  End of File */
@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file reactor.h
+///  \brief This file contains an event-driven (epoll) reactor that
+///  multiplexes receiving for many connections on a small thread pool.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#ifndef __JAUS_CORE_TRANSPORT_REACTOR__H
+#define __JAUS_CORE_TRANSPORT_REACTOR__H
+
+#include "jaus/core/transport/connection.h"
+#include <vector>
+#include <map>
+#include <set>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace JAUS
+{
+    ////////////////////////////////////////////////////////////////////////////////////
+    ///
+    ///   \class Reactor
+    ///   \brief Event-driven alternative to Connection::Thread.  Connections that
+    ///          have a receive descriptor (UDP/TCP sockets) are registered with a
+    ///          single epoll set, and a small fixed pool of threads calls
+    ///          UpdateConnection only when a descriptor is readable.
+    ///
+    ///   Descriptors are registered one-shot, so a connection is only ever
+    ///   updated by one thread at a time and is re-armed once its update
+    ///   completes.  Connections without a descriptor (e.g. shared memory) are
+    ///   not accepted and should be updated by a Connection::Thread.  Only
+    ///   available on Linux, use IsSupported to check.
+    ///
+    ////////////////////////////////////////////////////////////////////////////////////
+    class JAUS_CORE_DLL Reactor
+    {
+    public:
+        static const unsigned int DefaultThreads = 2;       ///<  Default size of the thread pool.
+        static const unsigned int MaxEventsPerWait = 64;    ///<  Maximum events handled per wait call.
+        static const unsigned int WaitTimeMs = 100;         ///<  Time to wait for events before checking for shutdown.
+        Reactor();
+        ~Reactor();
+        // Returns true if the platform supports event-driven updates.
+        static bool IsSupported();
+        // Creates the event set and starts the thread pool.
+        bool Initialize(const unsigned int numThreads = DefaultThreads,
+                        volatile bool* shutdownFlag = NULL);
+        // Stops the thread pool and removes all connections.
+        void Shutdown();
+        // Returns true if initialized and running.
+        bool IsInitialized() const { return mEventSet >= 0; }
+        // Adds a connection to update when it has data to receive.
+        bool AddConnection(Connection::Ptr connection);
+        // Adds a connection that is not owned by the reactor (e.g. pending TCP connections).
+        bool AddConnection(Connection* connection);
+        // Removes a connection (NULL for all) from the reactor.
+        void RemoveConnection(Connection::Ptr connection);
+        // Removes a connection not owned by the reactor without shutting it down.
+        void RemoveConnection(Connection* connection);
+        // Shuts down all connections updated by the reactor.
+        void ShutdownConnections();
+        // Gets the number of connections being updated.
+        unsigned int GetNumConnections() const;
+        // Gets the number of threads in the pool.
+        unsigned int GetNumThreads() const { return (unsigned int)mThreads.size(); }
+    protected:
+        /** Connection registered with the event set. */
+        class Source
+        {
+        public:
+            Source() : mpConnection(NULL), mDescriptor(-1) {}
+            Connection::Ptr mPtr;       ///<  Shared pointer to connection (empty if not owned).
+            Connection* mpConnection;   ///<  Connection to update.
+            int mDescriptor;            ///<  Receive descriptor being monitored.
+        };
+        typedef std::map<unsigned int, Source> SourceMap;
+        static void ReactorThread(void* args);
+        bool Register(Connection* connection, Connection::Ptr ptr);
+        void Unregister(SourceMap::iterator source);
+        void Dispatch(const unsigned int key, const unsigned int events);
+        void FinishDispatch(Connection* connection);
+        int mEventSet;                                  ///<  Event set descriptor (-1 if not initialized).
+        volatile bool mShutdownFlag;                    ///<  Signals threads to exit.
+        volatile bool* mpShutdownFlag;                  ///<  Global shutdown flag.
+        std::vector<Thread*> mThreads;                  ///<  Thread pool.
+        SharedMutex mSourcesMutex;                      ///<  Mutex for thread protection of sources.
+        SourceMap mSources;                             ///<  Registered sources by key.
+        std::map<Connection*, unsigned int> mKeys;      ///<  Lookup of source key by connection.
+        unsigned int mNextKey;                          ///<  Next key to assign to a source.
+        boost::mutex mActiveMutex;                      ///<  Mutex for thread protection of active connections.
+        boost::condition_variable mActiveCondition;     ///<  Signaled when a connection update completes.
+        std::set<Connection*> mActive;                  ///<  Connections being updated by a thread.
+    };
+}
+
+#endif
+/*  End of File */
@@ -0,0 +1,108 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file routingtable.h
+///  \brief This file contains the definition of the RoutingTable class
+///  used by NodeManager to find the connections to components.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#ifndef __JAUS_CORE_TRANSPORT_ROUTING_TABLE__H
+#define __JAUS_CORE_TRANSPORT_ROUTING_TABLE__H
+
+#include "jaus/core/transport/connection.h"
+
+namespace JAUS
+{
+    ////////////////////////////////////////////////////////////////////////////////////
+    ///
+    ///   \class RoutingTable
+    ///   \brief Connections used to route packets.  A RoutingTable is never
+    ///          modified after it is published.
+    ///
+    ///   Each time the connections of a NodeManager change it builds and
+    ///   publishes a new RoutingTable, so routing reads the current table
+    ///   without locking.  Destinations are found in an
+    ///   open-addressing hash table keyed by component ID, and the transport
+    ///   type of each route is stored so no RTTI is needed.
+    ///
+    ////////////////////////////////////////////////////////////////////////////////////
+    class JAUS_CORE_DLL RoutingTable
+    {
+    public:
+        typedef boost::shared_ptr<const RoutingTable> Ptr;
+        /** Connection to a component. */
+        class JAUS_CORE_DLL Route
+        {
+        public:
+            Route() : mTransportType(Connection::Transport::JTCP) {}
+            Address mID;                    ///<  Component ID.
+            int mTransportType;             ///<  Connection::Transport type of the connection.
+            Connection::Ptr mpConnection;   ///<  Connection to the component.
+        };
+        /** Entry in the hash table, with the routes to a component by transport type. */
+        class JAUS_CORE_DLL Slot
+        {
+        public:
+            Slot() : mID(0), mpSharedMemory(NULL), mpUdp(NULL), mpTcp(NULL) {}
+            UInt mID;                       ///<  Component ID (0 if slot is empty).
+            const Route* mpSharedMemory;    ///<  Shared memory route (NULL if none).
+            const Route* mpUdp;             ///<  UDP route (NULL if none).
+            const Route* mpTcp;             ///<  TCP route (NULL if none).
+        };
+        RoutingTable() : mMask(0) {}
+        ~RoutingTable() {}
+        /** Builds the table from maps of connections by transport. */
+        void Build(const Connection::Map& sharedMemory,
+                   const Connection::Map& udp,
+                   const Connection::Map& tcp,
+                   const Connection::Ptr& udpServer);
+        /** Finds routes to a component, NULL if there are none. */
+        const Slot* Find(const Address& id) const;
+        /** Gets the preferred route to a component (shared memory, UDP, then TCP), NULL if none. */
+        const Route* GetRoute(const Address& id) const;
+        Connection::Ptr mpUdpServer;        ///<  UDP server used for global broadcasts.
+        std::vector<Route> mSharedMemory;   ///<  Shared memory routes (in ID order).
+        std::vector<Route> mNetwork;        ///<  UDP routes followed by TCP routes (in ID order).
+    private:
+        RoutingTable(const RoutingTable&);
+        RoutingTable& operator=(const RoutingTable&);
+        void Insert(const Route* route);
+        std::vector<Slot> mSlots;           ///<  Hash table (size is a power of 2).
+        UInt mMask;                         ///<  Mask of hash values (size of mSlots - 1).
+    };
+}
+
+#endif
+/*  End of File */
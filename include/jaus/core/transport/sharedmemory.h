@@ -42,6 +42,7 @@
 #include "jaus/core/transport/connection.h"
 #include <map>
 #include <boost/interprocess/sync/interprocess_mutex.hpp>
+#include <boost/atomic.hpp>
 
 
 namespace JAUS
@@ -56,6 +57,12 @@ namespace JAUS
     ///   transport header has JTCP and JUDP so that no data modifications are needed
     ///   when converting from shared memory to those transport.
     ///
+    ///   By default memory is organized as two mailboxes protected by interprocess
+    ///   mutexes.  If the host sets mRingBufferFlag, memory is instead organized as
+    ///   two single-producer/single-consumer rings (one per direction) which need
+    ///   no locks, and packets are given to callbacks directly from shared memory.
+    ///   Clients detect which layout the host uses automatically.
+    ///
     ////////////////////////////////////////////////////////////////////////////////////
     class JAUS_CORE_DLL SharedMemory : public Connection
     {
@@ -83,6 +90,8 @@ namespace JAUS
             Type mSharedConnectionType;     ///<  Type of shared memory "connection" to create.
             Address mComponentID;           ///<  ID of component to host or open shared memory for.
             Time mCreationTime;             ///<  Time stamp for creation of shared memory.
+            bool mRingBufferFlag;           ///<  If true, host memory as lock-free rings instead of mailboxes.
+            bool mWakeupFlag;               ///<  If true (rings only), receiver blocks until data arrives instead of polling.
         };
         SharedMemory(const bool singleThread = true);
         virtual ~SharedMemory();
@@ -111,6 +120,10 @@ namespace JAUS
         /** Method to check if someone is listing to the connection. */
         bool HasSubscriber(const unsigned int readInterval = 500);
         SharedMemory::Parameters GetParameters() const { return mParameters; }
+        /** Returns true if memory is organized as lock-free rings. */
+        bool IsRingBuffer() const { return mpRingBox != NULL; }
+        /** Receiver blocks waiting for data when using rings with wakeup. */
+        virtual bool WaitsForData() const;
     protected:
         ////////////////////////////////////////////////////////////////////////////////////
         ///
@@ -154,13 +167,77 @@ namespace JAUS
             unsigned char mpWriteRegion[DefaultMemorySize]; ///<  Write region (where to write outgoing data to).
             unsigned char mpReadRegion[DefaultMemorySize];  ///<  Read region (where to read data from).
         };
+        ////////////////////////////////////////////////////////////////////////////////////
+        ///
+        ///   \class Ring
+        ///   \brief Single-producer/single-consumer ring buffer stored in shared
+        ///          memory.
+        ///
+        ///   The producer only writes mHead and the consumer only writes mTail, each
+        ///   on its own cache line, so no interprocess mutex is needed.  Messages are
+        ///   stored as a UInt length followed by data, padded to 4 bytes.  A length
+        ///   of WrapMarker means the rest of the buffer is unused and data continues
+        ///   at the start.  Within a process, producers must be serialized.
+        ///
+        ///   mSignal is incremented on each write and is used as a futex on Linux so
+        ///   the consumer can sleep until data arrives.  Other platforms poll.
+        ///
+        ////////////////////////////////////////////////////////////////////////////////////
+        class JAUS_CORE_DLL Ring
+        {
+        public:
+            static const unsigned int CacheLineSize = 64;       ///<  Padding between producer/consumer data.
+            static const unsigned int DataSize = 1048576;       ///<  Size of data buffer (must be a power of 2).
+            static const UInt WrapMarker = 0xFFFFFFFF;          ///<  Length value indicating data wraps to start.
+            Ring();
+            ~Ring() {}
+            bool Write(const Packet& packet);
+            const unsigned char* Front(UInt& length);
+            void Pop(const UInt length);
+            bool BeginWait(UInt& signal);
+            void EndWait();
+            static void Wait(const boost::atomic<UInt>* futex, const UInt signal, const unsigned int timeoutMs);
+            void Wake();
+            static UInt GetRecordSize(const UInt length) { return (sizeof(UInt) + length + 3) & ~((UInt)3); }
+            boost::atomic<UInt> mHead;                                          ///<  Write position (producer only).
+            unsigned char mHeadPad[CacheLineSize - sizeof(boost::atomic<UInt>)];
+            boost::atomic<UInt> mTail;                                          ///<  Read position (consumer only).
+            unsigned char mTailPad[CacheLineSize - sizeof(boost::atomic<UInt>)];
+            boost::atomic<UInt> mSignal;        ///<  Incremented on each write (futex word).
+            boost::atomic<UInt> mWaiting;       ///<  Non-zero when the consumer is waiting for data.
+            volatile unsigned char mValidFlag;  ///<  If 1, memory is valid, if 0, host is trying to close.
+            volatile Time::Stamp mWriteTimeMs;  ///<  The last time data was written (producer only).
+            volatile Time::Stamp mReadTimeMs;   ///<  The last time the ring was checked for data (consumer only).
+            unsigned char mControlPad[CacheLineSize];
+            unsigned char mData[DataSize];      ///<  Message data.
+        };
+        ////////////////////////////////////////////////////////////////////////////////////
+        ///
+        ///   \class RingBox
+        ///   \brief Contents of shared memory when using rings.
+        ///
+        ////////////////////////////////////////////////////////////////////////////////////
+        class JAUS_CORE_DLL RingBox
+        {
+        public:
+            RingBox() {}
+            ~RingBox() {}
+            Ring mReadRing;     ///<  Data sent to the host.
+            Ring mWriteRing;    ///<  Data sent by the host.
+        };
+        void ReceiveRingData();
+        static const unsigned int MaxRingMessagesPerUpdate = 256;   ///<  Limit on messages processed per update.
+        static const unsigned int RingWaitTimeMs = 100;             ///<  How long receiver waits for data before checking status.
         Packet mTransportHeader;            ///<  Transport header (blank).
+        Packet mRecvBuffer;                 ///<  Re-usable buffer for incomming data.
         Parameters mParameters;             ///<  Parameters.
         volatile bool mConnectedFlag;       ///<  Signals connected or not.
         std::string mSharedMemoryName;      ///<  Name of shared memory object.
         void* mpSharedObject;               ///<  Shared object/structure in shared memory.
-        void* mpMappedObjectRegion;         ///<  Mapped region of memory for data structure.
-        SharedMemory::Box* mpBox;           ///<  Mapped memory data.
+        void* mpMappedObjectRegion;         ///<  Mapped region of memory for data structure.
+        SharedMemory::Box* mpBox;           ///<  Mapped memory data.
+        SharedMemory::RingBox* mpRingBox;   ///<  Mapped memory data (if using rings).
+        SharedMutex mRingMutex;             ///<  Protects mapping of ring memory while in use.
     };
 }
 
@@ -71,6 +71,7 @@ namespace JAUS
         const static unsigned short Port = 3794;         ///< JAUS UDP/TCP Port Number == "jaus".
         const static unsigned int OverheadSizeBytes = 73;///< JTCP Overhead in bytes including JAUS General Header
         const static Byte Version = 0x02;                ///< JTCP Header Version.
+        const static unsigned int NewConnectionTimeoutMs = 5000; ///< Time a new connection may be silent before it is closed.
 
         TCP(const bool singleThread = true);
         virtual ~TCP();
@@ -90,8 +91,12 @@ namespace JAUS
         /** Gets the overhead for each packet added by medium in bytes. */
         inline virtual unsigned int GetTransportOverheadInBytes() const { return OverheadSizeBytes; }
         virtual Parameters* CreateParameters() const { return new TCP::Parameters(); }
+        virtual int GetDescriptor() const;
         bool IsClient() const;
+        void CloseNewConnections(const bool timedOutOnly);
     protected:
+        virtual bool TransmitPacket(const Packet& packet,
+                                    const Header& packetHeader) const;
         void CloseSocket();
         void DeleteSocket();
         void RemoveConnection(TCP* connection);
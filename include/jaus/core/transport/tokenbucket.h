@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file tokenbucket.h
+///  \brief This file contains the definition of the TokenBucket class
+///  used to limit the rate data is sent at.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#ifndef __JAUS_CORE_TRANSPORT_TOKEN_BUCKET__H
+#define __JAUS_CORE_TRANSPORT_TOKEN_BUCKET__H
+
+#include "jaus/core/types.h"
+
+namespace JAUS
+{
+    ////////////////////////////////////////////////////////////////////////////////////
+    ///
+    ///   \class TokenBucket
+    ///   \brief Token bucket rate limiter, used to shape outgoing traffic to the
+    ///          bandwidth of a link.
+    ///
+    ///   Tokens (bytes) are added at a fixed rate up to the burst size.  Data
+    ///   can be sent when enough tokens are available, otherwise the sender
+    ///   must wait.  A packet larger than the burst size is allowed once the
+    ///   bucket is full, so it never waits forever.
+    ///
+    ////////////////////////////////////////////////////////////////////////////////////
+    class JAUS_CORE_DLL TokenBucket
+    {
+    public:
+        TokenBucket(const unsigned int bytesPerSecond = 0, const unsigned int burstBytes = 0);
+        ~TokenBucket();
+        // Sets the rate (0 = no limit) and burst size (0 = 1/10 second of data).
+        void SetRate(const unsigned int bytesPerSecond, const unsigned int burstBytes = 0);
+        /** Gets the rate in bytes per second (0 = no limit). */
+        unsigned int GetRate() const { return mRate; }
+        /** Gets the burst size in bytes. */
+        unsigned int GetBurstSize() const { return mBurst; }
+        /** Returns true if a rate limit is set. */
+        bool IsLimited() const { return mRate > 0; }
+        // Takes tokens if available, otherwise gets how long to wait.
+        bool Take(const unsigned int bytes, double* waitTimeSeconds = NULL);
+        // Takes tokens even if not available (future sends wait longer).
+        void Force(const unsigned int bytes);
+        // Waits until tokens are available and takes them.
+        bool Wait(const unsigned int bytes, volatile bool* abortFlag = NULL);
+    private:
+        void Refill(const double timeSeconds);
+        Mutex mMutex;                   ///<  Mutex for thread protection.
+        volatile unsigned int mRate;    ///<  Bytes per second (0 = no limit).
+        volatile unsigned int mBurst;   ///<  Maximum tokens saved.
+        double mTokens;                 ///<  Tokens available (negative if borrowed).
+        double mUpdateTimeSeconds;      ///<  Last time tokens were added.
+    };
+}
+
+#endif
+/*  End of File */
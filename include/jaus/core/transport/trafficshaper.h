@@ -0,0 +1,120 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file trafficshaper.h
+///  \brief This file contains the definition of the TrafficShaper class
+///  used to queue outgoing data until a rate limit allows it to be sent.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#ifndef __JAUS_CORE_TRANSPORT_TRAFFIC_SHAPER__H
+#define __JAUS_CORE_TRANSPORT_TRAFFIC_SHAPER__H
+
+#include "jaus/core/header.h"
+#include "jaus/core/transport/tokenbucket.h"
+#include "jaus/core/transport/packetpool.h"
+#include <list>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace JAUS
+{
+    class Connection;   // Forward
+
+    ////////////////////////////////////////////////////////////////////////////////////
+    ///
+    ///   \class TrafficShaper
+    ///   \brief Limits the rate data is sent over a socket without blocking the
+    ///          threads sending it.
+    ///
+    ///   Packets that the TokenBucket can't send right away are copied into a
+    ///   queue for their priority, and a sender thread transmits them (highest
+    ///   priority first) as the rate allows.  When too much data is waiting,
+    ///   packets are dropped.  High and Safety Critical packets are never
+    ///   queued, they are sent right away and count against the rate.
+    ///
+    ///   Connections that send from the same socket share one TrafficShaper, so
+    ///   the rate applies to the link and not to each destination.
+    ///
+    ////////////////////////////////////////////////////////////////////////////////////
+    class JAUS_CORE_DLL TrafficShaper
+    {
+    public:
+        typedef boost::shared_ptr<TrafficShaper> Ptr;   ///<  Shaper pointer.
+        static const int Send    = 0;   ///<  Packet can be sent now.
+        static const int Queued  = 1;   ///<  Packet will be sent by the shaper.
+        static const int Dropped = 2;   ///<  Packet was discarded.
+        TrafficShaper();
+        ~TrafficShaper();
+        // Sets the rate (0 = no limit), burst size, and most bytes queued (0 = no limit).
+        void SetRate(const unsigned int bytesPerSecond,
+                     const unsigned int burstBytes = 0,
+                     const unsigned int maxQueuedBytes = 0);
+        /** Returns true if a rate limit is set. */
+        bool IsLimited() const { return mBucket.IsLimited(); }
+        // Sends, queues, or drops a packet for a connection (see Send, Queued, Dropped).
+        int Shape(const Connection* connection, const Packet& packet, const Header& header);
+        // Discards packets queued for a connection, waiting if one is being sent.
+        void Remove(const Connection* connection);
+        // Gets the number of bytes waiting to be sent.
+        unsigned int GetQueuedBytes() const;
+    private:
+        TrafficShaper(const TrafficShaper& shaper);
+        TrafficShaper& operator=(const TrafficShaper& shaper);
+        static const unsigned int Lanes = Header::Priority::High;  ///<  Number of priorities that can be queued.
+        /** Packet waiting for the rate limit. */
+        struct Entry
+        {
+            Packet* mpPacket;                   ///<  Copy of the packet (from mPool).
+            Header mHeader;                     ///<  JAUS header of the packet.
+            const Connection* mpConnection;     ///<  Connection to send with.
+        };
+        typedef std::list<Entry> Queue;
+        static void SenderThread(void* args);
+        TokenBucket mBucket;                        ///<  Rate limit.
+        PacketPool mPool;                           ///<  Buffers for queued packets.
+        mutable boost::mutex mMutex;                ///<  Mutex for thread protection of queues.
+        boost::condition_variable mCondition;       ///<  Signaled when packets are queued or sent.
+        Queue mQueues[Lanes];                       ///<  Packets waiting to be sent, by priority.
+        unsigned int mQueuedBytes;                  ///<  Bytes waiting to be sent.
+        unsigned int mMaxQueuedBytes;               ///<  Most bytes that can wait (0 = no limit).
+        const Connection* mpSending;                ///<  Connection the sender thread is using (NULL if none).
+        bool mShutdownFlag;                         ///<  If true, sender thread exits.
+        JAUS::Thread mSenderThread;                 ///<  Thread sending queued packets.
+    };
+}
+
+#endif
+/*  End of File */
@@ -44,12 +44,17 @@
 #include "jaus/core/service.h"
 #include "jaus/core/time.h"
 #include "jaus/core/transport/connection.h"
+#include "jaus/core/transport/prioritypacketqueue.h"
+#include "jaus/core/transport/latencyhistogram.h"
+#include "jaus/core/transport/conflationtable.h"
 
 #include <set>
 
 
 namespace JAUS
 {
+    class Receipt;
+
     ////////////////////////////////////////////////////////////////////////////////////
     ///
     ///   \class Transport
@@ -62,6 +67,7 @@ namespace JAUS
                                     public Connection::Callback
     {
         friend class Component;
+        friend class Service;
     public:        
         ////////////////////////////////////////////////////////////////////////////////////
         ///
@@ -80,6 +86,24 @@ namespace JAUS
             typedef std::map<UShort, Set > Map;
             virtual void ProcessMessage(const JAUS::Message* message) {};
         };
+        ////////////////////////////////////////////////////////////////////////////////////
+        ///
+        ///   \class ResponseCallback
+        ///   \brief Callback used with SendAsync to get the response to a message
+        ///          without blocking the thread that sent it.
+        ///
+        ///   Callbacks are made by Transport processing threads, so they must not
+        ///   block.  The response is only valid during the call.
+        ///
+        ////////////////////////////////////////////////////////////////////////////////////
+        class JAUS_CORE_DLL ResponseCallback
+        {
+        public:
+            ResponseCallback() {}
+            virtual ~ResponseCallback() {}
+            // Called with the response received, or NULL if none arrived before the timeout (or shutdown).
+            virtual void ProcessResponse(const UInt id, const JAUS::Message* response) = 0;
+        };
         static const std::string Name;                  ///<  Name of the service.
         Transport();
         virtual ~Transport();
@@ -124,6 +148,17 @@ namespace JAUS
         virtual bool Send(const Message* message,
                           Message::List& possibleResponses,
                           const unsigned int waitTimeMs = Service::DefaultWaitMs) const;
+        // Sends a message, the response (or timeout) is given to the callback (returns ID, 0 on failure).
+        UInt SendAsync(const Message* message,
+                       ResponseCallback* callback,
+                       const unsigned int waitTimeMs = Service::DefaultWaitMs) const;
+        // Sends a message, one of the possible responses (or timeout) is given to the callback.
+        UInt SendAsync(const Message* message,
+                       const std::set<UShort>& responseCodes,
+                       ResponseCallback* callback,
+                       const unsigned int waitTimeMs = Service::DefaultWaitMs) const;
+        // Stops waiting for the response to a message sent with SendAsync (no callback is made).
+        bool CancelAsync(const UInt id) const;
         // Register to receive copies of messages when received by Transport.
         void RegisterCallback(const UShort messageCode, Callback* callback);
         // Reads the payload data which includes a message code, and converts to Message structure.
@@ -141,6 +176,33 @@ namespace JAUS
         bool SetMaxMessageProcessingThreads(unsigned int limit = 1);
         /*  Gets a pointer to the node manager, don't use if initialized. */
         NodeManager* GetNodeManager();
+        // Sets the size of the received packet queues, and what to do when they are full.
+        void SetPacketQueueOptions(const unsigned int capacity,
+                                   const PacketQueue::OverflowPolicy policy = PacketQueue::DropOldest);
+        // Gets statistics for the queue of single (or multi-packet stream) packets received.
+        PacketQueue::Statistics GetPacketQueueStatistics(const bool multiPacket = false) const;
+        // Gets statistics for the queue lane of a priority (see Header::Priority).
+        PacketQueue::Statistics GetPacketQueueStatistics(const bool multiPacket, const Byte priority) const;
+        // Gets the time received packets of a priority waited before processing.
+        LatencyHistogram::Statistics GetLatencyStatistics(const Byte priority, const bool reset = false);
+        // Keeps only the newest queued report of a type per source and event ID.
+        void EnableConflation(const UShort messageCode, const bool enable = true);
+        // Gets the number of received reports replaced by newer ones before processing.
+        unsigned int GetConflatedCount() const;
+        // Gets allocation statistics for the packet buffers used by the transport.
+        PacketPool::Statistics GetPacketPoolStatistics() const;
+        // Sets per source memory limit and timeout for reassembly of large data sets.
+        void SetLargeDataSetOptions(const unsigned int memoryLimitBytes = 16*1024*1024,
+                                    const unsigned int timeoutMs = 500);
+        // Enables retransmission of only the missing packets of large data sets (NACK).
+        void EnableLargeDataSetRetransmission(const bool enable = true,
+                                              const unsigned int cacheSizeBytes = 8*1024*1024,
+                                              const unsigned int nackDelayMs = 50);
+        // Enables zlib compression of large data sets of a message type sent to a component.
+        void EnablePayloadCompression(const UShort messageCode,
+                                      const Address& destination,
+                                      const bool enable = true,
+                                      const unsigned int thresholdBytes = 4096);
     protected:
         // Copies message template and callbacks.
         void CopyRegisteredItems(Transport* transport);
@@ -152,16 +214,53 @@ namespace JAUS
     private:
         // Recursively try to create the message.
         Message* CreateMessageFromService(const UShort messageCode, const Service* service) const;
+        // Recursively finds the Service that creates a message type, and the message it made.
+        const Service* FindMessageFactory(const UShort messageCode,
+                                          const Service* service,
+                                          Message** message) const;
+        // Creates a message using the Service found by FindMessageFactory.
+        Message* CreateMessageFromFactory(const UShort messageCode, const Service* factory) const;
+        // Builds the table of which Service creates each message type received.
+        void BuildMessageFactoryTable();
+        // Sets the Service that creates a message type (NULL if none) in the table.
+        void SetMessageFactory(const UShort messageCode, const Service* factory) const;
         // Create a message using templates.
         Message* GetMessageFromTemplate(const UShort messageCode) const;
         // Gets a message structure for reading packet data (pre-allocated).
-        Message* GetCachedMessage(const UShort messageCode);
+        Message* GetCachedMessage(const UShort messageCode,
+                                  std::map<UShort, Message*>* messageCache = NULL);
         // Processes a single packet.
         virtual void ProcessSinglePackets(Packet* packet = NULL);
+        // De-serializes a single packet and passes it to receipts or services.
+        void ProcessSinglePacket(Packet& packet, std::map<UShort, Message*>* messageCache);
+        // Thread function for processing packets given to a ProcessingWorker.
+        static void ProcessingWorkerThread(void* workerPointer);
         // Process multi-packet stream data
         virtual void ProcessMultiPackets(Packet* packet = NULL);
+        // Adds a packet to its large data set, and processes any data sets completed.
+        void ProcessMultiPacket(Packet& packet, std::map<UShort, Message*>* messageCache);
+        // Keeps a copy of a multi-packet stream sent for retransmission.
+        void CacheSentStream(const UShort messageCode,
+                             const Packet::List& stream,
+                             const Header::List& streamHeaders) const;
+        // Re-sends packets a receiver reported missing.
+        void ProcessNack(const Packet& packet, const Header& header);
+        // Requests missing packets of incomplete large data sets.
+        void RequestMissingPackets();
+        // Waits until a large data set packet can be sent without exceeding the rate limit.
+        void PaceLargeDataSet(const Address& destination, const unsigned int bytes) const;
+        // Gets the size at which payloads sent to a destination are compressed (0 = never).
+        unsigned int GetCompressionThreshold(const UShort messageCode, const Address& destination) const;
         // Check for a thread/procedure call waiting for an incomming message inline.
         bool CheckPendingReceipts(const Header& header, const UShort messageCode, const Packet& packet);
+        // Adds a receipt to the index of sends waiting for responses.
+        void AddPendingReceipt(Receipt* receipt) const;
+        // Removes a receipt from the index of sends waiting for responses.
+        void RemovePendingReceipt(Receipt* receipt) const;
+        // Gives asynchronous sends that timed out to their callbacks.
+        void CheckAsyncReceiptTimeouts();
+        // Removes a completed asynchronous receipt, makes the callback, and deletes it.
+        void FinishAsyncReceipt(Receipt* receipt, const bool callback) const;
         // Method to notify Node Manager of our existence.
         void NotifyNodeManager(const unsigned int waitForResponseTimeMs = 1000);
         
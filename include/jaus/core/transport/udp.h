@@ -40,6 +40,8 @@
 #define __JAUS_CORE_TRANSPORT_UDP_CONNECTION__H
 
 #include "jaus/core/transport/connection.h"
+#include "jaus/core/transport/headercompression.h"
+#include <vector>
 
 namespace JAUS
 {
@@ -69,11 +71,15 @@ namespace JAUS
             bool mUseBroadcastingFlag;  ///<  Broadcast, or multicast?
             IP4Address mMulticastIP;    ///<  Multicast group.
             unsigned char mTimeToLive;  ///<  Time to Live TTL for UDP.
+            unsigned int mBatchSize;    ///<  Max datagrams per receive/send system call, 0 or 1 disables batching.
+            bool mHeaderCompressionFlag;///<  Use header compression when sending (receiving is always supported).
         };
 
         const static unsigned short Port = 3794;            ///< JAUS UDP/UDP Port Number == "jaus".
         const static unsigned int OverheadSizeBytes = 61;   ///< Total overhead in bytes include JAUS General header and JUDP 
         const static Byte Version = 0x02;                   ///< JUDP Header Version.
+        const static unsigned int DefaultBatchSize = 16;    ///< Suggested batch size when batching is enabled.
+        const static unsigned int MaxBatchSize = 64;        ///< Largest batch size used per system call.
 
         UDP(const bool singleThread = true);
         virtual ~UDP();
@@ -94,19 +100,44 @@ namespace JAUS
         /** Gets the overhead for each packet added by medium in bytes. */
         inline virtual unsigned int GetTransportOverheadInBytes() const { return OverheadSizeBytes; }
         virtual Parameters* CreateParameters() const { return new UDP::Parameters(); }
+        /** Client connections only send, data is received by the server connection. */
+        virtual bool IsSendOnly() const { return mParameters.mClientFlag; }
+        virtual int GetDescriptor() const;
         /** Gets the port number for the connection. */
         inline unsigned short GetDestPortNumber() const { return mParameters.mDestPortNumber; }
         /** Gets the port number for the connection. */
         inline unsigned short GetSourcePortNumber() const { return mParameters.mSourcePortNumber; }
+        /** Returns true if batching, and packets are queued waiting to be sent by SendBatch. */
+        inline bool HasPendingPackets() const { return mPendingCount > 0; }
+        static unsigned int SendBatch(const std::vector<UDP*>& connections);
     protected:
         void CloseSocket();
         void DeleteSocket();
         void ReceiveIncommingData();
+        void ReceiveBatch(Info& sourceInfo);
+        void ProcessDatagram(const Packet& datagram, Info& sourceInfo);
+        int ProcessJausPacket(unsigned char* data, const unsigned int length, Info& sourceInfo);
+        virtual bool TransmitPacket(const Packet& packet,
+                                    const Header& packetHeader) const;
+        void WriteJausPacket(const Packet& packet, Packet& datagram) const;
+        bool TakePendingPackets();
+        int SendDatagram(const Packet& datagram, const unsigned int numPackets) const;
+        void UpdateSendStatistics(const unsigned int numPackets, const int bytes) const;
+        static bool CompareSocket(const UDP* first, const UDP* second);
         void* mpSocket;             ///<  The actual network connection.
         Packet mTransportHeader;    ///<  Transport header data.
         Parameters mParameters;     ///<  Connection options/parameters.
         Packet mSendCache;          ///<  Reusable packet for sending.
         Packet mRecvBuffer;         ///<  Main buffer for incomming serialized data.
+        Packet mPendingBuffer;      ///<  JUDP datagram being filled with packets when batching.
+        volatile unsigned int mPendingCount;    ///<  Number of packets in mPendingBuffer.
+        Packet mFlushBuffer;        ///<  Datagram taken from mPendingBuffer by SendBatch.
+        unsigned int mFlushCount;   ///<  Number of packets in mFlushBuffer.
+        SharedMutex mFlushMutex;    ///<  Held by SendBatch from taking queued packets until they are sent.
+        std::vector<unsigned char> mBatchBuffer;    ///<  Buffer for datagrams received in a batch.
+        HeaderCompression::Ptr mpHeaderCompression; ///<  Header templates (shared with client connections).
+        Packet mExpandBuffer;       ///<  Packet restored from a compressed header.
+        Packet mReplyBuffer;        ///<  Header compression reply to send.
     };
 }
 
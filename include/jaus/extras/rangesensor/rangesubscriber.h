@@ -90,9 +90,18 @@ namespace JAUS
         bool CreateRangeSubscription(const Address& id, 
                                      const Byte deviceID = 0,
                                      const unsigned int waitTimeMs = Service::DefaultWaitMs);
+        // Create a range subscription without blocking (check or wait on the handle returned).
+        AsyncResponse::Ptr CreateRangeSubscriptionAsync(const Address& id, 
+                                                        const Byte deviceID = 0,
+                                                        AsyncResponse::Callback* callback = NULL,
+                                                        const unsigned int waitTimeMs = Service::DefaultWaitMs);
         bool GetRangeSensorInfo(const Address& id, 
                                 RangeSensorConfig::List& list,
                                 const unsigned int waitTimeMs = Service::DefaultWaitMs*3) const;
+        // Query range sensor information without blocking, response is a ReportRangeSensorConfiguration.
+        AsyncResponse::Ptr GetRangeSensorInfoAsync(const Address& id,
+                                                   AsyncResponse::Callback* callback = NULL,
+                                                   const unsigned int waitTimeMs = Service::DefaultWaitMs*3) const;
         // Overload to get data as it arrives.
         virtual void ProcessLocalRangeScan(const Point3D::List& scan,
                                            const Address& sourceID, 
@@ -300,8 +300,14 @@ void TestLargeDataSets()
             std::cout << "Large Data Sets Error: Could Not Collect Stream.\n";
         }
     }
-    // Now merge the data.
-    LargeDataSet::MergeLargeDataSet(header, messageCode, payload, dataSet.mStream, NULL);
+    // Data is merged as it is added.
+    if(dataSet.mCompleteFlag == false)
+    {
+        std::cout << "Large Data Sets Error: Stream Not Complete.\n";
+        return;
+    }
+    payload = dataSet.mBuffer;
+    payload.SetReadPos(LargeDataSet::DataOffset);
     for(unsigned int i = 0; i < payloadSize/UINT_SIZE; i++)
     {
         payload.Read(data);
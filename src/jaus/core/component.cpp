@@ -597,16 +597,16 @@ bool Component::AddService(Service* service)
 
     if(mInitializedFlag == false)
     {
-        if(mpTransportService && service->GetServiceID().mName == Transport::Name)
+        if(mpTransportService && service->GetServiceID().GetName() == Transport::Name)
         {
             std::cout << "Component::ERROR - Cannot replace Transport service directly.\n";
             return false;
         }
         Service::Map::iterator s;
-        s = mServices.find(service->GetServiceID().mName);
+        s = mServices.find(service->GetServiceID().GetName());
         if(s == mServices.end())
         {
-            mServices[service->GetServiceID().mName] = service;
+            mServices[service->GetServiceID().GetName()] = service;
         }
         else
         {
@@ -617,9 +617,15 @@ bool Component::AddService(Service* service)
                 // Copy callbacks, etc.
                 t->CopyRegisteredItems(t2);
             }
+            mServiceMessageCodes.erase(s->first);
             delete s->second;
             s->second = service;
         }
+        // Record what message types the Service consumes.
+        if(dynamic_cast<Transport*>(service) == NULL)
+        {
+            service->GetReceivedMessageCodes(mServiceMessageCodes[service->GetServiceID().GetName()]);
+        }
         // Now attach services that inherit from each other.
         for(s = mServices.begin();
             s != mServices.end();
@@ -643,6 +649,8 @@ bool Component::AddService(Service* service)
             mpTransportService->SetComponent(this);
         }
 
+        UpdateMessageRoutes();
+
         result = true;
     }
     return result;
@@ -742,6 +750,93 @@ Service::ID::Set Component::GetServiceSet() const
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gets the Services that must receive a message, this is used by
+///          the Transport Service to route received messages.
+///
+///   \param[in] messageCode Type of message received.
+///
+///   \return Pointer to the list of Services to deliver the message to (never
+///           NULL).
+///
+////////////////////////////////////////////////////////////////////////////////////
+const Service::List* Component::GetMessageRoute(const UShort messageCode) const
+{
+    std::map<UShort, Service::List>::const_iterator route;
+    route = mMessageRoutes.find(messageCode);
+    if(route != mMessageRoutes.end())
+    {
+        return &route->second;
+    }
+    return &mDefaultMessageRoute;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Re-builds the table of what Services receive each type of message.
+///
+///   Services with no registered message codes receive all messages.  This
+///   is only done when Services are added (before initialization), so the
+///   table does not need thread protection.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Component::UpdateMessageRoutes()
+{
+    Service::Map::iterator s;
+    std::map<std::string, std::set<UShort> >::iterator codes;
+    std::set<UShort>::iterator code;
+
+    mMessageRoutes.clear();
+    mDefaultMessageRoute.clear();
+
+    // Find all message codes with at least one consumer.
+    for(codes = mServiceMessageCodes.begin();
+        codes != mServiceMessageCodes.end();
+        codes++)
+    {
+        for(code = codes->second.begin();
+            code != codes->second.end();
+            code++)
+        {
+            mMessageRoutes[*code];
+        }
+    }
+    // Add Services in the same order they are stored in the Component.
+    for(s = mServices.begin();
+        s != mServices.end();
+        s++)
+    {
+        codes = mServiceMessageCodes.find(s->first);
+        if(s->second == mpTransportService || codes == mServiceMessageCodes.end())
+        {
+            continue;
+        }
+        std::map<UShort, Service::List>::iterator route;
+        if(codes->second.empty())
+        {
+            mDefaultMessageRoute.push_back(s->second);
+            for(route = mMessageRoutes.begin();
+                route != mMessageRoutes.end();
+                route++)
+            {
+                route->second.push_back(s->second);
+            }
+        }
+        else
+        {
+            for(code = codes->second.begin();
+                code != codes->second.end();
+                code++)
+            {
+                mMessageRoutes[*code].push_back(s->second);
+            }
+        }
+    }
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief This method is called by the mCheckServiceTimer.  It calls the
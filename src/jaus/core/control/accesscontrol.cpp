@@ -46,6 +46,54 @@
 
 using namespace JAUS;
 
+namespace JAUS
+{
+    ////////////////////////////////////////////////////////////////////////////////////
+    ///
+    ///   \class RequestControlResponse
+    ///   \brief Handle for a Request Control sent without blocking, records
+    ///          control when the confirmation is received.
+    ///
+    ////////////////////////////////////////////////////////////////////////////////////
+    class RequestControlResponse : public AsyncResponse
+    {
+    public:
+        RequestControlResponse(AccessControl* accessControl,
+                               const Address& id,
+                               const bool reacquire,
+                               AsyncResponse::Callback* callback) : AsyncResponse(callback),
+                                                                    mpAccessControl(accessControl),
+                                                                    mID(id),
+                                                                    mReacquireFlag(reacquire)
+        {
+        }
+    protected:
+        ////////////////////////////////////////////////////////////////////////////////////
+        ///
+        ///   \brief Records control of the component if it was accepted.
+        ///
+        ///   \param[in] response Confirm or Reject Control, NULL on timeout.
+        ///
+        ///   \return True if control was acquired.
+        ///
+        ////////////////////////////////////////////////////////////////////////////////////
+        virtual bool OnResponse(const Message* response)
+        {
+            const ConfirmControl* confirm = dynamic_cast<const ConfirmControl*>(response);
+            if(confirm && confirm->GetResponseCode() == ConfirmControl::ControlAccepted)
+            {
+                mpAccessControl->ProcessControlAccepted(mID, mReacquireFlag);
+                return true;
+            }
+            return false;
+        }
+    private:
+        AccessControl* mpAccessControl; ///<  Service that sent the request.
+        Address mID;                    ///<  Component control was requested from.
+        bool mReacquireFlag;            ///<  If true, maintain control.
+    };
+}
+
 const std::string AccessControl::Name = "urn:jaus:jss:core:AccessControl";
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -202,48 +250,7 @@ bool AccessControl::RequestComponentControl(const Address& id,
         {
             if(confirm.GetResponseCode() == ConfirmControl::ControlAccepted)
             {
-                {
-                    WriteLock wLock(mControlMutex);
-                    mControlledComponents.insert(id);
-                    mMaintainFlags[id] = reacquire;    
-                    mControlFlags[id] = true;
-                    // Set the time we verified we have control.
-                    mControlCheckTimes[id].SetCurrentTime();
-                    // Set the time we confirmed control.
-                    mControlConfirmTimes[id].SetCurrentTime();
-                    // Set a default value for timeout.
-                    mTimeoutPeriods[id] = mTimeoutPeriod;
-                }
-
-                // Query the timout period for the component.
-                QueryTimeout query(id, GetComponentID());
-                Send(&query);
-
-                // Trigger acquisition of control events!
-
-                Service::Map children = GetChildServices();
-                Service::Map::iterator child;
-                for(child = children.begin();
-                    child != children.end();
-                    child++)
-                {
-                    Child* controlChild = dynamic_cast<Child *>(child->second);
-                    if(controlChild)
-                    {
-                        controlChild->ProcessAcquisitionOfControl(id);
-                    }
-                }
-
-                {
-                    ReadLock cbrLock(mCallbacksMutex);
-                    Callback::Set::iterator cb;
-                    for(cb = mCallbacks.begin();
-                        cb != mCallbacks.end();
-                        cb++)
-                    {
-                        (*cb)->ProcessAcquisitionfControl(id);
-                    }
-                }
+                ProcessControlAccepted(id, reacquire);
                 return true;
             }
         }
@@ -255,6 +262,97 @@ bool AccessControl::RequestComponentControl(const Address& id,
     return false;
 }
 
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Requests control of a component without blocking.
+///
+///   Control is recorded (and children and callbacks notified) by the
+///   Transport thread that receives the confirmation, the same as
+///   RequestComponentControl.  Use this to take control of many components
+///   at once from a single thread.
+///
+///   \param[in] id The ID of the component to request control of.
+///   \param[in] reacquire If true, control is maintained (re-requested).
+///   \param[in] callback Optional callback made when the request is done.
+///   \param[in] waitTimeMs How long to wait for a response.
+///
+///   \return Handle to the request, IsSuccessful is true if control was
+///           acquired.
+///
+////////////////////////////////////////////////////////////////////////////////////
+AsyncResponse::Ptr AccessControl::RequestComponentControlAsync(const Address& id, 
+                                                               const bool reacquire,
+                                                               AsyncResponse::Callback* callback,
+                                                               const unsigned int waitTimeMs)
+{
+    RequestControl request(id, GetComponentID());
+    request.SetAuthorityCode(mAuthorityCode);
+    std::set<UShort> responseCodes;
+    responseCodes.insert(CONFIRM_CONTROL);
+    responseCodes.insert(REJECT_CONTROL);
+
+    AsyncResponse::Ptr handle(new RequestControlResponse(this, id, reacquire, callback));
+    AsyncResponse::Send(GetTransportService(), handle, &request, responseCodes, waitTimeMs);
+    return handle;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Records that control of a component was acquired, then notifies
+///          children and callbacks.
+///
+///   \param[in] id The component controlled.
+///   \param[in] reacquire If true, control is maintained (re-requested).
+///
+////////////////////////////////////////////////////////////////////////////////////
+void AccessControl::ProcessControlAccepted(const Address& id, const bool reacquire)
+{
+    {
+        WriteLock wLock(mControlMutex);
+        mControlledComponents.insert(id);
+        mMaintainFlags[id] = reacquire;    
+        mControlFlags[id] = true;
+        // Set the time we verified we have control.
+        mControlCheckTimes[id].SetCurrentTime();
+        // Set the time we confirmed control.
+        mControlConfirmTimes[id].SetCurrentTime();
+        // Set a default value for timeout.
+        mTimeoutPeriods[id] = mTimeoutPeriod;
+    }
+
+    // Query the timout period for the component.
+    QueryTimeout query(id, GetComponentID());
+    Send(&query);
+
+    // Trigger acquisition of control events!
+
+    Service::Map children = GetChildServices();
+    Service::Map::iterator child;
+    for(child = children.begin();
+        child != children.end();
+        child++)
+    {
+        Child* controlChild = dynamic_cast<Child *>(child->second);
+        if(controlChild)
+        {
+            controlChild->ProcessAcquisitionOfControl(id);
+        }
+    }
+
+    {
+        ReadLock cbrLock(mCallbacksMutex);
+        Callback::Set::iterator cb;
+        for(cb = mCallbacks.begin();
+            cb != mCallbacks.end();
+            cb++)
+        {
+            (*cb)->ProcessAcquisitionfControl(id);
+        }
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Method to release exclusive control of a component.
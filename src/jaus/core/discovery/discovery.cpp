@@ -57,12 +57,301 @@
 #include "jaus/core/component.h"
 
 #include <iostream>
+#include <algorithm>
 #include <tinyxml/tinyxml.h>
 
 using namespace JAUS;
 
 const std::string Discovery::Name = "urn:jaus:jss:core:Discovery";
 
+
+/** Service index entries copied while publishing a Snapshot.  Entries not
+    in it are still shared with the previous Snapshot. */
+typedef std::map<Service::ID::Handle, boost::shared_ptr<Discovery::Snapshot::Providers> > WritableProviders;
+
+
+/** Gets the providers of a service for modification, copying the entry
+    shared with the previous Snapshot the first time. */
+static Discovery::Snapshot::Providers* GetWritableProviders(Discovery::Snapshot::ServiceIndex& index,
+                                                           WritableProviders& writable,
+                                                           const Service::ID::Handle service)
+{
+    WritableProviders::iterator copy = writable.find(service);
+    if(copy != writable.end())
+    {
+        return copy->second.get();
+    }
+    boost::shared_ptr<Discovery::Snapshot::Providers> providers;
+    Discovery::Snapshot::ServiceIndex::const_iterator shared = index.find(service);
+    if(shared != index.end())
+    {
+        providers.reset(new Discovery::Snapshot::Providers(*shared->second));
+    }
+    else
+    {
+        providers.reset(new Discovery::Snapshot::Providers());
+    }
+    writable[service] = providers;
+    index[service] = providers;
+    return providers.get();
+}
+
+
+/** Adds the components of a subsystem to a service index, keeping
+    the components for each service sorted. */
+static void AddToServiceIndex(Discovery::Snapshot::ServiceIndex& index,
+                              WritableProviders& writable,
+                              const Subsystem& subsystem)
+{
+    Subsystem::Configuration::const_iterator node;
+    Subsystem::Component::Set::const_iterator component;
+    Service::ID::Set::const_iterator service;
+    for(node = subsystem.mConfiguration.begin(); node != subsystem.mConfiguration.end(); node++)
+    {
+        for(component = node->second.begin(); component != node->second.end(); component++)
+        {
+            for(service = component->mServices.begin(); service != component->mServices.end(); service++)
+            {
+                // Names without a Handle were never interned locally, so
+                // they cannot be looked up.
+                if(service->GetHandle() == Service::ID::NoHandle)
+                {
+                    continue;
+                }
+                Discovery::Snapshot::Providers* providers = GetWritableProviders(index, writable, service->GetHandle());
+                Address::List::iterator position = std::lower_bound(providers->mComponents.begin(),
+                                                                     providers->mComponents.end(),
+                                                                     component->mID);
+                size_t offset = position - providers->mComponents.begin();
+                providers->mComponents.insert(position, component->mID);
+                providers->mVersions.insert(providers->mVersions.begin() + offset, service->mVersion);
+            }
+        }
+    }
+}
+
+
+/** Removes the components of a subsystem (as they were indexed) from
+    a service index.  Entries left empty are removed by the caller. */
+static void RemoveFromServiceIndex(Discovery::Snapshot::ServiceIndex& index,
+                                   WritableProviders& writable,
+                                   const Subsystem& subsystem)
+{
+    Subsystem::Configuration::const_iterator node;
+    Subsystem::Component::Set::const_iterator component;
+    Service::ID::Set::const_iterator service;
+    for(node = subsystem.mConfiguration.begin(); node != subsystem.mConfiguration.end(); node++)
+    {
+        for(component = node->second.begin(); component != node->second.end(); component++)
+        {
+            for(service = component->mServices.begin(); service != component->mServices.end(); service++)
+            {
+                if(index.find(service->GetHandle()) == index.end())
+                {
+                    continue;
+                }
+                Discovery::Snapshot::Providers* providers = GetWritableProviders(index, writable, service->GetHandle());
+                Address::List::iterator position = std::lower_bound(providers->mComponents.begin(),
+                                                                     providers->mComponents.end(),
+                                                                     component->mID);
+                if(position != providers->mComponents.end() && *position == component->mID)
+                {
+                    size_t offset = position - providers->mComponents.begin();
+                    providers->mComponents.erase(position);
+                    providers->mVersions.erase(providers->mVersions.begin() + offset);
+                }
+            }
+        }
+    }
+}
+
+
+/** Mixes data into a FNV-1a hash. */
+static UInt HashBytes(UInt hash, const void* data, const unsigned int length)
+{
+    const Byte* bytes = (const Byte*)data;
+    for(unsigned int i = 0; i < length; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+
+/** Gets the configuration generation advertised for incremental discovery.
+    It is a hash of the components (and their services) in the subsystem, and
+    the identification, authority, and status of this component, so it changes
+    whenever data peers query for changes. */
+static UInt ComputeConfigurationGeneration(const Subsystem& subsystem, const Address& id)
+{
+    UInt hash = 2166136261U;
+    Subsystem::Configuration::const_iterator node;
+    Subsystem::Component::Set::const_iterator component;
+    for(node = subsystem.mConfiguration.begin(); node != subsystem.mConfiguration.end(); node++)
+    {
+        for(component = node->second.begin(); component != node->second.end(); component++)
+        {
+            UInt address = component->mID.ToUInt();
+            hash = HashBytes(hash, &address, sizeof(address));
+            Service::ID::Set::const_iterator service;
+            for(service = component->mServices.begin(); service != component->mServices.end(); service++)
+            {
+                hash = HashBytes(hash, service->GetName().c_str(), (unsigned int)service->GetName().size());
+                hash = HashBytes(hash, &service->mVersion, sizeof(service->mVersion));
+            }
+            if(component->mID == id)
+            {
+                hash = HashBytes(hash, component->mIdentification.c_str(), (unsigned int)component->mIdentification.size());
+                hash = HashBytes(hash, &component->mAuthorityLevel, sizeof(component->mAuthorityLevel));
+                hash = HashBytes(hash, &component->mStatus, sizeof(component->mStatus));
+            }
+        }
+    }
+    // Zero means no generation.
+    return hash == 0 ? 1 : hash;
+}
+
+
+/** Returns true if the data shared in discovery about a component is different. */
+static bool HasComponentChanged(const Subsystem::Component& previous, const Subsystem::Component& current)
+{
+    if(previous.mIdentification != current.mIdentification ||
+       previous.mAuthorityLevel != current.mAuthorityLevel ||
+       previous.mStatus != current.mStatus ||
+       previous.mServices.size() != current.mServices.size())
+    {
+        return true;
+    }
+    Service::ID::Set::const_iterator p, c;
+    for(p = previous.mServices.begin(), c = current.mServices.begin();
+        p != previous.mServices.end();
+        p++, c++)
+    {
+        if(*p != *c || p->mVersion != c->mVersion)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/** Adds components of the current subsystem that are new or changed to the
+    changes, and components of the previous subsystem not in the current. */
+static void GetSubsystemChanges(const Subsystem* previous,
+                                const Subsystem* current,
+                                Discovery::Changes& changes)
+{
+    bool changed = false;
+    Subsystem::Configuration::const_iterator node, otherNode;
+    Subsystem::Component::Set::const_iterator component, otherComponent;
+    if(current)
+    {
+        for(node = current->mConfiguration.begin(); node != current->mConfiguration.end(); node++)
+        {
+            if(previous)
+            {
+                otherNode = previous->mConfiguration.find(node->first);
+            }
+            for(component = node->second.begin(); component != node->second.end(); component++)
+            {
+                if(previous == NULL || otherNode == previous->mConfiguration.end() ||
+                   (otherComponent = otherNode->second.find(*component)) == otherNode->second.end())
+                {
+                    changes.mAdded.push_back(component->mID);
+                    changed = true;
+                }
+                else if(HasComponentChanged(*otherComponent, *component))
+                {
+                    changes.mChanged.push_back(component->mID);
+                    changed = true;
+                }
+            }
+        }
+    }
+    if(previous)
+    {
+        for(node = previous->mConfiguration.begin(); node != previous->mConfiguration.end(); node++)
+        {
+            if(current)
+            {
+                otherNode = current->mConfiguration.find(node->first);
+            }
+            for(component = node->second.begin(); component != node->second.end(); component++)
+            {
+                if(current == NULL || otherNode == current->mConfiguration.end() ||
+                   otherNode->second.find(*component) == otherNode->second.end())
+                {
+                    changes.mRemoved.push_back(component->mID);
+                    changed = true;
+                }
+            }
+        }
+    }
+    if(changed || previous == NULL || current == NULL || current->HasChanged(*previous))
+    {
+        changes.mSubsystems.insert(previous ? previous->mSubsystemID : current->mSubsystemID);
+    }
+}
+
+
+/** Returns true if the data shared in a Snapshot about a subsystem is
+    different, update times are not compared. */
+static bool HasSubsystemChanged(const Subsystem* previous, const Subsystem* current)
+{
+    if(previous == NULL || current == NULL)
+    {
+        return previous != current;
+    }
+    if((dynamic_cast<const Vehicle*>(previous) == NULL) != (dynamic_cast<const Vehicle*>(current) == NULL))
+    {
+        return true;
+    }
+    Discovery::Changes changes;
+    GetSubsystemChanges(previous, current, changes);
+    return changes.mSubsystems.size() > 0;
+}
+
+
+/** Gets the last time data was received, or the time the data was created
+    if nothing has been received since. */
+template<class T>
+static Time::Stamp GetHeardTimeMs(const std::map<T, Time::Stamp>& heard, const T& id, const Time& created)
+{
+    typename std::map<T, Time::Stamp>::const_iterator h = heard.find(id);
+    return h != heard.end() ? h->second : created.ToMs();
+}
+
+
+/** Gets the differences between two snapshots of the system.  Subsystems
+    shared by both snapshots have not changed, so they are skipped. */
+static void GetSystemChanges(const Discovery::Snapshot& previous,
+                             const Discovery::Snapshot& current,
+                             Discovery::Changes& changes)
+{
+    Subsystem::Map::const_iterator s, other;
+    for(s = current.mSystem.begin(); s != current.mSystem.end(); s++)
+    {
+        other = previous.mSystem.find(s->first);
+        if(other == previous.mSystem.end())
+        {
+            GetSubsystemChanges(NULL, s->second.get(), changes);
+        }
+        else if(other->second != s->second)
+        {
+            GetSubsystemChanges(other->second.get(), s->second.get(), changes);
+        }
+    }
+    for(s = previous.mSystem.begin(); s != previous.mSystem.end(); s++)
+    {
+        if(current.mSystem.find(s->first) == current.mSystem.end())
+        {
+            GetSubsystemChanges(s->second.get(), NULL, changes);
+        }
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Constructor.
@@ -77,6 +366,11 @@ Discovery::Discovery() : Events::Child(Service::ID(Discovery::Name), Service::ID
     mNodeIdentification = "Node";
     mSubsystemType = Subsystem::OtherSubsystem;
     mTriggerCallbacksFlag = false;
+    mIncrementalDiscoveryFlag = false;
+    mMaxBackoffMs = 60000;
+    mGeneration = 0;
+    mSnapshot.reset(new Snapshot());
+    mCallbackSnapshot = mSnapshot;
 }
 
 
@@ -150,6 +444,16 @@ bool Discovery::LoadSettings(const std::string& filename)
         mSubsystemType = (Subsystem::Type)atoi(element->Attribute("type"));
         mSubsystemIdentification = element->FirstChild()->Value();
     }
+    element = doc.FirstChild("JAUS").FirstChild("Discovery").FirstChild("Incremental").ToElement();
+    if(element && element->FirstChild() && element->FirstChild()->Value())
+    {
+        unsigned int maxBackoffMs = mMaxBackoffMs;
+        if(element->Attribute("max_backoff_ms"))
+        {
+            maxBackoffMs = (unsigned int)atoi(element->Attribute("max_backoff_ms"));
+        }
+        EnableIncrementalDiscovery(atoi(element->FirstChild()->Value()) > 0 ? true : false, maxBackoffMs);
+    }
     return true;
 }
 
@@ -161,6 +465,7 @@ bool Discovery::LoadSettings(const std::string& filename)
 ////////////////////////////////////////////////////////////////////////////////////
 void Discovery::Initialize()
 {
+    WriteLock wLock(mSubsystemDataMutex);
     if(mSystem.size() == 0)
     {
         if(mDiscoverSubsystemsFlag)
@@ -181,6 +486,7 @@ void Discovery::Initialize()
         mSystem[GetComponentID().mSubsystem]->GetComponent(GetComponentID())->mIdentification = mComponentIdentification;
         mSystem[GetComponentID().mSubsystem]->GetComponent(GetComponentID())->mAuthorityLevel = this->GetComponent()->AccessControlService()->GetAuthorityCode();
         mSystem[GetComponentID().mSubsystem]->mUpdateTime.SetCurrentTime();
+        PublishSnapshot(GetComponentID().mSubsystem);
     }
 }
 
@@ -193,8 +499,18 @@ void Discovery::Initialize()
 void Discovery::Shutdown()
 {
     WriteLock wLock(mSubsystemDataMutex);
+    std::set<UShort> subsystems;
+    Subsystem::Map::const_iterator s;
+    for(s = mSystem.begin(); s != mSystem.end(); s++)
+    {
+        subsystems.insert(s->first);
+    }
     Subsystem::DeleteSubsystemMap(mSystem);
+    PublishSnapshot(subsystems);
     mSubsystemList.clear();
+    mPeers.clear();
+    mSubsystemHeardMs.clear();
+    mComponentHeardMs.clear();
 }
 
 
@@ -210,29 +526,33 @@ void Discovery::Shutdown()
 ////////////////////////////////////////////////////////////////////////////////////
 void Discovery::Receive(const Message* message)
 {
-    Subsystem::Map::iterator myInfo = mSystem.find(GetComponentID().mSubsystem);
-    if(myInfo == mSystem.end())
     {
-        Subsystem* ptr = NULL;
-        // Initialize configuration and services information
-        // for this subsystem.
-        if(mSubsystemType == Subsystem::Vehicle)
-        {
-            ptr = new Vehicle();
-            mSystem[GetComponentID().mSubsystem].reset(ptr);
-            ((Vehicle*)ptr)->mAuthorityLevel = GetComponent()->AccessControlService()->GetAuthorityCode();
-        }
-        else
+        WriteLock wLock(mSubsystemDataMutex);
+        Subsystem::Map::iterator myInfo = mSystem.find(GetComponentID().mSubsystem);
+        if(myInfo == mSystem.end())
         {
-            ptr = new Subsystem();
-            mSystem[GetComponentID().mSubsystem].reset(ptr);
+            Subsystem* ptr = NULL;
+            // Initialize configuration and services information
+            // for this subsystem.
+            if(mSubsystemType == Subsystem::Vehicle)
+            {
+                ptr = new Vehicle();
+                mSystem[GetComponentID().mSubsystem].reset(ptr);
+                ((Vehicle*)ptr)->mAuthorityLevel = GetComponent()->AccessControlService()->GetAuthorityCode();
+            }
+            else
+            {
+                ptr = new Subsystem();
+                mSystem[GetComponentID().mSubsystem].reset(ptr);
+            }
+            ptr->mType = mSubsystemType;
+            ptr->mIdentification = mSubsystemIdentification;
+            ptr->mSubsystemID = GetComponentID().mSubsystem;
+            ptr->GetComponent(GetComponentID())->mIdentification = mComponentIdentification;
+            ptr->GetComponent(GetComponentID())->mServices = GetTransportService()->GetServices();
+            ptr->GetComponent(GetComponentID())->mAuthorityLevel = GetComponent()->AccessControlService()->GetAuthorityCode();
+            PublishSnapshot(GetComponentID().mSubsystem);
         }
-        ptr->mType = mSubsystemType;
-        ptr->mIdentification = mSubsystemIdentification;
-        ptr->mSubsystemID = GetComponentID().mSubsystem;
-        ptr->GetComponent(GetComponentID())->mIdentification = mComponentIdentification;
-        ptr->GetComponent(GetComponentID())->mServices = GetTransportService()->GetServices();
-        ptr->GetComponent(GetComponentID())->mAuthorityLevel = GetComponent()->AccessControlService()->GetAuthorityCode();
     }
 
     switch(message->GetMessageCode())
@@ -319,6 +639,10 @@ void Discovery::Receive(const Message* message)
                         haveData = true;
                         response.SetIdentification(mSubsystemIdentification);
                         response.SetType((ReportIdentification::IdentificationType)mSubsystemType);
+                        if(mIncrementalDiscoveryFlag)
+                        {
+                            response.SetGeneration(mGeneration);
+                        }
                     }
 
                     ReadLock rLock(mSubsystemDataMutex);
@@ -373,7 +697,7 @@ void Discovery::Receive(const Message* message)
                 Subsystem::Map::iterator s = mSystem.find(GetComponentID().mSubsystem);
                 if(s != mSystem.end())
                 {
-                    s->second->mUpdateTime.SetCurrentTime();
+                    mSubsystemHeardMs[s->first] = Time::GetUtcTimeMs();
                 }
             }
             if(query->GetSourceID().mSubsystem == GetComponentID().mSubsystem)
@@ -483,8 +807,9 @@ void Discovery::Receive(const Message* message)
                 }
                 // Update known services and component/subsystem update times.
                 subsystem->second->GetComponent(message->GetSourceID())->mServices = *registerServices->GetServices();
-                subsystem->second->GetComponent(message->GetSourceID())->mUpdateTime.SetCurrentTime();
-                subsystem->second->mUpdateTime.SetCurrentTime();
+                mComponentHeardMs[message->GetSourceID()] = Time::GetUtcTimeMs();
+                mSubsystemHeardMs[subsystem->first] = Time::GetUtcTimeMs();
+                PublishIfChanged(subsystem->first);
             }
         }
         break;
@@ -508,6 +833,7 @@ void Discovery::Receive(const Message* message)
                     }
 
                     Address id(report->GetSourceID().mSubsystem, 0, 0);
+                    Address::Set reported;
 
                     // Create any components needed, and send appropriate queries.
                     ReportConfiguration::Nodes::const_iterator node;
@@ -523,6 +849,7 @@ void Discovery::Receive(const Message* message)
                         {
                             id.mComponent = record->mComponent;
                             subsystem->second->GetComponent(id);
+                            reported.insert(id);
 
                             (*(query.GetNodeList()))[id.mNode].push_back(id.mComponent);
 
@@ -534,7 +861,15 @@ void Discovery::Receive(const Message* message)
                         }
                     }
 
-                    subsystem->second->mUpdateTime.SetCurrentTime();
+                    // Remember what the peer reported, so these components can be
+                    // kept alive while its generation does not change.
+                    if(mIncrementalDiscoveryFlag)
+                    {
+                        mPeers[report->GetSourceID()].mComponents = reported;
+                    }
+
+                    mSubsystemHeardMs[subsystem->first] = Time::GetUtcTimeMs();
+                    PublishIfChanged(subsystem->first);
                 }
 
                 if(query.GetNodeList()->size() == 0)
@@ -557,13 +892,29 @@ void Discovery::Receive(const Message* message)
             {                
                 Subsystem::Map::iterator subsystem;
 
-                // Publish services for the component.
-                RegisterServices registerServices(report->GetSourceID(), GetComponentID());
-                *registerServices.GetServices() = GetTransportService()->GetServices();
-                Send(&registerServices);  
-                
                 WriteLock wLock(mSubsystemDataMutex);
 
+                // With incremental discovery, peers are only queried again if
+                // their configuration generation changes (or backoff time ends).
+                bool queryPeer = true;
+                if(mIncrementalDiscoveryFlag && 
+                   report->GetGeneration() != 0 &&
+                   report->GetQueryType() == ReportIdentification::SubsystemIdentification)
+                {
+                    subsystem = mSystem.find(message->GetSourceID().mSubsystem);
+                    queryPeer = CheckPeerGeneration(report->GetSourceID(),
+                                                    report->GetGeneration(),
+                                                    subsystem != mSystem.end() && subsystem->second->mConfiguration.size() > 0);
+                }
+
+                if(queryPeer)
+                {
+                    // Publish services for the component.
+                    RegisterServices registerServices(report->GetSourceID(), GetComponentID());
+                    *registerServices.GetServices() = GetTransportService()->GetServices();
+                    Send(&registerServices);  
+                }
+
                 subsystem = mSystem.find(message->GetSourceID().mSubsystem);
                 
                 if(subsystem != mSystem.end())
@@ -606,10 +957,27 @@ void Discovery::Receive(const Message* message)
                         subsystem->second->mIdentification = report->GetIdentification();
                         subsystem->second->mType = (Subsystem::Type)report->GetType();
 
-                        // Query the configuration of the subsystem.
-                        QueryConfiguration querySubsystemConfig(report->GetSourceID(), GetComponentID());
-                        querySubsystemConfig.SetQueryType(QueryConfiguration::SubsystemConfiguration);
-                        Send(&querySubsystemConfig);
+                        if(queryPeer)
+                        {
+                            // Query the configuration of the subsystem.
+                            QueryConfiguration querySubsystemConfig(report->GetSourceID(), GetComponentID());
+                            querySubsystemConfig.SetQueryType(QueryConfiguration::SubsystemConfiguration);
+                            Send(&querySubsystemConfig);
+                        }
+                        else
+                        {
+                            // Configuration is unchanged, so the components the
+                            // peer reported last are still connected.
+                            const Address::Set& components = mPeers[report->GetSourceID()].mComponents;
+                            Address::Set::const_iterator id;
+                            for(id = components.begin(); id != components.end(); id++)
+                            {
+                                if(subsystem->second->HaveComponent(*id))
+                                {
+                                    mComponentHeardMs[*id] = Time::GetUtcTimeMs();
+                                }
+                            }
+                        }
 
                         if(subsystem->first == GetComponentID().mSubsystem)
                         {
@@ -643,7 +1011,7 @@ void Discovery::Receive(const Message* message)
                         Subsystem::Component* component = subsystem->second->GetComponent(report->GetSourceID());
                         component->mID = report->GetSourceID();
                         component->mIdentification = report->GetIdentification();
-                        component->mUpdateTime.SetCurrentTime();
+                        mComponentHeardMs[report->GetSourceID()] = Time::GetUtcTimeMs();
 
                         if(subsystem->second->mConfiguration.size() == 0)
                         {
@@ -657,7 +1025,10 @@ void Discovery::Receive(const Message* message)
                     break;
                 }
                 
-                subsystem->second->mUpdateTime.SetCurrentTime();
+                // Replies to every broadcast only keep the subsystem alive,
+                // so a new Snapshot is only made if data changed.
+                mSubsystemHeardMs[subsystem->first] = Time::GetUtcTimeMs();
+                PublishIfChanged(subsystem->first);
             }
         }
         break;
@@ -693,12 +1064,12 @@ void Discovery::Receive(const Message* message)
                     {
                         id.mComponent = record->mComponent;
                         subsystem->second->GetComponent(id)->mServices = record->mServices;
-                        subsystem->second->GetComponent(id)->mUpdateTime.SetCurrentTime();
+                        mComponentHeardMs[id] = Time::GetUtcTimeMs();
                     }
                 }
 
-                subsystem->second->mUpdateTime.SetCurrentTime();
-
+                mSubsystemHeardMs[subsystem->first] = Time::GetUtcTimeMs();
+                PublishIfChanged(subsystem->first);
             }
         }
         break;
@@ -719,6 +1090,7 @@ void Discovery::Receive(const Message* message)
                 {
                     vehicle->mAuthorityLevel = command->GetAuthorityCode();
                 }
+                PublishSnapshot(s->first);
             }
         };
         break;
@@ -739,6 +1111,7 @@ void Discovery::Receive(const Message* message)
                 {
                     vehicle->mAuthorityLevel = report->GetAuthorityCode();
                 }
+                PublishSnapshot(s->first);
             }
         };
         break;
@@ -754,6 +1127,7 @@ void Discovery::Receive(const Message* message)
             if(s != mSystem.end())
             {
                 s->second->GetComponent(report->GetSourceID())->mStatus = report->GetStatus();
+                PublishSnapshot(s->first);
             }
         };
         break;
@@ -816,6 +1190,24 @@ Message* Discovery::CreateMessage(const UShort messageCode) const
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gets the message codes processed by the Receive method.  In
+///          addition to Discovery messages, the Service tracks authority
+///          and status information of discovered components.
+///
+///   \param[out] messageCodes Message codes processed by the Service.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Discovery::GetReceivedMessageCodes(std::set<UShort>& messageCodes) const
+{
+    Service::GetReceivedMessageCodes(messageCodes);
+    messageCodes.insert(SET_AUTHORITY);
+    messageCodes.insert(REPORT_AUTHORITY);
+    messageCodes.insert(REPORT_STATUS);
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Method called periodically by external classes and is used to
@@ -857,13 +1249,26 @@ void Discovery::CheckServiceStatus(const unsigned int timeSinceLastCheckMs)
         Subsystem::Map::iterator me = mSystem.find(GetComponentID().mSubsystem);
         if(me != mSystem.end())
         {
-            me->second->GetComponent(GetComponentID())->mAuthorityLevel = GetComponent()->AccessControlService()->GetAuthorityCode();
-            me->second->GetComponent(GetComponentID())->mStatus = GetComponent()->ManagementService()->GetStatus();
-            me->second->GetComponent(GetComponentID())->mServices = GetTransportService()->GetServices();
+            Subsystem::Component* myComponent = me->second->GetComponent(GetComponentID());
+            Subsystem::Component previous = *myComponent;
+            myComponent->mAuthorityLevel = GetComponent()->AccessControlService()->GetAuthorityCode();
+            myComponent->mStatus = GetComponent()->ManagementService()->GetStatus();
+            myComponent->mServices = GetTransportService()->GetServices();
+            bool changed = HasComponentChanged(previous, *myComponent);
             Vehicle* vehicle = dynamic_cast<Vehicle*>(me->second.get());
             if(vehicle != NULL && vehicle->mAuthorityLevel < GetComponent()->AccessControlService()->GetAuthorityCode())
             {
                 vehicle->mAuthorityLevel = GetComponent()->AccessControlService()->GetAuthorityCode();
+                changed = true;
+            }
+            // Only publish if something changed, this is called every update.
+            if(changed)
+            {
+                PublishSnapshot(me->first);
+            }
+            if(changed || updateSystemInfo)
+            {
+                mGeneration = ComputeConfigurationGeneration(*me->second, GetComponentID());
             }
         }
     }
@@ -875,7 +1280,6 @@ void Discovery::CheckServiceStatus(const unsigned int timeSinceLastCheckMs)
         return;
     }
 
-    Subsystem::Map system;
     Address::List lostComponents;
     
 
@@ -883,12 +1287,16 @@ void Discovery::CheckServiceStatus(const unsigned int timeSinceLastCheckMs)
         WriteLock wLock(mSubsystemDataMutex);
 
         Time::Stamp disconnectTimeMs = this->GetComponent()->TransportService()->GetDisconnectTimeMs();
+        std::set<UShort> changed;
         // Delete all components and subsystems we no
         // longer have connections to.
         Subsystem::Map::iterator subsystem = mSystem.begin();
         while(subsystem != mSystem.end())
         {
-            if(mBroadcastDelayMs*2.0 >= (unsigned int)(Time::GetUtcTimeMs() - subsystem->second->mUpdateTime.ToMs()))
+            // Liveness times are kept out of the Snapshot, so only removals
+            // of components and subsystems are published here.
+            Time::Stamp heardMs = GetHeardTimeMs(mSubsystemHeardMs, subsystem->first, subsystem->second->mUpdateTime);
+            if(mBroadcastDelayMs*2.0 >= (unsigned int)(Time::GetUtcTimeMs() - heardMs))
             {
                 subsystem++;
                 continue;
@@ -900,21 +1308,21 @@ void Discovery::CheckServiceStatus(const unsigned int timeSinceLastCheckMs)
                 while(component != node->second.end())
                 {
                     if(component->mID == GetComponentID() || 
-                        (disconnectTimeMs >= (Time::Stamp)(Time::GetUtcTimeMs() - component->mUpdateTime.ToMs())))
+                        (disconnectTimeMs >= (Time::Stamp)(Time::GetUtcTimeMs() - GetHeardTimeMs(mComponentHeardMs, component->mID, component->mUpdateTime))))
                     {
                         component++;
                     }
                     else
                     {
                         lostComponents.push_back(component->mID);
-                        node->second.erase(component);
-                        component = node->second.begin();
+                        mComponentHeardMs.erase(component->mID);
+                        node->second.erase(component++);
+                        changed.insert(subsystem->first);
                     }
                 }
                 if(node->second.size() == 0)
                 {
-                    subsystem->second->mConfiguration.erase(node);
-                    node = subsystem->second->mConfiguration.begin();
+                    subsystem->second->mConfiguration.erase(node++);
                 }
                 else
                 {
@@ -923,8 +1331,9 @@ void Discovery::CheckServiceStatus(const unsigned int timeSinceLastCheckMs)
             }
             if(subsystem->second->mConfiguration.size() == 0)
             {
-                mSystem.erase(subsystem);
-                subsystem = mSystem.begin();
+                mSubsystemHeardMs.erase(subsystem->first);
+                changed.insert(subsystem->first);
+                mSystem.erase(subsystem++);
             }
             else
             {
@@ -932,9 +1341,10 @@ void Discovery::CheckServiceStatus(const unsigned int timeSinceLastCheckMs)
             }
         }
 
-        // Make a copy of the current state so we can
-        // generate non-blocking callbacks on the data.
-        Subsystem::CopySubsystemMap(mSystem, system);
+        if(changed.size() > 0)
+        {
+            PublishSnapshot(changed);
+        }
 
         // Remove from subsystem list.
         Address::List::iterator lostComponent;
@@ -946,24 +1356,29 @@ void Discovery::CheckServiceStatus(const unsigned int timeSinceLastCheckMs)
             {
                 mSubsystemList.erase(mSubsystemList.find(*lostComponent));
             }
+            mPeers.erase(*lostComponent);
         }
 
     }
 
     
     {
-        // Do standard update on callbacks.
+        // Give callbacks the current snapshot and what changed since the
+        // last update, no copies are made.
+        Snapshot::Ptr system = boost::atomic_load(&mSnapshot);
+        Changes changes;
+        GetSystemChanges(*mCallbackSnapshot, *system, changes);
+        mCallbackSnapshot = system;
+
         ReadLock cbLock(mCallbacksMutex);
         Callback::Set::iterator cb;
         for(cb = mCallbacks.begin();
             cb != mCallbacks.end();
             cb++)
         {
-            (*cb)->ProcessSystemState(system);
+            (*cb)->ProcessSystemChanges(system, changes);
         }
     }
-    // Delete copies made.
-    Subsystem::DeleteSubsystemMap(system);
 
     mTriggerCallbacksFlag = false;
 }
@@ -1114,6 +1529,31 @@ bool Discovery::SetDiscoveryFrequency(const double frequencyHz)
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Enables incremental discovery (off by default).
+///
+///   Each component advertises a configuration generation in its subsystem
+///   identification report (a JAUS++ extension appended to the message).
+///   Peers only re-query configuration and services when the generation
+///   changes.  Peers whose generation does not change are still re-queried,
+///   with an exponential backoff up to maxBackoffMs, in case a change was
+///   missed.  Components that do not send a generation are always queried.
+///
+///   \param[in] enable If true, incremental discovery is used.
+///   \param[in] maxBackoffMs Maximum time between queries of a peer whose
+///                           generation does not change.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Discovery::EnableIncrementalDiscovery(const bool enable, const unsigned int maxBackoffMs)
+{
+    WriteLock wLock(mSubsystemDataMutex);
+    mIncrementalDiscoveryFlag = enable;
+    mMaxBackoffMs = maxBackoffMs;
+    mPeers.clear();
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \return A map list of all subsystems and their identification names.
@@ -1121,13 +1561,14 @@ bool Discovery::SetDiscoveryFrequency(const double frequencyHz)
 ////////////////////////////////////////////////////////////////////////////////////
 Discovery::List Discovery::GetSubsystemList() const
 {
-    ReadLock rLock(*( (SharedMutex*)&mSubsystemDataMutex));
+    Snapshot::Ptr system = GetSnapshot();
+    ReadLock rLock(*( (SharedMutex*)&mSubsystemsToDiscoverMutex));
 
     Discovery::List list;
     Subsystem::Map::const_iterator subsystem;
 
-    for(subsystem = mSystem.begin();
-        subsystem != mSystem.end();
+    for(subsystem = system->mSystem.begin();
+        subsystem != system->mSystem.end();
         subsystem++)
     {
         if(mSubsystemsToDiscover.size() == 0 ||
@@ -1148,13 +1589,14 @@ Discovery::List Discovery::GetSubsystemList() const
 ////////////////////////////////////////////////////////////////////////////////////
 Discovery::List Discovery::GetVehicleList() const
 {
-    ReadLock rLock(*( (SharedMutex*)&mSubsystemDataMutex));
+    Snapshot::Ptr system = GetSnapshot();
+    ReadLock rLock(*( (SharedMutex*)&mSubsystemsToDiscoverMutex));
 
     Discovery::List list;
     Subsystem::Map::const_iterator subsystem;
 
-    for(subsystem = mSystem.begin();
-        subsystem != mSystem.end();
+    for(subsystem = system->mSystem.begin();
+        subsystem != system->mSystem.end();
         subsystem++)
     {
         if(subsystem->second->mType == Subsystem::Vehicle)
@@ -1173,29 +1615,59 @@ Discovery::List Discovery::GetVehicleList() const
 
 ////////////////////////////////////////////////////////////////////////////////////
 ///
+///   \brief Gets the components discovered with a given service.
+///
+///   This allocates a new list on each call.  To look up components
+///   repeatedly, pass the same list to the overload that fills it in.
+///
 ///   \return A list of any components discovered with a given service.
 ///
 ////////////////////////////////////////////////////////////////////////////////////
 Address::List Discovery::GetComponentsWithService(const std::string& serviceName) const
 {
     Address::List list;
-    Subsystem::Map subsystems;
-    this->GetSubsystems(subsystems);
-    Subsystem::Map::iterator s;
-    for(s = subsystems.begin();
-        s != subsystems.end();
-        s++)
-    {
-        Address::List components;
-        components = s->second->GetComponentsWithService(serviceName);
-        for(unsigned int i = 0; i < (unsigned int)components.size(); i++)
+    GetComponentsWithService(serviceName, list);
+    return list;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gets the components discovered with a given service.
+///
+///   Components are looked up in the service index of the current Snapshot
+///   and copied into the list given, so no memory is allocated once the list
+///   has grown large enough.  To avoid the copy, use
+///   GetSnapshot()->GetComponentsWithService instead (this does not apply the
+///   subsystems to discover filter).
+///
+///   \param[in] serviceName Name of the service to look up.
+///   \param[out] components Components with the service, sorted by ID (any
+///                          previous contents are replaced).
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Discovery::GetComponentsWithService(const std::string& serviceName,
+                                         Address::List& components) const
+{
+    Snapshot::Ptr system = GetSnapshot();
+    const Address::List& providers = system->GetComponentsWithService(serviceName);
+
+    ReadLock rLock(*( (SharedMutex*)&mSubsystemsToDiscoverMutex));
+    if(mSubsystemsToDiscover.size() == 0)
+    {
+        components.assign(providers.begin(), providers.end());
+        return;
+    }
+
+    components.clear();
+    Address::List::const_iterator id;
+    for(id = providers.begin(); id != providers.end(); id++)
+    {
+        if(mSubsystemsToDiscover.find(id->mSubsystem) != mSubsystemsToDiscover.end())
         {
-            list.push_back(components[i]);
+            components.push_back(*id);
         }
     }
-    Subsystem::DeleteSubsystemMap(subsystems);
-
-    return list;
 }
 
 
@@ -1210,9 +1682,9 @@ Address::List Discovery::GetComponentsWithService(const std::string& serviceName
 ////////////////////////////////////////////////////////////////////////////////////
 Subsystem::Ptr Discovery::GetSubsystem(const UShort id) const
 {
-    ReadLock rLock(*( (SharedMutex*)&mSubsystemDataMutex));
-    Subsystem::Map::const_iterator subsystem = mSystem.find(id);
-    if(subsystem != mSystem.end())
+    Snapshot::Ptr system = GetSnapshot();
+    Subsystem::Map::const_iterator subsystem = system->mSystem.find(id);
+    if(subsystem != system->mSystem.end())
     {
         return Subsystem::Ptr(subsystem->second->Clone());
     }
@@ -1220,6 +1692,45 @@ Subsystem::Ptr Discovery::GetSubsystem(const UShort id) const
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gets the last time data was received from a component or
+///          subsystem.
+///
+///   Discovery tracks liveness outside of the published Snapshot, so the
+///   mUpdateTime values in copies of subsystem data only record when a
+///   component or subsystem was added.  Use this method to check liveness.
+///
+///   \param[in] id Component ID, or subsystem ID with node and component
+///                 set to 0 for the subsystem.
+///
+///   \return UTC time in ms data was last received, 0 if not discovered.
+///
+////////////////////////////////////////////////////////////////////////////////////
+Time::Stamp Discovery::GetLastHeardTimeMs(const Address& id) const
+{
+    Snapshot::Ptr system = GetSnapshot();
+    Subsystem::Map::const_iterator subsystem = system->mSystem.find(id.mSubsystem);
+    if(subsystem == system->mSystem.end())
+    {
+        return 0;
+    }
+
+    ReadLock rLock(*( (SharedMutex*)&mSubsystemDataMutex));
+    if(id.mNode == 0 && id.mComponent == 0)
+    {
+        return GetHeardTimeMs(mSubsystemHeardMs, id.mSubsystem, subsystem->second->mUpdateTime);
+    }
+
+    const Subsystem::Component* component = subsystem->second->GetComponent(id);
+    if(component == NULL)
+    {
+        return 0;
+    }
+    return GetHeardTimeMs(mComponentHeardMs, id, component->mUpdateTime);
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Gets a copy of the know vehicle data for a subsystem, if it
@@ -1234,9 +1745,9 @@ Subsystem::Ptr Discovery::GetSubsystem(const UShort id) const
 ////////////////////////////////////////////////////////////////////////////////////
 Vehicle::Ptr Discovery::GetVehicle(const UShort id) const
 {
-    ReadLock rLock(*( (SharedMutex*)&mSubsystemDataMutex));
-    Subsystem::Map::const_iterator subsystem = mSystem.find(id);
-    if(subsystem != mSystem.end())
+    Snapshot::Ptr system = GetSnapshot();
+    Subsystem::Map::const_iterator subsystem = system->mSystem.find(id);
+    if(subsystem != system->mSystem.end())
     {
         Vehicle* vehicle = dynamic_cast<Vehicle *>(subsystem->second.get());
         if(vehicle)
@@ -1271,6 +1782,7 @@ bool Discovery::SetComponentState(const Address& id,
         if(subsystem->second->HaveComponent(id))
         {
             subsystem->second->GetComponent(id)->mStatus = componentState;
+            PublishSnapshot(id.mSubsystem);
             return true;
         }
     }
@@ -1306,6 +1818,7 @@ bool Discovery::SetVehiclePosition(const UShort id,
             vehicle->mUpdateTime = time;
             vehicle->mPresenceVector |= Vehicle::PresenceVector::Position;
             vehicle->mPresenceVector |= Vehicle::PresenceVector::TimeStamp;
+            PublishSnapshot(id);
             return true;
         }
     }
@@ -1341,6 +1854,7 @@ bool Discovery::SetVehicleAttitude(const UShort id,
             vehicle->mUpdateTime = time;
             vehicle->mPresenceVector |= Vehicle::PresenceVector::Attitude;
             vehicle->mPresenceVector |= Vehicle::PresenceVector::TimeStamp;
+            PublishSnapshot(id);
             return true;
         }
     }
@@ -1376,6 +1890,7 @@ bool Discovery::SetVehicleLinearVelocity(const UShort id,
             vehicle->mUpdateTime = time;
             vehicle->mPresenceVector |= Vehicle::PresenceVector::LinearVelocity;
             vehicle->mPresenceVector |= Vehicle::PresenceVector::TimeStamp;
+            PublishSnapshot(id);
             return true;
         }
     }
@@ -1407,6 +1922,7 @@ bool Discovery::SetCustomVehicleData(const UShort id,
         if(vehicle)
         {
             vehicle->SetAdditionalInfo(info);
+            PublishSnapshot(id);
             return true;
         }
     }
@@ -1446,6 +1962,7 @@ bool Discovery::SetVehiclePose(const UShort id,
             vehicle->mPresenceVector |= Vehicle::PresenceVector::Position;
             vehicle->mPresenceVector |= Vehicle::PresenceVector::Attitude;
             vehicle->mPresenceVector |= Vehicle::PresenceVector::TimeStamp;
+            PublishSnapshot(id);
             return true;
         }
     }
@@ -1462,11 +1979,12 @@ bool Discovery::SetVehiclePose(const UShort id,
 ////////////////////////////////////////////////////////////////////////////////////
 void Discovery::GetSubsystems(Subsystem::Map& subsystems) const
 {
-    ReadLock rLock(*( (SharedMutex*)&mSubsystemDataMutex));
+    Snapshot::Ptr system = GetSnapshot();
+    ReadLock rLock(*( (SharedMutex*)&mSubsystemsToDiscoverMutex));
 
     Subsystem::DeleteSubsystemMap(subsystems);
     
-    Subsystem::CopySubsystemMap(mSystem, subsystems);
+    Subsystem::CopySubsystemMap(system->mSystem, subsystems);
 
     // Remove ignored subsystems.
     Subsystem::Map::iterator si = subsystems.begin();
@@ -1485,6 +2003,23 @@ void Discovery::GetSubsystems(Subsystem::Map& subsystems) const
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gets the current system configuration.
+///
+///   The Snapshot is shared, not copied, and is never modified after it is
+///   published, so it can be used without locking.  Subsystems filtered
+///   by SetSubsystemsToDiscover are included.
+///
+///   \return Current system configuration.
+///
+////////////////////////////////////////////////////////////////////////////////////
+Discovery::Snapshot::Ptr Discovery::GetSnapshot() const
+{
+    return boost::atomic_load(&mSnapshot);
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Gets a copy of the subsystem data.
@@ -1494,12 +2029,13 @@ void Discovery::GetSubsystems(Subsystem::Map& subsystems) const
 ////////////////////////////////////////////////////////////////////////////////////
 void Discovery::GetVehicles(Vehicle::Map& vehicles) const
 {
-    ReadLock rLock(*( (SharedMutex*)&mSubsystemDataMutex));
+    Snapshot::Ptr system = GetSnapshot();
+    ReadLock rLock(*( (SharedMutex*)&mSubsystemsToDiscoverMutex));
 
     Vehicle::DeleteVehicleMap(vehicles);
     Subsystem::Map::const_iterator subsystem;
-    for(subsystem = mSystem.begin();
-        subsystem != mSystem.end();
+    for(subsystem = system->mSystem.begin();
+        subsystem != system->mSystem.end();
         subsystem++)
     {
         if(subsystem->second->mType == Subsystem::Vehicle)
@@ -1605,7 +2141,7 @@ void Discovery::PrintSystemConfiguration() const
                     service != component->mServices.end();
                     service++)
                 {
-                    std::cout << "        " << ++count << " - " << service->mName << std::endl;
+                    std::cout << "        " << ++count << " - " << service->GetName() << std::endl;
                 }
             }
         }
@@ -1623,9 +2159,9 @@ void Discovery::PrintSystemConfiguration() const
 ////////////////////////////////////////////////////////////////////////////////////
 void Discovery::PrintStatus() const
 {
-    ReadLock rLock(*( (SharedMutex*)&mSubsystemDataMutex));
+    Snapshot::Ptr system = GetSnapshot();
     std::cout << "Subsystem Identification: " << mSubsystemIdentification << std::endl;
-    std::cout << "There are " << mSystem.size() << " Subsystems on Network.\n";
+    std::cout << "There are " << system->mSystem.size() << " Subsystems on Network.\n";
 }
 
 
@@ -1652,7 +2188,7 @@ void Discovery::TriggerDiscoveryCallbacks()
 ////////////////////////////////////////////////////////////////////////////////////
 void Discovery::SetSubsystemsToDiscover(const std::set<UShort>& toDiscover)
 {
-    WriteLock wLock(mSubsystemDataMutex);
+    WriteLock wLock(mSubsystemsToDiscoverMutex);
     mSubsystemsToDiscover = toDiscover;
 }
 
@@ -1665,8 +2201,214 @@ void Discovery::SetSubsystemsToDiscover(const std::set<UShort>& toDiscover)
 ////////////////////////////////////////////////////////////////////////////////////
 std::set<UShort> Discovery::GetSubsystemsToDiscover() const
 {
-    ReadLock rLock(*( (SharedMutex*)&mSubsystemDataMutex));
+    ReadLock rLock(*( (SharedMutex*)&mSubsystemsToDiscoverMutex));
     return mSubsystemsToDiscover;
 }
 
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Saves the configuration generation reported by a peer, and
+///          checks if the peer must be queried for its configuration.
+///
+///   Must be called with mSubsystemDataMutex locked for writing.
+///
+///   \param[in] peer Component that reported its generation.
+///   \param[in] generation Configuration generation reported.
+///   \param[in] haveConfiguration True if configuration of the peer subsystem
+///                                is known.
+///
+///   \return True if the generation changed, configuration is not known, or
+///           the backoff time has ended, otherwise false.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool Discovery::CheckPeerGeneration(const Address& peer, 
+                                    const UInt generation,
+                                    const bool haveConfiguration)
+{
+    Time::Stamp timeMs = Time::GetUtcTimeMs();
+    Peer& info = mPeers[peer];
+    bool unchanged = info.mGeneration == generation && haveConfiguration && info.mComponents.size() > 0;
+
+    if(unchanged && timeMs < info.mNextQueryTimeMs)
+    {
+        return false;
+    }
+
+    if(unchanged)
+    {
+        // Stable peer, wait longer before checking again.
+        info.mBackoffMs *= 2;
+    }
+    else
+    {
+        info.mBackoffMs = mBroadcastDelayMs*2;
+    }
+    if(info.mBackoffMs > mMaxBackoffMs)
+    {
+        info.mBackoffMs = mMaxBackoffMs;
+    }
+    info.mGeneration = generation;
+    info.mNextQueryTimeMs = timeMs + info.mBackoffMs;
+
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Publishes a new Snapshot of the system configuration, with new
+///          copies of the subsystems given.  All other subsystems are shared
+///          with the previous Snapshot.
+///
+///   Must be called with mSubsystemDataMutex locked for writing.
+///
+///   \param[in] subsystems Subsystems that changed (or were removed).
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Discovery::PublishSnapshot(const std::set<UShort>& subsystems)
+{
+    Snapshot::Ptr previous = boost::atomic_load(&mSnapshot);
+    boost::shared_ptr<Snapshot> snapshot(new Snapshot());
+    snapshot->mVersion = previous->mVersion + 1;
+    snapshot->mSystem = previous->mSystem;
+
+    // Only pointers to the index entries are copied here, entries for the
+    // services of changed subsystems are copied when they are modified.
+    snapshot->mServices = previous->mServices;
+    WritableProviders writable;
+
+    std::set<UShort>::const_iterator id;
+    for(id = subsystems.begin(); id != subsystems.end(); id++)
+    {
+        // Only index entries for subsystems that changed are updated.
+        Subsystem::Map::const_iterator old = previous->mSystem.find(*id);
+        if(old != previous->mSystem.end())
+        {
+            RemoveFromServiceIndex(snapshot->mServices, writable, *old->second);
+        }
+        Subsystem::Map::const_iterator subsystem = mSystem.find(*id);
+        if(subsystem != mSystem.end())
+        {
+            snapshot->mSystem[*id].reset(subsystem->second->Clone());
+            AddToServiceIndex(snapshot->mServices, writable, *snapshot->mSystem[*id]);
+        }
+        else
+        {
+            snapshot->mSystem.erase(*id);
+        }
+    }
+
+    WritableProviders::const_iterator providers;
+    for(providers = writable.begin(); providers != writable.end(); providers++)
+    {
+        if(providers->second->mComponents.size() == 0)
+        {
+            snapshot->mServices.erase(providers->first);
+        }
+    }
+
+    boost::atomic_store(&mSnapshot, Snapshot::Ptr(snapshot));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Publishes a new Snapshot of the system configuration, with a new
+///          copy of the subsystem given.
+///
+///   Must be called with mSubsystemDataMutex locked for writing.
+///
+///   \param[in] subsystem Subsystem that changed (or was removed).
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Discovery::PublishSnapshot(const UShort subsystem)
+{
+    std::set<UShort> subsystems;
+    subsystems.insert(subsystem);
+    PublishSnapshot(subsystems);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Publishes a new Snapshot of the system configuration if the data
+///          shared about a subsystem is different from the current Snapshot.
+///
+///   Replies to discovery queries only show a subsystem is still connected,
+///   so they do not need a new copy of the subsystem.
+///
+///   Must be called with mSubsystemDataMutex locked for writing.
+///
+///   \param[in] subsystem Subsystem that may have changed.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Discovery::PublishIfChanged(const UShort subsystem)
+{
+    Snapshot::Ptr published = boost::atomic_load(&mSnapshot);
+    Subsystem::Map::iterator current = mSystem.find(subsystem);
+    Subsystem::Map::const_iterator previous = published->mSystem.find(subsystem);
+    if(HasSubsystemChanged(previous != published->mSystem.end() ? previous->second.get() : NULL,
+                           current != mSystem.end() ? current->second.get() : NULL))
+    {
+        if(current != mSystem.end())
+        {
+            current->second->mUpdateTime.SetCurrentTime();
+        }
+        PublishSnapshot(subsystem);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gets the components with a service, using the service index.
+///
+///   \param[in] serviceName Name of the service to look up.
+///
+///   \return Components with the service, sorted by ID.  The list belongs
+///           to the Snapshot, and is empty if no components have it.
+///
+////////////////////////////////////////////////////////////////////////////////////
+const Address::List& Discovery::Snapshot::GetComponentsWithService(const std::string& serviceName) const
+{
+    return GetComponentsWithService(Service::ID::Find(serviceName));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gets the components with a service, using the service index.
+///
+///   \param[in] service Interned Handle of the service name (see
+///                      Service::ID::GetHandle).
+///
+///   \return Components with the service, sorted by ID.  The list belongs
+///           to the Snapshot, and is empty if no components have it.
+///
+////////////////////////////////////////////////////////////////////////////////////
+const Address::List& Discovery::Snapshot::GetComponentsWithService(const Service::ID::Handle service) const
+{
+    static const Address::List empty;
+    ServiceIndex::const_iterator providers = mServices.find(service);
+    return providers != mServices.end() ? providers->second->mComponents : empty;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gets the components with a service, and the version of the
+///          service each one has.
+///
+///   \param[in] service Interned Handle of the service name.
+///
+///   \return Providers of the service (owned by the Snapshot), NULL if none.
+///
+////////////////////////////////////////////////////////////////////////////////////
+const Discovery::Snapshot::Providers* Discovery::Snapshot::GetProviders(const Service::ID::Handle service) const
+{
+    ServiceIndex::const_iterator providers = mServices.find(service);
+    return providers != mServices.end() ? providers->second.get() : NULL;
+}
+
 /*  End of File */
@@ -159,7 +159,7 @@ bool RegisterServices::IsLargeDataSet(const unsigned int maxPayloadSize) const
         s != mServices.end();
         s++)
     {
-        size += (unsigned int)(BYTE_SIZE + s->mName.size() + BYTE_SIZE*2);
+        size += (unsigned int)(BYTE_SIZE + s->GetName().size() + BYTE_SIZE*2);
     }
     return size > maxPayloadSize;
 }
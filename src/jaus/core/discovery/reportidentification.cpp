@@ -55,6 +55,7 @@ ReportIdentification::ReportIdentification(const Address& dest,
 {
     mQueryType = ComponentIdentification;
     mIdentificationType = Vehicle;
+    mGeneration = 0;
 }
 
 
@@ -67,6 +68,7 @@ ReportIdentification::ReportIdentification(const ReportIdentification& message)
 {
     mQueryType = ComponentIdentification;
     mIdentificationType = Vehicle;
+    mGeneration = 0;
     *this = message;
 }
 
@@ -108,6 +110,8 @@ bool ReportIdentification::SetIdentification(const std::string& identification)
 ///   \brief Writes message payload to the packet.
 ///
 ///   Message contents are written to the packet following the JAUS standard.
+///   If a configuration generation is set, it is written after the
+///   identification (JAUS++ extension used for incremental discovery).
 ///
 ///   \param[out] packet Packet to write payload to.
 ///
@@ -126,6 +130,11 @@ int ReportIdentification::WriteMessageBody(Packet& packet) const
         expected += (int)mIdentification.size();
         total += packet.Write(mIdentification);
     }
+    if(mGeneration != 0)
+    {
+        expected += UINT_SIZE;
+        total += packet.Write(mGeneration);
+    }
     return total == expected ? total : -1;
 }
 
@@ -154,6 +163,13 @@ int ReportIdentification::ReadMessageBody(const Packet& packet)
         expected += count;
         total += packet.Read(mIdentification, (unsigned int)count);
     }
+    // Optional generation sent by JAUS++ components.
+    mGeneration = 0;
+    if(packet.Length() >= packet.GetReadPos() + UINT_SIZE)
+    {
+        expected += UINT_SIZE;
+        total += packet.Read(mGeneration);
+    }
     return total == expected ? total : -1;
 }
 
@@ -168,6 +184,7 @@ void ReportIdentification::ClearMessageBody()
     mQueryType = ComponentIdentification;
     mIdentificationType = Vehicle;
     mIdentification.clear();
+    mGeneration = 0;
 }
 
 
@@ -184,6 +201,7 @@ ReportIdentification& ReportIdentification::operator =(const ReportIdentificatio
         mQueryType = message.mQueryType;
         mIdentificationType = message.mIdentificationType;
         mIdentification = message.mIdentification;
+        mGeneration = message.mGeneration;
     }
     return *this;
 }
@@ -240,7 +240,7 @@ bool ReportServices::IsLargeDataSet(const unsigned int maxPayloadSize) const
                 s != component->mServices.end();
                 s++)
             {
-                size += (unsigned int)(BYTE_SIZE + s->mName.size() + BYTE_SIZE*2);
+                size += (unsigned int)(BYTE_SIZE + s->GetName().size() + BYTE_SIZE*2);
             }
         }
     }
@@ -214,6 +214,12 @@ void Subsystem::RemoveComponent(const Address& component)
 ////////////////////////////////////////////////////////////////////////////////////
 bool Subsystem::HaveService(const std::string& name, Address* id) const
 {
+    // Names never interned are not used by any service.
+    if(Service::ID::Find(name) == Service::ID::NoHandle)
+    {
+        return false;
+    }
+    const Service::ID key(name);
     Configuration::const_iterator node;
     for(node = mConfiguration.begin();
         node != mConfiguration.end();
@@ -225,7 +231,7 @@ bool Subsystem::HaveService(const std::string& name, Address* id) const
             component++)
         {
             Service::ID::Set::const_iterator service;
-            service = component->mServices.find(Service::ID(name));
+            service = component->mServices.find(key);
             if(service != component->mServices.end())
             {
                 if(id)
@@ -378,6 +384,11 @@ const Subsystem::Component* Subsystem::GetComponent(const Address& id) const
 Address::List Subsystem::GetComponentsWithService(const std::string& name) const
 {
     Address::List results;
+    if(Service::ID::Find(name) == Service::ID::NoHandle)
+    {
+        return results;
+    }
+    const Service::ID key(name);
     Configuration::const_iterator node;
     for(node = mConfiguration.begin();
         node != mConfiguration.end();
@@ -389,7 +400,7 @@ Address::List Subsystem::GetComponentsWithService(const std::string& name) const
             component++)
         {
             Service::ID::Set::const_iterator service;
-            service = component->mServices.find(Service::ID(name));
+            service = component->mServices.find(key);
             if(service != component->mServices.end())
             {
                 results.push_back(component->mID);
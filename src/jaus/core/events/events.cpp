@@ -58,6 +58,98 @@ using namespace JAUS;
 
 const std::string Events::Name = "urn:jaus:jss:core:Events";
 
+namespace JAUS
+{
+    ////////////////////////////////////////////////////////////////////////////////////
+    ///
+    ///   \class CreateEventResponse
+    ///   \brief Handle for a Create Event request sent without blocking, adds
+    ///          the subscription when the confirmation is received.
+    ///
+    ////////////////////////////////////////////////////////////////////////////////////
+    class CreateEventResponse : public AsyncResponse
+    {
+    public:
+        CreateEventResponse(Events* events,
+                            const Address& provider,
+                            const Message* query,
+                            const Events::Type type,
+                            const double minimumPeriodicRate,
+                            const Byte requestID,
+                            AsyncResponse::Callback* callback) : AsyncResponse(callback),
+                                                                 mpEvents(events),
+                                                                 mProvider(provider),
+                                                                 mpQueryMessage(query->Clone()),
+                                                                 mType(type),
+                                                                 mMinimumPeriodicRate(minimumPeriodicRate),
+                                                                 mRequestID(requestID)
+        {
+        }
+        ~CreateEventResponse()
+        {
+            delete mpQueryMessage;
+        }
+    protected:
+        virtual bool OnResponse(const Message* response);
+        virtual void OnFinish(const bool success);
+    private:
+        Events* mpEvents;               ///<  Events service that sent the request.
+        Address mProvider;              ///<  Component that will provide the event.
+        Message* mpQueryMessage;        ///<  Query message of the event.
+        Events::Type mType;             ///<  Type of event requested.
+        double mMinimumPeriodicRate;    ///<  Minimum rate accepted for Periodic events.
+        Byte mRequestID;                ///<  Local request ID.
+    };
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Adds the subscription if the request was confirmed.
+///
+///   \param[in] response Confirm or Reject Event Request, NULL on timeout.
+///
+///   \return True if the subscription was created.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool CreateEventResponse::OnResponse(const Message* response)
+{
+    bool result = false;
+    const ConfirmEventRequest* confirm = dynamic_cast<const ConfirmEventRequest*>(response);
+    if(confirm)
+    {
+        if(mType == Events::Periodic && confirm->GetConfirmedPeriodicRate() < mMinimumPeriodicRate)
+        {
+            // Cancel requested event since it does not 
+            // meet minimum requirements.
+            CancelEvent cancel(confirm->GetSourceID(), mpEvents->GetComponentID());
+            cancel.SetEventID(confirm->GetEventID());
+            cancel.SetRequestID(mRequestID);
+            mpEvents->Send(&cancel);
+        }
+        else
+        {
+            mpEvents->AddSubscription(mProvider, mpQueryMessage, mType, *confirm);
+            result = true;
+        }
+    }
+    return result;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Releases the request ID once the request is done, whether it was
+///          confirmed, rejected, timed out, cancelled, or never sent.
+///
+///   \param[in] success True if the subscription was created.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void CreateEventResponse::OnFinish(const bool success)
+{
+    mpEvents->ReleaseRequestID(mRequestID);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Constructor.
@@ -72,6 +164,8 @@ Events::Subscription::Subscription()
     mUpdateTimeMs = 0;
     mpEventService = NULL;
     mTriggerTimeSeconds = 0;
+    mpSharedSubscriptions = NULL;
+    mScheduleID = 0;
 }
 
 
@@ -89,6 +183,8 @@ Events::Subscription::Subscription(const Events::Subscription& data)
     mUpdateTimeMs = 0;
     mpEventService = NULL;
     mTriggerTimeSeconds = 0;
+    mpSharedSubscriptions = NULL;
+    mScheduleID = 0;
     *this = data;
 }
 
@@ -134,6 +230,8 @@ Events::Subscription& Events::Subscription::operator =(const Events::Subscriptio
         }
         mpEventService = data.mpEventService;
         mTriggerTimeSeconds = data.mTriggerTimeSeconds;
+        mpSharedSubscriptions = data.mpSharedSubscriptions;
+        mScheduleID = data.mScheduleID;
     }
     return *this;
 }
@@ -238,6 +336,11 @@ const Events* Events::Child::EventsService() const
 ///          subscription information and transmit to all subscribers of the
 ///          event.
 ///
+///   If other subscriptions use the same report data (same report code and
+///   query message), the report is serialized once here and the Event
+///   message is re-sent to their subscribers with only the event ID and
+///   sequence number changed.
+///
 ///   \param[in] info Subscription information.
 ///   \param[in] payload Report message payload to include in Event message.
 ///
@@ -252,6 +355,20 @@ void Events::Child::SendEvent(const Events::Subscription& info,
     eventMessage.SetReportMessage(payload);
     // Send to all destinations.
     SendToList(info.mClients, &eventMessage);
+    
+    const Subscription::List* shared = Events::GetSharedSubscriptions(info);
+    if(shared)
+    {
+        Subscription::List::const_iterator other;
+        for(other = shared->begin();
+            other != shared->end();
+            other++)
+        {
+            eventMessage.SetSequenceNumber(other->mSequenceNumber);
+            eventMessage.SetEventID(other->mID);
+            SendToList(other->mClients, &eventMessage);
+        }
+    }
 }
 
 
@@ -263,7 +380,7 @@ void Events::Child::SendEvent(const Events::Subscription& info,
 Events::Events() : Service(Service::ID(Events::Name, 1.0), Service::ID(Transport::Name, 1.0))
 {
     mCheckEventsTimeMs = Time::GetUtcTimeMs();
-    mPeriodicTimer.RegisterTimerEvent(Events::PeriodicEvent, this);
+    mNextScheduleID = 0;
     mShutdownFlag = false;
 }
 
@@ -292,7 +409,15 @@ void Events::Shutdown()
         WriteLock printLock(mDebugMessagesMutex);
         std::cout << "[" << GetServiceID().ToString() << "-" << mComponentID.ToString() << "] - Stopping Events Timer\n";
     }
-    mPeriodicTimer.Stop();
+    {
+        boost::lock_guard<boost::mutex> lock(mScheduleMutex);
+        mScheduleCondition.notify_all();
+    }
+    mPeriodicThread.StopThread();
+    {
+        boost::lock_guard<boost::mutex> lock(mScheduleMutex);
+        mSchedule = std::priority_queue<Deadline>();
+    }
     if(mDebugMessagesFlag)
     {
         WriteLock printLock(mDebugMessagesMutex);
@@ -364,18 +489,7 @@ bool Events::RequestEveryChangeEvent(const Address& provider,
     
     // Generate a local request ID, then add to
     // list of pending responses.
-    Byte requestID = 0;
-    std::set<Byte>::iterator riter;
-    {
-        WriteLock wLock(mRequestMutex);
-        riter = mRequestSet.find(requestID);
-        while(riter != mRequestSet.end() )
-        {
-            requestID++;
-            riter = mRequestSet.find(requestID);
-        }
-        mRequestSet.insert(requestID);
-    }
+    Byte requestID = ReserveRequestID();
     request.SetRequestID(requestID);
     
     // Setup list of possible responses to command.
@@ -389,40 +503,7 @@ bool Events::RequestEveryChangeEvent(const Address& provider,
     {
         if(confirm.GetSourceID().IsValid()) // Confirmation.
         {
-            Subscription sub;             
-            Subscription::List::iterator siter;
-
-            sub.mID = confirm.GetEventID();
-            sub.mSequenceNumber = 0;
-            sub.mpQueryMessage = query->Clone();
-            sub.mType = EveryChange;
-            sub.mPeriodicRate = confirm.GetConfirmedPeriodicRate();
-            sub.mUpdateTimeMs = Time::GetUtcTimeMs();
-            sub.mProducer = provider;
-            sub.mClients.insert(GetComponentID());
-
-            WriteLock wLock(mEventsMutex);
-
-            // Don't add duplicate events.
-            bool exists = false;
-            for(siter = mSubscriptions.begin();
-                siter != mSubscriptions.end();
-                siter++)
-            {
-                if(siter->mID == sub.mID &&
-                   siter->mProducer == provider &&
-                   siter->mpQueryMessage->GetMessageCode() == query->GetMessageCode())
-                {
-                    *siter = sub;
-                    exists = true;
-                    break;
-                }
-            }
-            if(!exists)
-            {
-                mSubscriptions.push_back(sub);
-            }
-
+            AddSubscription(provider, query, EveryChange, confirm);
             result = true;
         }
         else if(mDebugMessagesFlag)
@@ -431,15 +512,8 @@ bool Events::RequestEveryChangeEvent(const Address& provider,
             std::cout << "[" << GetServiceID().ToString() << "-" << mComponentID.ToString() << "] - Could not create subscription to " << provider.ToString() << " for Query: " << query->GetMessageName() << "\n";
         }
     }
-    {
-        // Remove local request ID from queue.
-        WriteLock wLock(mRequestMutex);
-        riter = mRequestSet.find(requestID);
-        if(riter != mRequestSet.end() )
-        {
-            mRequestSet.erase(riter);
-        }
-    }
+    // Remove local request ID from queue.
+    ReleaseRequestID(requestID);
     return result;
 }
 
@@ -479,18 +553,7 @@ bool Events::RequestPeriodicEvent(const Address &provider,
     
     // Generate a local request ID, then add to
     // list of pending responses.
-    Byte requestID = 0;
-    std::set<Byte>::iterator riter;
-    {
-        WriteLock wLock(mRequestMutex);
-        riter = mRequestSet.find(requestID);
-        while(riter != mRequestSet.end() )
-        {
-            requestID++;
-            riter = mRequestSet.find(requestID);
-        }
-        mRequestSet.insert(requestID);
-    }
+    Byte requestID = ReserveRequestID();
     
     request.SetRequestID(requestID);
     
@@ -518,40 +581,7 @@ bool Events::RequestPeriodicEvent(const Address &provider,
             }
             else
             {
-                Subscription sub;
-                Subscription::List::iterator siter;
-
-                sub.mID = confirm.GetEventID();
-                sub.mSequenceNumber = 0;
-                sub.mpQueryMessage = query->Clone();
-                sub.mType = Periodic;
-                sub.mPeriodicRate = confirm.GetConfirmedPeriodicRate();
-                sub.mUpdateTimeMs = Time::GetUtcTimeMs();
-                sub.mProducer = provider;
-                sub.mClients.insert(GetComponentID());
-
-                WriteLock wLock(mEventsMutex);
-
-                // Don't add duplicate events.
-                bool exists = false;
-                for(siter = mSubscriptions.begin();
-                    siter != mSubscriptions.end();
-                    siter++)
-                {
-                    if(siter->mProducer == provider &&
-                       siter->mpQueryMessage->GetMessageCode() == query->GetMessageCode() &&
-                       siter->mpQueryMessage->GetPresenceVector() == query->GetPresenceVector())
-                    {
-                        *siter = sub;
-                        exists = true;
-                        break;
-                    }
-                }
-                if(!exists)
-                {
-                    mSubscriptions.push_back(sub);
-                }
-
+                AddSubscription(provider, query, Periodic, confirm);
                 result = true;
             }
         }
@@ -562,20 +592,77 @@ bool Events::RequestPeriodicEvent(const Address &provider,
         }
     }
     
-    {
-        // Remove local request ID from queue.
-        WriteLock wLock(mRequestMutex);
-        riter = mRequestSet.find(requestID);
-        if(riter != mRequestSet.end() )
-        {
-            mRequestSet.erase(riter);
-        }
-    }
+    // Remove local request ID from queue.
+    ReleaseRequestID(requestID);
 
     return result;
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Requests an Every Change event subscription from the component
+///          specified, without blocking.
+///
+///   The subscription is added when the confirmation is received, the same
+///   as RequestEveryChangeEvent.  Use this to subscribe to many components
+///   at once from a single thread.
+///
+///   \param[in] provider The component that will provide the event.
+///   \param[in] query The type of data to query (used to determine type of
+///                    report information desired).
+///   \param[in] callback Optional callback made when the request is done.
+///   \param[in] waitTimeMs How long to wait for a response from the component
+///                         sending confirmation/rejection.
+///
+///   \return Handle to the request, IsSuccessful is true once the
+///           subscription is created.
+///
+////////////////////////////////////////////////////////////////////////////////////
+AsyncResponse::Ptr Events::RequestEveryChangeEventAsync(const Address& provider,
+                                                        const Message* query,
+                                                        AsyncResponse::Callback* callback,
+                                                        const unsigned int waitTimeMs)
+{
+    return RequestEventAsync(provider, query, EveryChange, 0.0, 0.0, callback, waitTimeMs);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Requests a Periodic event subscription from the component
+///          specified, without blocking.
+///
+///   The subscription is added when the confirmation is received, the same
+///   as RequestPeriodicEvent.  If the confirmed rate is less than the minimum,
+///   the event is cancelled (without waiting) and the request fails.
+///
+///   \param[in] provider The component that will provide the event.
+///   \param[in] query The type of data to query (used to determine type of
+///                    report information desired).
+///   \param[in] desiredPeriodicRate The desired periodic update rate for the
+///                                  event.
+///   \param[in] minimumPeriodicRate The minimum periodic rate that you will
+///                                  accept.
+///   \param[in] callback Optional callback made when the request is done.
+///   \param[in] waitTimeMs How long to wait for a response from the component
+///                         sending confirmation/rejection.
+///
+///   \return Handle to the request, IsSuccessful is true once the
+///           subscription is created.
+///
+////////////////////////////////////////////////////////////////////////////////////
+AsyncResponse::Ptr Events::RequestPeriodicEventAsync(const Address& provider,
+                                                     const Message* query,
+                                                     const double desiredPeriodicRate,
+                                                     const double minimumPeriodicRate,
+                                                     AsyncResponse::Callback* callback,
+                                                     const unsigned int waitTimeMs)
+{
+    return RequestEventAsync(provider, query, Periodic, desiredPeriodicRate, minimumPeriodicRate, callback, waitTimeMs);
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Signals to the Event Service that the type of data has changed
@@ -599,6 +686,8 @@ void Events::SignalEvent(const UShort reportMessageCode,
     }
 
     Subscription::Map::iterator sub;
+    Subscription::List matches;
+    std::vector<UInt> keys;
     for(sub = toGenerate.begin();
         sub != toGenerate.end();
         sub++)
@@ -607,17 +696,29 @@ void Events::SignalEvent(const UShort reportMessageCode,
             (sub->second.mType == EveryChange || changeOnly == false) &&
             sub->second.mpEventService != NULL)
         {
-            ((Child *)(sub->second.mpEventService))->GenerateEvent(sub->second);
-            // Update the status of the event generated.
+            matches.push_back(sub->second);
+            keys.push_back(sub->first);
+        }
+    }
+    if(matches.size() == 0)
+    {
+        return;
+    }
+
+    GenerateEvents(matches);
+
+    // Update the status of the events generated.
+    {
+        WriteLock wLock(mEventsMutex);
+        std::vector<UInt>::iterator key;
+        for(key = keys.begin(); key != keys.end(); key++)
+        {
+            Subscription::Map::iterator e = mEvents.find(*key);
+            if(e != mEvents.end())
             {
-                WriteLock wLock(mEventsMutex);
-                Subscription::Map::iterator e = mEvents.find(sub->first);
-                if(e != mEvents.end())
-                {
-                    e->second.mSequenceNumber++;
-                    e->second.mTriggerTimeSeconds = CxUtils::Timer::GetTimeSeconds();
-                    e->second.mUpdateTimeMs = Time::GetUtcTimeMs();
-                }
+                e->second.mSequenceNumber++;
+                e->second.mTriggerTimeSeconds = CxUtils::Timer::GetTimeSeconds();
+                e->second.mUpdateTimeMs = Time::GetUtcTimeMs();
             }
         }
     }
@@ -968,7 +1069,6 @@ void Events::Receive(const Message* message)
     case CANCEL_EVENT:
         {
             const CancelEvent* input = dynamic_cast<const CancelEvent*>(message);
-            double maxFrequencyHz = 0.5;
             bool canceled = false;
             {
                 WriteLock wLock(mEventsMutex);
@@ -997,19 +1097,8 @@ void Events::Receive(const Message* message)
                         }
                     }
                 }
-              
-                // Look up how what the highest update frequency is
-                // for events, so if needed, we can slow down the
-                // periodic timer.
-                for(sub = mEvents.begin();
-                    sub != mEvents.end() && true == canceled;
-                    sub++)
-                {
-                    if(sub->second.mPeriodicRate > maxFrequencyHz)
-                    {
-                        maxFrequencyHz = sub->second.mPeriodicRate;
-                    }
-                }                
+                // Deadlines of erased events are discarded by the
+                // periodic thread when they come due.
             }
 
             // Send confirmation or rejection of cancelation
@@ -1024,13 +1113,6 @@ void Events::Receive(const Message* message)
                 response.SetRequestID(input->GetRequestID());
                 response.SetEventID(input->GetEventID());
                 Send(&response);   
-                
-                // See if we need to change the periodic timer update frequency.  Throttle 
-                // down as needed.
-                if(mPeriodicTimer.IsActive() && mPeriodicTimer.GetFrequency() > maxFrequencyHz)
-                {
-                    mPeriodicTimer.ChangeFrequency(maxFrequencyHz);
-                }   
             }
             else
             {
@@ -1116,6 +1198,8 @@ void Events::Receive(const Message* message)
                                         if(confirmedPeriodicRate > siter->second.mPeriodicRate)
                                         {
                                             siter->second.mPeriodicRate = confirmedPeriodicRate;
+                                            // Re-schedule at the faster rate.
+                                            SchedulePeriodicEvent(siter->first, siter->second);
                                         }
                                     }
                                     // Make sure this source is in our list, just in case.
@@ -1165,6 +1249,10 @@ void Events::Receive(const Message* message)
 
                             WriteLock wLock(mEventsMutex);
                             mEvents[key] = subscription;
+                            if(subscription.mType == Events::Periodic)
+                            {
+                                SchedulePeriodicEvent(key, mEvents[key]);
+                            }
                         }
                         
                         ConfirmEventRequest confirm(message->GetSourceID(), GetComponentID());
@@ -1175,19 +1263,13 @@ void Events::Receive(const Message* message)
                         {
                             signalEventCode = subscription.mpQueryMessage->GetMessageCodeOfResponse();
                         }
-                        // Start periodic timer to either generate periodic
-                        // events, or to verify events are still valid (or re-create subscriptions).
-                        if(subscription.mType == Events::Periodic && mPeriodicTimer.IsActive() == false)
+                        // Start periodic thread to generate periodic events.
+                        if(subscription.mType == Events::Periodic && mPeriodicThread.IsThreadActive() == false)
                         {
                             std::stringstream tname;
                             tname << GetComponentID().ToString() << ":Events";
-                            mPeriodicTimer.SetName(tname.str());
-                            mPeriodicTimer.Start(subscription.mPeriodicRate);
-                        }
-                        else if(mPeriodicTimer.IsActive() && 
-                                subscription.mPeriodicRate > mPeriodicTimer.GetFrequency())
-                        {
-                            mPeriodicTimer.ChangeFrequency(subscription.mPeriodicRate);
+                            mPeriodicThread.CreateThread(Events::PeriodicEventThread, this);
+                            mPeriodicThread.SetThreadName(tname.str());
                         }
                     }
                     
@@ -1713,59 +1795,433 @@ bool Events::CancelSubscription(Subscription& sub, const unsigned int waitTimeMs
 
 ////////////////////////////////////////////////////////////////////////////////////
 ///
-///   \brief Method called whenever a Periodic event needs is generated from
-///          the Timer..
+///   \brief Generates Event messages for a set of subscriptions.
+///
+///   Subscriptions that use the same report code and query message (e.g.
+///   multiple clients asking for the same presence vector at different rates)
+///   are grouped, so GenerateEvent is called once per group and the report
+///   is only built and serialized once.
+///
+///   \param[in] subscriptions Subscriptions to generate events for.
 ///
 ////////////////////////////////////////////////////////////////////////////////////
-void Events::PeriodicEvent(void *args)
+void Events::GenerateEvents(const Subscription::List& subscriptions) const
 {
-    Events* service = (Events *)args;
-    Events::Subscription::Map::iterator local;
-    
-    if(service->mShutdownFlag)
+    std::vector<Packet> queries(subscriptions.size());
+    std::vector<bool> generated(subscriptions.size(), false);
+
+    for(unsigned int i = 0; i < (unsigned int)subscriptions.size(); i++)
+    {
+        if(subscriptions[i].mpQueryMessage)
+        {
+            subscriptions[i].mpQueryMessage->WriteMessageBody(queries[i]);
+        }
+    }
+
+    for(unsigned int i = 0; i < (unsigned int)subscriptions.size() && mShutdownFlag == false; i++)
+    {
+        Child* child = dynamic_cast<Child*>(subscriptions[i].mpEventService);
+        if(generated[i] || child == NULL)
+        {
+            continue;
+        }
+        Subscription::List shared;
+        for(unsigned int j = i + 1; j < (unsigned int)subscriptions.size(); j++)
+        {
+            if(generated[j] == false &&
+               IsSameReport(subscriptions[i], queries[i], subscriptions[j], queries[j]))
+            {
+                shared.push_back(subscriptions[j]);
+                generated[j] = true;
+            }
+        }
+        generated[i] = true;
+        if(shared.size() > 0)
+        {
+            Subscription leader(subscriptions[i]);
+            leader.mpSharedSubscriptions = &shared;
+            child->GenerateEvent(leader);
+        }
+        else
+        {
+            child->GenerateEvent(subscriptions[i]);
+        }
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Checks if two subscriptions will produce identical report data.
+///
+///   \param[in] first First subscription.
+///   \param[in] firstQuery Serialized query message body of first subscription.
+///   \param[in] second Second subscription.
+///   \param[in] secondQuery Serialized query message body of second subscription.
+///
+///   \return True if the same report can be sent to both, false otherwise.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool Events::IsSameReport(const Subscription& first,
+                          const Packet& firstQuery,
+                          const Subscription& second,
+                          const Packet& secondQuery)
+{
+    if(first.mpEventService != second.mpEventService ||
+       first.mpQueryMessage == NULL ||
+       second.mpQueryMessage == NULL)
+    {
+        return false;
+    }
+    if(first.mpQueryMessage->GetMessageCode() != second.mpQueryMessage->GetMessageCode() ||
+       first.mpQueryMessage->GetPresenceVector() != second.mpQueryMessage->GetPresenceVector() ||
+       firstQuery.Length() != secondQuery.Length())
+    {
+        return false;
+    }
+    return firstQuery.Length() == 0 ||
+           memcmp(firstQuery.Ptr(), secondQuery.Ptr(), firstQuery.Length()) == 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gets timing statistics for Periodic events.
+///
+///   \param[in] reset If true, statistics are cleared after they are read.
+///
+///   \return Copy of the timing statistics.
+///
+////////////////////////////////////////////////////////////////////////////////////
+Events::TimingStatistics Events::GetTimingStatistics(const bool reset)
+{
+    boost::lock_guard<boost::mutex> lock(mScheduleMutex);
+    TimingStatistics copy = mTimingStatistics;
+    if(reset)
+    {
+        mTimingStatistics.Clear();
+    }
+    return copy;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Adds a deadline for a Periodic event to the schedule.
+///
+///   Any deadline already scheduled for the event becomes stale and is
+///   discarded when it comes due.  Must be called with the events mutex
+///   locked for writing.
+///
+///   \param[in] key Key of the event in the events map.
+///   \param[in] subscription The Periodic event to schedule.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Events::SchedulePeriodicEvent(const UInt key, Subscription& subscription)
+{
+    boost::lock_guard<boost::mutex> lock(mScheduleMutex);
+    Deadline deadline;
+    deadline.mKey = key;
+    deadline.mScheduleID = ++mNextScheduleID;
+    deadline.mTimeSeconds = CxUtils::Timer::GetTimeSeconds() + 1.0/(subscription.mPeriodicRate + CxUtils::CX_EPSILON);
+    subscription.mScheduleID = deadline.mScheduleID;
+    mSchedule.push(deadline);
+    mScheduleCondition.notify_all();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Generates the Periodic events whose deadlines have passed, then
+///          schedules their next deadlines.
+///
+///   Next deadlines are computed from the previous deadline (not the time
+///   the event was generated) so that slow rates do not drift.  If the
+///   event is late by more than a period, the missed deadlines are skipped.
+///
+///   \param[in] due Deadlines that have passed.
+///   \param[in] fireTimeSeconds Time the deadlines were taken from the schedule.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Events::GeneratePeriodicEvents(const std::vector<Deadline>& due, 
+                                    const double fireTimeSeconds)
+{
+    Subscription::List toGenerate;
+    std::vector<Deadline> deadlines;
+
+    // Copy only the events that are due (discarding stale deadlines), so that
+    // we do not call other services code within our events mutex.
+    {
+        ReadLock rLock(mEventsMutex);
+        std::vector<Deadline>::const_iterator d;
+        for(d = due.begin(); d != due.end(); d++)
+        {
+            Subscription::Map::const_iterator e = mEvents.find(d->mKey);
+            if(e != mEvents.end() &&
+               e->second.mType == Events::Periodic &&
+               e->second.mScheduleID == d->mScheduleID)
+            {
+                toGenerate.push_back(e->second);
+                deadlines.push_back(*d);
+            }
+        }
+    }
+    if(toGenerate.size() == 0)
     {
         return;
     }
-    
-    Subscription::Map eventsCopy;
-    // Make a copy of events so that we do not call other services
-    // code within our events mutex.  This will avoid deadlock 
-    // situations
+
+    GenerateEvents(toGenerate);
+
+    double doneTimeSeconds = CxUtils::Timer::GetTimeSeconds();
+    // Update states in actual map of data within the mutex.
     {
-        ReadLock rLock(service->mEventsMutex);
-        eventsCopy = service->mEvents;
+        WriteLock wLock(mEventsMutex);
+        for(unsigned int i = 0; i < (unsigned int)deadlines.size(); i++)
+        {
+            Subscription::Map::iterator actual = mEvents.find(deadlines[i].mKey);
+            if(actual != mEvents.end() &&
+               actual->second.mSequenceNumber == toGenerate[i].mSequenceNumber &&
+               actual->second.mType == toGenerate[i].mType)
+            {
+                actual->second.mUpdateTimeMs = Time::GetUtcTimeMs();
+                actual->second.mTriggerTimeSeconds = doneTimeSeconds;
+                actual->second.mSequenceNumber++;
+            }
+        }
     }
-    for(local = eventsCopy.begin();
-        local != eventsCopy.end() && service->mShutdownFlag == false && service->mPeriodicTimer.IsShuttingDown() == false;
-        local++)
+
+    // Schedule next deadlines and update statistics.
     {
-        Events::Child* child = dynamic_cast<Events::Child*>(local->second.mpEventService);
-        if(local->second.mType == Events::Periodic && child)
+        boost::lock_guard<boost::mutex> lock(mScheduleMutex);
+        for(unsigned int i = 0; i < (unsigned int)deadlines.size(); i++)
         {
-            double delay = 1.0/(local->second.mPeriodicRate + CxUtils::CX_EPSILON);
-            if(CxUtils::Timer::GetTimeSeconds() - local->second.mTriggerTimeSeconds >= delay)
+            double period = 1.0/(toGenerate[i].mPeriodicRate + CxUtils::CX_EPSILON);
+            double jitterMs = (fireTimeSeconds - deadlines[i].mTimeSeconds)*1000.0;
+            unsigned int missed = 0;
+            if(doneTimeSeconds > deadlines[i].mTimeSeconds + period)
             {
-                // Trigger periodic event. 
-                child->GenerateEvent(local->second);
-                // Update states in actual map of data within the mutex.
+                missed = (unsigned int)((doneTimeSeconds - deadlines[i].mTimeSeconds)/period);
+            }
+            
+            mTimingStatistics.mEventsGenerated++;
+            mTimingStatistics.mMissedDeadlines += missed;
+            mTimingStatistics.mMeanJitterMs += (jitterMs - mTimingStatistics.mMeanJitterMs)/mTimingStatistics.mEventsGenerated;
+            if(jitterMs > mTimingStatistics.mMaxJitterMs)
+            {
+                mTimingStatistics.mMaxJitterMs = jitterMs;
+            }
+
+            Deadline next = deadlines[i];
+            next.mTimeSeconds += period*(missed + 1);
+            mSchedule.push(next);
+        }
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Thread which sleeps until the earliest Periodic event deadline
+///          and then generates all events that are due.
+///
+///   \param[in] args Pointer to Events service.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Events::PeriodicEventThread(void *args)
+{
+    Events* service = (Events *)args;
+    std::vector<Deadline> due;
+
+    while(service->mShutdownFlag == false && 
+          service->mPeriodicThread.QuitThreadFlag() == false)
+    {
+        double fireTimeSeconds = 0;
+        due.clear();
+        {
+            boost::unique_lock<boost::mutex> lock(service->mScheduleMutex);
+            if(service->mSchedule.empty())
+            {
+                service->mScheduleCondition.timed_wait(lock, boost::posix_time::milliseconds(100));
+                continue;
+            }
+            fireTimeSeconds = CxUtils::Timer::GetTimeSeconds();
+            double waitSeconds = service->mSchedule.top().mTimeSeconds - fireTimeSeconds;
+            if(waitSeconds > 0)
+            {
+                // Wait for the next deadline, or for a new one to be added.
+                if(waitSeconds > 0.1)
                 {
-                    WriteLock wLock(service->mEventsMutex);
-                    Events::Subscription::Map::iterator actual = service->mEvents.find(local->first);
-                    if(actual != service->mEvents.end() &&
-                       actual->second.mSequenceNumber == local->second.mSequenceNumber &&
-                       actual->second.mType == local->second.mType)
-                    {
-                        actual->second.mUpdateTimeMs = Time::GetUtcTimeMs();
-                        actual->second.mTriggerTimeSeconds = CxUtils::Timer::GetTimeSeconds();
-                        actual->second.mSequenceNumber++;
-                    }
+                    waitSeconds = 0.1;
                 }
+                service->mScheduleCondition.timed_wait(lock, boost::posix_time::microseconds((long)(waitSeconds*1000000.0)));
+                continue;
+            }
+            while(service->mSchedule.empty() == false &&
+                  service->mSchedule.top().mTimeSeconds <= fireTimeSeconds)
+            {
+                due.push_back(service->mSchedule.top());
+                service->mSchedule.pop();
             }
         }
+        service->GeneratePeriodicEvents(due, fireTimeSeconds);
+    }
+}
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gets a local request ID not used by another Create Event request
+///          waiting for a response.
+///
+///   \return Request ID, release with ReleaseRequestID.
+///
+////////////////////////////////////////////////////////////////////////////////////
+Byte Events::ReserveRequestID()
+{
+    Byte requestID = 0;
+    std::set<Byte>::iterator riter;
+    WriteLock wLock(mRequestMutex);
+    riter = mRequestSet.find(requestID);
+    while(riter != mRequestSet.end() )
+    {
+        requestID++;
+        riter = mRequestSet.find(requestID);
+    }
+    mRequestSet.insert(requestID);
+    return requestID;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Removes a local request ID once the request is done.
+///
+///   \param[in] requestID Request ID from ReserveRequestID.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Events::ReleaseRequestID(const Byte requestID)
+{
+    WriteLock wLock(mRequestMutex);
+    std::set<Byte>::iterator riter = mRequestSet.find(requestID);
+    if(riter != mRequestSet.end() )
+    {
+        mRequestSet.erase(riter);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Adds (or replaces) a subscription confirmed by a provider.
+///
+///   \param[in] provider The component providing the event.
+///   \param[in] query Query message of the event (copied).
+///   \param[in] type Type of event.
+///   \param[in] confirm Confirmation received.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Events::AddSubscription(const Address& provider,
+                             const Message* query,
+                             const Events::Type type,
+                             const ConfirmEventRequest& confirm)
+{
+    Subscription sub;             
+    Subscription::List::iterator siter;
+
+    sub.mID = confirm.GetEventID();
+    sub.mSequenceNumber = 0;
+    sub.mpQueryMessage = query->Clone();
+    sub.mType = type;
+    sub.mPeriodicRate = confirm.GetConfirmedPeriodicRate();
+    sub.mUpdateTimeMs = Time::GetUtcTimeMs();
+    sub.mProducer = provider;
+    sub.mClients.insert(GetComponentID());
+
+    WriteLock wLock(mEventsMutex);
+
+    // Don't add duplicate events.
+    bool exists = false;
+    for(siter = mSubscriptions.begin();
+        siter != mSubscriptions.end();
+        siter++)
+    {
+        bool same = false;
+        if(type == EveryChange)
+        {
+            same = siter->mID == sub.mID &&
+                   siter->mProducer == provider &&
+                   siter->mpQueryMessage->GetMessageCode() == query->GetMessageCode();
+        }
+        else
+        {
+            same = siter->mProducer == provider &&
+                   siter->mpQueryMessage->GetMessageCode() == query->GetMessageCode() &&
+                   siter->mpQueryMessage->GetPresenceVector() == query->GetPresenceVector();
+        }
+        if(same)
+        {
+            *siter = sub;
+            exists = true;
+            break;
+        }
+    }
+    if(!exists)
+    {
+        mSubscriptions.push_back(sub);
     }
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Sends a Create Event request without blocking.
+///
+///   \param[in] provider The component that will provide the event.
+///   \param[in] query The type of data to query.
+///   \param[in] type Type of event.
+///   \param[in] desiredPeriodicRate Desired rate (Periodic only).
+///   \param[in] minimumPeriodicRate Minimum rate accepted (Periodic only).
+///   \param[in] callback Optional callback made when the request is done.
+///   \param[in] waitTimeMs How long to wait for a response.
+///
+///   \return Handle to the request.
+///
+////////////////////////////////////////////////////////////////////////////////////
+AsyncResponse::Ptr Events::RequestEventAsync(const Address& provider,
+                                             const Message* query,
+                                             const Events::Type type,
+                                             const double desiredPeriodicRate,
+                                             const double minimumPeriodicRate,
+                                             AsyncResponse::Callback* callback,
+                                             const unsigned int waitTimeMs)
+{
+    if(query == NULL)
+    {
+        AsyncResponse::Ptr failed(new AsyncResponse());
+        AsyncResponse::Send(NULL, failed, NULL);
+        return failed;
+    }
+
+    CreateEvent request(provider, GetComponentID());
+    request.SetType(type);
+    if(type == Periodic)
+    {
+        request.SetRequestedPeriodicRate(desiredPeriodicRate);
+    }
+    request.SetQueryMessage(query);
+    Byte requestID = ReserveRequestID();
+    request.SetRequestID(requestID);
 
+    AsyncResponse::Ptr handle(new CreateEventResponse(this, provider, query, type, minimumPeriodicRate, requestID, callback));
+    std::set<UShort> responseCodes;
+    responseCodes.insert(CONFIRM_EVENT_REQUEST);
+    responseCodes.insert(REJECT_EVENT_REQUEST);
+    // The request ID is released by the handle when done (even if not sent).
+    AsyncResponse::Send(GetTransportService(), handle, &request, responseCodes, waitTimeMs);
+    return handle;
+}
 
 /*  End of File */
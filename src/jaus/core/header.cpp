@@ -118,6 +118,33 @@ int Header::Write(Packet& packet) const
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Overwrites only the destination ID and sequence number of a
+///          header that has already been written to a packet.
+///
+///   Used when the same serialized message goes to many destinations, so
+///   the rest of the header and the payload are not written again.
+///
+///   \param[out] packet The packet containing a header written by Write.
+///   \param[in] startPos Position of the start of the header in the packet.
+///
+///   \return Number of bytes written to packet, 0 on failure.
+///
+////////////////////////////////////////////////////////////////////////////////////
+int Header::WriteRouting(Packet& packet, const unsigned int startPos) const
+{
+    if(mSize < MinSize || packet.Length() < startPos + mSize)
+    {
+        return 0;
+    }
+    int result = 0;
+    result += packet.Write(mDestinationID.ToUInt(), startPos + DestinationOffset);
+    result += packet.Write(mSequenceNumber, startPos + mSize - USHORT_SIZE);
+    return result;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Reads header data from the current read position in the packet.
@@ -182,7 +209,9 @@ bool Header::IsValid(std::string* errorMessage) const
         return false;
     }
 
-    if(mMessageType > MessageType::Normal)
+    // Only multi-packet streams may have a compressed payload.
+    if(mMessageType > MessageType::Compressed ||
+       (mMessageType == MessageType::Compressed && mControlFlag == DataControl::Single))
     {
         if(errorMessage)
         {
@@ -200,7 +229,8 @@ bool Header::IsValid(std::string* errorMessage) const
         return false;
     }
 
-    if(mSize > MinSize && (mAckNackFlag == AckNack::Nack || mAckNackFlag == AckNack::Ack))
+    // A NACK may list packets of a large data set to retransmit.
+    if(mSize > MinSize && mAckNackFlag == AckNack::Ack)
     {
         if(errorMessage)
         {
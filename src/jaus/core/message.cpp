@@ -367,6 +367,9 @@ int Message::Write(Packet& packet,
 ///                             sent using any broadcast options (e.g. 
 ///                             multicast). 0 = no options, 1 = local broadcast,
 ///                             2 = global broadcast.
+///   \param[in] compressionThreshold If non-zero, payloads of at least this
+///                                   many bytes are compressed using zlib
+///                                   (receiver must support JAUS++ compression).
 ///
 ///   \return FAILURE on error, otherwise number of packets written.
 ///
@@ -376,7 +379,8 @@ int Message::WriteLargeDataSet(Packet::List& stream,
                                const UShort maxPayloadSize,
                                const Packet* transportHeader,
                                const UShort startingSequenceNumber,
-                               const Byte broadcastFlags) const
+                               const Byte broadcastFlags,
+                               const unsigned int compressionThreshold) const
 {
     Header header;
     header.mDestinationID = mDestinationID;
@@ -384,8 +388,6 @@ int Message::WriteLargeDataSet(Packet::List& stream,
     header.mPriorityFlag = mPriority;
     header.mBroadcastFlag = broadcastFlags;
 
-    stream.clear();
-    streamHeaders.clear();
     Packet* temp = ((Packet *)(&mStreamPayload));
     temp->Clear();
     if(IsLargeDataSet() && WriteMessageBody(*temp) >= 0)
@@ -397,9 +399,12 @@ int Message::WriteLargeDataSet(Packet::List& stream,
                                          streamHeaders, 
                                          transportHeader, 
                                          maxPayloadSize,
-                                         startingSequenceNumber);
+                                         startingSequenceNumber,
+                                         compressionThreshold);
         return (int)stream.size();
     }
+    stream.clear();
+    streamHeaders.clear();
     return FAILURE;
 }
 
@@ -43,6 +43,7 @@
 #include "jaus/core/component.h"
 #include "jaus/core/sensor.h"
 #include <cstdio>
+#include <boost/unordered_map.hpp>
 #include <boost/thread.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/date_time.hpp>
@@ -50,6 +51,92 @@
 using namespace JAUS;
 
 SharedMutex Service::mDebugMessagesMutex;
+const unsigned int Service::DefaultSignaledUpdatePeriodMs;
+const Service::ID::Handle Service::ID::NoHandle;
+const unsigned int Service::ID::MaxReadNames;
+
+namespace JAUS
+{
+    ////////////////////////////////////////////////////////////////////////////////////
+    ///
+    ///   \class ServiceNameTable
+    ///   \brief Global table of interned service names.  Names are never removed,
+    ///          so references to them stay valid.
+    ///
+    ///   The contents are never modified once published, so lookups only load
+    ///   the current contents without locking.  Adding a name publishes a copy
+    ///   with the name added.  Names read from messages are limited to
+    ///   ID::MaxReadNames, so other components cannot grow the table without
+    ///   limit.
+    ///
+    ////////////////////////////////////////////////////////////////////////////////////
+    class ServiceNameTable
+    {
+    public:
+        /** Contents of the table. */
+        class Names
+        {
+        public:
+            Names() : mReadNames(0) { mNames.push_back(boost::shared_ptr<const std::string>(new std::string())); }
+            boost::unordered_map<std::string, Service::ID::Handle> mHandles;    ///<  Handles by name.
+            std::vector<boost::shared_ptr<const std::string> > mNames;         ///<  Names by handle (shared by all copies).
+            unsigned int mReadNames;                                            ///<  Number of names added by ID::Read.
+        };
+        ServiceNameTable() : mpNames(new Names()) {}
+        // Gets the table (created on first use, so static IDs can intern).
+        static ServiceNameTable& Instance()
+        {
+            static ServiceNameTable table;
+            return table;
+        }
+        // Gets the Handle for a name, NoHandle if not in the table.
+        Service::ID::Handle Find(const std::string& name) const
+        {
+            boost::shared_ptr<const Names> names = boost::atomic_load(&mpNames);
+            boost::unordered_map<std::string, Service::ID::Handle>::const_iterator entry = names->mHandles.find(name);
+            return entry != names->mHandles.end() ? entry->second : Service::ID::NoHandle;
+        }
+        // Gets the Handle for a name, adding it if needed (NoHandle if a read name is over the limit).
+        Service::ID::Handle Add(const std::string& name, const bool read)
+        {
+            boost::mutex::scoped_lock lock(mAddMutex);
+            boost::shared_ptr<const Names> names = boost::atomic_load(&mpNames);
+            boost::unordered_map<std::string, Service::ID::Handle>::const_iterator entry = names->mHandles.find(name);
+            if(entry != names->mHandles.end())
+            {
+                return entry->second;
+            }
+            if(read && names->mReadNames >= Service::ID::MaxReadNames)
+            {
+                return Service::ID::NoHandle;
+            }
+            boost::shared_ptr<Names> copy(new Names(*names));
+            Service::ID::Handle handle = (Service::ID::Handle)copy->mNames.size();
+            copy->mNames.push_back(boost::shared_ptr<const std::string>(new std::string(name)));
+            copy->mHandles[name] = handle;
+            if(read)
+            {
+                copy->mReadNames++;
+            }
+            boost::atomic_store(&mpNames, boost::shared_ptr<const Names>(copy));
+            return handle;
+        }
+        // Gets the name for a Handle.
+        const std::string& GetName(const Service::ID::Handle handle) const
+        {
+            boost::shared_ptr<const Names> names = boost::atomic_load(&mpNames);
+            if(handle < (Service::ID::Handle)names->mNames.size())
+            {
+                return *names->mNames[handle];
+            }
+            return *names->mNames[Service::ID::NoHandle];
+        }
+    private:
+        boost::mutex mAddMutex;                 ///<  Serializes adding names.
+        boost::shared_ptr<const Names> mpNames; ///<  Current contents (use boost::atomic_load/store).
+    };
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////////
 ///
@@ -59,8 +146,9 @@ SharedMutex Service::mDebugMessagesMutex;
 ///  \param[in] version Service version number.
 ///
 ////////////////////////////////////////////////////////////////////////////////////
-Service::ID::ID(const std::string& name, const double version) : mName(name),
-                                                                 mVersion(version)
+Service::ID::ID(const std::string& name, const double version) : mVersion(version),
+                                                                 mName(name),
+                                                                 mHandle(Intern(name))
 {
 }
 
@@ -70,9 +158,10 @@ Service::ID::ID(const std::string& name, const double version) : mName(name),
 ///  \brief Copy constructor.
 ///
 ////////////////////////////////////////////////////////////////////////////////////
-Service::ID::ID(const ID& id)
+Service::ID::ID(const ID& id) : mVersion(id.mVersion),
+                                mName(id.mName),
+                                mHandle(id.mHandle)
 {
-    *this = id;
 }
 
 
@@ -133,6 +222,8 @@ int Service::ID::Read(const Packet& packet)
         result += packet.Read(majorVersionNumber);
         result += packet.Read(minorVersionNumber);
         mVersion = majorVersionNumber + minorVersionNumber/10.0;
+        // Names from other components count against the limit of the table.
+        mHandle = mName.empty() ? NoHandle : ServiceNameTable::Instance().Add(mName, true);
     }
     return result;
 }
@@ -147,6 +238,77 @@ void Service::ID::Clear()
 {
     mName.clear();
     mVersion = 0.0;
+    mHandle = NoHandle;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \brief Sets the name of the service, and updates the interned Handle.
+///
+///  \param[in] name Service name identifier.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Service::ID::SetName(const std::string& name)
+{
+    mName = name;
+    mHandle = Intern(name);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \brief Gets the interned Handle for a service name, adding the name to
+///         the global table if it is not there.
+///
+///  \param[in] name Service name identifier.
+///
+///  \return Handle for the name (NoHandle for an empty name).
+///
+////////////////////////////////////////////////////////////////////////////////////
+Service::ID::Handle Service::ID::Intern(const std::string& name)
+{
+    if(name.empty())
+    {
+        return NoHandle;
+    }
+    ServiceNameTable& table = ServiceNameTable::Instance();
+    Handle handle = table.Find(name);
+    if(handle != NoHandle)
+    {
+        return handle;
+    }
+    return table.Add(name, false);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \brief Gets the interned Handle for a service name, without adding it.
+///
+///  \param[in] name Service name identifier.
+///
+///  \return Handle for the name, NoHandle if it was never interned.
+///
+////////////////////////////////////////////////////////////////////////////////////
+Service::ID::Handle Service::ID::Find(const std::string& name)
+{
+    return ServiceNameTable::Instance().Find(name);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \brief Gets the service name for an interned Handle.
+///
+///  \param[in] handle Handle of the name.
+///
+///  \return Service name (empty if the handle is not valid).
+///
+////////////////////////////////////////////////////////////////////////////////////
+const std::string& Service::ID::GetName(const Handle handle)
+{
+    return ServiceNameTable::Instance().GetName(handle);
 }
 
 
@@ -198,11 +360,32 @@ Service::ID& Service::ID::operator =(const Service::ID& id)
     {
         mName = id.mName;
         mVersion = id.mVersion;
+        mHandle = id.mHandle;
     }
     return *this;
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \brief Orders IDs by Handle.  IDs without a Handle (names read after the
+///         limit of the name table was reached) follow, ordered by name.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool Service::ID::operator <(const Service::ID& id) const
+{
+    if(mHandle != NoHandle && id.mHandle != NoHandle)
+    {
+        return mHandle < id.mHandle;
+    }
+    if(mHandle != NoHandle || id.mHandle != NoHandle)
+    {
+        return mHandle != NoHandle;
+    }
+    return mName < id.mName;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///  \brief Constructor.
@@ -224,6 +407,8 @@ Service::Service(const ID& serviceIdentifier, const ID& parentServiceIdentifier)
     mShutdownServiceFlag = false;
     mServiceUpdateThreadDelayMs = 0;
     mSingleThreadModeFlag = false;
+    mServiceUpdateSignalFlag = false;
+    mServiceUpdateSignals = 0;
 }
 
 
@@ -367,6 +552,35 @@ void Service::Receive(const Message* message)
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gets the message codes this Service wants delivered to its
+///          Receive method.
+///
+///   The Component uses this information to build a routing table so that
+///   received messages are only passed to the Services that consume them.  The
+///   default implementation returns every message code the Service can create
+///   with CreateMessage.  Services that process messages created by other
+///   Services must overload this method and add those codes.  If the set is
+///   left empty, the Service receives all messages.
+///
+///   \param[out] messageCodes Message codes processed by the Service.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Service::GetReceivedMessageCodes(std::set<UShort>& messageCodes) const
+{
+    for(unsigned int code = 0; code <= JAUS_USHORT_MAX; code++)
+    {
+        Message* message = CreateMessage((UShort)code);
+        if(message)
+        {
+            messageCodes.insert((UShort)code);
+            delete message;
+        }
+    }
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///  \brief Sets the component ID of the Service.
@@ -407,7 +621,7 @@ bool Service::SetComponentID(const Address& id)
 ////////////////////////////////////////////////////////////////////////////////////
 bool Service::InheritsFrom(const Service::ID& id) const
 {
-    if(mParentServiceID.mName == id.mName)
+    if(mParentServiceID == id)
     {
         return true;
     }
@@ -446,10 +660,10 @@ bool Service::AddChildService(Service* childService)
             parent = parent->mpJausParentService;
         }
     }
-    Map::iterator child = mJausChildServices.find(childService->mServiceID.mName);
+    Map::iterator child = mJausChildServices.find(childService->mServiceID.GetName());
     if(child == mJausChildServices.end())
     {
-        mJausChildServices[childService->mServiceID.mName] = childService;
+        mJausChildServices[childService->mServiceID.GetName()] = childService;
         if(mpTransportService)
         {
             childService->mpTransportService = mpTransportService;
@@ -457,6 +671,11 @@ bool Service::AddChildService(Service* childService)
         childService->mpJausParentService = this;
         childService->SetComponent(mpComponent);
         result = true;
+        // Message types the new Service creates must be added to the table.
+        if(mpTransportService && mpTransportService->IsInitialized())
+        {
+            mpTransportService->BuildMessageFactoryTable();
+        }
     }
     return result;
 }
@@ -515,7 +734,7 @@ const Service* Service::GetParentService() const
 Service* Service::GetChildService(const Service::ID& id)
 {
     Map::iterator child;
-    child = mJausChildServices.find(id.mName);
+    child = mJausChildServices.find(id.GetName());
     if(child != mJausChildServices.end())
     {
         return child->second;
@@ -534,7 +753,7 @@ Service* Service::GetChildService(const Service::ID& id)
 const Service* Service::GetChildService(const Service::ID& id) const
 {
     Map::const_iterator child;
-    child = mJausChildServices.find(id.mName);
+    child = mJausChildServices.find(id.GetName());
     if(child != mJausChildServices.end())
     {
         return child->second;
@@ -644,6 +863,10 @@ void Service::SetComponent(Component* component)
 ///         to call the UpdateServiceEvent method automatically for any
 ///         given service at a specified update interval.
 ///
+///  If mServiceUpdateSignalFlag is set, the thread sleeps until the service
+///  is signaled (SignalServiceUpdate) instead of polling, but still calls
+///  UpdateServiceEvent every update period for periodic work.
+///
 ///  \param[in] servicePtr Pointer to the service to update.
 ///
 ////////////////////////////////////////////////////////////////////////////////////
@@ -661,7 +884,12 @@ void Service::ServiceUpdateThreadFunc(void* servicePtr)
         }
 
         // Sleep!
-        if(service->mServiceUpdateThreadDelayMs == 0)
+        if(service->mServiceUpdateSignalFlag)
+        {
+            service->WaitForServiceUpdate(service->mServiceUpdateThreadDelayMs == 0 ? 
+                                          DefaultSignaledUpdatePeriodMs : service->mServiceUpdateThreadDelayMs);
+        }
+        else if(service->mServiceUpdateThreadDelayMs == 0)
         {
             boost::this_thread::sleep(boost::posix_time::microseconds(1000));
         }
@@ -688,11 +916,59 @@ void Service::StopServiceUpdateEventThread()
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \brief Wakes one thread running ServiceUpdateThreadFunc that is waiting
+///         for work, call once for each item of work added (e.g. packet
+///         queued).
+///
+///  Only used if mServiceUpdateSignalFlag is set, otherwise update threads
+///  poll.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Service::SignalServiceUpdate()
+{
+    {
+        boost::lock_guard<boost::mutex> lock(mServiceUpdateMutex);
+        mServiceUpdateSignals++;
+    }
+    mServiceUpdateCondition.notify_one();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \brief Waits until SignalServiceUpdate is called, or the timeout.
+///
+///  \param[in] timeoutMs Maximum time to wait in milliseconds.
+///
+///  \return True if signaled, false on timeout.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool Service::WaitForServiceUpdate(const unsigned int timeoutMs)
+{
+    boost::unique_lock<boost::mutex> lock(mServiceUpdateMutex);
+    if(mServiceUpdateSignals == 0 && mServiceUpdateThread.QuitThreadFlag() == false)
+    {
+        mServiceUpdateCondition.timed_wait(lock, boost::posix_time::milliseconds(timeoutMs));
+    }
+    if(mServiceUpdateSignals > 0)
+    {
+        mServiceUpdateSignals--;
+        return true;
+    }
+    return false;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///  \brief If the message is not supported by this Service, use this method
 ///         to pass it to all children to this Service.
 ///
+///  Only Services registered for the message code (see
+///  GetReceivedMessageCodes) are given the message.
+///
 ///  \param[in] message The message to push to child Services.
 ///
 ////////////////////////////////////////////////////////////////////////////////////
@@ -709,16 +985,16 @@ void Service::PushMessageToChildren(const Message* message)
         {
             return;
         }
-        // Let all services receives message, even if they ignore it.
-        Service::Map services = mpComponent->GetServices();
-        Service::Map::iterator s;
-        for(s = services.begin();
-            s != services.end();
+        // Only pass the message to services registered for it.
+        const Service::List* services = mpComponent->GetMessageRoute(message->GetMessageCode());
+        Service::List::const_iterator s;
+        for(s = services->begin();
+            s != services->end();
             s++)
         {
-            if(s->second != transport && s->second->mServiceEnabledFlag)
+            if((*s)->mServiceEnabledFlag)
             {
-                s->second->Receive(message);
+                (*s)->Receive(message);
             }
         }
     }
@@ -0,0 +1,340 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file asyncresponse.cpp
+///  \brief This file contains the AsyncResponse class which is used to
+///  wait for, or be called back with, the response to a message without
+///  blocking the thread that sent it.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#include "jaus/core/transport/asyncresponse.h"
+
+using namespace JAUS;
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Constructor, initializes default values.
+///
+///   \param[in] callback Optional callback to make when the request is done.
+///                       Must remain valid until then.
+///
+////////////////////////////////////////////////////////////////////////////////////
+AsyncResponse::AsyncResponse(Callback* callback) : mpTransport(NULL),
+                                                   mpCallback(callback),
+                                                   mID(0),
+                                                   mDoneFlag(false),
+                                                   mSuccessFlag(false),
+                                                   mpResponse(NULL)
+{
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Destructor, deletes copy of response.
+///
+////////////////////////////////////////////////////////////////////////////////////
+AsyncResponse::~AsyncResponse()
+{
+    if(mpResponse)
+    {
+        delete mpResponse;
+        mpResponse = NULL;
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Sends a message using Transport::SendAsync, the response expected
+///          is given by the message GetMessageCodeOfResponse method.
+///
+///   \param[in] transport Transport to send with.
+///   \param[in] handle Handle to complete, it is kept alive until done.
+///   \param[in] message Message to send.
+///   \param[in] waitTimeMs How long to wait for a response, 0 is INFINITE.
+///
+///   \return True if sent, false on failure (the handle is done).
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool AsyncResponse::Send(const Transport* transport,
+                         const AsyncResponse::Ptr& handle,
+                         const Message* message,
+                         const unsigned int waitTimeMs)
+{
+    std::set<UShort> responseCodes;
+    if(message)
+    {
+        responseCodes.insert(message->GetMessageCodeOfResponse());
+    }
+    return Send(transport, handle, message, responseCodes, waitTimeMs);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Sends a message using Transport::SendAsync.
+///
+///   \param[in] transport Transport to send with.
+///   \param[in] handle Handle to complete, it is kept alive until done.
+///   \param[in] message Message to send.
+///   \param[in] responseCodes Message codes of the possible responses.
+///   \param[in] waitTimeMs How long to wait for a response, 0 is INFINITE.
+///
+///   \return True if sent, false on failure (the handle is done).
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool AsyncResponse::Send(const Transport* transport,
+                         const AsyncResponse::Ptr& handle,
+                         const Message* message,
+                         const std::set<UShort>& responseCodes,
+                         const unsigned int waitTimeMs)
+{
+    if(handle == NULL)
+    {
+        return false;
+    }
+    {
+        boost::lock_guard<boost::mutex> lock(handle->mMutex);
+        handle->mpTransport = transport;
+        handle->mSelf = handle;
+    }
+    UInt id = 0;
+    if(transport)
+    {
+        id = transport->SendAsync(message, responseCodes, handle.get(), waitTimeMs);
+    }
+    if(id == 0)
+    {
+        handle->Finish(0, NULL, false);
+        return false;
+    }
+    boost::lock_guard<boost::mutex> lock(handle->mMutex);
+    if(handle->mDoneFlag == false)
+    {
+        handle->mID = id;
+    }
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Waits until the request is done.
+///
+///   \param[in] waitTimeMs Maximum time to wait in ms, 0 is INFINITE.
+///
+///   \return True if done, false if still waiting for a response.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool AsyncResponse::Wait(const unsigned int waitTimeMs) const
+{
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    if(waitTimeMs == 0)
+    {
+        while(mDoneFlag == false)
+        {
+            mDoneCondition.wait(lock);
+        }
+    }
+    else
+    {
+        boost::system_time timeout = boost::get_system_time() + boost::posix_time::milliseconds(waitTimeMs);
+        while(mDoneFlag == false &&
+              mDoneCondition.timed_wait(lock, timeout))
+        {
+        }
+    }
+    return mDoneFlag;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Checks if the request is done without blocking.
+///
+///   \return True once a response was received, the wait time ended, the
+///           request was cancelled, or the Transport shut down.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool AsyncResponse::IsDone() const
+{
+    boost::lock_guard<boost::mutex> lock(mMutex);
+    return mDoneFlag;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Checks if the request succeeded.
+///
+///   \return True if done and the response was received and accepted.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool AsyncResponse::IsSuccessful() const
+{
+    boost::lock_guard<boost::mutex> lock(mMutex);
+    return mDoneFlag && mSuccessFlag;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gets the response received.
+///
+///   \return Copy of the response received, NULL if not done or no response.
+///           The handle owns the message.
+///
+////////////////////////////////////////////////////////////////////////////////////
+const Message* AsyncResponse::GetResponse() const
+{
+    boost::lock_guard<boost::mutex> lock(mMutex);
+    return mDoneFlag ? mpResponse : NULL;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gets the ID of the asynchronous send.
+///
+///   \return ID given by Transport::SendAsync (0 if not sent).
+///
+////////////////////////////////////////////////////////////////////////////////////
+UInt AsyncResponse::GetID() const
+{
+    boost::lock_guard<boost::mutex> lock(mMutex);
+    return mID;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Stops waiting for a response.  The request is done but not
+///          successful, and no callback is made.
+///
+///   \return True if cancelled, false if already done.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool AsyncResponse::Cancel()
+{
+    const Transport* transport = NULL;
+    UInt id = 0;
+    {
+        boost::lock_guard<boost::mutex> lock(mMutex);
+        if(mDoneFlag || mpTransport == NULL || mID == 0)
+        {
+            return false;
+        }
+        transport = mpTransport;
+        id = mID;
+    }
+    if(transport->CancelAsync(id))
+    {
+        OnResponse(NULL);
+        // Held until the end of this method, so we are not deleted.
+        Ptr self = Finish(id, NULL, false);
+        return true;
+    }
+    return false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Called by the Transport when the response is received, the wait
+///          time ended, or the Transport shut down.  Processes the response
+///          (OnResponse), marks the request done, then makes the callback.
+///
+///   \param[in] id ID from Transport::SendAsync.
+///   \param[in] response Response received, NULL on timeout or shutdown.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void AsyncResponse::ProcessResponse(const UInt id, const Message* response)
+{
+    bool success = OnResponse(response);
+    Callback* callback = mpCallback;
+    // Once done, the handle may be deleted when self is released.
+    Ptr self = Finish(id, response, success);
+    if(callback)
+    {
+        callback->ProcessAsyncResponse(self);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Marks the request done and wakes waiting threads.  All requests
+///          end here (response, timeout, cancel, shutdown, or failed send),
+///          so OnFinish is called first to release anything held.
+///
+///   \param[in] id ID from Transport::SendAsync.
+///   \param[in] response Response to copy (NULL if none).
+///   \param[in] success If true, the response was accepted.
+///
+///   \return Handle reference kept while waiting, release it last.
+///
+////////////////////////////////////////////////////////////////////////////////////
+AsyncResponse::Ptr AsyncResponse::Finish(const UInt id, const Message* response, const bool success)
+{
+    Ptr self;
+    {
+        boost::lock_guard<boost::mutex> lock(mMutex);
+        if(mDoneFlag)
+        {
+            return self;
+        }
+    }
+    OnFinish(success);
+    {
+        boost::lock_guard<boost::mutex> lock(mMutex);
+        if(id != 0)
+        {
+            mID = id;
+        }
+        if(response && mpResponse == NULL)
+        {
+            mpResponse = response->Clone();
+        }
+        mSuccessFlag = success;
+        mDoneFlag = true;
+        self.swap(mSelf);
+    }
+    mDoneCondition.notify_all();
+    return self;
+}
+
+/*  End of File */
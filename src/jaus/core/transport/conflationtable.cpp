@@ -0,0 +1,293 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file conflationtable.cpp
+///  \brief This file contains the ConflationTable class which is used
+///  to keep only the newest state report from a source in the receive queue.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#include "jaus/core/transport/conflationtable.h"
+#include "jaus/core/corecodes.h"
+#include <cxutils/timer.h>
+
+using namespace JAUS;
+
+const unsigned int ConflationTable::DefaultTimeoutMs;
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \return True if key is less than key being compared.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool ConflationTable::Key::operator<(const ConflationTable::Key& key) const
+{
+    if(mSource != key.mSource)
+    {
+        return mSource < key.mSource;
+    }
+    if(mMessageCode != key.mMessageCode)
+    {
+        return mMessageCode < key.mMessageCode;
+    }
+    if(mEventFlag != key.mEventFlag)
+    {
+        return mEventFlag < key.mEventFlag;
+    }
+    return mEventID < key.mEventID;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Constructor, initializes default values.
+///
+////////////////////////////////////////////////////////////////////////////////////
+ConflationTable::ConflationTable() : mEnabledFlag(false),
+                                     mTimeoutMs(DefaultTimeoutMs),
+                                     mConflatedCount(0)
+{
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Destructor.
+///
+////////////////////////////////////////////////////////////////////////////////////
+ConflationTable::~ConflationTable()
+{
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Enables conflation of a message type.  Only use this for messages
+///          where the newest one replaces all before it (state reports).
+///
+///   \param[in] messageCode Message type.  Reports sent as part of an Event
+///                          message are conflated by the report type.
+///   \param[in] enable If true, conflate, otherwise process every message.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void ConflationTable::Enable(const UShort messageCode, const bool enable)
+{
+    Mutex::ScopedLock lock(&mMutex);
+    if(enable)
+    {
+        mMessageCodes.insert(messageCode);
+    }
+    else
+    {
+        mMessageCodes.erase(messageCode);
+    }
+    mEnabledFlag = mMessageCodes.size() > 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \param[in] messageCode Message type.
+///
+///   \return True if the message type is conflated.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool ConflationTable::IsEnabled(const UShort messageCode) const
+{
+    if(mEnabledFlag == false)
+    {
+        return false;
+    }
+    Mutex::ScopedLock lock(&mMutex);
+    return mMessageCodes.find(messageCode) != mMessageCodes.end();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gets the conflation key for a single packet message.
+///
+///   \param[in] packet Packet data (header and payload).
+///   \param[in] header Header read from the packet.
+///   \param[out] key Key of the packet.
+///
+///   \return True if the message type is conflated, otherwise false.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool ConflationTable::GetKey(const Packet& packet, const Header& header, Key& key) const
+{
+    if(mEnabledFlag == false ||
+       header.mControlFlag != Header::DataControl::Single ||
+       packet.Length() < Header::MinSize)
+    {
+        return false;
+    }
+
+    UShort messageCode = 0;
+    packet.Read(messageCode, Header::PayloadOffset);
+    key.mSource = header.mSourceID.ToUInt();
+    key.mMessageCode = messageCode;
+    key.mEventID = 0;
+    key.mEventFlag = false;
+    if(messageCode == EVENT)
+    {
+        // Event ID, sequence number, report size, and report code.
+        unsigned int offset = Header::MinSize;
+        if(packet.Length() < offset + BYTE_SIZE*2 + UINT_SIZE + USHORT_SIZE)
+        {
+            return false;
+        }
+        packet.Read(key.mEventID, offset);
+        packet.Read(key.mMessageCode, offset + BYTE_SIZE*2 + UINT_SIZE);
+        key.mEventFlag = true;
+    }
+    return IsEnabled(key.mMessageCode);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Called when a packet is received, before it is queued.
+///
+///   If a packet with the same key is already queued, the data is stored
+///   and copied over the queued packet by Take.  If the queued packet has
+///   waited longer than the timeout (e.g. it was discarded by a full queue),
+///   the new packet is queued instead.
+///
+///   \param[in] key Key of the packet.
+///   \param[in] packet Packet data received.
+///
+///   \return True if the packet must be queued, false if it replaced the
+///           packet already queued.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool ConflationTable::Update(const Key& key, const Packet& packet)
+{
+    double timeSeconds = CxUtils::Timer::GetTimeSeconds();
+    Mutex::ScopedLock lock(&mMutex);
+    Entry& entry = mEntries[key];
+    if(entry.mQueuedFlag &&
+       (timeSeconds - entry.mQueueTimeSeconds)*1000.0 < mTimeoutMs)
+    {
+        entry.mLatest.Clear(false);
+        entry.mLatest.Write(packet.Ptr(), packet.Length());
+        entry.mUpdatedFlag = true;
+        mConflatedCount++;
+        return false;
+    }
+    entry.mQueuedFlag = true;
+    entry.mUpdatedFlag = false;
+    entry.mQueueTimeSeconds = timeSeconds;
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Called when a packet Update said to queue could not be queued,
+///          so the next packet with the key is queued.
+///
+///   \param[in] key Key of the packet.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void ConflationTable::Cancel(const Key& key)
+{
+    Mutex::ScopedLock lock(&mMutex);
+    std::map<Key, Entry>::iterator entry = mEntries.find(key);
+    if(entry != mEntries.end())
+    {
+        entry->second.mQueuedFlag = false;
+        entry->second.mUpdatedFlag = false;
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Called when a packet is removed from the queue for processing.
+///          If newer data was received while it was queued, the newer data
+///          is copied over it.
+///
+///   \param[in] key Key of the packet.
+///   \param[in,out] packet Packet removed from the queue.
+///
+///   \return True if the packet was replaced by newer data, otherwise false.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool ConflationTable::Take(const Key& key, Packet& packet)
+{
+    Mutex::ScopedLock lock(&mMutex);
+    std::map<Key, Entry>::iterator entry = mEntries.find(key);
+    if(entry == mEntries.end())
+    {
+        return false;
+    }
+    entry->second.mQueuedFlag = false;
+    if(entry->second.mUpdatedFlag == false)
+    {
+        return false;
+    }
+    entry->second.mUpdatedFlag = false;
+    packet.Clear(false);
+    packet.Write(entry->second.mLatest.Ptr(), entry->second.mLatest.Length());
+    packet.SetReadPos(0);
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Removes all stored data (message types enabled are kept).
+///
+////////////////////////////////////////////////////////////////////////////////////
+void ConflationTable::Clear()
+{
+    Mutex::ScopedLock lock(&mMutex);
+    mEntries.clear();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \return Number of keys (source, message, event) in the table.
+///
+////////////////////////////////////////////////////////////////////////////////////
+unsigned int ConflationTable::GetKeyCount() const
+{
+    Mutex::ScopedLock lock(&mMutex);
+    return (unsigned int)mEntries.size();
+}
+
+/*  End of File */
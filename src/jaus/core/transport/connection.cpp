@@ -253,6 +253,11 @@ void Connection::Thread::Execute()
                 }
             }
         }
+        // Send anything batched by routing the data received.
+        if(mpParent)
+        {
+            mpParent->FlushPackets();
+        }
         // Remove bad connections.
         if(bad.size() > 0)
         {
@@ -308,11 +313,13 @@ Connection::Connection(const bool singleThread) : mSingleThreadModeFlag(singleTh
         mConnectionNumber = ConnectionCounter++;
     }
     mpManager = NULL;
+    mpReactor = NULL;
     mpGlobalShutdownFlag = NULL;
     mTransportType = 0;
     mLocalConnectionFlag = false;
     mFixedConnectionFlag = false;
     mConnectionUpdateDelayMs = 0;
+    mpShaper.reset(new TrafficShaper());
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -376,6 +383,104 @@ void Connection::SetNodeManager(NodeManager* nm)
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Limits the rate data is sent by the connection (traffic shaping).
+///
+///   Packets are queued until the rate allows them to be sent, and are sent
+///   by the TrafficShaper thread so that senders never wait.  If too much
+///   data is already waiting, packets are dropped.  High and Safety Critical
+///   priority packets are never delayed or dropped, but count against the rate.
+///   Connections sharing a socket share the limit.
+///
+///   \param[in] bytesPerSecond Rate limit, 0 = no limit.
+///   \param[in] burstBytes Bytes that can be sent at once, 0 uses 1/10 of
+///                         a second of data.
+///   \param[in] maxQueuedBytes Most bytes waiting to be sent before packets
+///                             are dropped, 0 = no limit.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Connection::SetRateLimit(const unsigned int bytesPerSecond,
+                              const unsigned int burstBytes,
+                              const unsigned int maxQueuedBytes)
+{
+    mpShaper->SetRate(bytesPerSecond, burstBytes, maxQueuedBytes);
+    WriteLock wLock(mConnectionMutex);
+    mStats.mRateLimit = bytesPerSecond;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Applies the rate limit to a packet being sent.  This method does
+///          not wait for the rate limit, packets that can't be sent now are
+///          queued and sent later using TransmitPacket.
+///
+///   \param[in] packet JAUS packet being sent.
+///   \param[in] header JAUS header of the packet.
+///
+///   \return TrafficShaper::Send if the packet should be sent now,
+///           TrafficShaper::Queued if it will be sent later, or
+///           TrafficShaper::Dropped if it was discarded.
+///
+////////////////////////////////////////////////////////////////////////////////////
+int Connection::ShapeTraffic(const Packet& packet, const Header& header) const
+{
+    const unsigned int bytes = packet.Length();
+    const bool limited = mpShaper->IsLimited() && header.mPriorityFlag < Header::Priority::High;
+    SharedMutex* m = (SharedMutex*)&mConnectionMutex;
+    Connection::Statistics* stats = (Connection::Statistics*)&mStats;
+
+    if(limited)
+    {
+        // Count the bytes before queuing, the shaper may send them right away.
+        WriteLock wLock(*m);
+        stats->mQueuedBytes += bytes;
+    }
+    int result = mpShaper->Shape(this, packet, header);
+    if(limited)
+    {
+        WriteLock wLock(*m);
+        if(result == TrafficShaper::Queued)
+        {
+            if(stats->mQueuedBytes > stats->mMaxQueuedBytes)
+            {
+                stats->mMaxQueuedBytes = stats->mQueuedBytes;
+            }
+        }
+        else
+        {
+            stats->mQueuedBytes -= bytes;
+            if(result == TrafficShaper::Dropped)
+            {
+                stats->mPacketsDropped++;
+                stats->mTotalPacketsDropped++;
+            }
+        }
+    }
+    return result;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Called by the TrafficShaper thread to send a packet that was
+///          waiting for the rate limit.
+///
+///   \param[in] packet JAUS packet to send.
+///   \param[in] packetHeader JAUS header of the packet.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Connection::SendQueuedPacket(const Packet& packet, const Header& packetHeader) const
+{
+    {
+        WriteLock wLock(*((SharedMutex*)&mConnectionMutex));
+        ((Connection::Statistics*)&mStats)->mQueuedBytes -= packet.Length();
+    }
+    TransmitPacket(packet, packetHeader);
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Sends the packet data to all registered callbacks, and then
@@ -431,13 +536,23 @@ void Connection::UpdateConnectionThread(void* args)
 
         connection->UpdateConnection();
 
+        // Send anything batched by routing the data received.
+        if(connection->mpManager)
+        {
+            connection->mpManager->FlushPackets();
+        }
+
         if(connection->GetGlobalShutdownSignal() == true || connection->IsConnected() == false)
         {
             // Connection has closed, exit thread.
             break;
         }
 
-        // Sleep!
+        // Sleep! (unless UpdateConnection already waited for data)
+        if(connection->WaitsForData())
+        {
+            continue;
+        }
         if(connection->mConnectionUpdateDelayMs == 0)
         {
             boost::this_thread::sleep(boost::posix_time::microseconds(1000));
@@ -0,0 +1,276 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file headercompression.cpp
+///  \brief This file contains the table of header templates used to
+///  compress/expand JAUS general transport headers for JUDP.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#include "jaus/core/transport/headercompression.h"
+#include <cstring>
+
+using namespace JAUS;
+
+const unsigned int HeaderCompression::FieldsSize;
+const unsigned int HeaderCompression::CompressedHeaderSize;
+const unsigned int HeaderCompression::FlagsOffset;
+const unsigned int HeaderCompression::TemplateSize;
+const unsigned int HeaderCompression::MaxTemplates;
+const unsigned int HeaderCompression::RefreshTimeMs;
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Constructor, initializes default values.
+///
+////////////////////////////////////////////////////////////////////////////////////
+HeaderCompression::HeaderCompression()
+{
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Destructor.
+///
+////////////////////////////////////////////////////////////////////////////////////
+HeaderCompression::~HeaderCompression()
+{
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Writes a JAUS packet using header compression.
+///
+///   The first time a header template is seen it is sent in full with
+///   Compression::Request.  Once the receiver replies with Compression::Engaged
+///   the template is left out of the packet until it is refreshed.
+///
+///   \param[in] packet JAUS packet (general header, payload, and sequence number).
+///   \param[out] output Compressed packet is appended to this buffer.
+///
+///   \return True if written to output, false if the packet can't use
+///           header compression (write it unchanged).
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool HeaderCompression::Compress(const Packet& packet, Packet& output)
+{
+    const unsigned char* ptr = packet.Ptr();
+    UShort size = 0;
+    if(packet.Length() < Header::MinSize + USHORT_SIZE ||
+       (ptr[0] >> 6) != Header::Compression::None ||
+       packet.Read(size, BYTE_SIZE) <= 0 ||
+       size != packet.Length() ||
+       (UInt)size + FieldsSize > Header::MaxPacketSize)
+    {
+        return false;
+    }
+    // Only single packet messages to a specific component are compressed, since
+    // large data sets and broadcasts would need a template for every receiver.
+    UInt destination = 0;
+    packet.Read(destination, Header::DestinationOffset);
+    if(((ptr[FlagsOffset] >> 6) & 0x03) != Header::DataControl::Single ||
+       Address(destination).IsBroadcast())
+    {
+        return false;
+    }
+
+    std::string templateData((const char*)(ptr + FlagsOffset), TemplateSize);
+    Time::Stamp timeMs = Time::GetUtcTimeMs();
+
+    Mutex::ScopedLock lock(&mMutex);
+
+    Byte number = 0;
+    std::map<std::string, Byte>::iterator n = mNumbers.find(templateData);
+    if(n != mNumbers.end())
+    {
+        number = n->second;
+    }
+    else
+    {
+        if(mTemplates.size() < MaxTemplates)
+        {
+            mTemplates.push_back(Template());
+            number = (Byte)mTemplates.size();
+        }
+        else
+        {
+            // Re-use the HC number of the least recently used template.
+            unsigned int oldest = 0;
+            for(unsigned int i = 1; i < (unsigned int)mTemplates.size(); i++)
+            {
+                if(mTemplates[i].mUsedTimeMs < mTemplates[oldest].mUsedTimeMs)
+                {
+                    oldest = i;
+                }
+            }
+            mNumbers.erase(mTemplates[oldest].mData);
+            mTemplates[oldest] = Template();
+            number = (Byte)(oldest + 1);
+        }
+        mTemplates[number - 1].mData = templateData;
+        mNumbers[templateData] = number;
+    }
+
+    Template& entry = mTemplates[number - 1];
+    entry.mUsedTimeMs = timeMs;
+    if(entry.mEngagedFlag && timeMs - entry.mRequestTimeMs < RefreshTimeMs)
+    {
+        output.Write((Byte)((ptr[0] & 0x3F) | (Header::Compression::Compressed << 6)));
+        output.Write((UShort)(size - TemplateSize + FieldsSize));
+        output.Write(number);
+        output.Write((Byte)TemplateSize);
+        output.Write(ptr + FlagsOffset + TemplateSize, size - FlagsOffset - TemplateSize);
+    }
+    else
+    {
+        output.Write((Byte)((ptr[0] & 0x3F) | (Header::Compression::Request << 6)));
+        output.Write((UShort)(size + FieldsSize));
+        output.Write(number);
+        output.Write((Byte)TemplateSize);
+        output.Write(ptr + FlagsOffset, size - FlagsOffset);
+        entry.mRequestTimeMs = timeMs;
+    }
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Reads a packet using header compression, restoring the
+///          full JAUS general header.
+///
+///   \param[in] data Pointer to start of packet data.
+///   \param[in] length Number of bytes available at data.
+///   \param[in] source Address of the sender (e.g. "IP:port"), templates
+///                     are stored per source.
+///   \param[out] packet Restored JAUS packet, empty if there is nothing
+///                      to process (e.g. Compression::Engaged reply, or
+///                      unknown template).
+///   \param[out] reply Compression::Engaged reply to send to the source of
+///                     the packet, empty if no reply is needed.
+///
+///   \return Number of bytes read from data, 0 on error.
+///
+////////////////////////////////////////////////////////////////////////////////////
+int HeaderCompression::Expand(const unsigned char* data,
+                              const unsigned int length,
+                              const std::string& source,
+                              Packet& packet,
+                              Packet& reply)
+{
+    packet.Clear(false);
+    reply.Clear(false);
+
+    if(data == NULL || length < CompressedHeaderSize + USHORT_SIZE)
+    {
+        return 0;
+    }
+    UShort size = (UShort)(data[1] | (data[2] << 8));
+    Byte compression = data[0] >> 6;
+    Byte number = data[3];
+    Byte templateSize = data[4];
+    if(size > length || size < CompressedHeaderSize + USHORT_SIZE || number == 0 || templateSize == 0)
+    {
+        return 0;
+    }
+    const unsigned char* body = data + CompressedHeaderSize;
+    unsigned int bodySize = size - CompressedHeaderSize;
+
+    Mutex::ScopedLock lock(&mMutex);
+
+    if(compression == Header::Compression::Request)
+    {
+        // Template must at least contain flags, destination, and source.
+        if(templateSize < BYTE_SIZE + UINT_SIZE*2 || bodySize < (unsigned int)templateSize + USHORT_SIZE)
+        {
+            return 0;
+        }
+        mReceived[std::make_pair(source, number)] = std::string((const char*)body, templateSize);
+
+        packet.Write((Byte)(data[0] & 0x3F));
+        packet.Write((UShort)(size - FieldsSize));
+        packet.Write(body, bodySize);
+
+        // Reply with the stored template, swapping destination and source.
+        reply.Write((Byte)(Header::MessageType::Normal | (Header::Compression::Engaged << 6)));
+        reply.Write((UShort)(CompressedHeaderSize + BYTE_SIZE + UINT_SIZE*2 + templateSize + USHORT_SIZE));
+        reply.Write(number);
+        reply.Write(templateSize);
+        reply.Write((Byte)Header::Priority::High);
+        reply.Write(body + BYTE_SIZE + UINT_SIZE, UINT_SIZE);
+        reply.Write(body + BYTE_SIZE, UINT_SIZE);
+        reply.Write(body, templateSize);
+        reply.Write((UShort)0);
+    }
+    else if(compression == Header::Compression::Compressed)
+    {
+        std::map<std::pair<std::string, Byte>, std::string>::iterator t;
+        t = mReceived.find(std::make_pair(source, number));
+        if(t == mReceived.end() || t->second.size() != templateSize)
+        {
+            // Sender will refresh the template, until then data is lost.
+            return size;
+        }
+        if(size - FieldsSize + templateSize > Header::MaxPacketSize)
+        {
+            return 0;
+        }
+        packet.Reserve(size - FieldsSize + templateSize);
+        packet.Write((Byte)(data[0] & 0x3F));
+        packet.Write((UShort)(size - FieldsSize + templateSize));
+        packet.Write((const unsigned char*)t->second.c_str(), templateSize);
+        packet.Write(body, bodySize);
+    }
+    else if(compression == Header::Compression::Engaged)
+    {
+        // Receiver stored a template, compressed headers can be used if it
+        // matches what was sent.
+        unsigned int offset = BYTE_SIZE + UINT_SIZE*2;
+        if(bodySize >= offset + templateSize + USHORT_SIZE && number <= mTemplates.size())
+        {
+            Template& sent = mTemplates[number - 1];
+            if(sent.mData.size() == templateSize &&
+               memcmp(sent.mData.c_str(), body + offset, templateSize) == 0)
+            {
+                sent.mEngagedFlag = true;
+            }
+        }
+    }
+    return size;
+}
+
+/*  End of File */
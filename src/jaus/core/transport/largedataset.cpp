@@ -36,22 +36,23 @@
 ///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
 ///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ///
-////////////////////////////////////////////////////////////////////////////////////
-#include "jaus/core/transport/largedataset.h"
-#include <string.h>
-
-using namespace JAUS;
-
-
-////////////////////////////////////////////////////////////////////////////////////
-///
-///   \brief Constructor, initializes default values.
-///
-///   \param[in] src Source of the large data set.
-///   \param[in] code Message code (type of payload data).
+////////////////////////////////////////////////////////////////////////////////////
+#include "jaus/core/transport/largedataset.h"
+#include <string.h>
+#include <zlib.h>
+
+using namespace JAUS;
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Constructor, initializes default values.
+///
+///   \param[in] src Source of the large data set.
+///   \param[in] code Message code (type of payload data).
 ///   \param[in] pv Presence vector data.
 ///
-////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
 LargeDataSet::Key::Key(const Address& src,
                        const UShort code,
                        const UInt pv)
@@ -60,20 +61,20 @@ LargeDataSet::Key::Key(const Address& src,
     mMessageCode = code;
     mPresenceVector = pv;
     mIdentifier = 0;
-}
-
-
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Constructor, initializes default values.
 ///
-////////////////////////////////////////////////////////////////////////////////////
-LargeDataSet::Key::Key(const LargeDataSet::Key& key)
-{
-    *this = key;
-}
-
-
+////////////////////////////////////////////////////////////////////////////////////
+LargeDataSet::Key::Key(const LargeDataSet::Key& key)
+{
+    *this = key;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Destructor.
@@ -81,52 +82,52 @@ LargeDataSet::Key::Key(const LargeDataSet::Key& key)
 ////////////////////////////////////////////////////////////////////////////////////
 LargeDataSet::Key::~Key()
 {
-}
-
-
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Updates the key data for comparisons.
 ///
-////////////////////////////////////////////////////////////////////////////////////
-void LargeDataSet::Key::Update() const
-{
-    Packet * p = ( (Packet *)(&mKey) );
-    p->Clear();
-    p->Reserve(UINT_SIZE + USHORT_SIZE + ULONG_SIZE + BYTE_SIZE);
+////////////////////////////////////////////////////////////////////////////////////
+void LargeDataSet::Key::Update() const
+{
+    Packet * p = ( (Packet *)(&mKey) );
+    p->Clear();
+    p->Reserve(UINT_SIZE + USHORT_SIZE + ULONG_SIZE + BYTE_SIZE);
     p->Write(mSourceID.ToUInt());
     p->Write(mMessageCode);
     p->Write(mPresenceVector);
-    p->Write(mIdentifier);
-}
-
-
+    p->Write(mIdentifier);
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Compares key data.
 ///
 ////////////////////////////////////////////////////////////////////////////////////
 bool LargeDataSet::Key::operator<(const LargeDataSet::Key& key) const
-{
-    Update();
-    key.Update();
+{
+    Update();
+    key.Update();
 
     if(memcmp(mKey.Ptr(), key.mKey.Ptr(), mKey.Length()) < 0)
     {
         return true;
     }
     return false;
-}
-
-
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Compares key data.
 ///
 ////////////////////////////////////////////////////////////////////////////////////
 bool LargeDataSet::Key::operator<=(const LargeDataSet::Key& key) const
-{
-    Update();
+{
+    Update();
     key.Update();
 
     if(memcmp(mKey.Ptr(), key.mKey.Ptr(), mKey.Length()) <= 0)
@@ -134,69 +135,83 @@ bool LargeDataSet::Key::operator<=(const LargeDataSet::Key& key) const
         return true;
     }
     return false;
-}
-
-
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Compares key data.
 ///
-////////////////////////////////////////////////////////////////////////////////////
-LargeDataSet::Key& LargeDataSet::Key::operator=(const LargeDataSet::Key& key)
-{
-    if(this != &key)
-    {
-        mSourceID = key.mSourceID;
-        mMessageCode = key.mMessageCode;
-        mPresenceVector = key.mPresenceVector;
-        mIdentifier = key.mIdentifier;
-        mKey = key.mKey;
-    }
-    return *this;
-}
-
-
+////////////////////////////////////////////////////////////////////////////////////
+LargeDataSet::Key& LargeDataSet::Key::operator=(const LargeDataSet::Key& key)
+{
+    if(this != &key)
+    {
+        mSourceID = key.mSourceID;
+        mMessageCode = key.mMessageCode;
+        mPresenceVector = key.mPresenceVector;
+        mIdentifier = key.mIdentifier;
+        mKey = key.mKey;
+    }
+    return *this;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Constructor.
 ///
-////////////////////////////////////////////////////////////////////////////////////
-LargeDataSet::LargeDataSet()
-{
-    mCompleteFlag = false;
-    mUpdateTimeMs = 0;
-    mMessageCode = 0;
-    mHaveLastFlag = false;
-}
-
-
+////////////////////////////////////////////////////////////////////////////////////
+LargeDataSet::LargeDataSet()
+{
+    mCompleteFlag = false;
+    mUpdateTimeMs = 0;
+    mMessageCode = 0;
+    mHaveLastFlag = false;
+    mHaveFirstFlag = false;
+    mFirstSequenceNumber = mLastSequenceNumber = 0;
+    mPacketDataSize = 0;
+    mNumReceived = 0;
+    mNackTimeMs = 0;
+    mNumNacks = 0;
+    mMemoryLimit = 0;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Destructor.
 ///
-////////////////////////////////////////////////////////////////////////////////////
-LargeDataSet::~LargeDataSet()
-{
-}
-
-
+////////////////////////////////////////////////////////////////////////////////////
+LargeDataSet::~LargeDataSet()
+{
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Clears contents of LDS.
 ///
-////////////////////////////////////////////////////////////////////////////////////
-void LargeDataSet::Clear()
-{
-    mHeader = Header();
-    mMessageCode = 0;
-    mHaveLastFlag = false;
-    mCompleteFlag = false;
-    mStream.clear();
-    mMissing.clear();
-    mUpdateTimeMs = 0;
-}
-
-
+////////////////////////////////////////////////////////////////////////////////////
+void LargeDataSet::Clear()
+{
+    mHeader = Header();
+    mMessageCode = 0;
+    mHaveLastFlag = false;
+    mCompleteFlag = false;
+    mHaveFirstFlag = false;
+    mFirstSequenceNumber = mLastSequenceNumber = 0;
+    mPacketDataSize = 0;
+    mNumReceived = 0;
+    mReceived.clear();
+    mBuffer.Clear();
+    mStream.clear();
+    mUpdateTimeMs = 0;
+    mNackTimeMs = 0;
+    mNumNacks = 0;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Adds a multi-stream packet to the data set.
@@ -205,386 +220,822 @@ void LargeDataSet::Clear()
 ///
 ///   \return True if added, false otherwise.
 ///
-////////////////////////////////////////////////////////////////////////////////////
-bool LargeDataSet::AddPacket(const Packet& message)
-{
-    Header header;
-    UShort messageCode;
-    message.SetReadPos(0);
-    if(header.Read(message) &&
-       message.Read(messageCode))
-    {
-        if(header.mControlFlag != Header::DataControl::Single)
-        {
-            return AddPacket(header, messageCode, message);
-        }
-    }
-    return false;
-}
-
-
+////////////////////////////////////////////////////////////////////////////////////
+bool LargeDataSet::AddPacket(const Packet& message)
+{
+    Header header;
+    UShort messageCode;
+    message.SetReadPos(0);
+    if(header.Read(message) &&
+       message.Read(messageCode))
+    {
+        if(header.mControlFlag != Header::DataControl::Single)
+        {
+            return AddPacket(header, messageCode, message);
+        }
+    }
+    return false;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Adds a multi-stream packet to the data set.
 ///
+///   The packet data is copied to its final position in the merged buffer.
+///   If the first packet of the sequence has not been received yet, the 
+///   packet is held until it arrives.
+///
 ///   \param[in] header Message header data.
 ///   \param[in] messageCode Message type.
 ///   \param[in] packet Serialized JAUS message data.
 ///
 ///   \return True if added, false otherwise.
 ///
-////////////////////////////////////////////////////////////////////////////////////
-bool LargeDataSet::AddPacket(const Header& header, 
-                             const UShort messageCode, 
-                             const Packet& packet)
-{
-    if(header.mControlFlag == Header::DataControl::Single || mCompleteFlag)
-    {
-        return false; // Not multi-packet stream.
-    }
-    if(mStream.size() == 0)
-    {
-        mMessageCode = messageCode;
-        mHeader.mSourceID = header.mSourceID;
-        mHeader.mDestinationID = header.mDestinationID;
-        mHeader.mSequenceNumber = header.mSequenceNumber;
-        /*
-        for(UShort m = 0; m < header.mSequenceNumber; m++)
-        {
-            mMissing.insert(m);
-        }
-        */
-        mStream[header.mSequenceNumber] = packet;
-        mUpdateTimeMs = Time::GetUtcTimeMs();
-        return true;
-    }
-    
-    if(messageCode != mMessageCode || 
-       header.mSourceID != mHeader.mSourceID)
-    {
-        return false; // Wrong data set.
-    }
-    /*
-    std::set<UShort>::iterator m;
-    // Update count of packets missing.
-    if(header.mSequenceNumber > mHeader.mSequenceNumber)
-    {
-        for(UShort n = mHeader.mSequenceNumber + 1; n < header.mSequenceNumber; n++)
-        {
-            mMissing.insert(n);
-        }
-        mHeader.mSequenceNumber = header.mSequenceNumber;
-    }
-    else
-    {
-        m = mMissing.find(header.mSequenceNumber);
-        if(m == mMissing.end())
-        {
-            return false; // This packet is not missing from the data set.
-        }
-        else
-        {
-            // Remove found data.
-            mMissing.erase(m);
-        }
-    }
-    */
-
-    if(header.mControlFlag == Header::DataControl::Last)
-    {
-        mHaveLastFlag = true;
-    }
-
-    mStream[header.mSequenceNumber] = packet;
-    if(/*mMissing.size() == 0 && */mHaveLastFlag)
-    {
-        // See if all the data is present.
-        Stream::iterator p;
-        UShort prevSequenceNumber = 0;
-        bool first = true;
-        mCompleteFlag = true;
-        for(p = mStream.begin(); p != mStream.end(); p++)
-        {
-            if(first)
-            {
-                first = false;
-            }
-            else if(prevSequenceNumber + 1 != p->first)
-            {
-                mCompleteFlag = false;
-                break;
-            }
-            prevSequenceNumber = p->first;
-        }
-    }
-    mUpdateTimeMs = Time::GetUtcTimeMs();
-    return true;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////////
-///
-///   \brief Generates a multi-packet sequence following the rules of the
-///          JAUS standard given a large data set.
-///
-///   \param[in] header Message header data to use (e.g. src/dest/priority).
-///   \param[in] messageCode Message type (payload type).
-///   \param[in] payload Message payload data.
-///   \param[out] stream Multi-packet stream sequence constructed.
-///   \param[out] streamHeaders headers for the stream sequence constructed.
-///   \param[in] transportHeader Additional transport header data to add
-///                              to each packet for the transport layer. The
-///                              typical value is 0x02 for JUDP.
-///   \param[in] maxPayloadSize This is maximum allowed size for each packet
+////////////////////////////////////////////////////////////////////////////////////
+bool LargeDataSet::AddPacket(const Header& header, 
+                             const UShort messageCode, 
+                             const Packet& packet)
+{
+    if(header.mControlFlag == Header::DataControl::Single || mCompleteFlag)
+    {
+        return false; // Not multi-packet stream.
+    }
+    if(header.mSize < Header::MinSize + USHORT_SIZE || packet.Length() < header.mSize)
+    {
+        return false; // Bad packet.
+    }
+    if(mHaveFirstFlag == false && mStream.size() == 0)
+    {
+        mMessageCode = messageCode;
+        mHeader.mSourceID = header.mSourceID;
+        mHeader.mDestinationID = header.mDestinationID;
+        mHeader.mSequenceNumber = header.mSequenceNumber;
+    }
+    else if(messageCode != mMessageCode || 
+            header.mSourceID != mHeader.mSourceID)
+    {
+        return false; // Wrong data set.
+    }
+
+    bool result = false;
+    if(header.mControlFlag == Header::DataControl::First)
+    {
+        if(mHaveFirstFlag)
+        {
+            return false; // Already have start of sequence.
+        }
+        mHaveFirstFlag = true;
+        mFirstSequenceNumber = header.mSequenceNumber;
+        mPacketDataSize = header.mSize - (Header::MinSize + USHORT_SIZE);
+        mHeader.mPriorityFlag = header.mPriorityFlag;
+        mHeader.mMessageType = header.mMessageType;
+        mNumReceived = 0;
+        mReceived.clear();
+        mBuffer.Clear();
+        // Reserve enough memory for what we have been holding (or the whole
+        // data set if the last packet has already been received).  Sequence
+        // numbers may wrap around, so use the distance from the first packet
+        // (packets more than half the sequence space away are from before it).
+        unsigned int numPackets = 1;
+        Stream::iterator held;
+        for(held = mStream.begin(); held != mStream.end(); held++)
+        {
+            UShort span = (UShort)(held->first - mFirstSequenceNumber);
+            if(span < 0x8000 && (unsigned int)span + 1 > numPackets)
+            {
+                numPackets = (unsigned int)span + 1;
+            }
+        }
+        unsigned int size = DataOffset + mPacketDataSize*numPackets + USHORT_SIZE;
+        if(mMemoryLimit > 0 && size > mMemoryLimit)
+        {
+            size = mMemoryLimit;
+        }
+        mBuffer.Reserve(size);
+        result = CopyPacket(header, packet);
+        // Copy any packets received before the first.
+        for(held = mStream.begin(); held != mStream.end() && mCompleteFlag == false; held++)
+        {
+            Header heldHeader;
+            held->second.SetReadPos(0);
+            if(heldHeader.Read(held->second))
+            {
+                CopyPacket(heldHeader, held->second);
+            }
+        }
+        mStream.clear();
+    }
+    else if(mHaveFirstFlag == false)
+    {
+        if(mMemoryLimit > 0 && 
+           mStream.find(header.mSequenceNumber) == mStream.end() &&
+           GetMemoryUsage() + header.mSize > mMemoryLimit)
+        {
+            return false; // Holding too much.
+        }
+        // Hold until we know where this goes (only keep the
+        // JAUS message, not any transport data before it).
+        Packet& held = mStream[header.mSequenceNumber];
+        held.Clear();
+        held.Write(packet.Ptr() + packet.Length() - header.mSize, header.mSize);
+        result = true;
+    }
+    else
+    {
+        result = CopyPacket(header, packet);
+    }
+
+    mUpdateTimeMs = Time::GetUtcTimeMs();
+    return result;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gets the amount of memory used to store the data set.
+///
+///   \return Number of bytes allocated for the data set.
+///
+////////////////////////////////////////////////////////////////////////////////////
+unsigned int LargeDataSet::GetMemoryUsage() const
+{
+    unsigned int total = mBuffer.Reserved() + (unsigned int)(mReceived.capacity()/8);
+    Stream::const_iterator held;
+    for(held = mStream.begin(); held != mStream.end(); held++)
+    {
+        total += held->second.Reserved();
+    }
+    return total;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gets the sequence numbers of packets missing from the data set,
+///          used to request retransmission of them.
+///
+///   Ranges are inclusive and may wrap around.  If the first (or last)
+///   packet of the sequence has not been received, the range before (or
+///   after) the packets received extends half the sequence number space,
+///   so the sender must limit it to the packets it sent.
+///
+///   \param[out] reference Sequence number of a packet received, used by
+///                         the sender to identify the data set.
+///   \param[out] ranges Pairs of sequence numbers [from, to] missing.
+///   \param[in] maxRanges Maximum number of ranges to get.
+///
+///   \return True if packets are missing, false otherwise.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool LargeDataSet::GetMissingPackets(UShort& reference,
+                                     std::vector<UShort>& ranges,
+                                     const unsigned int maxRanges) const
+{
+    ranges.clear();
+    if(mCompleteFlag)
+    {
+        return false;
+    }
+
+    // Get sequence numbers received in order.
+    std::vector<UShort> have;
+    bool haveLast = false;
+    if(mHaveFirstFlag)
+    {
+        for(unsigned int i = 0; i < (unsigned int)mReceived.size(); i++)
+        {
+            if(mReceived[i])
+            {
+                have.push_back((UShort)(mFirstSequenceNumber + i));
+            }
+        }
+        haveLast = mHaveLastFlag;
+    }
+    else
+    {
+        // Order by distance from the first packet added, handling wrap around.
+        std::map<int, UShort> ordered;
+        Stream::const_iterator held;
+        for(held = mStream.begin(); held != mStream.end(); held++)
+        {
+            Header heldHeader;
+            held->second.SetReadPos(0);
+            if(heldHeader.Read(held->second) && heldHeader.mControlFlag == Header::DataControl::Last)
+            {
+                haveLast = true;
+            }
+            ordered[(Short)(held->first - mHeader.mSequenceNumber)] = held->first;
+        }
+        std::map<int, UShort>::iterator o;
+        for(o = ordered.begin(); o != ordered.end(); o++)
+        {
+            have.push_back(o->second);
+        }
+    }
+    if(have.size() == 0)
+    {
+        return false;
+    }
+    reference = have.front();
+
+    if(mHaveFirstFlag == false)
+    {
+        ranges.push_back((UShort)(have.front() - 0x8000));
+        ranges.push_back((UShort)(have.front() - 1));
+    }
+    for(unsigned int i = 1; i < (unsigned int)have.size() && ranges.size() < maxRanges*2; i++)
+    {
+        if((UShort)(have[i] - have[i - 1]) > 1)
+        {
+            ranges.push_back((UShort)(have[i - 1] + 1));
+            ranges.push_back((UShort)(have[i] - 1));
+        }
+    }
+    if(ranges.size() < maxRanges*2)
+    {
+        if(haveLast == false)
+        {
+            ranges.push_back((UShort)(have.back() + 1));
+            ranges.push_back((UShort)(have.back() + 0x7FFF));
+        }
+        else if(mHaveFirstFlag && have.back() != mLastSequenceNumber)
+        {
+            ranges.push_back((UShort)(have.back() + 1));
+            ranges.push_back(mLastSequenceNumber);
+        }
+    }
+    return ranges.size() > 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Copies packet data to its position in the merged buffer, which
+///          requires the first packet of the sequence to have been received.
+///
+///   When all packets have been copied, the header and message code are
+///   written to the start of the buffer and the data set is complete.
+///
+///   \param[in] header Message header data for the packet.
+///   \param[in] packet Serialized JAUS message data (header ends the packet).
+///
+///   \return True if added, false otherwise.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool LargeDataSet::CopyPacket(const Header& header, const Packet& packet)
+{
+    if(header.mSize < Header::MinSize + USHORT_SIZE || packet.Length() < header.mSize)
+    {
+        return false;
+    }
+    unsigned int index = (UShort)(header.mSequenceNumber - mFirstSequenceNumber);
+    unsigned int dataSize = header.mSize - (Header::MinSize + USHORT_SIZE);
+    unsigned int offset = DataOffset + index*mPacketDataSize;
+
+    // The sequence number comes from the sender, so reject any index that
+    // would need more memory than allowed before reserving it.
+    if(mMemoryLimit > 0 && offset + dataSize + USHORT_SIZE > mMemoryLimit)
+    {
+        return false;
+    }
+
+    if(header.mControlFlag == Header::DataControl::Last)
+    {
+        if(mHaveLastFlag || dataSize > mPacketDataSize)
+        {
+            return false;
+        }
+        mHaveLastFlag = true;
+        mLastSequenceNumber = header.mSequenceNumber;
+        // We now know the exact size of the message.
+        mBuffer.Reserve(DataOffset + index*mPacketDataSize + dataSize + USHORT_SIZE);
+    }
+    else if(dataSize != mPacketDataSize)
+    {
+        return false; // Only the last packet may be a different size.
+    }
+    if(mHaveLastFlag && index > (UShort)(mLastSequenceNumber - mFirstSequenceNumber))
+    {
+        return false; // Beyond the end of the sequence.
+    }
+    if(index < (unsigned int)mReceived.size() && mReceived[index])
+    {
+        return true; // Duplicate.
+    }
+
+    if(offset + dataSize > mBuffer.Length())
+    {
+        // Grow geometrically until the size is known from the last packet.
+        if(mHaveLastFlag == false && offset + dataSize > mBuffer.Reserved())
+        {
+            unsigned int size = 2*(offset + dataSize);
+            if(mMemoryLimit > 0 && size > mMemoryLimit)
+            {
+                size = mMemoryLimit;
+            }
+            mBuffer.Reserve(size);
+        }
+        mBuffer.SetLength(offset + dataSize);
+    }
+    const unsigned char* data = packet.Ptr() + packet.Length() - header.mSize + DataOffset;
+    mBuffer.Write(data, dataSize, offset);
+
+    if(index >= (unsigned int)mReceived.size())
+    {
+        mReceived.resize(index + 1, false);
+    }
+    mReceived[index] = true;
+    mNumReceived++;
+
+    if(mHaveLastFlag && mNumReceived == (unsigned int)(UShort)(mLastSequenceNumber - mFirstSequenceNumber) + 1)
+    {
+        if(mHeader.mMessageType == Header::MessageType::Compressed)
+        {
+            mHeader.mMessageType = Header::MessageType::Normal;
+            // Decompressed data counts against the memory limit too.
+            unsigned int maxSize = MaxDecompressedSize;
+            if(mMemoryLimit > 0)
+            {
+                unsigned int used = GetMemoryUsage();
+                maxSize = used < mMemoryLimit ? mMemoryLimit - used : 0;
+            }
+            if(DecompressMergedPayload(mBuffer, maxSize) == false)
+            {
+                // Bad data, complete with nothing to read so it is discarded.
+                mBuffer.Clear();
+                mReceived.clear();
+                mCompleteFlag = true;
+                return false;
+            }
+        }
+        // Write the header and message code to the front of the buffer, using
+        // the same layout as MergeLargeDataSet.
+        Packet front;
+        mHeader.mSize = Header::MinSize;
+        mHeader.mAckNackFlag = Header::AckNack::None;
+        mHeader.mControlFlag = Header::DataControl::Single;
+        mHeader.mSequenceNumber = mLastSequenceNumber;
+        mHeader.Write(front);
+        front.SetWritePos(Header::PayloadOffset);
+        front.Write(mMessageCode);
+        mBuffer.Write(front.Ptr(), DataOffset, 0);
+        mBuffer.SetWritePos(mBuffer.Length());
+        mBuffer.SetReadPos(0);
+        mReceived.clear();
+        mCompleteFlag = true;
+    }
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Generates a multi-packet sequence following the rules of the
+///          JAUS standard given a large data set.
+///
+///   \param[in] header Message header data to use (e.g. src/dest/priority).
+///   \param[in] messageCode Message type (payload type).
+///   \param[in] payload Message payload data.
+///   \param[out] stream Multi-packet stream sequence constructed.  Packets
+///                      already in the stream are written over in place, so
+///                      re-using a stream does not allocate memory.
+///   \param[out] streamHeaders headers for the stream sequence constructed.
+///   \param[in] transportHeader Additional transport header data to add
+///                              to each packet for the transport layer. The
+///                              typical value is 0x02 for JUDP.
+///   \param[in] maxPayloadSize This is maximum allowed size for each packet
 ///                             payload (data only).  This value does not include
 ///                             transport size, General Transport Header, or message
 ///                             code size.
 ///   \param[in] startingSequenceNumber The starting sequence number to use for
 ///                                     messages. Default is 0.
+///   \param[in] compressionThreshold If non-zero, payloads of at least this
+///                                   many bytes are compressed (only used if
+///                                   the compressed data is smaller).
+///
+////////////////////////////////////////////////////////////////////////////////////
+void LargeDataSet::CreateLargeDataSet(const Header& header,
+                                      const UShort messageCode,
+                                      const Packet& payload,
+                                      Packet::List& stream,
+                                      Header::List& streamHeaders,
+                                      const Packet* transportHeader,
+                                      const UShort maxPayloadSize,
+                                      const UShort startingSequenceNumber,
+                                      const unsigned int compressionThreshold)
+{
+    Header sHeader(header);
+    Packet compressed;
+    const Packet* data = &payload;              // Payload data sent (may be compressed).
+    unsigned int packetSize = maxPayloadSize;   // Size of payload data in each packet.
+
+    sHeader.mMessageType = Header::MessageType::Normal;
+    if(compressionThreshold > 0 &&
+       payload.Length() >= compressionThreshold &&
+       CompressPayload(payload, compressed) &&
+       compressed.Length() < payload.Length())
+    {
+        data = &compressed;
+        sHeader.mMessageType = Header::MessageType::Compressed;
+        // A compressed payload is always sent as a multi-packet
+        // stream, so split it in two if it fits in a single packet.
+        if(compressed.Length() <= packetSize)
+        {
+            packetSize = (compressed.Length() + 1)/2;
+        }
+    }
+    
+    unsigned int total = 0;                     // Total number of bytes in payload converted.
+    unsigned int toWrite = 0;                   // How much data to write for a given packet.
+    const unsigned char* ptr = data->Ptr();     // Pointer to payload data to write.
+    unsigned int transportHeaderSize = transportHeader ? transportHeader->Length() : 0;
+    unsigned int count = 0;                     // Number of packets written.
+
+    sHeader.mSequenceNumber = startingSequenceNumber;
+
+    while(total < data->Length())
+    {
+        // Set the data control flags.
+        if(sHeader.mSequenceNumber == startingSequenceNumber)
+        {
+            sHeader.mControlFlag = Header::DataControl::First;
+        }
+        else
+        {
+            sHeader.mControlFlag = Header::DataControl::Normal;
+        }
+        // Calculate the amount of data being written.
+        toWrite = packetSize;
+        if(total + toWrite >= data->Length())
+        {
+            toWrite = data->Length() - total;
+            // Check for last packet in sequence or if
+            // this is not really a large data set.
+            if(sHeader.mSequenceNumber != startingSequenceNumber)
+            {
+                sHeader.mControlFlag = Header::DataControl::Last;
+            }
+            else
+            {
+                sHeader.mControlFlag = Header::DataControl::Single;
+            }
+        }
+        sHeader.mSize = (UShort)(Header::MinSize + USHORT_SIZE + toWrite);
+        // Write in place over packets already in the stream.
+        if(count == (unsigned int)stream.size())
+        {
+            stream.push_back(Packet());
+            streamHeaders.push_back(sHeader);
+        }
+        Packet& sPacket = stream[count];
+        sPacket.Clear(false);
+        if(sPacket.Reserved() < packetSize + Header::MinSize + transportHeaderSize + USHORT_SIZE)
+        {
+            sPacket.Reserve(packetSize + Header::MinSize + transportHeaderSize + USHORT_SIZE);
+        }
+        if(transportHeaderSize > 0)
+        {
+            sPacket.Write(*transportHeader);  //  Transport Header.
+        }
+        sHeader.Write(sPacket);              //  General Transport Header.
+        sPacket.Write(messageCode);          //  Message type.
+        total += (unsigned int)sPacket.Write((unsigned char *)(ptr), toWrite); // Write payload data
+        streamHeaders[count] = sHeader;      //  Header of packet in sequence.
+        count++;
+        ptr += toWrite;                      //  Advance the pointer.
+        sHeader.mSequenceNumber++;           //  Increase the sequence number.        
+    }
+    // Remove packets left from a longer stream.
+    stream.resize(count);
+    streamHeaders.resize(count);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Generates a multi-packet sequence following the rules of the
+///          JAUS standard given a large data set.
+///
+///   \param[out] header Message header data to use (e.g. src/dest/priority).
+///   \param[out] messageCode Message type (payload type).
+///   \param[out] payload Message payload data.
+///   \param[in] stream Multi-packet stream sequence constructed.
+///   \param[in] transportHeader Additional transport header data to add
+///                              to each packet for the transport layer. The
+///                              typical value is 0x02 for JUDP.
 ///
-////////////////////////////////////////////////////////////////////////////////////
-void LargeDataSet::CreateLargeDataSet(const Header& header,
-                                      const UShort messageCode,
-                                      const Packet& payload,
-                                      Packet::List& stream,
-                                      Header::List& streamHeaders,
-                                      const Packet* transportHeader,
-                                      const UShort maxPayloadSize,
-                                      const UShort startingSequenceNumber)
-{
-    stream.clear();
-    streamHeaders.clear();
-
-    Header sHeader(header);
-    Packet sPacket;
-    
-    unsigned int total = 0;                     // Total number of bytes in payload converted.
-    unsigned int toWrite = 0;                   // How much data to write for a given packet.
-    const unsigned char* ptr = payload.Ptr();   // Pointer to payload data to write.
-    unsigned int transportHeaderSize = transportHeader ? transportHeader->Length() : 0;
-
-    // Reserve memory for data
-    sPacket.Reserve(maxPayloadSize + Header::MinSize + transportHeaderSize + USHORT_SIZE);
-    sHeader.mSequenceNumber = startingSequenceNumber;
-
-    while(total < payload.Length())
-    {
-        // Set the data control flags.
-        if(sHeader.mSequenceNumber == startingSequenceNumber)
-        {
-            sHeader.mControlFlag = Header::DataControl::First;
-        }
-        else
-        {
-            sHeader.mControlFlag = Header::DataControl::Normal;
-        }
-        // Calculate the amount of data being written.
-        toWrite = maxPayloadSize;
-        if(total + toWrite > payload.Length())
-        {
-            toWrite = payload.Length() - total;
-            // Check for last packet in sequence or if
-            // this is not really a large data set.
-            if(sHeader.mSequenceNumber != 0)
-            {
-                sHeader.mControlFlag = Header::DataControl::Last;
-            }
-            else
-            {
-                sHeader.mControlFlag = Header::DataControl::Single;
-            }
-        }
-        sHeader.mSize = (UShort)(Header::MinSize + USHORT_SIZE + toWrite);
-        // Clear the stream packet
-        sPacket.Clear();
-        if(transportHeaderSize > 0)
-        {
-            sPacket.Write(*transportHeader);  //  Transport Header.
-        }
-        sHeader.Write(sPacket);              //  General Transport Header.
-        sPacket.Write(messageCode);          //  Message type.
-        total += (unsigned int)sPacket.Write((unsigned char *)(ptr), toWrite); // Write payload data
-        stream.push_back(sPacket);           //  Add to multi-packet sequence.
-        streamHeaders.push_back(sHeader);    //  Add header to sequence.
-        ptr += toWrite;                      //  Advance the pointer.
-        sHeader.mSequenceNumber++;           //  Increase the sequence number.        
-    }
-}
-
-
-////////////////////////////////////////////////////////////////////////////////////
-///
-///   \brief Generates a multi-packet sequence following the rules of the
-///          JAUS standard given a large data set.
-///
-///   \param[out] header Message header data to use (e.g. src/dest/priority).
-///   \param[out] messageCode Message type (payload type).
-///   \param[out] payload Message payload data.
-///   \param[in] stream Multi-packet stream sequence constructed.
-///   \param[in] transportHeader Additional transport header data to add
-///                              to each packet for the transport layer. The
-///                              typical value is 0x02 for JUDP.
-///
 ///   \return true on success, false on failure.
 ///
-////////////////////////////////////////////////////////////////////////////////////
-bool LargeDataSet::MergeLargeDataSet(Header& header,
-                                     UShort& messageCode,
-                                     Packet& payload,
-                                     const Packet::List& stream,
-                                     const Packet* transportHeader)
-{
-    Header sHeader;
-    Packet::List::const_iterator sPacket;
-    UShort sequenceNumber = 0;
-    std::map<UShort, const Packet*> orderedPackets;
-    std::map<UShort, Header> orderedHeaders;
-
-    // Clear data.
-    header.mSize = Header::MinSize;
-    header.mAckNackFlag = Header::AckNack::None;
-    header.mSequenceNumber = 0;
-    header.mControlFlag = Header::DataControl::Single;
-    payload.Clear();
-    
-    unsigned int transportHeaderSize = transportHeader ? transportHeader->Length() : 0;
-    for(sPacket = stream.begin(); sPacket != stream.end(); sPacket++)
-    {
-        // Read after the transport header (don't do validation).
-        if(transportHeaderSize > 0)
-        {
-            sPacket->SetReadPos(transportHeaderSize);
-        }
-        else
-        {
-            sPacket->SetReadPos(0);
-        }
-        if(sHeader.Read(*sPacket) && sPacket->Read(messageCode))
-        {
-            orderedPackets[sHeader.mSequenceNumber] = &(*sPacket);
-            orderedHeaders[sHeader.mSequenceNumber] = sHeader;
-        }
-        else
-        {
-            payload.Clear();
-            break;
-        }
-    }
-    if(stream.size() == orderedPackets.size())
-    {
-        std::map<UShort, const Packet*>::iterator data;
-        std::map<UShort, Header>::iterator dataHeader;
-
-        bool first = true;
-        UShort prevSequenceNumber = 0;
-        for(data = orderedPackets.begin(), dataHeader = orderedHeaders.begin(); 
-            data != orderedPackets.end() && dataHeader != orderedHeaders.end(); 
-            data++, dataHeader++)
-        {
-            if(first)
-            {
-                if(dataHeader->second.mControlFlag != Header::DataControl::First)
-                {
-                    break;
-                }
-                header.mSourceID = dataHeader->second.mSourceID;
-                header.mDestinationID = dataHeader->second.mDestinationID;
-                header.mPriorityFlag = dataHeader->second.mPriorityFlag;
-                header.Write(payload);
-                payload.Write(messageCode);
-                first = false;
-            }
-            else if(prevSequenceNumber + 1 != data->first)
-            {
-                break;
-            }
-            prevSequenceNumber = header.mSequenceNumber = data->first;
-            // Write the data to the payload.
-            payload.Write((unsigned char *)(data->second->Ptr() + data->second->GetReadPos()), 
-                                            dataHeader->second.mSize - (Header::MinSize + USHORT_SIZE));
-        }
-    }
-    
-    return payload.Length() > 0;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////////
-///
-///   \brief Generates a multi-packet sequence following the rules of the
-///          JAUS standard given a large data set.
-///
-///   \param[out] header Message header data to use (e.g. src/dest/priority).
-///   \param[out] messageCode Message type (payload type).
-///   \param[out] payload Message payload data.
-///   \param[in] stream Multi-packet stream sequence constructed.
-///   \param[in] transportHeader Additional transport header data to add
-///                              to each packet for the transport layer. The
-///                              typical value is 0x02 for JUDP.
-///
+////////////////////////////////////////////////////////////////////////////////////
+bool LargeDataSet::MergeLargeDataSet(Header& header,
+                                     UShort& messageCode,
+                                     Packet& payload,
+                                     const Packet::List& stream,
+                                     const Packet* transportHeader)
+{
+    Header sHeader;
+    Packet::List::const_iterator sPacket;
+    UShort sequenceNumber = 0;
+    std::map<UShort, const Packet*> orderedPackets;
+    std::map<UShort, Header> orderedHeaders;
+    bool compressedFlag = false;
+
+    // Clear data.
+    header.mSize = Header::MinSize;
+    header.mAckNackFlag = Header::AckNack::None;
+    header.mSequenceNumber = 0;
+    header.mControlFlag = Header::DataControl::Single;
+    payload.Clear();
+    
+    unsigned int transportHeaderSize = transportHeader ? transportHeader->Length() : 0;
+    for(sPacket = stream.begin(); sPacket != stream.end(); sPacket++)
+    {
+        // Read after the transport header (don't do validation).
+        if(transportHeaderSize > 0)
+        {
+            sPacket->SetReadPos(transportHeaderSize);
+        }
+        else
+        {
+            sPacket->SetReadPos(0);
+        }
+        if(sHeader.Read(*sPacket) && sPacket->Read(messageCode))
+        {
+            orderedPackets[sHeader.mSequenceNumber] = &(*sPacket);
+            orderedHeaders[sHeader.mSequenceNumber] = sHeader;
+        }
+        else
+        {
+            payload.Clear();
+            break;
+        }
+    }
+    if(stream.size() == orderedPackets.size())
+    {
+        std::map<UShort, const Packet*>::iterator data;
+        std::map<UShort, Header>::iterator dataHeader;
+
+        bool first = true;
+        UShort prevSequenceNumber = 0;
+        for(data = orderedPackets.begin(), dataHeader = orderedHeaders.begin(); 
+            data != orderedPackets.end() && dataHeader != orderedHeaders.end(); 
+            data++, dataHeader++)
+        {
+            if(first)
+            {
+                if(dataHeader->second.mControlFlag != Header::DataControl::First)
+                {
+                    break;
+                }
+                header.mSourceID = dataHeader->second.mSourceID;
+                header.mDestinationID = dataHeader->second.mDestinationID;
+                header.mPriorityFlag = dataHeader->second.mPriorityFlag;
+                header.Write(payload);
+                payload.Write(messageCode);
+                compressedFlag = dataHeader->second.mMessageType == Header::MessageType::Compressed;
+                first = false;
+            }
+            else if(prevSequenceNumber + 1 != data->first)
+            {
+                break;
+            }
+            prevSequenceNumber = header.mSequenceNumber = data->first;
+            // Write the data to the payload.
+            payload.Write((unsigned char *)(data->second->Ptr() + data->second->GetReadPos()), 
+                                            dataHeader->second.mSize - (Header::MinSize + USHORT_SIZE));
+        }
+    }
+    if(compressedFlag && DecompressMergedPayload(payload) == false)
+    {
+        payload.Clear();
+    }
+    
+    return payload.Length() > 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Generates a multi-packet sequence following the rules of the
+///          JAUS standard given a large data set.
+///
+///   \param[out] header Message header data to use (e.g. src/dest/priority).
+///   \param[out] messageCode Message type (payload type).
+///   \param[out] payload Message payload data.
+///   \param[in] stream Multi-packet stream sequence constructed.
+///   \param[in] transportHeader Additional transport header data to add
+///                              to each packet for the transport layer. The
+///                              typical value is 0x02 for JUDP.
+///
 ///   \return true on success, false on failure.
 ///
-////////////////////////////////////////////////////////////////////////////////////
-bool LargeDataSet::MergeLargeDataSet(Header& header,
-                                     UShort& messageCode,
-                                     Packet& payload,
-                                     const Stream& stream,
-                                     const Packet* transportHeader)
-{
-    Header sHeader;
-    Stream::const_iterator sPacket;
-    UShort prevSequenceNumber = 0;
-    
-    // Clear data.
-    header.mSize = Header::MinSize;
-    header.mAckNackFlag = Header::AckNack::None;
-    header.mSequenceNumber = 0;
-    header.mControlFlag = Header::DataControl::Single;
-    payload.Clear();
-    
-    bool first = true;
-    unsigned int transportHeaderSize = transportHeader ? transportHeader->Length() : 0;
-    for(sPacket = stream.begin(); sPacket != stream.end(); sPacket++)
-    {
-        // Read after the transport header (don't do validation).
-        if(transportHeaderSize > 0)
-        {
-            sPacket->second.SetReadPos(transportHeaderSize);
-        }
-        else
-        {
-            sPacket->second.SetReadPos(0);
-        }
-        if(sHeader.Read(sPacket->second) && sPacket->second.Read(messageCode))
-        {
-            if(first)
-            {
-                header.mSourceID = sHeader.mSourceID;
-                header.mDestinationID = sHeader.mDestinationID;
-                header.mPriorityFlag = sHeader.mPriorityFlag;
-                header.Write(payload);
-                payload.Write(messageCode);
-                first = false;
-            }
-            // Check for out of order data.
-            else if(prevSequenceNumber + 1 != sHeader.mSequenceNumber)
-            {
-                payload.Clear();
-                break;
-            }
-            // Write the data to the payload.
-            payload.Write((unsigned char *)(sPacket->second.Ptr() + sPacket->second.GetReadPos()), 
-                                            sHeader.mSize - (Header::MinSize + USHORT_SIZE));
-            header.mSequenceNumber = prevSequenceNumber = sHeader.mSequenceNumber;
-        }
-        else
-        {
-            payload.Clear();
-            break;
-        }
-    }
-
-    return payload.Length() > 0;
-}
-
-/*  End of File */
+////////////////////////////////////////////////////////////////////////////////////
+bool LargeDataSet::MergeLargeDataSet(Header& header,
+                                     UShort& messageCode,
+                                     Packet& payload,
+                                     const Stream& stream,
+                                     const Packet* transportHeader)
+{
+    Header sHeader;
+    Stream::const_iterator sPacket;
+    UShort prevSequenceNumber = 0;
+    bool compressedFlag = false;
+    
+    // Clear data.
+    header.mSize = Header::MinSize;
+    header.mAckNackFlag = Header::AckNack::None;
+    header.mSequenceNumber = 0;
+    header.mControlFlag = Header::DataControl::Single;
+    payload.Clear();
+    
+    bool first = true;
+    unsigned int transportHeaderSize = transportHeader ? transportHeader->Length() : 0;
+    for(sPacket = stream.begin(); sPacket != stream.end(); sPacket++)
+    {
+        // Read after the transport header (don't do validation).
+        if(transportHeaderSize > 0)
+        {
+            sPacket->second.SetReadPos(transportHeaderSize);
+        }
+        else
+        {
+            sPacket->second.SetReadPos(0);
+        }
+        if(sHeader.Read(sPacket->second) && sPacket->second.Read(messageCode))
+        {
+            if(first)
+            {
+                header.mSourceID = sHeader.mSourceID;
+                header.mDestinationID = sHeader.mDestinationID;
+                header.mPriorityFlag = sHeader.mPriorityFlag;
+                header.Write(payload);
+                payload.Write(messageCode);
+                compressedFlag = sHeader.mMessageType == Header::MessageType::Compressed;
+                first = false;
+            }
+            // Check for out of order data.
+            else if(prevSequenceNumber + 1 != sHeader.mSequenceNumber)
+            {
+                payload.Clear();
+                break;
+            }
+            // Write the data to the payload.
+            payload.Write((unsigned char *)(sPacket->second.Ptr() + sPacket->second.GetReadPos()), 
+                                            sHeader.mSize - (Header::MinSize + USHORT_SIZE));
+            header.mSequenceNumber = prevSequenceNumber = sHeader.mSequenceNumber;
+        }
+        else
+        {
+            payload.Clear();
+            break;
+        }
+    }
+    if(payload.Length() > 0 && compressedFlag && DecompressMergedPayload(payload) == false)
+    {
+        payload.Clear();
+    }
+
+    return payload.Length() > 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Compresses payload data of a large data set using zlib.
+///
+///   \param[in] payload Message payload data.
+///   \param[out] compressed Uncompressed size of the payload (UInt) followed
+///                          by the compressed data.
+///
+///   \return True on success, false on failure.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool LargeDataSet::CompressPayload(const Packet& payload, Packet& compressed)
+{
+    uLongf length = compressBound((uLong)payload.Length());
+
+    compressed.Clear();
+    compressed.Reserve(UINT_SIZE + (unsigned int)length);
+    compressed.Write((UInt)payload.Length());
+    compressed.SetLength(UINT_SIZE + (unsigned int)length);
+    if(compress2(compressed.Ptr() + UINT_SIZE, 
+                 &length, 
+                 payload.Ptr(), 
+                 (uLong)payload.Length(), 
+                 Z_DEFAULT_COMPRESSION) != Z_OK)
+    {
+        compressed.Clear();
+        return false;
+    }
+    compressed.SetLength(UINT_SIZE + (unsigned int)length);
+    compressed.SetWritePos(compressed.Length());
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Decompresses payload data created by CompressPayload.
+///
+///   The uncompressed size is given by the sender, so memory is reserved as
+///   data is actually decompressed rather than all at once.
+///
+///   \param[in] compressed Packet containing compressed data.
+///   \param[in] offset Position of the compressed data (uncompressed size)
+///                     within the packet, data continues to the end of it.
+///   \param[out] payload The decompressed data is added to the end of this
+///                       packet.
+///   \param[in] maxSize Largest uncompressed size accepted (bytes).
+///
+///   \return True on success, false on failure.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool LargeDataSet::DecompressPayload(const Packet& compressed,
+                                     const unsigned int offset,
+                                     Packet& payload,
+                                     const unsigned int maxSize)
+{
+    UInt size = 0;
+    if(compressed.Length() <= offset + UINT_SIZE ||
+       compressed.Read(size, offset) <= 0 ||
+       size == 0 ||
+       size > MaxDecompressedSize ||
+       size > maxSize)
+    {
+        return false;
+    }
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(z_stream));
+    if(inflateInit(&stream) != Z_OK)
+    {
+        return false;
+    }
+    unsigned int inputSize = compressed.Length() - offset - UINT_SIZE;
+    stream.next_in = (Bytef*)(compressed.Ptr() + offset + UINT_SIZE);
+    stream.avail_in = (uInt)inputSize;
+
+    unsigned int start = payload.Length();
+    unsigned int reserved = inputSize < size/4 ? inputSize*4 : size;
+    unsigned int length = 0;
+    int status = Z_OK;
+    while(status == Z_OK)
+    {
+        if(length == reserved)
+        {
+            if(reserved == size)
+            {
+                break; // More data than the size given.
+            }
+            reserved = reserved < size/2 ? reserved*2 : size;
+        }
+        payload.Reserve(start + reserved);
+        payload.SetLength(start + reserved);
+        stream.next_out = payload.Ptr() + start + length;
+        stream.avail_out = (uInt)(reserved - length);
+        status = inflate(&stream, Z_NO_FLUSH);
+        length = reserved - (unsigned int)stream.avail_out;
+    }
+    inflateEnd(&stream);
+
+    if(status != Z_STREAM_END || length != size)
+    {
+        payload.SetLength(start);
+        payload.SetWritePos(start);
+        return false;
+    }
+    payload.SetWritePos(payload.Length());
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Decompresses the payload of a merged large data set in place.
+///
+///   \param[in,out] merged Merged message data (header, message code, 
+///                         compressed payload).
+///   \param[in] maxSize Largest uncompressed payload size accepted (bytes).
+///
+///   \return True on success, false on failure.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool LargeDataSet::DecompressMergedPayload(Packet& merged, const unsigned int maxSize)
+{
+    if(merged.Length() < DataOffset)
+    {
+        return false;
+    }
+    Packet decompressed;
+    decompressed.Write(merged.Ptr(), DataOffset);
+    if(DecompressPayload(merged, DataOffset, decompressed, maxSize) == false)
+    {
+        return false;
+    }
+    merged = decompressed;
+    merged.SetReadPos(0);
+    return true;
+}
+
+/*  End of File */
@@ -0,0 +1,200 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file latencyhistogram.cpp
+///  \brief This file contains the implementation of the LatencyHistogram class
+///  used to measure message delivery latency.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#include "jaus/core/transport/latencyhistogram.h"
+#include <sstream>
+
+using namespace JAUS;
+
+const unsigned int LatencyHistogram::Buckets;
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gets the latency under which a percentage of samples fall.
+///
+///   \param[in] percentile Percent of samples (e.g. 99.9).
+///
+///   \return Upper limit in microseconds of the bucket containing the
+///           percentile (or the max sample if smaller), 0 if no samples.
+///
+////////////////////////////////////////////////////////////////////////////////////
+unsigned int LatencyHistogram::Statistics::GetPercentileUs(const double percentile) const
+{
+    if(mSamples == 0)
+    {
+        return 0;
+    }
+    double target = mSamples*percentile/100.0;
+    unsigned int count = 0;
+    for(unsigned int i = 0; i < (unsigned int)mCounts.size(); i++)
+    {
+        count += mCounts[i];
+        if(count >= target && count > 0)
+        {
+            unsigned int limit = GetBucketLimitUs(i);
+            return limit < mMaxUs ? limit : mMaxUs;
+        }
+    }
+    return mMaxUs;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \return Summary of samples, mean, percentiles, and max latency.
+///
+////////////////////////////////////////////////////////////////////////////////////
+std::string LatencyHistogram::Statistics::ToString() const
+{
+    std::stringstream str;
+    str << "Samples: " << mSamples
+        << " Mean: " << GetMeanUs() << " us"
+        << " 50%: " << GetPercentileUs(50.0) << " us"
+        << " 99%: " << GetPercentileUs(99.0) << " us"
+        << " 99.9%: " << GetPercentileUs(99.9) << " us"
+        << " Max: " << mMaxUs << " us";
+    return str.str();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Constructor, initializes default values.
+///
+////////////////////////////////////////////////////////////////////////////////////
+LatencyHistogram::LatencyHistogram()
+{
+    Clear();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Destructor.
+///
+////////////////////////////////////////////////////////////////////////////////////
+LatencyHistogram::~LatencyHistogram()
+{
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Adds a sample to the histogram.  This method is thread safe.
+///
+///   \param[in] latencySeconds Latency in seconds (negative values count as 0).
+///
+////////////////////////////////////////////////////////////////////////////////////
+void LatencyHistogram::Add(const double latencySeconds)
+{
+    unsigned int us = 0;
+    if(latencySeconds > 0.0)
+    {
+        us = latencySeconds >= 4294.0 ? 4294000000U : (unsigned int)(latencySeconds*1000000.0);
+    }
+    unsigned int bucket = 0;
+    while(bucket < Buckets - 1 && us >= GetBucketLimitUs(bucket))
+    {
+        bucket++;
+    }
+    mCounts[bucket]++;
+    mSamples++;
+    mTotalUs += us;
+    unsigned int current = mMaxUs;
+    while(us > current && !mMaxUs.compare_exchange_weak(current, us))
+    {
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \return Copy of the histogram data.
+///
+////////////////////////////////////////////////////////////////////////////////////
+LatencyHistogram::Statistics LatencyHistogram::GetStatistics() const
+{
+    Statistics stats;
+    for(unsigned int i = 0; i < Buckets; i++)
+    {
+        stats.mCounts[i] = mCounts[i];
+    }
+    stats.mSamples = mSamples;
+    stats.mTotalUs = mTotalUs;
+    stats.mMaxUs = mMaxUs;
+    return stats;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Removes all samples.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void LatencyHistogram::Clear()
+{
+    for(unsigned int i = 0; i < Buckets; i++)
+    {
+        mCounts[i] = 0;
+    }
+    mSamples = 0;
+    mTotalUs = 0;
+    mMaxUs = 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \param[in] bucket Bucket number.
+///
+///   \return Samples in the bucket are less than this value in microseconds.
+///
+////////////////////////////////////////////////////////////////////////////////////
+unsigned int LatencyHistogram::GetBucketLimitUs(const unsigned int bucket)
+{
+    if(bucket >= Buckets - 1)
+    {
+        return 0xFFFFFFFF;
+    }
+    return 1U << bucket;
+}
+
+/*  End of File */
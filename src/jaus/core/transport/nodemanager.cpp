@@ -41,6 +41,7 @@
 #include "jaus/core/transport/udp.h"
 #include "jaus/core/transport/sharedmemory.h"
 #include <tinyxml/tinyxml.h>
+#include <algorithm>
 #include <boost/interprocess/sync/scoped_lock.hpp>
 #include <boost/interprocess/sync/named_mutex.hpp>
 #include <boost/thread.hpp>
@@ -65,6 +66,15 @@ NodeManager::Parameters::Parameters()
     mConnectionsPerThread = 1;
     mMulticastIP = std::string("239.255.0.1");
     mTimeToLive = 16;
+    mSharedMemoryRingsFlag = false;
+    mSharedMemoryWakeupFlag = true;
+    mEventDrivenFlag = false;
+    mEventThreads = Reactor::DefaultThreads;
+    mUdpBatchSize = 0;
+    mUdpHeaderCompressionFlag = false;
+    mRateLimit = 0;
+    mRateLimitBurst = 0;
+    mRateLimitQueueSize = 256*1024;
 }
 
 
@@ -136,6 +146,61 @@ bool NodeManager::Parameters::LoadSettings(const std::string& filename)
         mNetworkInterface.SetAddress(node->Value());
     }
 
+    node = doc.FirstChild("JAUS").FirstChild("Transport").FirstChild("UdpBatchSize").FirstChild().ToNode();
+    if(node && node->Value() && atoi(node->Value()) >= 0)
+    {
+        mUdpBatchSize = (unsigned int)atoi(node->Value());
+    }
+
+    node = doc.FirstChild("JAUS").FirstChild("Transport").FirstChild("UdpHeaderCompression").FirstChild().ToNode();
+    if(node && node->Value())
+    {
+        mUdpHeaderCompressionFlag = atoi(node->Value()) > 0 ? true : false;
+    }
+
+    element = doc.FirstChild("JAUS").FirstChild("Transport").FirstChild("RateLimit").ToElement();
+    if(element)
+    {
+        if(element->Attribute("bytesPerSecond") && atoi(element->Attribute("bytesPerSecond")) >= 0)
+        {
+            mRateLimit = (unsigned int)atoi(element->Attribute("bytesPerSecond"));
+        }
+        if(element->Attribute("burstBytes") && atoi(element->Attribute("burstBytes")) >= 0)
+        {
+            mRateLimitBurst = (unsigned int)atoi(element->Attribute("burstBytes"));
+        }
+        if(element->Attribute("queueBytes") && atoi(element->Attribute("queueBytes")) >= 0)
+        {
+            mRateLimitQueueSize = (unsigned int)atoi(element->Attribute("queueBytes"));
+        }
+    }
+
+    element = doc.FirstChild("JAUS").FirstChild("Transport").FirstChild("SharedMemory").ToElement();
+    if(element)
+    {
+        if(element->Attribute("ring"))
+        {
+            mSharedMemoryRingsFlag = atoi(element->Attribute("ring")) > 0;
+        }
+        if(element->Attribute("wakeup"))
+        {
+            mSharedMemoryWakeupFlag = atoi(element->Attribute("wakeup")) > 0;
+        }
+    }
+
+    element = doc.FirstChild("JAUS").FirstChild("Transport").FirstChild("Reactor").ToElement();
+    if(element)
+    {
+        if(element->Attribute("enable"))
+        {
+            mEventDrivenFlag = atoi(element->Attribute("enable")) > 0;
+        }
+        if(element->Attribute("threads") && atoi(element->Attribute("threads")) >= 1)
+        {
+            mEventThreads = (unsigned int)atoi(element->Attribute("threads"));
+        }
+    }
+
     element = doc.FirstChild("JAUS").FirstChild("Transport").FirstChild("Connection").ToElement();
     while(element)
     {
@@ -243,6 +308,7 @@ NodeManager::NodeManager(const bool singleThreadMode)
 {
     mInitializedFlag = false;
     mNodeShutdownFlag = false;
+    mRoutes.reset(new RoutingTable());
 
     // At least one thread for connections should be created.
     for(unsigned int i = 0; i < 1; i++)
@@ -338,6 +404,7 @@ bool NodeManager::Initialize()
     if(mpTcpServer->Initialize(tcpParams))
     {
         result = true;
+        ApplyRateLimit(mpTcpServer.get());
 
         // Setup UDP Server
         mpUdpServer.reset(new UDP());
@@ -352,8 +419,15 @@ bool NodeManager::Initialize()
         udpParams->mNetworkInterface = mSettings.GetNetworkInterface();
         udpParams->mMulticastIP = mSettings.GetMulticastIP();
         udpParams->mTimeToLive = mSettings.GetMulticastTLL();
+        udpParams->mBatchSize = mSettings.GetUdpBatchSize();
+        udpParams->mHeaderCompressionFlag = mSettings.UseUdpHeaderCompression();
         // Intialize
         mpUdpServer->Initialize(udpParams);
+        ApplyRateLimit(mpUdpServer.get());
+        {
+            WriteLock wLock(mConnectionsMutex);
+            PublishRoutes();
+        }
 
         if(mSettings.mSingleThreadModeFlag == false)
         {
@@ -362,14 +436,25 @@ bool NodeManager::Initialize()
             // of these are used to reduce the number of threads
             // generated by the process, and more are created as
             // they are needed.  Each Connection::Thread has a fixed number
-            // of connections in can handle.
-            mTcpServerUpdateThread.SetThreadName("TCP-Listen");
-            mTcpServerUpdateThread.SetParent(this, &mNodeShutdownFlag, false);
-            mTcpServerUpdateThread.AddConnection(mpTcpServer);
-
-            mUdpServerUpdateThread.SetThreadName("UDP-Recv");
-            mUdpServerUpdateThread.SetParent(this, &mNodeShutdownFlag, false);
-            mUdpServerUpdateThread.AddConnection(mpUdpServer);
+            // of connections in can handle.  If event-driven, a Reactor
+            // updates network connections only when they have data, and
+            // threads are only used for what it can't handle.
+            if(mSettings.mEventDrivenFlag && Reactor::IsSupported())
+            {
+                mReactor.Initialize(mSettings.mEventThreads, &mNodeShutdownFlag);
+            }
+            if(mReactor.AddConnection(mpTcpServer) == false)
+            {
+                mTcpServerUpdateThread.SetThreadName("TCP-Listen");
+                mTcpServerUpdateThread.SetParent(this, &mNodeShutdownFlag, false);
+                mTcpServerUpdateThread.AddConnection(mpTcpServer);
+            }
+            if(mReactor.AddConnection(mpUdpServer) == false)
+            {
+                mUdpServerUpdateThread.SetThreadName("UDP-Recv");
+                mUdpServerUpdateThread.SetParent(this, &mNodeShutdownFlag, false);
+                mUdpServerUpdateThread.AddConnection(mpUdpServer);
+            }
         }
 
         delete udpParams;
@@ -447,6 +532,7 @@ void NodeManager::Shutdown()
 
         mTcpServerUpdateThread.ShutdownConnections();
         mUdpServerUpdateThread.ShutdownConnections();
+        mReactor.ShutdownConnections();
 
         std::set<Connection::Thread*>::iterator refresh;
         for(refresh = mUpdateThreads.begin();
@@ -477,6 +563,7 @@ void NodeManager::Shutdown()
 
     mpTcpServer.reset();
     mpUdpServer.reset();
+    boost::atomic_store(&mRoutes, RoutingTable::Ptr(new RoutingTable()));
 
     // Stop/Kill Refresh System.
     mTcpServerUpdateThread.RemoveConnection(Connection::Ptr());
@@ -495,6 +582,9 @@ void NodeManager::Shutdown()
         (*refresh)->StopThread(10000);
     }
 
+    mReactor.RemoveConnection(Connection::Ptr());
+    mReactor.Shutdown();
+
     if(resetCounter)
     {
         Connection::ConnectionCounter = 0;
@@ -509,6 +599,7 @@ void NodeManager::Shutdown()
 void NodeManager::UpdateServiceEvent()
 {
     static Time::Stamp cleanupTime = Time::GetUtcTimeMs();
+    static Time::Stamp newConnectionTime = Time::GetUtcTimeMs();
     unsigned int checkInterval = mSettings.mDisconnectTimeMs > 0 ? mSettings.mDisconnectTimeMs : 5000;
 
     if(mpTcpServer == NULL || mpUdpServer == NULL)
@@ -630,7 +721,9 @@ void NodeManager::UpdateServiceEvent()
                     {
                         (*refresh)->RemoveConnection(remove->second);
                     }
+                    mReactor.RemoveConnection(remove->second);
                 }
+                PublishRoutes();
             }
 
             // See if we have fixed connection or not that needs to be made
@@ -676,6 +769,24 @@ void NodeManager::UpdateServiceEvent()
         }
         
     }
+    // The Reactor only updates new TCP connections when data arrives, so
+    // close any that never identify themselves.  Done without holding the
+    // connections mutex because identified connections are added with it.
+    if(mReactor.IsInitialized() && false == mNodeShutdownFlag &&
+       Time::GetUtcTimeMs() - newConnectionTime >= 1000)
+    {
+        Connection::Ptr server;
+        {
+            ReadLock rLock(mConnectionsMutex);
+            server = mpTcpServer;
+        }
+        TCP* tcp = dynamic_cast<TCP*>(server.get());
+        if(tcp)
+        {
+            tcp->CloseNewConnections(true);
+        }
+        newConnectionTime = Time::GetUtcTimeMs();
+    }
     // If single thread mode, we must manually
     // update all receive calls
     if(mSettings.mSingleThreadModeFlag)
@@ -706,6 +817,65 @@ void NodeManager::UpdateServiceEvent()
             con->second->UpdateConnection();
         }
     }
+
+    FlushPackets();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Sends any packets queued by UDP connections when batching is
+///          enabled (see Parameters::SetUdpBatchSize).
+///
+///   Called after connections are updated, so that all packets routed from
+///   the data received are sent together.  Only the connections the calling
+///   thread routed packets to are sent, so threads don't wait on each other.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void NodeManager::FlushPackets()
+{
+    std::vector<Connection::Ptr>* touched = mFlushList.get();
+    if(touched == NULL || touched->size() == 0)
+    {
+        return;
+    }
+    // Copy of shared pointers keeps connections alive while sending.
+    std::vector<Connection::Ptr> flush;
+    flush.swap(*touched);
+
+    std::vector<UDP*> connections;
+    connections.reserve(flush.size());
+    std::vector<Connection::Ptr>::iterator con;
+    for(con = flush.begin(); con != flush.end(); con++)
+    {
+        connections.push_back((UDP*)con->get());
+    }
+    UDP::SendBatch(connections);
+
+    // Re-use memory next time.
+    flush.clear();
+    flush.swap(*touched);
+}
+
+
+/** Remembers a UDP connection a packet was routed to so the calling thread
+    sends it on the next call to FlushPackets. */
+void NodeManager::AddToFlush(const Connection::Ptr& connection)
+{
+    if(mSettings.mUdpBatchSize <= 1 || ((UDP*)connection.get())->HasPendingPackets() == false)
+    {
+        return;
+    }
+    std::vector<Connection::Ptr>* touched = mFlushList.get();
+    if(touched == NULL)
+    {
+        touched = new std::vector<Connection::Ptr>();
+        mFlushList.reset(touched);
+    }
+    if(std::find(touched->begin(), touched->end(), connection) == touched->end())
+    {
+        touched->push_back(connection);
+    }
 }
 
 
@@ -759,6 +929,7 @@ bool NodeManager::AddConnection(Connection* connection)
     connection->SetGlobalShutdownFlag(&mNodeShutdownFlag);
     connection->RegisterCallback(this);
     connection->SetNodeManager(this);
+    ApplyRateLimit(connection);
 
     // Check for existing connections first.
     Connection::Map::iterator sm, udp, tcp;
@@ -789,14 +960,15 @@ bool NodeManager::AddConnection(Connection* connection)
         mTcpConnections[connection->GetConnectionID()] = ptr;
         break;
     }
+    PublishRoutes();
 
     // Add to refreshers if needed
     if(mSettings.mSingleThreadModeFlag == false && ptr->IsSendOnly() == false)
     {
-        bool refreshed = false;
+        bool refreshed = mReactor.AddConnection(ptr);
         std::set<Connection::Thread*>::iterator refresh;
         for(refresh = mUpdateThreads.begin();
-            refresh != mUpdateThreads.end();
+            refresh != mUpdateThreads.end() && refreshed == false;
             refresh++)
         {
             if((*refresh)->AddConnection(ptr))
@@ -820,6 +992,26 @@ bool NodeManager::AddConnection(Connection* connection)
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Sets the outgoing rate limit of a network connection from the
+///          settings (see Parameters::SetRateLimit).  Shared memory
+///          connections are not limited.
+///
+///   \param[in] connection Connection to limit.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void NodeManager::ApplyRateLimit(Connection* connection) const
+{
+    if(connection && connection->GetConnectionTransportType() != Connection::Transport::JSharedMemory)
+    {
+        connection->SetRateLimit(mSettings.mRateLimit,
+                                 mSettings.mRateLimitBurst,
+                                 mSettings.mRateLimitQueueSize);
+    }
+}
+
+
 /** Gets local and remote connection stats for the NodeManager. */
 bool NodeManager::GetStatistics(Connection::Statistics::List& local,
                                 Connection::Statistics::List& remote)
@@ -1015,6 +1207,7 @@ bool NodeManager::CreateNewConnection(const Address& id,
                 newConnection->RegisterCallback(this);
                 newConnection->SetGlobalShutdownFlag(&mNodeShutdownFlag);
                 newConnection->SetNodeManager(this);
+                ApplyRateLimit(newConnection.get());
                 mUdpConnections[id] = newConnection;
             }
         }
@@ -1044,6 +1237,7 @@ bool NodeManager::CreateNewConnection(const Address& id,
                 newConnection->SetGlobalShutdownFlag(&mNodeShutdownFlag);
                 newConnection->SetNodeManager(this);
                 newConnection->SetFixedConnection(fixed);
+                ApplyRateLimit(newConnection.get());
                 mTcpConnections[id] = newConnection;
             }
         }
@@ -1058,10 +1252,10 @@ bool NodeManager::CreateNewConnection(const Address& id,
         // Add to refreshers if needed
         if(mSettings.mSingleThreadModeFlag == false)
         {
-            bool refreshed = false;
+            bool refreshed = mReactor.AddConnection(newConnection);
             std::set<Connection::Thread*>::iterator refresh;
             for(refresh = mUpdateThreads.begin();
-                refresh != mUpdateThreads.end();
+                refresh != mUpdateThreads.end() && refreshed == false;
                 refresh++)
             {
                 if((*refresh)->AddConnection(newConnection))
@@ -1079,6 +1273,7 @@ bool NodeManager::CreateNewConnection(const Address& id,
             }
         }
     }
+    PublishRoutes();
     
     return result;
 }
@@ -1134,6 +1329,45 @@ void NodeManager::UpdateConnections(const Packet& jausPacket,
         return;
     }
 
+    // Connections are only changed for new or changed sources, so check
+    // the routing table without locking first.
+    {
+        RoutingTable::Ptr routes = boost::atomic_load(&mRoutes);
+        const RoutingTable::Slot* slot = routes->Find(jausHeader.mSourceID);
+        if(connection->GetConnectionTransportType() == Connection::Transport::JSharedMemory)
+        {
+            if(slot && slot->mpSharedMemory)
+            {
+                return;
+            }
+        }
+        else if(connection->GetConnectionTransportType() == Connection::Transport::JUDP)
+        {
+            if(slot && (slot->mpUdp || slot->mpTcp))
+            {
+                const Connection* udp = slot->mpUdp ? slot->mpUdp->mpConnection.get() : NULL;
+                const Connection* tcp = slot->mpTcp ? slot->mpTcp->mpConnection.get() : NULL;
+                if((udp == NULL || (udp->IsConnected() && udp->ConnectionChanged(sourceInfo) == false)) &&
+                   (tcp == NULL || (tcp->IsConnected() && tcp->ConnectionChanged(sourceInfo) == false)))
+                {
+                    if(udp)
+                    {
+                        slot->mpUdp->mpConnection->SignalConnectionUpdate(jausPacket.Length());
+                    }
+                    if(tcp)
+                    {
+                        slot->mpTcp->mpConnection->SignalConnectionUpdate(jausPacket.Length());
+                    }
+                    return;
+                }
+            }
+        }
+        else
+        {
+            return;
+        }
+    }
+
     Connection::Map::iterator con; // Connection iterator
 #ifdef JAUS_USE_UPGRADE_LOCKS
     UpgradeLock upgradeLock(mConnectionsMutex);
@@ -1217,6 +1451,8 @@ void NodeManager::UpdateConnections(const Packet& jausPacket,
                 {
                     (*refresh)->RemoveConnection(oldConnection);
                 }
+                mReactor.RemoveConnection(oldConnection);
+                PublishRoutes();
             }
 
             // Step 2: Create new connection
@@ -1287,18 +1523,19 @@ void NodeManager::RoutePacket(const Packet& jausPacket,
         return;
     }
 
-    Connection::Map::iterator con; // Connection iterator
-    // Shared lock
-    ReadLock readLock(mConnectionsMutex);
+    // Routes are read without locking (see RoutingTable).
+    RoutingTable::Ptr routes = boost::atomic_load(&mRoutes);
+    std::vector<RoutingTable::Route>::const_iterator route;
 
     // Check for broadcast message first.
     if(jausHeader.mDestinationID.IsBroadcast() && false == mNodeShutdownFlag)
     {
         bool fromLocalHost = connection->IsLocalConnection();
         bool globalBroadcastSuccess = false;
-        if(fromLocalHost && jausHeader.mBroadcastFlag != Header::Broadcast::None)
+        if(fromLocalHost && jausHeader.mBroadcastFlag != Header::Broadcast::None && routes->mpUdpServer != NULL)
         {
-            globalBroadcastSuccess = mpUdpServer->SendPacket(jausPacket, jausHeader);
+            globalBroadcastSuccess = routes->mpUdpServer->SendPacket(jausPacket, jausHeader);
+            AddToFlush(routes->mpUdpServer);
         }
 
         // Send to all matching destinations, but only send to every
@@ -1310,50 +1547,44 @@ void NodeManager::RoutePacket(const Packet& jausPacket,
         directHeader.mBroadcastFlag = Header::Broadcast::None;
         bool resetHeader = false;
 
-        for(con = mUdpConnections.begin();
-            con != mUdpConnections.end() && fromLocalHost;
-            con++)
+        for(route = routes->mNetwork.begin();
+            route != routes->mNetwork.end() && fromLocalHost;
+            route++)
         {
-            UDP* udp = dynamic_cast<UDP *>(con->second.get());
-            // IF the destination port matches the one used for
-            // broadcast, then don't send the message again, but make
-            // sure we send if it is a "fixed" connection
-            if(udp->IsFixedConnection() == false && udp->GetDestPortNumber() == mSettings.mDefaultPortNumber)
-            {
-                continue;
-            }
-            if(Address::DestinationMatch(jausHeader.mDestinationID, con->first) &&
-                con->first != jausHeader.mSourceID)
+            if(route->mTransportType == Connection::Transport::JUDP)
             {
-                directHeader.mDestinationID = con->first;
-                // Change destination address so it is no longer broadcast.
-                resetHeader = true;
-                Packet* ptr = (Packet *)&jausPacket;
-                ptr->SetWritePos(0);
-                directHeader.Write(*ptr);
-                con->second->SendPacket(jausPacket, directHeader);
+                UDP* udp = (UDP*)route->mpConnection.get();
+                // IF the destination port matches the one used for
+                // broadcast, then don't send the message again, but make
+                // sure we send if it is a "fixed" connection
+                if(udp->IsFixedConnection() == false && udp->GetDestPortNumber() == mSettings.mDefaultPortNumber)
+                {
+                    continue;
+                }
             }
-        }
-        // Broadcast to non-dynamic TCP connections
-        for(con = mTcpConnections.begin();
-            con != mTcpConnections.end() && fromLocalHost;
-            con++)
-        {
-            // Only send to outgoing connections we generated.
-            if(false == con->second->IsFixedConnection() || ((TCP*)con->second.get())->IsClient() == false)
+            else
             {
-                continue;
+                // Broadcast to non-dynamic TCP connections, only send 
+                // to outgoing connections we generated.
+                if(false == route->mpConnection->IsFixedConnection() || ((TCP*)route->mpConnection.get())->IsClient() == false)
+                {
+                    continue;
+                }
             }
-            if(Address::DestinationMatch(jausHeader.mDestinationID, con->first) &&
-                con->first != jausHeader.mSourceID)
+            if(Address::DestinationMatch(jausHeader.mDestinationID, route->mID) &&
+                route->mID != jausHeader.mSourceID)
             {
-                directHeader.mDestinationID = con->first;
+                directHeader.mDestinationID = route->mID;
                 // Change destination address so it is no longer broadcast.
                 resetHeader = true;
                 Packet* ptr = (Packet *)&jausPacket;
                 ptr->SetWritePos(0);
                 directHeader.Write(*ptr);
-                con->second->SendPacket(jausPacket, directHeader);
+                route->mpConnection->SendPacket(jausPacket, directHeader);
+                if(route->mTransportType == Connection::Transport::JUDP)
+                {
+                    AddToFlush(route->mpConnection);
+                }
             }
         }
 
@@ -1366,14 +1597,14 @@ void NodeManager::RoutePacket(const Packet& jausPacket,
         }
 
         // Send to shared memory components
-        for(con = mSharedMemoryConnections.begin();
-            con != mSharedMemoryConnections.end();
-            con++)
+        for(route = routes->mSharedMemory.begin();
+            route != routes->mSharedMemory.end();
+            route++)
         {
-            if(con->first != jausHeader.mSourceID && 
-                Address::DestinationMatch(jausHeader.mDestinationID, con->first))
+            if(route->mID != jausHeader.mSourceID && 
+                Address::DestinationMatch(jausHeader.mDestinationID, route->mID))
             {
-                con->second->SendPacket(jausPacket, jausHeader);
+                route->mpConnection->SendPacket(jausPacket, jausHeader);
             }
         }
 
@@ -1381,26 +1612,14 @@ void NodeManager::RoutePacket(const Packet& jausPacket,
     else
     {
         // Look up the destination and send directly.
-        bool haveConnection = false;
-
-        con = mSharedMemoryConnections.find(jausHeader.mDestinationID);
-        if( con != mSharedMemoryConnections.end())
+        const RoutingTable::Route* destination = routes->GetRoute(jausHeader.mDestinationID);
+        if(destination)
         {
-            haveConnection = true;
-        }
-        con = mSharedMemoryConnections.find(jausHeader.mDestinationID);
-        if( haveConnection == false && (con = mUdpConnections.find(jausHeader.mDestinationID)) != mUdpConnections.end())
-        {
-            haveConnection = true;
-        }
-        if( haveConnection == false && (con = mTcpConnections.find(jausHeader.mDestinationID)) != mTcpConnections.end())
-        {
-            haveConnection = true;
-        }
-
-        if(haveConnection)
-        {
-            con->second->SendPacket(jausPacket, jausHeader);
+            destination->mpConnection->SendPacket(jausPacket, jausHeader);
+            if(destination->mTransportType == Connection::Transport::JUDP)
+            {
+                AddToFlush(destination->mpConnection);
+            }
         }
     }
 }
@@ -1420,4 +1639,20 @@ void NodeManager::NodeUpdateThread(void* args)
 }
 
 
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Publishes a new RoutingTable with the current connections.
+///
+///   Must be called with mConnectionsMutex locked for writing, after any
+///   change to the maps of connections.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void NodeManager::PublishRoutes()
+{
+    boost::shared_ptr<RoutingTable> routes(new RoutingTable());
+    routes->Build(mSharedMemoryConnections, mUdpConnections, mTcpConnections, mpUdpServer);
+    boost::atomic_store(&mRoutes, RoutingTable::Ptr(routes));
+}
+
 /*  End of File */
@@ -0,0 +1,210 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file packetpool.cpp
+///  \brief This file contains a thread-safe pool of re-usable
+///  packet buffers.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#include "jaus/core/transport/packetpool.h"
+
+using namespace JAUS;
+
+const unsigned int PacketPool::DefaultMaxBuffers;
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Constructor, initializes default values.
+///
+///   \param[in] maxBuffers Maximum number of unused buffers to keep, buffers
+///                         released beyond this are deleted.
+///   \param[in] bufferSize Number of bytes to reserve in new buffers (0 lets
+///                         buffers grow as needed).
+///
+////////////////////////////////////////////////////////////////////////////////////
+PacketPool::PacketPool(const unsigned int maxBuffers,
+                       const unsigned int bufferSize) : mBuffers(128),
+                                                        mMaxBuffers(maxBuffers),
+                                                        mBufferSize(bufferSize),
+                                                        mInUse(0),
+                                                        mAvailable(0),
+                                                        mTotalCreated(0),
+                                                        mTotalAcquired(0),
+                                                        mTotalReleased(0),
+                                                        mTotalDiscarded(0)
+{
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Destructor, deletes all unused buffers.  Buffers still in use
+///          must not be released after the pool is destroyed.
+///
+////////////////////////////////////////////////////////////////////////////////////
+PacketPool::~PacketPool()
+{
+    Packet* packet = NULL;
+    while(mBuffers.pop(packet))
+    {
+        delete packet;
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gets an empty packet from the pool, or creates one if the pool
+///          is empty.  This method is thread safe.
+///
+///   \return Pointer to packet, return using Release when done.
+///
+////////////////////////////////////////////////////////////////////////////////////
+Packet* PacketPool::Acquire()
+{
+    Packet* packet = NULL;
+    if(mBuffers.pop(packet))
+    {
+        --mAvailable;
+    }
+    else
+    {
+        packet = Create();
+    }
+    ++mInUse;
+    ++mTotalAcquired;
+    packet->Clear(false);
+    return packet;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Returns a packet to the pool so it can be re-used.  This method
+///          is thread safe.
+///
+///   \param[in] packet Packet buffer received from Acquire (NULL is ignored).
+///
+////////////////////////////////////////////////////////////////////////////////////
+void PacketPool::Release(Packet* packet)
+{
+    if(packet == NULL)
+    {
+        return;
+    }
+    --mInUse;
+    ++mTotalReleased;
+    if(mAvailable < mMaxBuffers)
+    {
+        ++mAvailable;
+        mBuffers.push(packet);
+    }
+    else
+    {
+        ++mTotalDiscarded;
+        delete packet;
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Creates buffers ahead of time so the first messages processed
+///          do not allocate memory.
+///
+///   \param[in] count Number of buffers to add to the pool.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void PacketPool::Reserve(const unsigned int count)
+{
+    mBuffers.reserve(count);
+    for(unsigned int i = 0; i < count; i++)
+    {
+        ++mAvailable;
+        mBuffers.push(Create());
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \return Copy of the pool statistics.
+///
+////////////////////////////////////////////////////////////////////////////////////
+PacketPool::Statistics PacketPool::GetStatistics() const
+{
+    Statistics stats;
+    stats.mInUse = mInUse;
+    stats.mAvailable = mAvailable;
+    stats.mTotalCreated = mTotalCreated;
+    stats.mTotalAcquired = mTotalAcquired;
+    stats.mTotalReleased = mTotalReleased;
+    stats.mTotalDiscarded = mTotalDiscarded;
+    return stats;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Resets the acquire, release, create, and discard counters.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void PacketPool::ClearStatistics()
+{
+    mTotalCreated = 0;
+    mTotalAcquired = 0;
+    mTotalReleased = 0;
+    mTotalDiscarded = 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Allocates a new packet buffer.
+///
+////////////////////////////////////////////////////////////////////////////////////
+Packet* PacketPool::Create()
+{
+    Packet* packet = new Packet();
+    if(mBufferSize > 0)
+    {
+        packet->Reserve(mBufferSize);
+    }
+    ++mTotalCreated;
+    return packet;
+}
+
+/*  End of File */
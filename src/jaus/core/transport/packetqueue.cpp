@@ -0,0 +1,357 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file packetqueue.cpp
+///  \brief This file contains a bounded, lock-free, multi-producer
+///  queue of pooled packet buffers used by the Transport Service.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#include "jaus/core/transport/packetqueue.h"
+#include <cxutils/timer.h>
+
+using namespace JAUS;
+
+const unsigned int PacketQueue::DefaultCapacity;
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Constructor, initializes default values.
+///
+///   \param[in] capacity Maximum number of packets that can be queued.
+///   \param[in] policy What to do when the queue is full.
+///   \param[in] pool Pool to get packet buffers from, if NULL the queue
+///                   creates its own.  A shared pool must outlive the queue.
+///
+////////////////////////////////////////////////////////////////////////////////////
+PacketQueue::PacketQueue(const unsigned int capacity,
+                         const OverflowPolicy policy,
+                         PacketPool* pool) : mpOwnedPool(pool ? NULL : new PacketPool()),
+                                             mpPool(pool ? pool : mpOwnedPool.get()),
+                                             mQueue(capacity),
+                                             mCapacity(capacity),
+                                             mOverflowPolicy(policy),
+                                             mShutdownFlag(false),
+                                             mDepth(0),
+                                             mMaxDepth(0),
+                                             mTotalPushed(0),
+                                             mTotalPopped(0),
+                                             mTotalDropped(0),
+                                             mWaiters(0)
+{
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Destructor, returns all queued packets to the pool.
+///
+////////////////////////////////////////////////////////////////////////////////////
+PacketQueue::~PacketQueue()
+{
+    Clear();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Copies packet data into a pooled buffer and adds it to the end of the
+///          queue.  This method is safe to call from multiple threads at once.
+///
+///   If the queue is full, the overflow policy is applied.
+///
+///   \param[in] packet Packet data to queue.
+///
+///   \return True if added, false if the packet was discarded.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool PacketQueue::Push(const Packet& packet)
+{
+    Packet* buffer = NULL;
+
+    // Reserve a spot in the queue, the depth count includes packets
+    // being pushed so the capacity is never exceeded.
+    while(true)
+    {
+        unsigned int depth = ++mDepth;
+        if(depth <= mCapacity)
+        {
+            UpdateMaxDepth(depth);
+            break;
+        }
+        --mDepth;
+
+        if(mOverflowPolicy == DropNewest)
+        {
+            mTotalDropped++;
+            if(buffer)
+            {
+                Release(buffer);
+            }
+            return false;
+        }
+        else if(mOverflowPolicy == Block)
+        {
+            if(mShutdownFlag)
+            {
+                mTotalDropped++;
+                if(buffer)
+                {
+                    Release(buffer);
+                }
+                return false;
+            }
+            WaitForSpace();
+        }
+        else
+        {
+            // Discard the oldest data, re-using its buffer.
+            Entry oldest;
+            if(mQueue.pop(oldest))
+            {
+                --mDepth;
+                mTotalDropped++;
+                if(buffer == NULL)
+                {
+                    buffer = oldest.mpPacket;
+                }
+                else
+                {
+                    Release(oldest.mpPacket);
+                }
+            }
+        }
+    }
+
+    if(buffer == NULL)
+    {
+        buffer = mpPool->Acquire();
+    }
+    buffer->Clear(false);
+    buffer->Write(packet.Ptr(), packet.Length());
+    buffer->SetReadPos(0);
+    Entry entry;
+    entry.mpPacket = buffer;
+    entry.mPushTimeSeconds = CxUtils::Timer::GetTimeSeconds();
+    mQueue.push(entry);
+    mTotalPushed++;
+
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Removes the oldest packet from the queue.  This method is safe
+///          to call from multiple threads at once.
+///
+///   \param[out] pushTimeSeconds If not NULL, set to the time the packet was
+///                               pushed (CxUtils::Timer::GetTimeSeconds), used
+///                               to measure queuing latency.
+///
+///   \return Pointer to packet buffer (return with Release), NULL if
+///           nothing is queued.
+///
+////////////////////////////////////////////////////////////////////////////////////
+Packet* PacketQueue::Pop(double* pushTimeSeconds)
+{
+    Entry entry;
+    if(mQueue.pop(entry))
+    {
+        --mDepth;
+        mTotalPopped++;
+        SignalSpace();
+        if(pushTimeSeconds)
+        {
+            *pushTimeSeconds = entry.mPushTimeSeconds;
+        }
+        return entry.mpPacket;
+    }
+    return NULL;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Discards all packets in the queue (they are not counted as dropped).
+///
+////////////////////////////////////////////////////////////////////////////////////
+void PacketQueue::Clear()
+{
+    Entry entry;
+    while(mQueue.pop(entry))
+    {
+        --mDepth;
+        Release(entry.mpPacket);
+    }
+    SignalSpace(true);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Sets the shutdown flag, releasing any producers waiting on a full
+///          queue (Block policy).
+///
+///   \param[in] shutdown If true, producers stop waiting for room.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void PacketQueue::SignalShutdown(const bool shutdown)
+{
+    mShutdownFlag = shutdown;
+    SignalSpace(true);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Sets the maximum number of packets that can be queued.  If the
+///          queue is already deeper than the new capacity, nothing is
+///          discarded until the next push.
+///
+///   \param[in] capacity Maximum number of packets, must be greater than 0.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void PacketQueue::SetCapacity(const unsigned int capacity)
+{
+    if(capacity == 0)
+    {
+        return;
+    }
+    unsigned int previous = mCapacity.exchange(capacity);
+    if(capacity > previous)
+    {
+        // Pre-allocate queue nodes so pushes don't allocate memory.
+        mQueue.reserve(capacity - previous);
+        SignalSpace(true);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \return Copy of the queue statistics.
+///
+////////////////////////////////////////////////////////////////////////////////////
+PacketQueue::Statistics PacketQueue::GetStatistics() const
+{
+    Statistics stats;
+    stats.mCapacity = mCapacity;
+    stats.mDepth = mDepth;
+    stats.mMaxDepth = mMaxDepth;
+    stats.mTotalPushed = mTotalPushed;
+    stats.mTotalPopped = mTotalPopped;
+    stats.mTotalDropped = mTotalDropped;
+    return stats;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Resets the max depth, push, pop, and drop counters.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void PacketQueue::ClearStatistics()
+{
+    mMaxDepth = mDepth.load();
+    mTotalPushed = 0;
+    mTotalPopped = 0;
+    mTotalDropped = 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Updates the max depth reached if depth is larger.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void PacketQueue::UpdateMaxDepth(const unsigned int depth)
+{
+    unsigned int current = mMaxDepth;
+    while(depth > current && !mMaxDepth.compare_exchange_weak(current, depth))
+    {
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Waits until a packet is removed from a full queue, or shutdown
+///          is signaled (Block policy).
+///
+///   The condition is checked with mSpaceMutex locked, and consumers lock it
+///   before signaling, so a wakeup between the check and the wait is not lost.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void PacketQueue::WaitForSpace()
+{
+    ++mWaiters;
+    {
+        boost::unique_lock<boost::mutex> lock(mSpaceMutex);
+        while(mDepth >= mCapacity && mShutdownFlag == false)
+        {
+            mSpaceCondition.wait(lock);
+        }
+    }
+    --mWaiters;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Wakes producers waiting for room in the queue.  Nothing is locked
+///          if no producers are waiting.
+///
+///   \param[in] all If true, wake all waiting producers, otherwise one.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void PacketQueue::SignalSpace(const bool all)
+{
+    if(mWaiters == 0)
+    {
+        return;
+    }
+    boost::lock_guard<boost::mutex> lock(mSpaceMutex);
+    if(all)
+    {
+        mSpaceCondition.notify_all();
+    }
+    else
+    {
+        mSpaceCondition.notify_one();
+    }
+}
+
+/*  End of File */
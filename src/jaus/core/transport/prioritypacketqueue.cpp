@@ -0,0 +1,322 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file prioritypacketqueue.cpp
+///  \brief This file contains the implementation of the PriorityPacketQueue class
+///  which queues received packets in lanes by JAUS priority.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#include "jaus/core/transport/prioritypacketqueue.h"
+#include "jaus/core/header.h"
+
+using namespace JAUS;
+
+const unsigned int PriorityPacketQueue::Lanes;
+const unsigned int PriorityPacketQueue::DefaultStarvationLimit;
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Constructor, initializes default values.
+///
+///   \param[in] capacity Maximum number of packets that can be queued in
+///                       each lane.
+///   \param[in] policy What to do when a lane is full.
+///   \param[in] pool Pool to get packet buffers from, if NULL the queue
+///                   creates its own.  A shared pool must outlive the queue.
+///
+////////////////////////////////////////////////////////////////////////////////////
+PriorityPacketQueue::PriorityPacketQueue(const unsigned int capacity,
+                                         const PacketQueue::OverflowPolicy policy,
+                                         PacketPool* pool) : mpOwnedPool(pool ? NULL : new PacketPool()),
+                                                             mStarvationLimit(DefaultStarvationLimit)
+{
+    for(unsigned int i = 0; i < Lanes; i++)
+    {
+        mLanes[i].reset(new PacketQueue(capacity, policy, pool ? pool : mpOwnedPool.get()));
+        mPassedOver[i] = 0;
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Destructor, returns all queued packets to the pool.
+///
+////////////////////////////////////////////////////////////////////////////////////
+PriorityPacketQueue::~PriorityPacketQueue()
+{
+    for(unsigned int i = 0; i < Lanes; i++)
+    {
+        mLanes[i].reset();
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Copies packet data into a pooled buffer and adds it to the lane
+///          for its priority.  This method is safe to call from multiple
+///          threads at once.
+///
+///   \param[in] packet Packet data to queue.
+///   \param[in] priority Header::Priority of the packet.
+///
+///   \return True if added, false if the packet was discarded.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool PriorityPacketQueue::Push(const Packet& packet, const Byte priority)
+{
+    return mLanes[priority < Lanes ? priority : Header::Priority::Standard]->Push(packet);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Removes the next packet to process.  This method is safe to call
+///          from multiple threads at once.
+///
+///   The highest priority lane with data is used, unless a lower priority
+///   lane has been passed over StarvationLimit times.
+///
+///   \param[out] priority If not NULL, set to the priority of the packet.
+///   \param[out] pushTimeSeconds If not NULL, set to the time the packet was
+///                               pushed (CxUtils::Timer::GetTimeSeconds).
+///
+///   \return Pointer to packet buffer (return with Release), NULL if
+///           nothing is queued.
+///
+////////////////////////////////////////////////////////////////////////////////////
+Packet* PriorityPacketQueue::Pop(Byte* priority, double* pushTimeSeconds)
+{
+    Packet* packet = NULL;
+    // Starvation guard, serve the lowest lane that has waited too long.
+    for(unsigned int lane = 0; lane < Lanes - 1; lane++)
+    {
+        if(mPassedOver[lane] >= mStarvationLimit &&
+           (packet = PopLane(lane, pushTimeSeconds)) != NULL)
+        {
+            if(priority)
+            {
+                *priority = (Byte)lane;
+            }
+            return packet;
+        }
+    }
+    for(unsigned int lane = Lanes; lane > 0; lane--)
+    {
+        if((packet = PopLane(lane - 1, pushTimeSeconds)) != NULL)
+        {
+            if(priority)
+            {
+                *priority = (Byte)(lane - 1);
+            }
+            return packet;
+        }
+    }
+    return NULL;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Discards all queued packets (they are not counted as dropped).
+///
+////////////////////////////////////////////////////////////////////////////////////
+void PriorityPacketQueue::Clear()
+{
+    for(unsigned int i = 0; i < Lanes; i++)
+    {
+        mLanes[i]->Clear();
+        mPassedOver[i] = 0;
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Sets the maximum number of packets that can be queued in each lane.
+///
+///   \param[in] capacity Maximum number of packets, must be greater than 0.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void PriorityPacketQueue::SetCapacity(const unsigned int capacity)
+{
+    for(unsigned int i = 0; i < Lanes; i++)
+    {
+        mLanes[i]->SetCapacity(capacity);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Sets what to do when a lane is full.
+///
+///   \param[in] policy Overflow policy.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void PriorityPacketQueue::SetOverflowPolicy(const PacketQueue::OverflowPolicy policy)
+{
+    for(unsigned int i = 0; i < Lanes; i++)
+    {
+        mLanes[i]->SetOverflowPolicy(policy);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Releases any producers waiting on a full lane (Block policy).
+///
+///   \param[in] shutdown If true, stop waiting for space.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void PriorityPacketQueue::SignalShutdown(const bool shutdown)
+{
+    for(unsigned int i = 0; i < Lanes; i++)
+    {
+        mLanes[i]->SignalShutdown(shutdown);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \return Number of packets queued in all lanes.
+///
+////////////////////////////////////////////////////////////////////////////////////
+unsigned int PriorityPacketQueue::Size() const
+{
+    unsigned int size = 0;
+    for(unsigned int i = 0; i < Lanes; i++)
+    {
+        size += mLanes[i]->Size();
+    }
+    return size;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \return True if High or Safety Critical packets are queued.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool PriorityPacketQueue::HasUrgent() const
+{
+    return mLanes[Header::Priority::High]->IsEmpty() == false ||
+           mLanes[Header::Priority::SafetyCritical]->IsEmpty() == false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \return Statistics of all lanes combined (max depth is the largest of
+///           any lane).
+///
+////////////////////////////////////////////////////////////////////////////////////
+PacketQueue::Statistics PriorityPacketQueue::GetStatistics() const
+{
+    PacketQueue::Statistics total;
+    for(unsigned int i = 0; i < Lanes; i++)
+    {
+        PacketQueue::Statistics lane = mLanes[i]->GetStatistics();
+        total.mCapacity += lane.mCapacity;
+        total.mDepth += lane.mDepth;
+        total.mMaxDepth = lane.mMaxDepth > total.mMaxDepth ? lane.mMaxDepth : total.mMaxDepth;
+        total.mTotalPushed += lane.mTotalPushed;
+        total.mTotalPopped += lane.mTotalPopped;
+        total.mTotalDropped += lane.mTotalDropped;
+    }
+    return total;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \param[in] priority Header::Priority of the lane.
+///
+///   \return Statistics for the lane.
+///
+////////////////////////////////////////////////////////////////////////////////////
+PacketQueue::Statistics PriorityPacketQueue::GetStatistics(const Byte priority) const
+{
+    return mLanes[priority < Lanes ? priority : Header::Priority::Standard]->GetStatistics();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Resets the max depth, push, pop, and drop counters.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void PriorityPacketQueue::ClearStatistics()
+{
+    for(unsigned int i = 0; i < Lanes; i++)
+    {
+        mLanes[i]->ClearStatistics();
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Pops a packet from a lane, and counts lower priority lanes with
+///          data as passed over.
+///
+///   \param[in] lane Lane to pop from.
+///   \param[out] pushTimeSeconds Time the packet was pushed.
+///
+///   \return Pointer to packet, NULL if lane is empty.
+///
+////////////////////////////////////////////////////////////////////////////////////
+Packet* PriorityPacketQueue::PopLane(const unsigned int lane, double* pushTimeSeconds)
+{
+    Packet* packet = mLanes[lane]->Pop(pushTimeSeconds);
+    if(packet)
+    {
+        mPassedOver[lane] = 0;
+        for(unsigned int i = 0; i < lane; i++)
+        {
+            if(mLanes[i]->IsEmpty() == false)
+            {
+                mPassedOver[i]++;
+            }
+        }
+    }
+    return packet;
+}
+
+/*  End of File */
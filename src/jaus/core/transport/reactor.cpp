@@ -0,0 +1,543 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file reactor.cpp
+///  \brief This file contains an event-driven (epoll) reactor that
+///  multiplexes receiving for many connections on a small thread pool.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#include "jaus/core/transport/reactor.h"
+#include "jaus/core/transport/nodemanager.h"
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+#include <sstream>
+
+using namespace JAUS;
+
+const unsigned int Reactor::DefaultThreads;
+const unsigned int Reactor::MaxEventsPerWait;
+const unsigned int Reactor::WaitTimeMs;
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Constructor, initializes default values.
+///
+////////////////////////////////////////////////////////////////////////////////////
+Reactor::Reactor() : mEventSet(-1),
+                     mShutdownFlag(false),
+                     mpShutdownFlag(NULL),
+                     mNextKey(0)
+{
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Destructor, stops the thread pool.
+///
+////////////////////////////////////////////////////////////////////////////////////
+Reactor::~Reactor()
+{
+    Shutdown();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \return True if event-driven updates are supported on this platform,
+///           otherwise false and Connection::Thread must be used.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool Reactor::IsSupported()
+{
+#ifdef __linux__
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Creates the event set and starts the thread pool.
+///
+///   \param[in] numThreads Number of threads to update connections with.
+///   \param[in] shutdownFlag Pointer to global shutdown flag, threads exit
+///                           when set to true.
+///
+///   \return True on success (or already running), false on failure.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool Reactor::Initialize(const unsigned int numThreads,
+                         volatile bool* shutdownFlag)
+{
+    if(IsInitialized())
+    {
+        return true;
+    }
+#ifdef __linux__
+    mEventSet = epoll_create((int)MaxEventsPerWait);
+    if(mEventSet < 0)
+    {
+        return false;
+    }
+    fcntl(mEventSet, F_SETFD, FD_CLOEXEC);
+
+    mShutdownFlag = false;
+    mpShutdownFlag = shutdownFlag;
+
+    for(unsigned int i = 0; i < numThreads || i == 0; i++)
+    {
+        std::stringstream name;
+        name << "JAUS-Reactor-" << i;
+        Thread* thread = new Thread();
+        thread->SetThreadName(name.str());
+        mThreads.push_back(thread);
+        if(thread->CreateThread(Reactor::ReactorThread, this) <= 0)
+        {
+            Shutdown();
+            return false;
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Stops the thread pool and removes all connections (connections
+///          are not shutdown, use ShutdownConnections for that).
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Reactor::Shutdown()
+{
+    mShutdownFlag = true;
+
+    std::vector<Thread*>::iterator thread;
+    for(thread = mThreads.begin();
+        thread != mThreads.end();
+        thread++)
+    {
+        (*thread)->StopThread(WaitTimeMs*10);
+        delete (*thread);
+    }
+    mThreads.clear();
+
+    WriteLock wLock(mSourcesMutex);
+    while(mSources.size() > 0)
+    {
+        Unregister(mSources.begin());
+    }
+#ifdef __linux__
+    if(mEventSet >= 0)
+    {
+        close(mEventSet);
+    }
+#endif
+    mEventSet = -1;
+    mpShutdownFlag = NULL;
+    mShutdownFlag = false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Adds a connection to update whenever it has data to receive.
+///
+///   \param[in] connection Connection to add.
+///
+///   \return True if the reactor will update the connection, false if it
+///           can't (not initialized or connection has no receive descriptor).
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool Reactor::AddConnection(Connection::Ptr connection)
+{
+    return Register(connection.get(), connection);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Adds a connection that is not owned by the reactor, like a TCP
+///          connection that was accepted but doesn't have a JAUS ID yet.  If
+///          the connection is added again later using a Connection::Ptr, the
+///          reactor holds onto the shared pointer.
+///
+///   \param[in] connection Connection to add.
+///
+///   \return True if the reactor will update the connection, otherwise false.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool Reactor::AddConnection(Connection* connection)
+{
+    return Register(connection, Connection::Ptr());
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Shuts down and removes a connection from the reactor.
+///
+///   \param[in] connection Connection to remove, if NULL all connections
+///                         are removed (only those owned by
+///                         the reactor are shutdown).
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Reactor::RemoveConnection(Connection::Ptr connection)
+{
+    // Connections are shutdown without holding any locks, because shutting
+    // down a TCP listener removes its pending connections from the reactor.
+    // Connections not owned by the reactor are shutdown by their owners.
+    std::vector<Connection::Ptr> removed;
+    {
+        WriteLock wLock(mSourcesMutex);
+        if(connection == NULL)
+        {
+            while(mSources.size() > 0)
+            {
+                if(mSources.begin()->second.mPtr != NULL)
+                {
+                    removed.push_back(mSources.begin()->second.mPtr);
+                }
+                Unregister(mSources.begin());
+            }
+        }
+        else
+        {
+            std::map<Connection*, unsigned int>::iterator key = mKeys.find(connection.get());
+            if(key != mKeys.end())
+            {
+                removed.push_back(connection);
+                Unregister(mSources.find(key->second));
+            }
+        }
+    }
+    std::vector<Connection::Ptr>::iterator con;
+    for(con = removed.begin(); con != removed.end(); con++)
+    {
+        (*con)->Shutdown();
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Removes a connection that is not owned by the reactor (added
+///          using a raw pointer) without shutting it down.
+///
+///   If a thread is updating the connection, this method waits for the update
+///   to finish so the connection can be deleted once it returns.  Therefore it
+///   must not be called from within the update of the connection itself.
+///
+///   \param[in] connection Connection to remove.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Reactor::RemoveConnection(Connection* connection)
+{
+    if(connection == NULL)
+    {
+        return;
+    }
+    {
+        WriteLock wLock(mSourcesMutex);
+        std::map<Connection*, unsigned int>::iterator key = mKeys.find(connection);
+        if(key != mKeys.end())
+        {
+            Unregister(mSources.find(key->second));
+        }
+    }
+    boost::unique_lock<boost::mutex> lock(mActiveMutex);
+    while(mActive.find(connection) != mActive.end())
+    {
+        mActiveCondition.wait(lock);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Signals shutdown to, and shuts down, all connections updated by
+///          the reactor.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Reactor::ShutdownConnections()
+{
+    std::vector<Connection::Ptr> owned;
+    {
+        ReadLock rLock(mSourcesMutex);
+        SourceMap::iterator source;
+        for(source = mSources.begin();
+            source != mSources.end();
+            source++)
+        {
+            source->second.mpConnection->SignalGlobalShutdown(true);
+            source->second.mpConnection->ClearCallbacks();
+            if(source->second.mPtr != NULL)
+            {
+                owned.push_back(source->second.mPtr);
+            }
+        }
+    }
+    // Shutdown without the lock held, connections not owned by the
+    // reactor are shutdown by their owners (e.g. a TCP listener).
+    std::vector<Connection::Ptr>::iterator con;
+    for(con = owned.begin(); con != owned.end(); con++)
+    {
+        (*con)->Shutdown();
+    }
+}
+
+
+/** Returns the number of connections being updated. */
+unsigned int Reactor::GetNumConnections() const
+{
+    ReadLock rLock(*((SharedMutex *)&mSourcesMutex));
+    return (unsigned int)mSources.size();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Registers the receive descriptor of a connection with the
+///          event set.
+///
+///   Send only connections are accepted but not registered because there
+///   is nothing for them to receive.
+///
+///   \param[in] connection Connection to register.
+///   \param[in] ptr Shared pointer to connection, may be empty.
+///
+///   \return True if the reactor will update the connection, otherwise false.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool Reactor::Register(Connection* connection, Connection::Ptr ptr)
+{
+    if(connection == NULL || IsInitialized() == false)
+    {
+        return false;
+    }
+    if(connection->IsSendOnly())
+    {
+        return true;
+    }
+#ifdef __linux__
+    WriteLock wLock(mSourcesMutex);
+
+    std::map<Connection*, unsigned int>::iterator key = mKeys.find(connection);
+    if(key != mKeys.end())
+    {
+        // Already registered, keep a reference if given one.
+        if(ptr != NULL)
+        {
+            mSources[key->second].mPtr = ptr;
+        }
+        return true;
+    }
+
+    Source source;
+    source.mPtr = ptr;
+    source.mpConnection = connection;
+    source.mDescriptor = connection->GetDescriptor();
+    if(source.mDescriptor < 0)
+    {
+        return false;
+    }
+
+    // One-shot so only one thread updates the connection at a time.
+    struct epoll_event event;
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.u64 = 0;
+    event.data.u32 = mNextKey;
+
+    // Set the reactor first so receive calls don't wait on the first update.
+    connection->mpReactor = this;
+    if(epoll_ctl(mEventSet, EPOLL_CTL_ADD, source.mDescriptor, &event) != 0)
+    {
+        connection->mpReactor = NULL;
+        return false;
+    }
+    mSources[mNextKey] = source;
+    mKeys[connection] = mNextKey;
+    mNextKey++;
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Removes a source from the event set, mSourcesMutex must be
+///          write locked before calling.
+///
+///   \param[in] source Source to remove.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Reactor::Unregister(SourceMap::iterator source)
+{
+    if(source == mSources.end())
+    {
+        return;
+    }
+#ifdef __linux__
+    // Fails if the descriptor was already closed, which is fine.
+    struct epoll_event event;
+    event.events = 0;
+    event.data.u64 = 0;
+    epoll_ctl(mEventSet, EPOLL_CTL_DEL, source->second.mDescriptor, &event);
+#endif
+    source->second.mpConnection->mpReactor = NULL;
+    mKeys.erase(source->second.mpConnection);
+    mSources.erase(source);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Updates a connection that has data ready to receive, then re-arms
+///          its descriptor or removes it if the connection has closed.
+///
+///   \param[in] key Key of the source that is ready.
+///   \param[in] events Events reported for the descriptor.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Reactor::Dispatch(const unsigned int key, const unsigned int events)
+{
+#ifdef __linux__
+    Connection::Ptr ptr;
+    Connection* connection = NULL;
+    {
+        ReadLock rLock(mSourcesMutex);
+        SourceMap::iterator source = mSources.find(key);
+        if(source == mSources.end())
+        {
+            return;
+        }
+        // Copy of shared pointer keeps the connection alive if it is
+        // removed while being updated.
+        ptr = source->second.mPtr;
+        connection = source->second.mpConnection;
+        // Marked while the source is locked, so it can't be removed and
+        // deleted before the update completes.
+        boost::lock_guard<boost::mutex> lock(mActiveMutex);
+        mActive.insert(connection);
+    }
+
+    bool shutdown = mShutdownFlag || (mpShutdownFlag != NULL && *mpShutdownFlag);
+    if(shutdown == false && connection->IsConnected())
+    {
+        connection->UpdateConnection();
+        // Send anything batched by routing the data received.
+        if(connection->mpManager)
+        {
+            connection->mpManager->FlushPackets();
+        }
+        if((events & (EPOLLHUP | EPOLLERR)) && connection->IsConnected())
+        {
+            // Descriptor was closed by the other side or has an error, so
+            // the connection can't receive anymore.
+            connection->Shutdown();
+        }
+    }
+
+    {
+        WriteLock wLock(mSourcesMutex);
+        SourceMap::iterator source = mSources.find(key);
+        // Source is missing if removed while being updated.
+        if(source != mSources.end())
+        {
+            if(shutdown || connection->IsConnected() == false)
+            {
+                Unregister(source);
+            }
+            else
+            {
+                struct epoll_event event;
+                event.events = EPOLLIN | EPOLLONESHOT;
+                event.data.u64 = 0;
+                event.data.u32 = key;
+                if(epoll_ctl(mEventSet, EPOLL_CTL_MOD, source->second.mDescriptor, &event) != 0)
+                {
+                    Unregister(source);
+                }
+            }
+        }
+    }
+    FinishDispatch(connection);
+#endif
+}
+
+
+/** Clears the active state of a connection once its update is done, waking
+    any thread waiting to remove it. */
+void Reactor::FinishDispatch(Connection* connection)
+{
+    boost::lock_guard<boost::mutex> lock(mActiveMutex);
+    mActive.erase(connection);
+    mActiveCondition.notify_all();
+}
+
+
+/** Thread function which waits for descriptors to become ready and
+    updates their connections. */
+void Reactor::ReactorThread(void* args)
+{
+#ifdef __linux__
+    Reactor* reactor = (Reactor*)args;
+    struct epoll_event events[MaxEventsPerWait];
+
+    while(reactor->mShutdownFlag == false &&
+          (reactor->mpShutdownFlag == NULL || *reactor->mpShutdownFlag == false))
+    {
+        int count = epoll_wait(reactor->mEventSet, events, (int)MaxEventsPerWait, (int)WaitTimeMs);
+        for(int i = 0; i < count; i++)
+        {
+            reactor->Dispatch(events[i].data.u32, events[i].events);
+        }
+    }
+#endif
+}
+
+
+/*  End of File */
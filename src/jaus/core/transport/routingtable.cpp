@@ -0,0 +1,203 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file routingtable.cpp
+///  \brief This file contains the implementation of the RoutingTable class
+///  used by NodeManager to find the connections to components.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#include "jaus/core/transport/routingtable.h"
+
+using namespace JAUS;
+
+
+/** Hashes a component ID for the RoutingTable. */
+static inline UInt HashRoutingID(const UInt id)
+{
+    UInt hash = id ^ (id >> 16);
+    hash *= 0x45d9f3bU;
+    return hash ^ (hash >> 16);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Builds the table from maps of connections.  Only call this before
+///          the table is published.
+///
+///   \param[in] sharedMemory Shared memory connections by component ID.
+///   \param[in] udp UDP connections by component ID.
+///   \param[in] tcp TCP connections by component ID.
+///   \param[in] udpServer UDP server used for global broadcasts.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void RoutingTable::Build(const Connection::Map& sharedMemory,
+                                      const Connection::Map& udp,
+                                      const Connection::Map& tcp,
+                                      const Connection::Ptr& udpServer)
+{
+    mpUdpServer = udpServer;
+    mSharedMemory.reserve(sharedMemory.size());
+    mNetwork.reserve(udp.size() + tcp.size());
+
+    Route route;
+    Connection::Map::const_iterator con;
+    route.mTransportType = Connection::Transport::JSharedMemory;
+    for(con = sharedMemory.begin(); con != sharedMemory.end(); con++)
+    {
+        route.mID = con->first;
+        route.mpConnection = con->second;
+        mSharedMemory.push_back(route);
+    }
+    route.mTransportType = Connection::Transport::JUDP;
+    for(con = udp.begin(); con != udp.end(); con++)
+    {
+        route.mID = con->first;
+        route.mpConnection = con->second;
+        mNetwork.push_back(route);
+    }
+    route.mTransportType = Connection::Transport::JTCP;
+    for(con = tcp.begin(); con != tcp.end(); con++)
+    {
+        route.mID = con->first;
+        route.mpConnection = con->second;
+        mNetwork.push_back(route);
+    }
+
+    // Keep the table at most half full, so searches are short.
+    unsigned int size = 8;
+    while(size < (unsigned int)(mSharedMemory.size() + mNetwork.size())*2)
+    {
+        size *= 2;
+    }
+    mSlots.resize(size);
+    mMask = size - 1;
+
+    std::vector<Route>::const_iterator r;
+    for(r = mSharedMemory.begin(); r != mSharedMemory.end(); r++)
+    {
+        Insert(&(*r));
+    }
+    for(r = mNetwork.begin(); r != mNetwork.end(); r++)
+    {
+        Insert(&(*r));
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Adds a route to the hash table (linear probing).
+///
+////////////////////////////////////////////////////////////////////////////////////
+void RoutingTable::Insert(const Route* route)
+{
+    UInt id = route->mID.ToUInt();
+    UInt index = HashRoutingID(id) & mMask;
+    while(mSlots[index].mID != 0 && mSlots[index].mID != id)
+    {
+        index = (index + 1) & mMask;
+    }
+    Slot& slot = mSlots[index];
+    slot.mID = id;
+    switch(route->mTransportType)
+    {
+    case Connection::Transport::JSharedMemory:
+        slot.mpSharedMemory = route;
+        break;
+    case Connection::Transport::JUDP:
+        slot.mpUdp = route;
+        break;
+    default:
+        slot.mpTcp = route;
+        break;
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Finds the routes to a component.
+///
+///   \param[in] id Component ID.
+///
+///   \return Routes to the component by transport, NULL if none.
+///
+////////////////////////////////////////////////////////////////////////////////////
+const RoutingTable::Slot* RoutingTable::Find(const Address& id) const
+{
+    UInt key = id.ToUInt();
+    if(mSlots.size() == 0 || key == 0)
+    {
+        return NULL;
+    }
+    UInt index = HashRoutingID(key) & mMask;
+    while(mSlots[index].mID != 0)
+    {
+        if(mSlots[index].mID == key)
+        {
+            return &mSlots[index];
+        }
+        index = (index + 1) & mMask;
+    }
+    return NULL;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gets the route to use for a component, preferring shared memory,
+///          then UDP, then TCP.
+///
+///   \param[in] id Component ID.
+///
+///   \return Route to the component, NULL if none.
+///
+////////////////////////////////////////////////////////////////////////////////////
+const RoutingTable::Route* RoutingTable::GetRoute(const Address& id) const
+{
+    const Slot* slot = Find(id);
+    if(slot == NULL)
+    {
+        return NULL;
+    }
+    if(slot->mpSharedMemory)
+    {
+        return slot->mpSharedMemory;
+    }
+    return slot->mpUdp ? slot->mpUdp : slot->mpTcp;
+}
+
+/*  End of File */
@@ -50,6 +50,13 @@
 #include <boost/interprocess/sync/scoped_lock.hpp>
 #include <boost/interprocess/sync/named_mutex.hpp>
 
+#if defined(__linux__)
+#include <unistd.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
 using namespace JAUS;
 using namespace boost::interprocess;
 
@@ -59,6 +66,12 @@ using namespace boost::interprocess;
 typedef boost::interprocess::scoped_lock<boost::interprocess::named_mutex> NamedLock;
 typedef boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> InterprocessLock;
 
+const unsigned int SharedMemory::Ring::CacheLineSize;
+const unsigned int SharedMemory::Ring::DataSize;
+const UInt SharedMemory::Ring::WrapMarker;
+const unsigned int SharedMemory::MaxRingMessagesPerUpdate;
+const unsigned int SharedMemory::RingWaitTimeMs;
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Constructor.
@@ -70,6 +83,8 @@ SharedMemory::Parameters::Parameters()
     this->mMaxPacketSizeBytes = JAUS_USHORT_MAX;
     mCreationTime.SetCurrentTime();
     this->mTransportType = Connection::Transport::JSharedMemory;
+    mRingBufferFlag = false;
+    mWakeupFlag = false;
 }
 
 
@@ -115,6 +130,8 @@ SharedMemory::Parameters& SharedMemory::Parameters::operator=(const SharedMemory
         mSharedConnectionType = params.mSharedConnectionType;
         mComponentID = params.mComponentID;
         mCreationTime = params.mCreationTime;
+        mRingBufferFlag = params.mRingBufferFlag;
+        mWakeupFlag = params.mWakeupFlag;
     }
     return *this;
 }
@@ -137,6 +154,7 @@ SharedMemory::SharedMemory(const bool singleThread) : Connection(singleThread)
     mpSharedObject = NULL;
     mpMappedObjectRegion = NULL;
     mpBox = NULL;
+    mpRingBox = NULL;
 }
 
 
@@ -191,8 +209,47 @@ bool SharedMemory::Initialize(const Connection::Parameters* parameters)
 
     mSharedMemoryName = sharedObjectName;
 
+    // Rings require lock-free atomics since they are shared between processes.
+    boost::atomic<UInt> lockFreeCheck(0);
+    bool ringFlag = mParameters.mRingBufferFlag && lockFreeCheck.is_lock_free();
+
     // If not client, then we are hosting the memory segment.
-    if(mParameters.mSharedConnectionType == Parameters::Host)
+    if(mParameters.mSharedConnectionType == Parameters::Host && ringFlag)
+    {
+        try
+        {
+            mID = mParameters.mComponentID;
+
+            mStats.mPortName = mParameters.mComponentID.ToString();
+            mStats.mSourcePortNumber = mStats.mDestPortNumber = mParameters.mSourcePortNumber;
+            mStats.mSourceIP = mStats.mDestIP = IP4Address();
+
+            // Create memory using a different name than mailboxes, so that
+            // clients can tell which layout is in use.
+            sharedObjectName += ":Ring";
+            mSharedMemoryName = sharedObjectName;
+            boost::interprocess::shared_memory_object::remove(sharedObjectName.c_str());
+
+            mpSharedObject = new boost::interprocess::shared_memory_object(create_only,
+                                                                            sharedObjectName.c_str(),
+                                                                            read_write);
+            ((boost::interprocess::shared_memory_object*)mpSharedObject)->truncate(sizeof(SharedMemory::RingBox));
+            mpMappedObjectRegion = new boost::interprocess::mapped_region(*((boost::interprocess::shared_memory_object*)mpSharedObject),
+                                                                            read_write);
+            {
+                WriteLock ringLock(mRingMutex);
+                mpRingBox = new (((boost::interprocess::mapped_region*)mpMappedObjectRegion)->get_address())SharedMemory::RingBox();
+            }
+
+            mConnectedFlag = true;
+            result = true;
+        }
+        catch(boost::interprocess::interprocess_exception& ex)
+        {
+            std::cout << ex.what() << std::endl;
+        }
+    }
+    else if(mParameters.mSharedConnectionType == Parameters::Host)
     {
         try
         {
@@ -260,17 +317,44 @@ bool SharedMemory::Initialize(const Connection::Parameters* parameters)
             mStats.mDestinationID = mParameters.mComponentID;
             mConnectedFlag = true;
 
-            // Open memory
+            // Check if the host is using rings first.
+            try
+            {
+                mpSharedObject = new boost::interprocess::shared_memory_object(open_only,
+                                                                                (sharedObjectName + ":Ring").c_str(),
+                                                                                read_write);
+                mpMappedObjectRegion = new boost::interprocess::mapped_region(*((boost::interprocess::shared_memory_object*)mpSharedObject),
+                                                                              read_write);
+                WriteLock ringLock(mRingMutex);
+                mpRingBox = static_cast<SharedMemory::RingBox*>(((boost::interprocess::mapped_region*)mpMappedObjectRegion)->get_address());
+                result = true;
+            }
+            catch(boost::interprocess::interprocess_exception&)
+            {
+                if(mpSharedObject)
+                {
+                    delete ((boost::interprocess::shared_memory_object*)mpSharedObject);
+                    mpSharedObject = NULL;
+                }
+            }
+            if(result)
+            {
+                mSharedMemoryName = sharedObjectName + ":Ring";
+            }
+            else
+            {
+                // Open memory
 
-            mpSharedObject = new boost::interprocess::shared_memory_object(open_only,
-                                                                            sharedObjectName.c_str(),
-                                                                            read_write);
-            mpMappedObjectRegion = new boost::interprocess::mapped_region(*((boost::interprocess::shared_memory_object*)mpSharedObject),
-                                                                          read_write);
+                mpSharedObject = new boost::interprocess::shared_memory_object(open_only,
+                                                                                sharedObjectName.c_str(),
+                                                                                read_write);
+                mpMappedObjectRegion = new boost::interprocess::mapped_region(*((boost::interprocess::shared_memory_object*)mpSharedObject),
+                                                                              read_write);
 
-            mpBox = static_cast<SharedMemory::Box*>(((boost::interprocess::mapped_region*)mpMappedObjectRegion)->get_address());
+                mpBox = static_cast<SharedMemory::Box*>(((boost::interprocess::mapped_region*)mpMappedObjectRegion)->get_address());
 
-            result = true;
+                result = true;
+            }
         }
         catch(boost::interprocess::interprocess_exception& ex)
         {
@@ -292,6 +376,7 @@ bool SharedMemory::Initialize(const Connection::Parameters* parameters)
         mpSharedObject = NULL;
         mpMappedObjectRegion = NULL;
         mpBox = NULL;
+        mpRingBox = NULL;
     }
 
     // Create a thread if required to pull data from shared memory automatically and consume it.
@@ -315,6 +400,22 @@ void SharedMemory::Shutdown()
 {
     mConnectedFlag = false;
 
+    {
+        // Wake up our receive thread if it is waiting for data.
+        ReadLock ringLock(mRingMutex);
+        if(mpRingBox)
+        {
+            if(mParameters.mSharedConnectionType == Parameters::Host)
+            {
+                mpRingBox->mReadRing.Wake();
+            }
+            else
+            {
+                mpRingBox->mWriteRing.Wake();
+            }
+        }
+    }
+
     this->mUpdateConnectionThread.StopThread();
 
     // If we are hosting the shared memory, than we must mark it
@@ -335,10 +436,19 @@ void SharedMemory::Shutdown()
                 mpBox->mReadTable.mUpdateTimeMs = 0;
             }
         }
+        ReadLock ringLock(mRingMutex);
+        if(mpRingBox)
+        {
+            mpRingBox->mReadRing.mValidFlag = 0;
+            mpRingBox->mWriteRing.mValidFlag = 0;
+            mpRingBox->mReadRing.Wake();
+            mpRingBox->mWriteRing.Wake();
+        }
     }
 
     {
         WriteLock wLock(mConnectionMutex);
+        WriteLock ringLock(mRingMutex);
 
         if(mpSharedObject)
         {
@@ -350,6 +460,7 @@ void SharedMemory::Shutdown()
         }
         mpSharedObject = NULL;
         mpMappedObjectRegion = NULL;
+        mpRingBox = NULL;
     }
     mpBox = NULL;
 }
@@ -406,6 +517,41 @@ bool SharedMemory::SendPacket(const Packet& packet,
         return result;
     }
 
+    if(mpRingBox)
+    {
+        {
+            ReadLock ringLock(*((SharedMutex*)&mRingMutex));
+            if(mpRingBox == NULL)
+            {
+                return result;
+            }
+            // Host sends using the write ring, clients send to the read ring.
+            Ring* ring = &mpRingBox->mReadRing;
+            if(mParameters.mSharedConnectionType == SharedMemory::Parameters::Host)
+            {
+                ring = &mpRingBox->mWriteRing;
+            }
+            // Only one producer at a time.
+            WriteLock sendLock(*((SharedMutex*)&mSendMutex));
+            result = ring->Write(packet);
+        }
+        if(result)
+        {
+            // Update stats.
+            WriteLock wLock(*((SharedMutex *)&mConnectionMutex));
+            Connection::Statistics* stats = (Connection::Statistics*)&mStats;
+            stats->mMessagesSent++;
+            stats->mTotalMessagesSent++;
+            stats->mBytesSent += packet.Length();
+            stats->mTotalBytesSent += packet.Length();
+        }
+        else
+        {
+            std::cout << "Shared Memory Full" << std::endl;
+        }
+        return result;
+    }
+
     try
     {
         // Lock this structure for current process.
@@ -569,9 +715,15 @@ void SharedMemory::ReceiveIncommingData()
     {
         return;
     }
+
+    if(mpRingBox)
+    {
+        ReceiveRingData();
+        return;
+    }
     
-    Packet packet;
-    packet.Reserve(Header::MinSize*2);
+    Packet& packet = mRecvBuffer;
+    packet.Clear(false);
 
     bool result = false;
 #ifdef AVERAGE_STATS
@@ -712,6 +864,23 @@ Time::Stamp SharedMemory::GetUpdateTimeUtcMs() const
         return 0;
     }
 
+    if(mpRingBox)
+    {
+        ReadLock ringLock(*((SharedMutex*)&mRingMutex));
+        if(mpRingBox == NULL)
+        {
+            return 0;
+        }
+        // Same as mailboxes, the host checks its outbox, and
+        // clients check the host inbox.
+        const Ring* ring = &mpRingBox->mReadRing;
+        if(mParameters.mSharedConnectionType == SharedMemory::Parameters::Host)
+        {
+            ring = &mpRingBox->mWriteRing;
+        }
+        return ring->mReadTimeMs > ring->mWriteTimeMs ? ring->mReadTimeMs : ring->mWriteTimeMs;
+    }
+
     try
     {
         ReadLock rLock(*((SharedMutex*)&mConnectionMutex));
@@ -760,6 +929,11 @@ bool SharedMemory::HasSubscriber(const unsigned int readInterval)
 {
     bool result = false;
     Table table;
+    if(mConnectedFlag && mpRingBox)
+    {
+        Time::Stamp updateTimeMs = GetUpdateTimeUtcMs();
+        return Time::GetUtcTimeMs() - updateTimeMs < (Time::Stamp)readInterval;
+    }
     if(mConnectedFlag)
     {
         try
@@ -792,6 +966,304 @@ bool SharedMemory::HasSubscriber(const unsigned int readInterval)
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \return True if UpdateConnection blocks waiting for data to arrive (rings
+///           with wakeup enabled, in multi-threaded mode).
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool SharedMemory::WaitsForData() const
+{
+    return mpRingBox != NULL &&
+           mParameters.mWakeupFlag &&
+           mSingleThreadModeFlag == false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Pulls messages from the receive ring and shares them with callbacks
+///          directly from shared memory (no copy is made).
+///
+///   If no data is available and wakeup is enabled, waits for the sender to
+///   signal that data has arrived.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void SharedMemory::ReceiveRingData()
+{
+    unsigned int count = 0;
+    unsigned int bytes = 0;
+    RingBox* waitBox = NULL;
+    Ring* waitRing = NULL;
+    UInt signal = 0;
+    {
+        ReadLock ringLock(mRingMutex);
+        if(mpRingBox == NULL)
+        {
+            return;
+        }
+
+        // Host reads from the read ring, clients read what the host wrote.
+        Ring* ring = &mpRingBox->mWriteRing;
+        if(mParameters.mSharedConnectionType == SharedMemory::Parameters::Host)
+        {
+            ring = &mpRingBox->mReadRing;
+        }
+        if(ring->mValidFlag == 0)
+        {
+            mConnectedFlag = false;
+            return;
+        }
+
+        Connection::Info sourceInfo;
+        sourceInfo.mTransportType = this->mTransportType;
+        sourceInfo.mPortName = mSharedMemoryName;
+        sourceInfo.mDestIP.Clear();
+        sourceInfo.mDestPortNumber = mParameters.mDestPortNumber;
+        sourceInfo.mSourcePortNumber = mParameters.mSourcePortNumber;
+
+        const unsigned char* data = NULL;
+        UInt length = 0;
+        while(count < MaxRingMessagesPerUpdate &&
+              mConnectedFlag &&
+              (data = ring->Front(length)) != NULL)
+        {
+            // Wrap the data in shared memory.
+            Packet::Wrapper jausPacket((unsigned char *)data, length);
+            Header jausHeader;
+            if(jausHeader.Read(*jausPacket.GetData()))
+            {
+                SendToCallbacks(*jausPacket.GetData(),
+                                jausHeader,
+                                &sourceInfo);
+            }
+            ring->Pop(length);
+            bytes += length;
+            count++;
+        }
+        ring->mReadTimeMs = Time::GetUtcTimeMs();
+
+        if(count == 0 && WaitsForData())
+        {
+            waitBox = mpRingBox;
+            waitRing = ring;
+            if(ring->BeginWait(signal) == false)
+            {
+                ring->EndWait();
+                waitRing = NULL;
+            }
+        }
+    }
+
+    if(waitRing)
+    {
+        // Wait without holding the ring lock so shutdown is not delayed.  Only
+        // the address of the futex word is used here, the memory is not touched.
+        Ring::Wait(&waitRing->mSignal, signal, RingWaitTimeMs);
+        ReadLock ringLock(mRingMutex);
+        // If the ring was unmapped while waiting, its counter went with it.
+        if(mpRingBox == waitBox)
+        {
+            waitRing->EndWait();
+        }
+    }
+
+    if(count > 0)
+    {
+        // Update stats.
+        WriteLock wLock(mConnectionMutex);
+        mStats.mMessagesReceived += count;
+        mStats.mTotalMessagesReceived += count;
+        mStats.mBytesReceived += bytes;
+        mStats.mTotalBytesReceived += bytes;
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Constructor, initializes an empty ring.
+///
+////////////////////////////////////////////////////////////////////////////////////
+SharedMemory::Ring::Ring() : mHead(0), mTail(0), mSignal(0), mWaiting(0)
+{
+    mValidFlag = 1;
+    mWriteTimeMs = mReadTimeMs = Time::GetUtcTimeMs();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Copies a packet into the ring (producer only).
+///
+///   \param[in] packet Packet to write.
+///
+///   \return True on success, false if there is no room.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool SharedMemory::Ring::Write(const Packet& packet)
+{
+    const UInt length = packet.Length();
+    const UInt recordSize = GetRecordSize(length);
+    if(mValidFlag == 0 || recordSize > DataSize/2)
+    {
+        return false;
+    }
+
+    UInt head = mHead.load(boost::memory_order_relaxed);
+    UInt tail = mTail.load(boost::memory_order_acquire);
+    UInt offset = head & (DataSize - 1);
+    UInt skip = 0;
+
+    // Messages are never split, so skip unused space at the end.
+    if(offset + recordSize > DataSize)
+    {
+        skip = DataSize - offset;
+    }
+    if((head - tail) + skip + recordSize > DataSize)
+    {
+        return false;
+    }
+    if(skip > 0)
+    {
+        UInt marker = WrapMarker;
+        std::memcpy(mData + offset, &marker, sizeof(UInt));
+        head += skip;
+        offset = 0;
+    }
+    std::memcpy(mData + offset, &length, sizeof(UInt));
+    std::memcpy(mData + offset + sizeof(UInt), packet.Ptr(), length);
+    mHead.store(head + recordSize, boost::memory_order_release);
+    mWriteTimeMs = Time::GetUtcTimeMs();
+
+    Wake();
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gets the next message in the ring (consumer only).
+///
+///   \param[out] length Length of the message in bytes.
+///
+///   \return Pointer to message data in shared memory, NULL if empty.  Call
+///           Pop when finished with the data.
+///
+////////////////////////////////////////////////////////////////////////////////////
+const unsigned char* SharedMemory::Ring::Front(UInt& length)
+{
+    UInt tail = mTail.load(boost::memory_order_relaxed);
+    while(tail != mHead.load(boost::memory_order_acquire))
+    {
+        UInt offset = tail & (DataSize - 1);
+        std::memcpy(&length, mData + offset, sizeof(UInt));
+        if(length != WrapMarker)
+        {
+            return mData + offset + sizeof(UInt);
+        }
+        // Continue at the start of the buffer.
+        tail += DataSize - offset;
+        mTail.store(tail, boost::memory_order_release);
+    }
+    return NULL;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Removes the message returned by Front (consumer only).
+///
+///   \param[in] length Length of the message returned by Front.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void SharedMemory::Ring::Pop(const UInt length)
+{
+    mTail.store(mTail.load(boost::memory_order_relaxed) + GetRecordSize(length),
+                boost::memory_order_release);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Registers the consumer as waiting for data (consumer only).
+///
+///   Every call must be matched by a call to EndWait while the ring is
+///   still mapped.
+///
+///   \param[out] signal Value of the signal counter to pass to Wait.
+///
+///   \return True if the ring is empty and the consumer should wait.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool SharedMemory::Ring::BeginWait(UInt& signal)
+{
+    signal = mSignal.load();
+    ++mWaiting;
+    return mValidFlag && mHead.load() == mTail.load(boost::memory_order_relaxed);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Clears the waiting state set by BeginWait (consumer only).
+///
+////////////////////////////////////////////////////////////////////////////////////
+void SharedMemory::Ring::EndWait()
+{
+    --mWaiting;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Waits until the producer signals that data was written, or the
+///          timeout expires.
+///
+///   The futex memory is not read here, so it is safe to call without holding
+///   the lock that keeps the ring mapped.  If the ring is unmapped during the
+///   wait, the call returns at the timeout.
+///
+///   \param[in] futex Signal counter of the ring to wait on.
+///   \param[in] signal Value of the counter returned by BeginWait.
+///   \param[in] timeoutMs Maximum time to wait in ms.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void SharedMemory::Ring::Wait(const boost::atomic<UInt>* futex,
+                              const UInt signal,
+                              const unsigned int timeoutMs)
+{
+#if defined(__linux__)
+    // boost::atomic stores lock-free integers in place, so the
+    // signal counter can be used directly as a futex.
+    struct timespec timeout;
+    timeout.tv_sec = timeoutMs/1000;
+    timeout.tv_nsec = (timeoutMs%1000)*1000000;
+    syscall(SYS_futex, (int*)futex, FUTEX_WAIT, (int)signal, &timeout, NULL, 0);
+#else
+    // No interprocess wakeup available, poll.
+    boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+#endif
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Signals the consumer that data is available.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void SharedMemory::Ring::Wake()
+{
+    ++mSignal;
+    if(mWaiting.load() > 0)
+    {
+#if defined(__linux__)
+        syscall(SYS_futex, (int*)&mSignal, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+    }
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Constructor, initializes all values to 0.
@@ -129,6 +129,7 @@ TCP::TCP(const bool singleThread) : Connection(singleThread)
 ////////////////////////////////////////////////////////////////////////////////////
 TCP::~TCP()
 {
+    mpShaper->Remove(this);
 }
 
 
@@ -301,18 +302,11 @@ void TCP::Shutdown()
 
     mUpdateConnectionThread.StopThread();
 
-    DeleteSocket();
+    mpShaper->Remove(this);
 
-    WriteLock (mConnectionMutex);
+    DeleteSocket();
 
-    std::set<TCP*>::iterator undefined;
-    for(undefined = mNewConnections.begin();
-        undefined != mNewConnections.end();
-        undefined++)
-    {
-        delete *undefined;
-    }
-    mNewConnections.clear();
+    CloseNewConnections(false);
 }
 
 
@@ -347,6 +341,7 @@ Connection::Statistics TCP::GetStatistics()
         stats = mStats;
         mStats.mConnectionNumber = stats.mConnectionNumber = mConnectionNumber;
         mStats.mBytesReceived = mStats.mBytesSent = mStats.mMessagesReceived = mStats.mMessagesSent = 0;
+        mStats.mPacketsDropped = 0;
     }
     return stats;
 }
@@ -375,19 +370,41 @@ bool TCP::CanBroadcast(const int transportType) const
 ///   \param[in] packet JAUS packet with no additional transport overhead.
 ///   \param[in] packetHeader JAUS general header data.
 ///
-///   \return True on success, false on failure.
+///   \return True on success (or queued for the rate limit), false on failure.
 ///
 ////////////////////////////////////////////////////////////////////////////////////
 bool TCP::SendPacket(const Packet& packet,
                      const Header& packetHeader) const
+{
+    // Apply the rate limit (if any).
+    int shaping = ShapeTraffic(packet, packetHeader);
+    if(shaping != TrafficShaper::Send)
+    {
+        return shaping == TrafficShaper::Queued;
+    }
+
+    return TransmitPacket(packet, packetHeader);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Sends the packet over the TCP connection.
+///
+///   \param[in] packet JAUS packet with no additional transport overhead.
+///   \param[in] packetHeader JAUS general header data.
+///
+///   \return True on success, false on failure.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool TCP::TransmitPacket(const Packet& packet,
+                         const Header& packetHeader) const
 {
     bool result = false;
 
     // Send TCP Header, then packet
     CxUtils::Socket* socket = (CxUtils::Socket*)mpSocket;
 
-    Packet temp;
-
     if(socket == NULL)
     {
         return result;
@@ -424,7 +441,8 @@ void TCP::UpdateConnection()
     }
     ListenForConnections();
     ReceiveIncommingData();
-    if(mSingleThreadModeFlag)
+    // When a Reactor is used, new connections are updated by it as data arrives.
+    if(mSingleThreadModeFlag && mpReactor == NULL)
     {
         std::set<TCP*> newConnections = mNewConnections;
         std::set<TCP*>::iterator newCon;
@@ -481,6 +499,17 @@ const Packet& TCP::GetTransportHeader() const
 }
 
 
+/** Gets the socket descriptor for the connection (-1 if no socket). */
+int TCP::GetDescriptor() const
+{
+    if(mpSocket)
+    {
+        return ((CxUtils::Socket*)mpSocket)->GetSocket();
+    }
+    return -1;
+}
+
+
 /** Is this a client connection we created ? */
 bool TCP::IsClient() const
 {
@@ -567,12 +596,15 @@ void TCP::RemoveConnection(TCP* tcp)
 {
     {
         WriteLock wLock(mConnectionMutex);
-        if(mNewConnections.find(tcp) != mNewConnections.end())
+        if(mNewConnections.find(tcp) == mNewConnections.end())
         {
-            tcp->mStats.mDestinationID.Clear();
-            tcp->mStats.mSourceID = tcp->mSourceID;
-            mNewConnections.erase(mNewConnections.find(tcp));
+            // Already being closed.
+            tcp->mpParent = NULL;
+            return;
         }
+        tcp->mStats.mDestinationID.Clear();
+        tcp->mStats.mSourceID = tcp->mSourceID;
+        mNewConnections.erase(mNewConnections.find(tcp));
     }
     tcp->mpParent = NULL;
     
@@ -592,6 +624,58 @@ void TCP::RemoveConnection(TCP* tcp)
 
 
 
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Closes and deletes connections that do not know what JAUS component
+///          they are tied to yet.
+///
+///   When a Reactor is used, new connections are only updated when data
+///   arrives, so this must be called periodically to close connections that
+///   never identify themselves.  Connections are removed from the Reactor
+///   before they are deleted, which waits for any update in progress.  The
+///   connection mutex is not held while doing so because an update may be
+///   calling RemoveConnection.
+///
+///   \param[in] timedOutOnly If true, only connections that have not received
+///                           data within NewConnectionTimeoutMs or have
+///                           disconnected are closed, otherwise all are.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void TCP::CloseNewConnections(const bool timedOutOnly)
+{
+    std::vector<TCP*> closed;
+    {
+        WriteLock wLock(mConnectionMutex);
+        Time::Stamp currentTimeMs = Time::GetUtcTimeMs();
+        std::set<TCP*>::iterator newCon = mNewConnections.begin();
+        while(newCon != mNewConnections.end())
+        {
+            if(timedOutOnly == false ||
+               (*newCon)->IsConnected() == false ||
+               currentTimeMs - (*newCon)->GetUpdateTimeUtcMs() >= NewConnectionTimeoutMs)
+            {
+                closed.push_back(*newCon);
+                mNewConnections.erase(newCon++);
+            }
+            else
+            {
+                newCon++;
+            }
+        }
+    }
+    std::vector<TCP*>::iterator con;
+    for(con = closed.begin(); con != closed.end(); con++)
+    {
+        Reactor* reactor = (*con)->mpReactor;
+        if(reactor)
+        {
+            reactor->RemoveConnection((Connection*)(*con));
+        }
+        delete *con;
+    }
+}
+
+
 /** If in server mode, this method listens for
     and creates incomming TCP connections. */
 void TCP::ListenForConnections()
@@ -615,11 +699,10 @@ void TCP::ListenForConnections()
 
             // Push onto stack of new connections.  For these
             // connections we do not yet know what JAUS ID is
-            // associated with the connection.
-            {
-                WriteLock wLock(mConnectionMutex);
-                mNewConnections.insert(newTCP);
-            }
+            // associated with the connection.  The lock is held until
+            // setup is complete so it can't be closed before then.
+            WriteLock wLock(mConnectionMutex);
+            mNewConnections.insert(newTCP);
 
             newTCP->CopyConnectionData(this);
             newTCP->mpSocket = sock;
@@ -632,8 +715,20 @@ void TCP::ListenForConnections()
                 newTCP->mLocalConnectionFlag = true;
             }
             newTCP->Initialize(&mParameters);
+
+            // Until the Node Manager knows the JAUS ID of the connection,
+            // the Reactor must update it when data arrives.
+            Reactor* reactor = mpReactor;
+            if(reactor)
+            {
+                reactor->AddConnection(newTCP);
+            }
+        }
+        // With a Reactor, this is only called when a connection is pending.
+        if(mpReactor == NULL)
+        {
+            CxUtils::SleepMs(1);
         }
-        CxUtils::SleepMs(1);
     }
 }
 
@@ -654,8 +749,9 @@ void TCP::ReceiveIncommingData()
     }
 
     long int timeoutMs = 0;
-    if(mSingleThreadModeFlag)
+    if(mSingleThreadModeFlag || mpReactor)
     {
+        // A Reactor only updates the connection when data is ready.
         timeoutMs = 1;
     }
     else
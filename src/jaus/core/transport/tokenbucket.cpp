@@ -0,0 +1,216 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file tokenbucket.cpp
+///  \brief This file contains the implementation of the TokenBucket class
+///  used to limit the rate data is sent at.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#include "jaus/core/transport/tokenbucket.h"
+#include <cxutils/timer.h>
+#include <boost/thread.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+using namespace JAUS;
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Constructor, initializes default values.
+///
+///   \param[in] bytesPerSecond Rate limit, 0 = no limit.
+///   \param[in] burstBytes Maximum bytes that can be sent at once, 0 uses
+///                         1/10 of a second of data.
+///
+////////////////////////////////////////////////////////////////////////////////////
+TokenBucket::TokenBucket(const unsigned int bytesPerSecond,
+                         const unsigned int burstBytes) : mRate(0),
+                                                          mBurst(0),
+                                                          mTokens(0),
+                                                          mUpdateTimeSeconds(0)
+{
+    SetRate(bytesPerSecond, burstBytes);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Destructor.
+///
+////////////////////////////////////////////////////////////////////////////////////
+TokenBucket::~TokenBucket()
+{
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Sets the rate limit.  If the rate or burst size changes, the
+///          bucket starts full, otherwise tokens already taken are kept.
+///
+///   \param[in] bytesPerSecond Rate limit, 0 = no limit.
+///   \param[in] burstBytes Maximum bytes that can be sent at once, 0 uses
+///                         1/10 of a second of data.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void TokenBucket::SetRate(const unsigned int bytesPerSecond, const unsigned int burstBytes)
+{
+    unsigned int burst = burstBytes > 0 ? burstBytes : bytesPerSecond/10;
+    if(burst == 0 && bytesPerSecond > 0)
+    {
+        burst = 1;
+    }
+    Mutex::ScopedLock lock(&mMutex);
+    if(mRate == bytesPerSecond && mBurst == burst)
+    {
+        return;
+    }
+    mRate = bytesPerSecond;
+    mBurst = burst;
+    mTokens = mBurst;
+    mUpdateTimeSeconds = CxUtils::Timer::GetTimeSeconds();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Takes tokens for sending data if they are available.
+///
+///   \param[in] bytes Number of bytes to send.
+///   \param[out] waitTimeSeconds If not NULL and tokens are not available,
+///                               set to how long until they will be.
+///
+///   \return True if data can be sent, false if sender must wait.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool TokenBucket::Take(const unsigned int bytes, double* waitTimeSeconds)
+{
+    if(mRate == 0)
+    {
+        return true;
+    }
+    Mutex::ScopedLock lock(&mMutex);
+    if(mRate == 0)
+    {
+        return true;
+    }
+    Refill(CxUtils::Timer::GetTimeSeconds());
+    // Packets larger than the burst size can go once the bucket is full.
+    double needed = bytes < mBurst ? (double)bytes : (double)mBurst;
+    if(mTokens >= needed)
+    {
+        mTokens -= bytes;
+        return true;
+    }
+    if(waitTimeSeconds)
+    {
+        *waitTimeSeconds = (needed - mTokens)/mRate;
+    }
+    return false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Takes tokens for data that must be sent now, such as high
+///          priority messages.  Other data waits until the tokens are
+///          paid back.
+///
+///   \param[in] bytes Number of bytes sent.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void TokenBucket::Force(const unsigned int bytes)
+{
+    if(mRate == 0)
+    {
+        return;
+    }
+    Mutex::ScopedLock lock(&mMutex);
+    Refill(CxUtils::Timer::GetTimeSeconds());
+    mTokens -= bytes;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Blocks until tokens are available for the data, then takes them.
+///
+///   \param[in] bytes Number of bytes to send.
+///   \param[in] abortFlag If not NULL, waiting stops when this becomes true.
+///
+///   \return True if tokens were taken, false if aborted.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool TokenBucket::Wait(const unsigned int bytes, volatile bool* abortFlag)
+{
+    double waitTimeSeconds = 0;
+    while(Take(bytes, &waitTimeSeconds) == false)
+    {
+        if(abortFlag && *abortFlag)
+        {
+            return false;
+        }
+        // Don't sleep too long at once, so aborts are noticed.
+        if(waitTimeSeconds > 0.1)
+        {
+            waitTimeSeconds = 0.1;
+        }
+        boost::this_thread::sleep(boost::posix_time::microseconds((long)(waitTimeSeconds*1000000.0) + 1));
+    }
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Adds tokens for the time passed since the last update.
+///
+///   \param[in] timeSeconds Current time.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void TokenBucket::Refill(const double timeSeconds)
+{
+    if(timeSeconds > mUpdateTimeSeconds)
+    {
+        mTokens += (timeSeconds - mUpdateTimeSeconds)*mRate;
+        if(mTokens > mBurst)
+        {
+            mTokens = mBurst;
+        }
+    }
+    mUpdateTimeSeconds = timeSeconds;
+}
+
+/*  End of File */
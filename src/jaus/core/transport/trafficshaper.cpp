@@ -0,0 +1,284 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file trafficshaper.cpp
+///  \brief This file contains the implementation of the TrafficShaper class
+///  used to queue outgoing data until a rate limit allows it to be sent.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#include "jaus/core/transport/trafficshaper.h"
+#include "jaus/core/transport/connection.h"
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+using namespace JAUS;
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Constructor, initializes default values (no rate limit).
+///
+////////////////////////////////////////////////////////////////////////////////////
+TrafficShaper::TrafficShaper() : mPool(64),
+                                 mQueuedBytes(0),
+                                 mMaxQueuedBytes(0),
+                                 mpSending(NULL),
+                                 mShutdownFlag(false)
+{
+    mSenderThread.SetThreadName("JAUS TrafficShaper");
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Destructor, stops the sender thread and discards queued packets.
+///
+////////////////////////////////////////////////////////////////////////////////////
+TrafficShaper::~TrafficShaper()
+{
+    {
+        boost::lock_guard<boost::mutex> lock(mMutex);
+        mShutdownFlag = true;
+        mCondition.notify_all();
+    }
+    mSenderThread.StopThread();
+    for(unsigned int i = 0; i < Lanes; i++)
+    {
+        for(Queue::iterator entry = mQueues[i].begin(); entry != mQueues[i].end(); entry++)
+        {
+            mPool.Release(entry->mpPacket);
+        }
+        mQueues[i].clear();
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Sets the rate limit.
+///
+///   \param[in] bytesPerSecond Rate limit, 0 = no limit.
+///   \param[in] burstBytes Bytes that can be sent at once, 0 uses 1/10 of
+///                         a second of data.
+///   \param[in] maxQueuedBytes Most bytes waiting to be sent before packets
+///                             are dropped, 0 = no limit.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void TrafficShaper::SetRate(const unsigned int bytesPerSecond,
+                            const unsigned int burstBytes,
+                            const unsigned int maxQueuedBytes)
+{
+    mBucket.SetRate(bytesPerSecond, burstBytes);
+    boost::lock_guard<boost::mutex> lock(mMutex);
+    mMaxQueuedBytes = maxQueuedBytes;
+    // Queued packets may be sendable now.
+    mCondition.notify_all();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Applies the rate limit to a packet being sent.  This method
+///          never waits for the rate limit.
+///
+///   The packet can be sent right away if the rate allows it and nothing is
+///   waiting ahead of it.  Otherwise it is copied and queued for the sender
+///   thread, or dropped if too much data is already waiting.
+///
+///   \param[in] connection Connection sending the packet, queued packets are
+///                         sent using Connection::TransmitPacket.
+///   \param[in] packet JAUS packet to send.
+///   \param[in] header JAUS header of the packet.
+///
+///   \return TrafficShaper::Send if the caller should send the packet now,
+///           TrafficShaper::Queued if it will be sent later, or
+///           TrafficShaper::Dropped if it was discarded.
+///
+////////////////////////////////////////////////////////////////////////////////////
+int TrafficShaper::Shape(const Connection* connection, const Packet& packet, const Header& header)
+{
+    unsigned int bytes = packet.Length();
+    if(mBucket.IsLimited() == false)
+    {
+        return Send;
+    }
+    if(header.mPriorityFlag >= Header::Priority::High)
+    {
+        mBucket.Force(bytes);
+        return Send;
+    }
+
+    boost::lock_guard<boost::mutex> lock(mMutex);
+    if(mShutdownFlag)
+    {
+        return Dropped;
+    }
+    // Only skip the queue if nothing is waiting, so packets stay in order.
+    if(mQueuedBytes == 0 && mpSending == NULL && mBucket.Take(bytes))
+    {
+        return Send;
+    }
+    if(mMaxQueuedBytes > 0 && mQueuedBytes + bytes > mMaxQueuedBytes)
+    {
+        return Dropped;
+    }
+    if(mSenderThread.IsThreadActive() == false &&
+       mSenderThread.CreateThread(&TrafficShaper::SenderThread, this) <= 0)
+    {
+        return Dropped;
+    }
+
+    Entry entry;
+    entry.mpPacket = mPool.Acquire();
+    *entry.mpPacket = packet;
+    entry.mHeader = header;
+    entry.mpConnection = connection;
+    mQueues[header.mPriorityFlag].push_back(entry);
+    mQueuedBytes += bytes;
+    mCondition.notify_all();
+
+    return Queued;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Discards any packets queued for a connection.  If the sender
+///          thread is using the connection, this method waits until it is
+///          done, so the connection can be deleted once this returns.
+///
+///   \param[in] connection Connection being shutdown.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void TrafficShaper::Remove(const Connection* connection)
+{
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    for(unsigned int i = 0; i < Lanes; i++)
+    {
+        Queue::iterator entry = mQueues[i].begin();
+        while(entry != mQueues[i].end())
+        {
+            if(entry->mpConnection == connection)
+            {
+                mQueuedBytes -= entry->mpPacket->Length();
+                mPool.Release(entry->mpPacket);
+                entry = mQueues[i].erase(entry);
+            }
+            else
+            {
+                entry++;
+            }
+        }
+    }
+    while(mpSending == connection)
+    {
+        mCondition.wait(lock);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \return Number of bytes waiting for the rate limit.
+///
+////////////////////////////////////////////////////////////////////////////////////
+unsigned int TrafficShaper::GetQueuedBytes() const
+{
+    boost::lock_guard<boost::mutex> lock(mMutex);
+    return mQueuedBytes;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Sends queued packets, highest priority first, as the rate
+///          limit allows.
+///
+///   \param[in] args Pointer to TrafficShaper.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void TrafficShaper::SenderThread(void* args)
+{
+    TrafficShaper* shaper = (TrafficShaper*)args;
+    boost::unique_lock<boost::mutex> lock(shaper->mMutex);
+
+    while(shaper->mShutdownFlag == false &&
+          shaper->mSenderThread.QuitThreadFlag() == false)
+    {
+        Queue* queue = NULL;
+        for(int i = (int)Lanes - 1; i >= 0 && queue == NULL; i--)
+        {
+            if(shaper->mQueues[i].empty() == false)
+            {
+                queue = &shaper->mQueues[i];
+            }
+        }
+        if(queue == NULL)
+        {
+            shaper->mCondition.timed_wait(lock, boost::posix_time::milliseconds(100));
+            continue;
+        }
+
+        double waitTimeSeconds = 0;
+        unsigned int bytes = queue->front().mpPacket->Length();
+        if(shaper->mBucket.Take(bytes, &waitTimeSeconds) == false)
+        {
+            // Check again once tokens are available, or when a higher priority
+            // packet arrives.
+            if(waitTimeSeconds > 0.1)
+            {
+                waitTimeSeconds = 0.1;
+            }
+            shaper->mCondition.timed_wait(lock, boost::posix_time::microseconds((long)(waitTimeSeconds*1000000.0) + 1));
+            continue;
+        }
+
+        // Move the packet out of the queue so Remove can't delete it while sending.
+        Queue sending;
+        sending.splice(sending.begin(), *queue, queue->begin());
+        shaper->mQueuedBytes -= bytes;
+        shaper->mpSending = sending.front().mpConnection;
+        lock.unlock();
+
+        sending.front().mpConnection->SendQueuedPacket(*sending.front().mpPacket,
+                                                       sending.front().mHeader);
+        shaper->mPool.Release(sending.front().mpPacket);
+
+        lock.lock();
+        shaper->mpSending = NULL;
+        shaper->mCondition.notify_all();
+    }
+}
+
+/*  End of File */
@@ -49,6 +49,8 @@
 
 #include <queue>
 #include <map>
+#include <list>
+#include <algorithm>
 #include <stdlib.h>
 #include <stdio.h>
 #include <iostream>
@@ -56,6 +58,8 @@
 #include <fstream>
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition_variable.hpp>
 #include <boost/thread.hpp>
@@ -65,6 +69,7 @@
 #include <cxutils/fileio.h>
 #include <cxutils/networking/udpclient.h>
 #include <cxutils/circulararray.h>
+#include <cxutils/timer.h>
 
 namespace JAUS
 {
@@ -78,41 +83,195 @@ namespace JAUS
     class JAUS_CORE_DLL Receipt
     {
     public:
-        typedef std::set<Receipt*> Set; ///< List of receipt data.
+        typedef std::vector<Receipt*> List; ///< List of receipt data.
         Receipt();
         ~Receipt();
         volatile bool mPendingFlag;     ///<  True if pending.
-        const Message* mpMessage;       ///<  Message sent.
+        Address mDestinationID;         ///<  Component the message was sent to (source of the response).
+        std::set<UShort> mResponseCodes;///<  Message codes of possible responses.
         Message* mpResponse;            ///<  Message response data (if only 1 possible response).
         Message::List* mpResponses;     ///<  Message response data.
+        UInt mAsyncID;                  ///<  ID of an asynchronous send (0 for blocking sends).
+        Transport::ResponseCallback* mpCallback;    ///<  Callback for asynchronous sends.
+        Message::List mAsyncResponses;  ///<  Possible responses created for asynchronous sends.
         boost::mutex mConditionMutex;               ///<  Receipt mutex.
         boost::condition_variable mWaitCondition;   ///<  Used to notify when data is ready.
     };
+
+    ////////////////////////////////////////////////////////////////////////////////////
+    ///
+    ///   \class ReceiptShard
+    ///   \brief Part of the index of receipts waiting for responses.  Receipts
+    ///          are hashed by response source and message code to one of
+    ///          several shards, so matching a packet only locks one shard and
+    ///          only looks at receipts expecting that message from that source.
+    ///
+    ////////////////////////////////////////////////////////////////////////////////////
+    class ReceiptShard
+    {
+    public:
+        typedef boost::unordered_map<ULong, Receipt::List> Map;
+        boost::mutex mMutex;            ///<  Mutex for thread protection of shard.
+        Map mReceipts;                  ///<  Receipts by source and response code.
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////
+    ///
+    ///   \class SentStream
+    ///   \brief Copy of a multi-packet stream sent, kept so packets reported
+    ///          missing by the receiver (NACK) can be retransmitted.
+    ///
+    ////////////////////////////////////////////////////////////////////////////////////
+    class SentStream
+    {
+    public:
+        typedef std::list<SentStream> List;
+        SentStream() : mMessageCode(0), mFirstSequenceNumber(0), mSizeBytes(0), mSendTimeMs(0) {}
+        Address mDestinationID;         ///<  Destination of the stream.
+        UShort mMessageCode;            ///<  Message type.
+        UShort mFirstSequenceNumber;    ///<  Sequence number of first packet.
+        Packet::List mPackets;          ///<  Packets sent.
+        Header::List mHeaders;          ///<  Headers of packets sent.
+        unsigned int mSizeBytes;        ///<  Total size of packets in bytes.
+        Time::Stamp mSendTimeMs;        ///<  Time the stream was sent.
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////
+    ///
+    ///   \class SendStream
+    ///   \brief Packets and headers messages are serialized into when sent.  One
+    ///          is kept per thread, and packets are written in place, so their
+    ///          memory is re-used instead of allocated for each message.
+    ///
+    ////////////////////////////////////////////////////////////////////////////////////
+    class SendStream
+    {
+    public:
+        Packet::List mPackets;          ///<  Packets of the message being sent.
+        Header::List mHeaders;          ///<  Headers of the packets.
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////
+    ///
+    ///   \class ProcessingWorker
+    ///   \brief Thread used to process single packets when more than one
+    ///          message processing thread is used.
+    ///
+    ///   Packets are given to a worker based on their source, so all packets
+    ///   from a sender are processed in order by the same thread.  Each worker
+    ///   has its own message cache for de-serializing data, so no locking or
+    ///   memory allocation is needed per message.
+    ///
+    ////////////////////////////////////////////////////////////////////////////////////
+    class ProcessingWorker
+    {
+    public:
+        typedef std::vector<ProcessingWorker*> List;
+        ProcessingWorker(Transport* transport,
+                         PacketPool* pool,
+                         const unsigned int capacity,
+                         const PacketQueue::OverflowPolicy policy) : mpTransport(transport),
+                                                                     mQueue(capacity, policy, pool),
+                                                                     mSignals(0)
+        {
+        }
+        ~ProcessingWorker()
+        {
+            mThread.StopThread();
+            mQueue.Clear();
+            std::map<UShort, Message*>::iterator msg;
+            for(msg = mMessageCache.begin(); msg != mMessageCache.end(); msg++)
+            {
+                delete msg->second;
+            }
+            mMessageCache.clear();
+        }
+        // Wakes the worker after a packet is queued.
+        void Signal()
+        {
+            {
+                boost::lock_guard<boost::mutex> lock(mMutex);
+                mSignals++;
+            }
+            mCondition.notify_one();
+        }
+        // Waits until signaled or the timeout.
+        void Wait(const unsigned int timeoutMs)
+        {
+            boost::unique_lock<boost::mutex> lock(mMutex);
+            if(mSignals == 0 && mThread.QuitThreadFlag() == false)
+            {
+                mCondition.timed_wait(lock, boost::posix_time::milliseconds(timeoutMs));
+            }
+            mSignals = 0;
+        }
+        Transport* mpTransport;                     ///<  Transport the worker processes packets for.
+        PriorityPacketQueue mQueue;                 ///<  Single packets to process.
+        std::map<UShort, Message*> mMessageCache;   ///<  Pre-allocated memory for message decoding.
+        Thread mThread;                             ///<  Processing thread.
+        boost::mutex mMutex;                        ///<  Mutex for signals.
+        boost::condition_variable mCondition;       ///<  Wakes the thread when signaled.
+        unsigned int mSignals;                      ///<  Number of signals since last wait.
+    };
 }
 
 //#define USE_MESSAGE_QUEUE
 
 using namespace JAUS;
 
-static const unsigned int PACKET_QUEUE_SIZE = 1024;
+static const unsigned int PACKET_QUEUE_SIZE = PacketQueue::DefaultCapacity;
+static const unsigned int LARGE_DATA_SET_MEMORY_LIMIT = 16*1024*1024;
+static const unsigned int LARGE_DATA_SET_TIMEOUT_MS = 500;
+static const unsigned int RETRANSMIT_CACHE_SIZE = 8*1024*1024;
+static const unsigned int RETRANSMIT_CACHE_TIME_MS = 5000;
+static const unsigned int NACK_DELAY_MS = 50;
+static const unsigned int URGENT_PACKETS_PER_UPDATE = 16;
+static const unsigned int RECEIPT_SHARDS = 16;
+static const unsigned int MAX_NACKS = 5;
 
 const std::string Transport::Name = "urn:jaus:jss:core:Transport";
 
 
+/** Deletes the message cache of a thread when it exits. */
+static void DeleteMessageCache(std::map<UShort, Message*>* messageCache)
+{
+    std::map<UShort, Message*>::iterator msg;
+    for(msg = messageCache->begin(); msg != messageCache->end(); msg++)
+    {
+        delete msg->second;
+    }
+    delete messageCache;
+}
+
+
+/** Service that creates each message type, NULL if no Service does. */
+typedef std::map<UShort, const Service*> MessageFactoryTable;
+
+
 /** Stores all data structures required by the Transport Layer. */
 class Data
 {
 public:
-    Data(const bool singleThreadModeFlag) : mpSharedMemory(new SharedMemory(singleThreadModeFlag))
+    Data(const bool singleThreadModeFlag) : mpSharedMemory(new SharedMemory(singleThreadModeFlag)),
+                                            mSinglePacketQueue(PACKET_QUEUE_SIZE, PacketQueue::DropOldest, &mPacketPool),
+                                            mMultiPacketQueue(PACKET_QUEUE_SIZE*2, PacketQueue::DropOldest, &mPacketPool),
+                                            mMessageCache(DeleteMessageCache)
     {
         mProcessingThreadsLimit = 1;
         mStopMessageProcessingFlag = false;
         mSequenceNumber = 0;
-        mSinglePacketQueue.reserve(PACKET_QUEUE_SIZE);
-        mMultiPacketQueue.reserve(PACKET_QUEUE_SIZE*2);
-        mSinglePacketCache.Reserve(Header::MaxPacketSize);
-        mMultiPacketCache.Reserve(Header::MaxPacketSize);
         mLastNodeManagerCheckTimeMs = 0;
+        mLargeDataSetMemoryLimit = LARGE_DATA_SET_MEMORY_LIMIT;
+        mLargeDataSetTimeoutMs = LARGE_DATA_SET_TIMEOUT_MS;
+        mRetransmitFlag = false;
+        mRetransmitCacheSize = RETRANSMIT_CACHE_SIZE;
+        mNackDelayMs = NACK_DELAY_MS;
+        mSentStreamsBytes = 0;
+        mUrgentSends = 0;
+        mAsyncID = 0;
+        mPacketQueueCapacity = PACKET_QUEUE_SIZE;
+        mPacketQueuePolicy = PacketQueue::DropOldest;
+        mpMessageFactories.reset(new MessageFactoryTable());
     }
     ~Data() {}
 
@@ -120,19 +279,21 @@ public:
 
     NodeManager mNodeManager;                               ///<  Manages connection on the computing node.
 
-    typedef CxUtils::CircularArray<Packet> PacketQueue;     ///<  Type definition for a packet queue.
 #ifdef USE_MESSAGE_QUEUE
     std::queue<Message*> mMessageQueue;                     ///<  Message queue.
     Mutex mMessageQueueMutex;                               ///<  Mutex for thread protection of queue.
 #endif
-    SharedMutex mSinglePacketQueueMutex;                    ///<  Mutex for thread protection of single packet queue.
-    PacketQueue mSinglePacketQueue;                         ///<  Queue of message packets that are not part of a LDS.
-    SharedMutex mMultiPacketQueueMutex;                     ///<  Mutex for thread protection of multi-packet queue.
-    PacketQueue mMultiPacketQueue;                          ///<  Queue for multi-packet stream packets (LDS).
-    Packet  mSinglePacketCache;                             ///<  Cached copy of a single packet for de-serialization.
-    Packet  mMultiPacketCache;                              ///<  Cached copy of a multi-packet for de-serialization.
+    PacketPool mPacketPool;                                 ///<  Re-usable packet buffers for receiving and sending.
+    PriorityPacketQueue mSinglePacketQueue;                 ///<  Queue of message packets that are not part of a LDS.
+    PriorityPacketQueue mMultiPacketQueue;                  ///<  Queue for multi-packet stream packets (LDS).
+    LatencyHistogram mLatency[PriorityPacketQueue::Lanes];  ///<  Time packets wait before processing by priority.
+    ConflationTable mConflation;                            ///<  Newest state reports waiting in the single packet queue.
+    boost::atomic<unsigned int> mUrgentSends;               ///<  High/Safety Critical packets being sent.
+    TokenBucket mLargeDataSetPacer;                         ///<  Paces large data sets sent to other nodes.
     unsigned int mProcessingThreadsLimit;                   ///<  How many threads to use for message processing, default is 1.
-    std::vector<Thread*> mProcessingThreads;                ///<  Additional processing threads.
+    ProcessingWorker::List mProcessingWorkers;              ///<  Threads single packets are processed in (if limit > 1).
+    unsigned int mPacketQueueCapacity;                      ///<  Single packet queue capacity per priority.
+    PacketQueue::OverflowPolicy mPacketQueuePolicy;         ///<  What to do when a packet queue is full.
 
     volatile bool mStopMessageProcessingFlag;               ///<  If true, all message processing should stop.
     Time::Stamp mLastNodeManagerCheckTimeMs;                ///<  Last time we check to see if node manager was still running.
@@ -142,14 +303,31 @@ public:
 
     SharedMutex mMessageTemplatesMutex;                     ///<  Mutex for thread protection.
     std::map<UShort, Message*> mMessageTemplates;           ///<  Custom message templates.
-    SharedMutex mMessageCacheMutex;                         ///<  Mutex for thread protection of message cache.
-    std::map<UShort, Message*> mMessageCache;               ///<  Pre-allocated memory for message decoding.
+    Mutex mMessageFactoriesMutex;                           ///<  Serializes changes to the message factories.
+    boost::shared_ptr<const MessageFactoryTable> mpMessageFactories; ///<  Message factories (never modified once published, use boost::atomic_load/store).
+    boost::thread_specific_ptr<std::map<UShort, Message*> > mMessageCache; ///<  Pre-allocated memory for message decoding (per thread).
+    boost::thread_specific_ptr<SendStream> mSendStreams;    ///<  Re-used memory for serializing messages sent (per thread).
 
-    Packet mLargeDataSetCache;                              ///<  Cache packet memory for merged large data sets.
     LargeDataSet::Map mLargeDataSets;                       ///<  Large data sets.
-
-    SharedMutex mPendingReceiptsMutex;                      ///<  Mutex for thread protection of receipts.
-    Receipt::Set mPendingReceipts;                          ///<  List of blocking send calls waiting for responses.
+    unsigned int mLargeDataSetMemoryLimit;                  ///<  Max memory for large data sets from a single source.
+    unsigned int mLargeDataSetTimeoutMs;                    ///<  Large data sets not updated within this time are dropped.
+    Mutex mLargeDataSetsMutex;                              ///<  Mutex for thread protection of large data sets.
+
+    volatile bool mRetransmitFlag;                          ///<  If true, missing large data set packets are requested/resent.
+    unsigned int mRetransmitCacheSize;                      ///<  Max bytes of sent streams kept for retransmission.
+    unsigned int mNackDelayMs;                              ///<  How long to wait for missing packets before requesting them.
+    Mutex mSentStreamsMutex;                                ///<  Mutex for thread protection of sent streams.
+    SentStream::List mSentStreams;                          ///<  Streams sent, oldest first.
+    unsigned int mSentStreamsBytes;                         ///<  Total size of streams sent in bytes.
+
+    SharedMutex mCompressionMutex;                          ///<  Mutex for thread protection of compression options.
+    std::map<std::pair<UShort, UInt>, unsigned int> mCompressionThresholds; ///<  Compression threshold by message code and destination.
+
+    ReceiptShard mReceiptShards[RECEIPT_SHARDS];            ///<  Sends waiting for responses by source and response code.
+    Mutex mAsyncReceiptsMutex;                              ///<  Mutex for thread protection of asynchronous sends.
+    std::map<UInt, Receipt*> mAsyncReceipts;                ///<  Asynchronous sends waiting for responses by ID.
+    std::multimap<double, UInt> mAsyncDeadlines;            ///<  Asynchronous send IDs by timeout (seconds).
+    UInt mAsyncID;                                          ///<  Last asynchronous send ID.
 
     Transport::Callback::Map mMessageCallbacks;             ///<  Map of message callbacks.
     SharedMutex mSequenceNumberMutex;                       ///<  Mutex for thread protection of sequence number.
@@ -161,6 +339,83 @@ public:
 #define MEMBER ((Data *)mpData)
 
 
+/** Gets the packets messages sent by the calling thread are serialized into. */
+static SendStream* GetSendStream(Data* data)
+{
+    if(data->mSendStreams.get() == NULL)
+    {
+        data->mSendStreams.reset(new SendStream());
+    }
+    return data->mSendStreams.get();
+}
+
+
+/** Gets the key pending receipts are indexed by. */
+static ULong GetReceiptKey(const Address& source, const UShort messageCode)
+{
+    return (((ULong)source.ToUInt()) << 16) | messageCode;
+}
+
+
+/** Gets the shard a pending receipt key is stored in. */
+static unsigned int GetReceiptShard(const ULong key)
+{
+    return (unsigned int)(boost::hash<ULong>()(key) % RECEIPT_SHARDS);
+}
+
+
+/** Gets the processing worker packets from a source are given to. */
+static unsigned int GetProcessingWorker(const Address& source, const unsigned int workers)
+{
+    UInt id = source.ToUInt();
+    // Mix subsystem, node, and component so each changes the worker.
+    id ^= id >> 16;
+    id ^= id >> 8;
+    return (unsigned int)(id % workers);
+}
+
+
+/** Gets the memory a large data set may use given the limit per source and
+    the memory used by the other data sets from the source (0 = no limit). */
+static unsigned int GetLargeDataSetMemoryLimit(const unsigned int limit, const unsigned int used)
+{
+    if(limit == 0)
+    {
+        return 0;
+    }
+    // A limit of 1 byte rejects everything.
+    return used < limit ? limit - used : 1;
+}
+
+
+/** Pops the next packet to process from a single packet queue, and records
+    how long it waited.  Returns NULL if nothing to process. */
+static Packet* PopSinglePacket(Data* data, PriorityPacketQueue& queue)
+{
+    Byte priority = 0;
+    double pushTimeSeconds = 0;
+    Packet* packet = queue.Pop(&priority, &pushTimeSeconds);
+
+    if(packet == NULL || data->mStopMessageProcessingFlag)
+    {
+        queue.Release(packet);
+        return NULL;
+    }
+    data->mLatency[priority].Add(CxUtils::Timer::GetTimeSeconds() - pushTimeSeconds);
+
+    // Use the newest data if the report was updated while queued.
+    Header queuedHeader;
+    ConflationTable::Key key;
+    packet->SetReadPos(0);
+    if(queuedHeader.Read(*packet) > 0 &&
+       data->mConflation.GetKey(*packet, queuedHeader, key))
+    {
+        data->mConflation.Take(key, *packet);
+    }
+    return packet;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Constructor, initializes default values.
@@ -169,19 +424,28 @@ public:
 Receipt::Receipt()
 {
     mPendingFlag = true;
-    mpMessage = NULL;
     mpResponse = NULL;
     mpResponses = NULL;
+    mAsyncID = 0;
+    mpCallback = NULL;
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////////
 ///
-///   \brief Destructor.
+///   \brief Destructor, deletes responses created for asynchronous sends.
 ///
 ////////////////////////////////////////////////////////////////////////////////////
 Receipt::~Receipt()
 {
+    Message::List::iterator response;
+    for(response = mAsyncResponses.begin();
+        response != mAsyncResponses.end();
+        response++)
+    {
+        delete *response;
+    }
+    mAsyncResponses.clear();
 }
 
 
@@ -194,6 +458,8 @@ Transport::Transport() : Service(Service::ID(Transport::Name, 1.0), Service::ID(
                          
 {
     mpData = (void*)new Data(mSingleThreadModeFlag);
+    // Processing threads sleep until packets are queued.
+    mServiceUpdateSignalFlag = true;
 }
 
 
@@ -218,16 +484,9 @@ Transport::~Transport()
         }
         MEMBER->mMessageTemplates.clear();
     }
-    {
-        WriteLock wLock(MEMBER->mMessageTemplatesMutex);
-        for(msg = MEMBER->mMessageCache.begin();
-            msg != MEMBER->mMessageCache.end();
-            msg++)
-        {
-            delete msg->second;
-        }
-        MEMBER->mMessageCache.clear();
-    }
+    // Caches of other threads are deleted when they exit.
+    MEMBER->mMessageCache.reset();
+    MEMBER->mSendStreams.reset();
 
     delete (Data *)mpData;
 }
@@ -271,6 +530,33 @@ bool Transport::Initialize(const Address& componentID)
     smParams.mComponentID = componentID;
     smParams.mDestPortNumber = smParams.mSourcePortNumber = MEMBER->mNodeManager.GetSettings()->GetDefaultPortNumber();
     smParams.mSharedConnectionType = SharedMemory::Parameters::Host;
+    smParams.mRingBufferFlag = MEMBER->mNodeManager.GetSettings()->UseSharedMemoryRings();
+    smParams.mWakeupFlag = MEMBER->mNodeManager.GetSettings()->UseSharedMemoryWakeup();
+
+    // Large data sets leaving this node are paced to the network rate limit.
+    MEMBER->mLargeDataSetPacer.SetRate(MEMBER->mNodeManager.GetSettings()->GetRateLimit(),
+                                       MEMBER->mNodeManager.GetSettings()->GetRateLimitBurst());
+
+    // Look up which Service makes each message type once, instead of
+    // searching all Services for every message received.
+    BuildMessageFactoryTable();
+
+    // Single packets are split between workers by source when using more
+    // than one processing thread.
+    if(false == mSingleThreadModeFlag &&
+       MEMBER->mProcessingThreadsLimit > 1 &&
+       MEMBER->mProcessingWorkers.size() == 0)
+    {
+        for(unsigned int i = 0; i < MEMBER->mProcessingThreadsLimit; i++)
+        {
+            ProcessingWorker* worker = new ProcessingWorker(this,
+                                                            &MEMBER->mPacketPool,
+                                                            MEMBER->mPacketQueueCapacity,
+                                                            MEMBER->mPacketQueuePolicy);
+            MEMBER->mProcessingWorkers.push_back(worker);
+            worker->mThread.CreateThread(Transport::ProcessingWorkerThread, worker);
+        }
+    }
 
     // Subscribe to messages received by inbox.
     MEMBER->mpSharedMemory->RegisterCallback(this);
@@ -282,15 +568,6 @@ bool Transport::Initialize(const Address& componentID)
 
         if(false == mSingleThreadModeFlag && this->mServiceUpdateThread.IsThreadActive() == false)
         {
-            for(unsigned int i = 0; i < MEMBER->mProcessingThreadsLimit - 1; i++)
-            {
-                Thread* thread = new Thread();
-                MEMBER->mProcessingThreads.push_back(thread);
-            }
-            for(unsigned int i = 0; i < (int)MEMBER->mProcessingThreads.size(); i++)
-            {
-                MEMBER->mProcessingThreads[i]->CreateThread(Service::ServiceUpdateThreadFunc, this);
-            }
             this->StartServiceUpdateEventThread();
             boost::this_thread::sleep(boost::posix_time::milliseconds(100)); 
         }
@@ -324,13 +601,37 @@ bool Transport::IsInitialized() const
 void Transport::Shutdown()
 {
     MEMBER->mStopMessageProcessingFlag = true;
+    // Release any connection threads waiting on a full queue.
+    MEMBER->mSinglePacketQueue.SignalShutdown(true);
+    MEMBER->mMultiPacketQueue.SignalShutdown(true);
+    for(unsigned int i = 0; i < (unsigned int)MEMBER->mProcessingWorkers.size(); i++)
+    {
+        MEMBER->mProcessingWorkers[i]->mQueue.SignalShutdown(true);
+    }
     StopServiceUpdateEventThread();
-    for(unsigned int i = 0; i < (unsigned int)MEMBER->mProcessingThreads.size(); i++)
+
+    // Stop waiting for responses to asynchronous sends, callbacks are
+    // given no response (same as a timeout).
+    Receipt::List pending;
+    {
+        Mutex::ScopedLock lock(&MEMBER->mAsyncReceiptsMutex);
+        std::map<UInt, Receipt*>::iterator entry;
+        for(entry = MEMBER->mAsyncReceipts.begin(); entry != MEMBER->mAsyncReceipts.end(); entry++)
+        {
+            boost::lock_guard<boost::mutex> receiptLock(entry->second->mConditionMutex);
+            if(entry->second->mPendingFlag)
+            {
+                entry->second->mPendingFlag = false;
+                pending.push_back(entry->second);
+            }
+        }
+        MEMBER->mAsyncDeadlines.clear();
+    }
+    Receipt::List::iterator receipt;
+    for(receipt = pending.begin(); receipt != pending.end(); receipt++)
     {
-        MEMBER->mProcessingThreads[i]->StopThread();
-        delete MEMBER->mProcessingThreads[i];
+        FinishAsyncReceipt(*receipt, true);
     }
-    MEMBER->mProcessingThreads.clear();
 
     MEMBER->mpSharedMemory->ClearCallbacks();
 
@@ -339,6 +640,19 @@ void Transport::Shutdown()
     // Shutdown the Node Manager if running.
     MEMBER->mNodeManager.Shutdown();
 
+    // Nothing is received anymore, so workers can be deleted.
+    for(unsigned int i = 0; i < (unsigned int)MEMBER->mProcessingWorkers.size(); i++)
+    {
+        delete MEMBER->mProcessingWorkers[i];
+    }
+    MEMBER->mProcessingWorkers.clear();
+
+    MEMBER->mSinglePacketQueue.Clear();
+    MEMBER->mMultiPacketQueue.Clear();
+    MEMBER->mConflation.Clear();
+    MEMBER->mSinglePacketQueue.SignalShutdown(false);
+    MEMBER->mMultiPacketQueue.SignalShutdown(false);
+
     MEMBER->mStopMessageProcessingFlag = false;
 }
 
@@ -446,15 +760,6 @@ bool Transport::SerializeMessage(const Message* message,
                                  const UShort startingSequenceNumber,
                                  const int broadcastFlags) const
 {
-    Packet packet;
-    Header header;
-
-    // Pre-allocate memory. (use TCP overhead because it is the largest).
-    packet.Reserve(JAUS::Header::MaxPacketSize + TCP::OverheadSizeBytes + USHORT_SIZE);
-
-    // Clear stream/headers.
-    stream.clear();
-    streamHeaders.clear();
     unsigned int bestPacketSize = 1500 - /*MEMBER->mpSharedMemory->GetMaximumPacketSizeInBytes()*/ - TCP::OverheadSizeBytes - USHORT_SIZE;
     // If the message is a large data set, create a multi-packet stream.
     if(message->IsLargeDataSet(bestPacketSize))
@@ -463,15 +768,22 @@ bool Transport::SerializeMessage(const Message* message,
                                           streamHeaders,
                                           bestPacketSize,
                                           &(MEMBER->mpSharedMemory->GetTransportHeader()),
-                                          startingSequenceNumber) > 0;
+                                          startingSequenceNumber,
+                                          (Byte)broadcastFlags,
+                                          GetCompressionThreshold(message->GetMessageCode(),
+                                                                  message->GetDestinationID())) > 0;
     }
-    // Single packet.
-    else if(message->Write(packet, header, &(MEMBER->mpSharedMemory->GetTransportHeader()), true, startingSequenceNumber, (Byte)broadcastFlags) > 0)
+    // Single packet, written in place so the packet memory in the
+    // stream is re-used.
+    stream.resize(1);
+    streamHeaders.resize(1);
+    stream.front().Clear(false);
+    if(message->Write(stream.front(), streamHeaders.front(), &(MEMBER->mpSharedMemory->GetTransportHeader()), true, startingSequenceNumber, (Byte)broadcastFlags) > 0)
     {
-        stream.push_back(packet);
-        streamHeaders.push_back(header);
         return true;
     }
+    stream.clear();
+    streamHeaders.clear();
     return false;
 }
 
@@ -504,8 +816,16 @@ void Transport::UpdateServiceEvent()
     {
         MEMBER->mNodeManager.UpdateServiceEvent();
     }
+
+    CheckAsyncReceiptTimeouts();
 #ifndef USE_MESSAGE_QUEUE
     ProcessSinglePackets();
+    // High and Safety Critical packets preempt bulk large data set packets,
+    // limited so that multi-packet streams still make progress.
+    for(unsigned int i = 0; i < URGENT_PACKETS_PER_UPDATE && MEMBER->mSinglePacketQueue.HasUrgent(); i++)
+    {
+        ProcessSinglePackets();
+    }
     ProcessMultiPackets();
 #else
     Message* messageToShare = NULL;
@@ -540,8 +860,25 @@ void Transport::UpdateServiceEvent()
 ////////////////////////////////////////////////////////////////////////////////////
 Message* Transport::CreateMessage(const UShort messageCode) const
 {
-    // Try to create the message recursively.
-    Message* message = CreateMessageFromService(messageCode, this);
+    if(MEMBER->mStopMessageProcessingFlag)
+    {
+        return NULL;
+    }
+
+    // The table is never modified once published, so no lock is needed.
+    boost::shared_ptr<const MessageFactoryTable> factories = boost::atomic_load(&MEMBER->mpMessageFactories);
+    MessageFactoryTable::const_iterator f = factories->find(messageCode);
+    if(f != factories->end())
+    {
+        // Message types no Service creates have a NULL factory.
+        return f->second ? CreateMessageFromFactory(messageCode, f->second) : NULL;
+    }
+
+    // First time the message type is seen, so search all Services once and
+    // remember the result (even if no Service creates it).
+    Message* message = NULL;
+    const Service* factory = FindMessageFactory(messageCode, this, &message);
+    SetMessageFactory(messageCode, factory);
     return message;
 }
 
@@ -568,9 +905,10 @@ bool Transport::Send(const Message* message,
         std::cout << "JAUS::Transport::Send::ERROR: Not initialized!\n";
         return false;
     }
-    Packet sendPacket;
-    Packet::List stream;
-    Header::List streamHeaders;
+    PacketPool::Buffer sendPacket(MEMBER->mPacketPool);
+    SendStream* sendStream = GetSendStream(MEMBER);
+    Packet::List& stream = sendStream->mPackets;
+    Header::List& streamHeaders = sendStream->mHeaders;
     Packet::List::iterator packet;
     Header::List::iterator header;
     Header jausHeader;
@@ -604,12 +942,19 @@ bool Transport::Send(const Message* message,
         {
             header->mSequenceNumber = sequenceNumber++;
             // Sequence number goes at the end of the packet (this is retarded).
-            packet->Write(sequenceNumber, packet->Length() - USHORT_SIZE);
+            packet->Write(header->mSequenceNumber, packet->Length() - USHORT_SIZE);
+            PaceLargeDataSet(header->mDestinationID, packet->Length());
+            // Let urgent messages from other threads go first.
+            if(MEMBER->mUrgentSends > 0)
+            {
+                boost::this_thread::yield();
+            }
             if(SendPacket(*packet, *header) == false)
             {
                 return false;
             }
         }
+        CacheSentStream(message->GetMessageCode(), stream, streamHeaders);
         return true;
     }
     // Small message (single packet).
@@ -619,9 +964,19 @@ bool Transport::Send(const Message* message,
         sequenceNumber = MEMBER->mSequenceNumber;
         (*((UShort *)(&MEMBER->mSequenceNumber)))++;
     }
-    if(message->Write(*((Packet *)&sendPacket), jausHeader, &(MEMBER->mpSharedMemory->GetTransportHeader()), true, sequenceNumber, (Byte)broadcastFlags))
+    if(message->Write(*sendPacket, jausHeader, &(MEMBER->mpSharedMemory->GetTransportHeader()), true, sequenceNumber, (Byte)broadcastFlags))
     {
-        bool result =  SendPacket(sendPacket, jausHeader);
+        // Let threads sending large data sets know to yield.
+        bool urgent = jausHeader.mPriorityFlag >= Header::Priority::High;
+        if(urgent)
+        {
+            MEMBER->mUrgentSends++;
+        }
+        bool result =  SendPacket(*sendPacket, jausHeader);
+        if(urgent)
+        {
+            MEMBER->mUrgentSends--;
+        }
 
         return result;
     }
@@ -658,9 +1013,10 @@ bool Transport::SendToList(const Address::Set& destinations,
         return false;
     }
 
-    Packet sendPacket;
-    Packet::List stream;
-    Header::List streamHeaders;
+    PacketPool::Buffer sendPacket(MEMBER->mPacketPool);
+    SendStream* sendStream = GetSendStream(MEMBER);
+    Packet::List& stream = sendStream->mPackets;
+    Header::List& streamHeaders = sendStream->mHeaders;
     Packet::List::iterator packet;
     Header::List::iterator header;
     Header jausHeader;
@@ -679,35 +1035,62 @@ bool Transport::SendToList(const Address::Set& destinations,
 
     if(message->IsLargeDataSet(bestPacketSize))
     {
-        if(SerializeMessage(message, stream, streamHeaders, 0, (Byte)broadcastFlags) == false)
-        {
-            return false;
-        }
+        // Destinations may use different compression options, so
+        // serialize the message once for each option used.
+        std::map<unsigned int, Address::Set> compressionGroups;
+        std::map<unsigned int, Address::Set>::iterator group;
         for(dest = destinations.begin();
             dest != destinations.end();
             dest++)
         {
-            // Get sequence numbers for this message sequence.
+            compressionGroups[GetCompressionThreshold(message->GetMessageCode(), *dest)].insert(*dest);
+        }
+        for(group = compressionGroups.begin();
+            group != compressionGroups.end();
+            group++)
+        {
+            if(message->WriteLargeDataSet(stream,
+                                          streamHeaders,
+                                          bestPacketSize,
+                                          &(MEMBER->mpSharedMemory->GetTransportHeader()),
+                                          0,
+                                          (Byte)broadcastFlags,
+                                          group->first) <= 0)
+            {
+                return false;
+            }
+            // Reserve sequence numbers for every destination at once.
             UShort sequenceNumber = 0;
             {
                 WriteLock wsLock(*seqMutex);
                 sequenceNumber = MEMBER->mSequenceNumber;
-                (*((UShort *)(&MEMBER->mSequenceNumber))) += (UShort)stream.size();;
+                (*((UShort *)(&MEMBER->mSequenceNumber))) += (UShort)(stream.size()*group->second.size());
             }
-            for(packet = stream.begin(), header = streamHeaders.begin();
-                packet != stream.end() && header != streamHeaders.end();
-                packet++, header++)
+            for(dest = group->second.begin();
+                dest != group->second.end();
+                dest++)
             {
-                header->mDestinationID = *dest;
-                header->mSequenceNumber = sequenceNumber++;
-                packet->SetWritePos(transportHeaderSize);
-                // Update header
-                header->Write(*packet);
-                // Send the data.
-                if(SendPacket(*packet, *header) == false)
+                for(packet = stream.begin(), header = streamHeaders.begin();
+                    packet != stream.end() && header != streamHeaders.end();
+                    packet++, header++)
                 {
-                    return false;
+                    header->mDestinationID = *dest;
+                    header->mSequenceNumber = sequenceNumber++;
+                    // Packets are already serialized, only patch routing data.
+                    header->WriteRouting(*packet, transportHeaderSize);
+                    PaceLargeDataSet(header->mDestinationID, packet->Length());
+                    // Let urgent messages from other threads go first.
+                    if(MEMBER->mUrgentSends > 0)
+                    {
+                        boost::this_thread::yield();
+                    }
+                    // Send the data.
+                    if(SendPacket(*packet, *header) == false)
+                    {
+                        return false;
+                    }
                 }
+                CacheSentStream(message->GetMessageCode(), stream, streamHeaders);
             }
         }
         return true;
@@ -716,24 +1099,24 @@ bool Transport::SendToList(const Address::Set& destinations,
     {
         bool result = false;
         
-        message->Write(sendPacket, jausHeader, &(MEMBER->mpSharedMemory->GetTransportHeader()), true, 0, (Byte)broadcastFlags);
+        message->Write(*sendPacket, jausHeader, &(MEMBER->mpSharedMemory->GetTransportHeader()), true, 0, (Byte)broadcastFlags);
+        // Reserve sequence numbers for every destination at once.
+        {
+            WriteLock wsLock(*seqMutex);
+            jausHeader.mSequenceNumber = MEMBER->mSequenceNumber;
+            (*((UShort *)(&MEMBER->mSequenceNumber))) += (UShort)destinations.size();
+        }
         for(dest = destinations.begin();
-            dest != destinations.end() && sendPacket.Length() > 0;
+            dest != destinations.end() && sendPacket->Length() > 0;
             dest++)
         {
-            // Update JAUS Header data in packet.
+            // Update JAUS Header data in packet, the payload is
+            // serialized once and only routing data changes.
             jausHeader.mDestinationID = *dest;
-            // Now get a new sequence number
-            {
-                WriteLock wsLock(*seqMutex);
-                jausHeader.mSequenceNumber = MEMBER->mSequenceNumber;
-                (*((UShort *)(&MEMBER->mSequenceNumber)))++;
-            }
-            // Replace sequence number in packet.
-            sendPacket.SetWritePos(transportHeaderSize);
-            jausHeader.Write(sendPacket);
+            jausHeader.WriteRouting(*sendPacket, transportHeaderSize);
             // Send the packet
-            result = SendPacket(sendPacket, jausHeader);
+            result = SendPacket(*sendPacket, jausHeader);
+            jausHeader.mSequenceNumber++;
         }
         return result;
     }
@@ -792,7 +1175,6 @@ bool Transport::Send(const Message* message,
                      const unsigned int waitTimeMs) const
 {
     Receipt receipt;
-    Receipt::Set::iterator ritr;
 
     if(message == NULL || possibleResponses.size() == 0 || message->GetDestinationID().IsBroadcast())
     {
@@ -800,7 +1182,7 @@ bool Transport::Send(const Message* message,
     }
 
     receipt.mPendingFlag = true;
-    receipt.mpMessage = message;
+    receipt.mDestinationID = message->GetDestinationID();
     if(possibleResponses.size() == 1)
     {
         receipt.mpResponse = possibleResponses.front();
@@ -809,41 +1191,184 @@ bool Transport::Send(const Message* message,
     {
         receipt.mpResponses = &possibleResponses;
     }
-
-    Receipt::Set* pending = NULL;
+    Message::List::iterator response;
+    for(response = possibleResponses.begin();
+        response != possibleResponses.end();
+        response++)
     {
-        WriteLock wLock(*((SharedMutex *)&MEMBER->mPendingReceiptsMutex));
-        pending = ((Receipt::Set *)&MEMBER->mPendingReceipts);
-        pending->insert(&receipt);
+        receipt.mResponseCodes.insert((*response)->GetMessageCode());
     }
 
+    AddPendingReceipt(&receipt);
+
     {
         if(Send(message))
         {
 
             boost::unique_lock<boost::mutex> wLock(receipt.mConditionMutex);
             
+            // Check the flag, the response may arrive before we wait.
             if(waitTimeMs == 0)
             {
-                receipt.mWaitCondition.wait(wLock);
+                while(receipt.mPendingFlag)
+                {
+                    receipt.mWaitCondition.wait(wLock);
+                }
             }
             else
             {
-                receipt.mWaitCondition.timed_wait(wLock, boost::posix_time::milliseconds(waitTimeMs));
+                boost::system_time timeout = boost::get_system_time() + boost::posix_time::milliseconds(waitTimeMs);
+                while(receipt.mPendingFlag &&
+                      receipt.mWaitCondition.timed_wait(wLock, timeout))
+                {
+                }
             }
         }
     }
     
+    RemovePendingReceipt(&receipt);
+
+    return !receipt.mPendingFlag;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Sends a JAUS message without blocking, the response (or timeout)
+///          is given to a callback.
+///
+///   The response expected is the one given by the message
+///   GetMessageCodeOfResponse method.  Use this instead of blocking Send when
+///   many queries are outstanding at once (e.g. discovery), so a thread is
+///   not needed for each one.
+///
+///   \param[in] message JAUS Message to send.
+///   \param[in] callback Callback to give the response (or NULL on timeout
+///                       or shutdown) to.  Must remain valid until the callback is made or
+///                       CancelAsync is called.
+///   \param[in] waitTimeMs How long to wait in ms for a response to be
+///                         received, 0 is INFINITE.
+///
+///   \return ID of the send (given to callback), 0 on failure.
+///
+////////////////////////////////////////////////////////////////////////////////////
+UInt Transport::SendAsync(const Message* message,
+                          ResponseCallback* callback,
+                          const unsigned int waitTimeMs) const
+{
+    std::set<UShort> responseCodes;
+    if(message)
     {
-        WriteLock wLock(*((SharedMutex *)&MEMBER->mPendingReceiptsMutex));
-        ritr = pending->find(&receipt);
-        if(ritr != pending->end())
+        responseCodes.insert(message->GetMessageCodeOfResponse());
+    }
+    return SendAsync(message, responseCodes, callback, waitTimeMs);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Sends a JAUS message without blocking, the first of the possible
+///          responses received (or timeout) is given to a callback.
+///
+///   The callback may be made before this method returns, and is made by
+///   the Transport processing threads, so it must not block.
+///
+///   \param[in] message JAUS Message to send.
+///   \param[in] responseCodes Message codes of possible responses (e.g.
+///                            Confirm or Reject Event Request).  The
+///                            Transport must be able to create them.
+///   \param[in] callback Callback to give the response (or NULL on timeout
+///                       or shutdown) to.  Must remain valid until the callback is made or
+///                       CancelAsync is called.
+///   \param[in] waitTimeMs How long to wait in ms for a response to be
+///                         received, 0 is INFINITE.
+///
+///   \return ID of the send (given to callback), 0 on failure.
+///
+////////////////////////////////////////////////////////////////////////////////////
+UInt Transport::SendAsync(const Message* message,
+                          const std::set<UShort>& responseCodes,
+                          ResponseCallback* callback,
+                          const unsigned int waitTimeMs) const
+{
+    if(message == NULL || callback == NULL || responseCodes.size() == 0 || message->GetDestinationID().IsBroadcast())
+    {
+        return 0;
+    }
+
+    Receipt* receipt = new Receipt();
+    receipt->mDestinationID = message->GetDestinationID();
+    receipt->mResponseCodes = responseCodes;
+    receipt->mpCallback = callback;
+    std::set<UShort>::const_iterator code;
+    for(code = responseCodes.begin(); code != responseCodes.end(); code++)
+    {
+        Message* response = CreateMessage(*code);
+        if(response == NULL)
         {
-            pending->erase(ritr);
+            delete receipt;
+            return 0;
         }
+        receipt->mAsyncResponses.push_back(response);
     }
 
-    return !receipt.mPendingFlag;
+    UInt id = 0;
+    {
+        Mutex::ScopedLock lock(&MEMBER->mAsyncReceiptsMutex);
+        if(++MEMBER->mAsyncID == 0)
+        {
+            ++MEMBER->mAsyncID;
+        }
+        id = receipt->mAsyncID = MEMBER->mAsyncID;
+        MEMBER->mAsyncReceipts[id] = receipt;
+        if(waitTimeMs > 0)
+        {
+            MEMBER->mAsyncDeadlines.insert(std::make_pair(CxUtils::Timer::GetTimeSeconds() + waitTimeMs/1000.0, id));
+        }
+    }
+    AddPendingReceipt(receipt);
+
+    if(Send(message) == false)
+    {
+        CancelAsync(id);
+        return 0;
+    }
+    return id;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Stops waiting for the response to a message sent using SendAsync.
+///          No callback is made after this method returns true.
+///
+///   \param[in] id ID returned by SendAsync.
+///
+///   \return True if cancelled, false if the response (or timeout) was
+///           already given to the callback.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool Transport::CancelAsync(const UInt id) const
+{
+    Receipt* receipt = NULL;
+    {
+        Mutex::ScopedLock lock(&MEMBER->mAsyncReceiptsMutex);
+        std::map<UInt, Receipt*>::iterator entry = MEMBER->mAsyncReceipts.find(id);
+        if(entry == MEMBER->mAsyncReceipts.end())
+        {
+            return false;
+        }
+        boost::lock_guard<boost::mutex> receiptLock(entry->second->mConditionMutex);
+        if(entry->second->mPendingFlag == false)
+        {
+            // Response is being given to the callback.
+            return false;
+        }
+        entry->second->mPendingFlag = false;
+        receipt = entry->second;
+    }
+    FinishAsyncReceipt(receipt, false);
+    return true;
 }
 
 
@@ -899,29 +1424,7 @@ Message* Transport::CreateMessageFromService(const UShort messageCode, const Ser
         return message;
     }
 
-    const Transport* transport = dynamic_cast<const Transport*>(service);
-    if(transport)
-    {
-        message =  GetMessageFromTemplate(messageCode);
-    }
-    // Make sure we do not do an infinite recursive call on ourselves!
-    if(message == NULL && this != service)
-    {
-        message = service->CreateMessage(messageCode);
-    }
-    if(message == NULL)
-    {
-        Service::Map::const_iterator child;
-        for(child = service->mJausChildServices.begin();
-            child != service->mJausChildServices.end();
-            child++)
-        {
-            if( (message = CreateMessageFromService(messageCode, child->second)) != NULL )
-            {
-                break;
-            }
-        }
-    }
+    FindMessageFactory(messageCode, service, &message);
 
     return message;
 }
@@ -929,8 +1432,153 @@ Message* Transport::CreateMessageFromService(const UShort messageCode, const Ser
 
 ////////////////////////////////////////////////////////////////////////////////////
 ///
-///   \brief Converts a packet containing a message type (UShort) and payload to
-///          a Message structure if supported by the child services.
+///   \brief Recursively searches a Service and its children for the one that
+///          creates a message type.
+///
+///   \param[in] messageCode JAUS Message to try create.
+///   \param[in] service The Service to start the search at.
+///   \param[out] message Message created by the Service found (you must
+///                       delete), NULL if not found.
+///
+///   \return Pointer to the Service that created the message, NULL if not
+///           supported.
+///
+////////////////////////////////////////////////////////////////////////////////////
+const Service* Transport::FindMessageFactory(const UShort messageCode,
+                                             const Service* service,
+                                             Message** message) const
+{
+    *message = CreateMessageFromFactory(messageCode, service);
+    if(*message)
+    {
+        return service;
+    }
+
+    Service::Map::const_iterator child;
+    for(child = service->mJausChildServices.begin();
+        child != service->mJausChildServices.end();
+        child++)
+    {
+        const Service* factory = FindMessageFactory(messageCode, child->second, message);
+        if(factory)
+        {
+            return factory;
+        }
+    }
+
+    return NULL;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Creates a message using only the given Service (not children).
+///
+///   \param[in] messageCode JAUS Message to try create.
+///   \param[in] factory Service to create the message with.
+///
+///   \return Pointer to created message (you must delete), NULL if not
+///           supported by the Service.
+///
+////////////////////////////////////////////////////////////////////////////////////
+Message* Transport::CreateMessageFromFactory(const UShort messageCode, const Service* factory) const
+{
+    Message* message = NULL;
+
+    const Transport* transport = dynamic_cast<const Transport*>(factory);
+    if(transport)
+    {
+        message = transport->GetMessageFromTemplate(messageCode);
+    }
+    // Make sure we do not do an infinite recursive call on ourselves!
+    if(message == NULL && this != factory)
+    {
+        message = factory->CreateMessage(messageCode);
+    }
+
+    return message;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Finds which Service creates each message type received by the
+///          Services of the Transport, and message templates.
+///
+///   CreateMessage uses this table so it does not have to search every
+///   Service for each message.  Message types not in the table are added
+///   the first time they are received.  The table is built again when a
+///   Service is added after the Transport is initialized.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Transport::BuildMessageFactoryTable()
+{
+    std::set<UShort> messageCodes;
+    {
+        ReadLock rLock(MEMBER->mMessageTemplatesMutex);
+        std::map<UShort, Message*>::const_iterator m;
+        for(m = MEMBER->mMessageTemplates.begin(); m != MEMBER->mMessageTemplates.end(); m++)
+        {
+            messageCodes.insert(m->first);
+        }
+    }
+    std::vector<const Service*> services(1, this);
+    for(unsigned int i = 0; i < (unsigned int)services.size(); i++)
+    {
+        std::set<UShort> received;
+        services[i]->GetReceivedMessageCodes(received);
+        messageCodes.insert(received.begin(), received.end());
+        Service::Map::const_iterator child;
+        for(child = services[i]->mJausChildServices.begin();
+            child != services[i]->mJausChildServices.end();
+            child++)
+        {
+            services.push_back(child->second);
+        }
+    }
+
+    boost::shared_ptr<MessageFactoryTable> factories(new MessageFactoryTable());
+    std::set<UShort>::const_iterator code;
+    for(code = messageCodes.begin(); code != messageCodes.end(); code++)
+    {
+        Message* message = NULL;
+        (*factories)[*code] = FindMessageFactory(*code, this, &message);
+        delete message;
+    }
+
+    Mutex::ScopedLock lock(&MEMBER->mMessageFactoriesMutex);
+    boost::atomic_store(&MEMBER->mpMessageFactories, boost::shared_ptr<const MessageFactoryTable>(factories));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Publishes a copy of the message factory table with the Service
+///          that creates a message type.
+///
+///   \param[in] messageCode JAUS Message type.
+///   \param[in] factory Service that creates the message, NULL if none.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Transport::SetMessageFactory(const UShort messageCode, const Service* factory) const
+{
+    Mutex::ScopedLock lock(&MEMBER->mMessageFactoriesMutex);
+    boost::shared_ptr<const MessageFactoryTable> current = boost::atomic_load(&MEMBER->mpMessageFactories);
+    MessageFactoryTable::const_iterator f = current->find(messageCode);
+    if(f != current->end() && f->second == factory)
+    {
+        return;
+    }
+    boost::shared_ptr<MessageFactoryTable> factories(new MessageFactoryTable(*current));
+    (*factories)[messageCode] = factory;
+    boost::atomic_store(&MEMBER->mpMessageFactories, boost::shared_ptr<const MessageFactoryTable>(factories));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Converts a packet containing a message type (UShort) and payload to
+///          a Message structure if supported by the child services.
 ///
 ///   \param[in] packet Packet of payload data with the frist 2 bytes being
 ///                     the message code.  This packet should not contain
@@ -1006,6 +1654,9 @@ void Transport::AddMessageTemplate(Message* message)
         delete MEMBER->mMessageTemplates[message->GetMessageCode()];
     }
     MEMBER->mMessageTemplates[message->GetMessageCode()] = message;
+
+    // Templates are used before any Service creates the message.
+    SetMessageFactory(message->GetMessageCode(), this);
 }
 
 
@@ -1036,6 +1687,11 @@ unsigned int Transport::GetDisconnectTimeMs() const { return MEMBER->mNodeManage
 ///   \brief Sets the maximum number of threads to use for processing messages
 ///          received via the transport.
 ///
+///   If more than one thread is used, single packets are given to a thread
+///   based on their source, so messages from a sender are still processed
+///   in the order received.  Multi-packet streams (large data sets) are
+///   assembled and processed by the service update thread.
+///
 ///   \param[in] limit Thread limit (default is 1).
 ///
 ///   \return True on success, false on failure.
@@ -1063,6 +1719,263 @@ NodeManager* Transport::GetNodeManager()
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Sets the maximum number of packets received that can be waiting
+///          for processing, and what to do when the queues are full.
+///
+///   The multi-packet stream queue is given twice the capacity of the single
+///   packet queue.  Each priority has its own lane of this capacity, so bulk
+///   data never causes higher priority packets to be dropped.  Use
+///   GetPacketQueueStatistics to see how deep the queues get and how many
+///   packets are dropped.
+///
+///   \param[in] capacity Maximum number of single packets queued per priority.
+///   \param[in] policy What to do when a queue is full.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Transport::SetPacketQueueOptions(const unsigned int capacity,
+                                      const PacketQueue::OverflowPolicy policy)
+{
+    MEMBER->mPacketQueueCapacity = capacity;
+    MEMBER->mPacketQueuePolicy = policy;
+    MEMBER->mSinglePacketQueue.SetCapacity(capacity);
+    MEMBER->mSinglePacketQueue.SetOverflowPolicy(policy);
+    for(unsigned int i = 0; i < (unsigned int)MEMBER->mProcessingWorkers.size(); i++)
+    {
+        MEMBER->mProcessingWorkers[i]->mQueue.SetCapacity(capacity);
+        MEMBER->mProcessingWorkers[i]->mQueue.SetOverflowPolicy(policy);
+    }
+    MEMBER->mMultiPacketQueue.SetCapacity(capacity*2);
+    MEMBER->mMultiPacketQueue.SetOverflowPolicy(policy);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \param[in] multiPacket If true, statistics for the multi-packet stream
+///                          queue are returned, otherwise single packets.
+///
+///   \return Statistics for the received packet queue (combined for all
+///           processing threads).
+///
+////////////////////////////////////////////////////////////////////////////////////
+PacketQueue::Statistics Transport::GetPacketQueueStatistics(const bool multiPacket) const
+{
+    if(multiPacket)
+    {
+        return MEMBER->mMultiPacketQueue.GetStatistics();
+    }
+    PacketQueue::Statistics total = MEMBER->mSinglePacketQueue.GetStatistics();
+    for(unsigned int i = 0; i < (unsigned int)MEMBER->mProcessingWorkers.size(); i++)
+    {
+        PacketQueue::Statistics worker = MEMBER->mProcessingWorkers[i]->mQueue.GetStatistics();
+        total.mCapacity += worker.mCapacity;
+        total.mDepth += worker.mDepth;
+        total.mMaxDepth = worker.mMaxDepth > total.mMaxDepth ? worker.mMaxDepth : total.mMaxDepth;
+        total.mTotalPushed += worker.mTotalPushed;
+        total.mTotalPopped += worker.mTotalPopped;
+        total.mTotalDropped += worker.mTotalDropped;
+    }
+    return total;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \param[in] multiPacket If true, statistics for the multi-packet stream
+///                          queue are returned, otherwise single packets.
+///   \param[in] priority Header::Priority of the queue lane.
+///
+///   \return Statistics for the received packet queue lane.
+///
+////////////////////////////////////////////////////////////////////////////////////
+PacketQueue::Statistics Transport::GetPacketQueueStatistics(const bool multiPacket, const Byte priority) const
+{
+    if(multiPacket)
+    {
+        return MEMBER->mMultiPacketQueue.GetStatistics(priority);
+    }
+    PacketQueue::Statistics total = MEMBER->mSinglePacketQueue.GetStatistics(priority);
+    for(unsigned int i = 0; i < (unsigned int)MEMBER->mProcessingWorkers.size(); i++)
+    {
+        PacketQueue::Statistics worker = MEMBER->mProcessingWorkers[i]->mQueue.GetStatistics(priority);
+        total.mCapacity += worker.mCapacity;
+        total.mDepth += worker.mDepth;
+        total.mMaxDepth = worker.mMaxDepth > total.mMaxDepth ? worker.mMaxDepth : total.mMaxDepth;
+        total.mTotalPushed += worker.mTotalPushed;
+        total.mTotalPopped += worker.mTotalPopped;
+        total.mTotalDropped += worker.mTotalDropped;
+    }
+    return total;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gets a histogram of how long received packets waited in the
+///          Transport before processing started.
+///
+///   Use this to verify latency bounds (e.g. for Safety Critical messages)
+///   while the component is under load.
+///
+///   \param[in] priority Header::Priority of packets.
+///   \param[in] reset If true, samples are cleared after reading.
+///
+///   \return Latency histogram for the priority.
+///
+////////////////////////////////////////////////////////////////////////////////////
+LatencyHistogram::Statistics Transport::GetLatencyStatistics(const Byte priority, const bool reset)
+{
+    LatencyHistogram& histogram = MEMBER->mLatency[priority < PriorityPacketQueue::Lanes ? priority : Header::Priority::Standard];
+    LatencyHistogram::Statistics stats = histogram.GetStatistics();
+    if(reset)
+    {
+        histogram.Clear();
+    }
+    return stats;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Enables conflation (latest value coalescing) of a received
+///          message type.
+///
+///   When enabled, only one message of the type from each source (and
+///   event ID, for reports received in Event messages) waits in the
+///   receive queue.  If a newer one arrives before the queued one is
+///   processed, it replaces the queued one.  This keeps a component that
+///   falls behind acting on the freshest state (e.g. Report Global Pose,
+///   Report Velocity State, Report Heartbeat Pulse), and bounds memory.
+///   Only use this for messages where the newest replaces all before it.
+///
+///   \param[in] messageCode Message type to conflate.  Reports sent in
+///                          Event messages are conflated by report type.
+///   \param[in] enable If true conflate, if false process every message.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Transport::EnableConflation(const UShort messageCode, const bool enable)
+{
+    MEMBER->mConflation.Enable(messageCode, enable);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \return Number of received messages replaced by newer ones before
+///           they were processed (see EnableConflation).
+///
+////////////////////////////////////////////////////////////////////////////////////
+unsigned int Transport::GetConflatedCount() const
+{
+    return MEMBER->mConflation.GetConflatedCount();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \return Allocation statistics for the packet buffers used to receive,
+///           queue, and send messages.  If mTotalCreated keeps increasing
+///           during steady-state operation, memory is still being allocated.
+///
+////////////////////////////////////////////////////////////////////////////////////
+PacketPool::Statistics Transport::GetPacketPoolStatistics() const
+{
+    return MEMBER->mPacketPool.GetStatistics();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Sets limits on reassembly of large data sets (multi-packet 
+///          streams) received.
+///
+///   \param[in] memoryLimitBytes Maximum memory used by incomplete large data
+///                               sets from a single source, the oldest are
+///                               dropped when exceeded. 0 = no limit.
+///   \param[in] timeoutMs Incomplete large data sets not updated within this
+///                        time are dropped.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Transport::SetLargeDataSetOptions(const unsigned int memoryLimitBytes,
+                                       const unsigned int timeoutMs)
+{
+    MEMBER->mLargeDataSetMemoryLimit = memoryLimitBytes;
+    MEMBER->mLargeDataSetTimeoutMs = timeoutMs;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Enables selective retransmission of large data set (multi-packet
+///          stream) packets.
+///
+///   When enabled, large data sets sent are kept in a cache, and packets
+///   reported missing by a receiver with a negative acknowledge (NACK) are
+///   sent again.  Large data sets received which stop receiving data for
+///   nackDelayMs have their missing packets requested from the sender.  Both
+///   components should enable this option.
+///
+///   \param[in] enable If true, retransmission is enabled.
+///   \param[in] cacheSizeBytes Maximum size of sent streams kept for
+///                             retransmission.
+///   \param[in] nackDelayMs How long an incomplete large data set waits for
+///                          new data before requesting missing packets.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Transport::EnableLargeDataSetRetransmission(const bool enable,
+                                                 const unsigned int cacheSizeBytes,
+                                                 const unsigned int nackDelayMs)
+{
+    MEMBER->mRetransmitCacheSize = cacheSizeBytes;
+    MEMBER->mNackDelayMs = nackDelayMs;
+    MEMBER->mRetransmitFlag = enable;
+    if(enable == false)
+    {
+        Mutex::ScopedLock lock(&MEMBER->mSentStreamsMutex);
+        MEMBER->mSentStreams.clear();
+        MEMBER->mSentStreamsBytes = 0;
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Enables compression of large data sets (multi-packet streams) 
+///          of a message type sent to a component.
+///
+///   Compression is done using zlib, and is an extension to the JAUS 
+///   standard, so only enable it for components using JAUS++ (any 
+///   JAUS++ component can receive compressed data).  Payloads that do not
+///   get smaller are sent uncompressed.
+///
+///   \param[in] messageCode Message type to compress.
+///   \param[in] destination Component receiving the messages.
+///   \param[in] enable If true, compression is enabled, otherwise disabled.
+///   \param[in] thresholdBytes Only payloads of at least this many bytes
+///                             are compressed.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Transport::EnablePayloadCompression(const UShort messageCode,
+                                         const Address& destination,
+                                         const bool enable,
+                                         const unsigned int thresholdBytes)
+{
+    WriteLock wLock(MEMBER->mCompressionMutex);
+    std::pair<UShort, UInt> key(messageCode, destination.ToUInt());
+    if(enable)
+    {
+        // A threshold of 0 means no compression.
+        MEMBER->mCompressionThresholds[key] = thresholdBytes > 0 ? thresholdBytes : 1;
+    }
+    else
+    {
+        MEMBER->mCompressionThresholds.erase(key);
+    }
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Creates the desired message from templates.
@@ -1096,25 +2009,37 @@ Message*  Transport::GetMessageFromTemplate(const UShort messageCode) const
 ///          de-serializing message data.  If the message has not been
 ///          created previously, it get's made.
 ///
+///   Each thread has its own cache, so no locking is needed.
+///
 ///   \param[in] messageCode Message type.
+///   \param[in] messageCache Cache owned by the calling thread, if NULL the
+///                           cache of the calling thread is used.
 ///
-///   \return Pointer to message structure (you must delete) on success, NULL
+///   \return Pointer to message structure (do not delete) on success, NULL
 ///           if message type not found.
 ///
 ////////////////////////////////////////////////////////////////////////////////////
-Message*  Transport::GetCachedMessage(const UShort messageCode)
+Message*  Transport::GetCachedMessage(const UShort messageCode,
+                                      std::map<UShort, Message*>* messageCache)
 {
     Message* message = NULL;
     {
-        ReadLock rLock(MEMBER->mMessageCacheMutex);
+        if(messageCache == NULL)
+        {
+            if(MEMBER->mMessageCache.get() == NULL)
+            {
+                MEMBER->mMessageCache.reset(new std::map<UShort, Message*>());
+            }
+            messageCache = MEMBER->mMessageCache.get();
+        }
         std::map<UShort, Message*>::iterator m;
-        m = MEMBER->mMessageCache.find(messageCode);
-        if(m == MEMBER->mMessageCache.end())
+        m = messageCache->find(messageCode);
+        if(m == messageCache->end())
         {
             message = CreateMessage(messageCode);
             if(message)
             {
-                MEMBER->mMessageCache[messageCode] = message;
+                (*messageCache)[messageCode] = message;
             }
         }
         else
@@ -1173,7 +2098,10 @@ void Transport::CopyRegisteredItems(Transport* transport)
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Helper method to match packets to pending receipts that are
-///          from blocking send methods.
+///          from blocking or asynchronous send methods.
+///
+///   Receipts are indexed by response source and message code, so only
+///   the receipts waiting for this message from this source are checked.
 ///
 ////////////////////////////////////////////////////////////////////////////////////
 bool Transport::CheckPendingReceipts(const Header& header,
@@ -1181,19 +2109,49 @@ bool Transport::CheckPendingReceipts(const Header& header,
                                      const Packet& packet)
 {
     bool foundReceipt = false;
-    Receipt::Set::iterator receipt;
-
-    ReadLock rLock(MEMBER->mPendingReceiptsMutex);
+    Receipt* asyncReceipt = NULL;
+    ULong key = GetReceiptKey(header.mSourceID, messageCode);
+    ReceiptShard& shard = MEMBER->mReceiptShards[GetReceiptShard(key)];
 
-    for(receipt = MEMBER->mPendingReceipts.begin();
-        receipt != MEMBER->mPendingReceipts.end() && false == foundReceipt;
+    boost::unique_lock<boost::mutex> shardLock(shard.mMutex);
+    ReceiptShard::Map::iterator match = shard.mReceipts.find(key);
+    if(match == shard.mReceipts.end())
+    {
+        return false;
+    }
+    Receipt::List::iterator receipt;
+    for(receipt = match->second.begin();
+        receipt != match->second.end() && false == foundReceipt;
         receipt++)
     {
         boost::lock_guard<boost::mutex> lock((*receipt)->mConditionMutex);
-        if((*receipt)->mpResponse != NULL)
+        if((*receipt)->mPendingFlag == false)
+        {
+            continue;
+        }
+        if((*receipt)->mpCallback != NULL)
+        {
+            // Asynchronous send, callback is made after shard is unlocked.
+            Message::List::iterator response;
+            for(response = (*receipt)->mAsyncResponses.begin();
+                response != (*receipt)->mAsyncResponses.end();
+                response++)
+            {
+                if((*response)->GetMessageCode() == messageCode &&
+                   (*response)->Read(packet) > 0)
+                {
+                    (*receipt)->mpResponse = (*response);
+                    (*receipt)->mPendingFlag = false;
+                    asyncReceipt = (*receipt);
+                    foundReceipt = true;
+                    break;
+                }
+            }
+        }
+        else if((*receipt)->mpResponse != NULL)
         {
             if((*receipt)->mpResponse ->GetMessageCode() == messageCode &&
-                   (*receipt)->mpMessage->GetDestinationID() == header.mSourceID)
+                   (*receipt)->mDestinationID == header.mSourceID)
                 {
                     if( (*receipt)->mpResponse ->Read(packet) )
                     {
@@ -1212,7 +2170,7 @@ bool Transport::CheckPendingReceipts(const Header& header,
                 responses++)
             {
                 if((*responses)->GetMessageCode() == messageCode &&
-                   (*receipt)->mpMessage->GetDestinationID() == header.mSourceID)
+                   (*receipt)->mDestinationID == header.mSourceID)
                 {
                     if( (*responses)->Read(packet) )
                     {
@@ -1240,6 +2198,12 @@ bool Transport::CheckPendingReceipts(const Header& header,
         if(foundReceipt)
             break;
     }
+    shardLock.unlock();
+
+    if(asyncReceipt)
+    {
+        FinishAsyncReceipt(asyncReceipt, true);
+    }
 
     return foundReceipt;
 }
@@ -1247,47 +2211,175 @@ bool Transport::CheckPendingReceipts(const Header& header,
 
 ////////////////////////////////////////////////////////////////////////////////////
 ///
-///   \brief Process all data as it arrives and assignes to packet handling
-///          queues for processing by other methods.
+///   \brief Adds a receipt to the index of sends waiting for responses, under
+///          each possible response message code.
 ///
-///   \param[in] jausPacket JAUS Packet data without the transport header.
-///   \param[in] jausHeader JAUS General Header information for the packet.
-///   \param[in] connection Pointer to the connection the data was received by.
-///   \param[in] sourceInfo Additional information about the source of the packet
-///                         like the address it came in on.
+///   \param[in] receipt Receipt to add.
 ///
 ////////////////////////////////////////////////////////////////////////////////////
-void Transport::ProcessPacket(const Packet& jausPacket,
-                              const Header& jausHeader,
-                              const Connection* connection,
-                              const Connection::Info* sourceInfo)
+void Transport::AddPendingReceipt(Receipt* receipt) const
 {
-    // Ignore message not destined for this component.
-    if(Address::DestinationMatch(jausHeader.mDestinationID, mComponentID) == false)
+    std::set<UShort>::const_iterator code;
+    for(code = receipt->mResponseCodes.begin();
+        code != receipt->mResponseCodes.end();
+        code++)
     {
-        return;
+        ULong key = GetReceiptKey(receipt->mDestinationID, *code);
+        ReceiptShard& shard = MEMBER->mReceiptShards[GetReceiptShard(key)];
+        boost::lock_guard<boost::mutex> lock(shard.mMutex);
+        shard.mReceipts[key].push_back(receipt);
     }
+}
 
-    UShort messageCode = 0;
-
-    // Read the message code.
-    jausPacket.SetReadPos(Header::PayloadOffset);
-    jausPacket.Read(messageCode);
-    jausPacket.SetReadPos(0);   // Reset the read position.
 
-    // Send Acknowledge if requested.
-    if(jausHeader.mAckNackFlag == Header::AckNack::Request)
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Removes a receipt from the index of sends waiting for responses.
+///
+///   \param[in] receipt Receipt to remove.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Transport::RemovePendingReceipt(Receipt* receipt) const
+{
+    std::set<UShort>::const_iterator code;
+    for(code = receipt->mResponseCodes.begin();
+        code != receipt->mResponseCodes.end();
+        code++)
     {
-        Header ackHeader = jausHeader;
-        ackHeader.mSourceID = mComponentID;
-        ackHeader.mDestinationID = jausHeader.mSourceID;
-        ackHeader.mSize = Header::MinSize;
-        ackHeader.mAckNackFlag = Header::AckNack::Ack;
-        ackHeader.mSequenceNumber = jausHeader.mSequenceNumber;
-        Packet ackPacket;
-        if(ackHeader.Write(ackPacket))
+        ULong key = GetReceiptKey(receipt->mDestinationID, *code);
+        ReceiptShard& shard = MEMBER->mReceiptShards[GetReceiptShard(key)];
+        boost::lock_guard<boost::mutex> lock(shard.mMutex);
+        ReceiptShard::Map::iterator match = shard.mReceipts.find(key);
+        if(match != shard.mReceipts.end())
         {
-            SendPacket(ackPacket, ackHeader);
+            Receipt::List::iterator r = std::find(match->second.begin(), match->second.end(), receipt);
+            if(r != match->second.end())
+            {
+                match->second.erase(r);
+            }
+            if(match->second.size() == 0)
+            {
+                shard.mReceipts.erase(match);
+            }
+        }
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Gives asynchronous sends whose wait time has passed to their
+///          callbacks (with no response).
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Transport::CheckAsyncReceiptTimeouts()
+{
+    Receipt::List expired;
+    {
+        Mutex::ScopedLock lock(&MEMBER->mAsyncReceiptsMutex);
+        if(MEMBER->mAsyncDeadlines.size() == 0)
+        {
+            return;
+        }
+        double timeSeconds = CxUtils::Timer::GetTimeSeconds();
+        while(MEMBER->mAsyncDeadlines.size() > 0 &&
+              MEMBER->mAsyncDeadlines.begin()->first <= timeSeconds)
+        {
+            std::map<UInt, Receipt*>::iterator entry = MEMBER->mAsyncReceipts.find(MEMBER->mAsyncDeadlines.begin()->second);
+            MEMBER->mAsyncDeadlines.erase(MEMBER->mAsyncDeadlines.begin());
+            if(entry != MEMBER->mAsyncReceipts.end())
+            {
+                boost::lock_guard<boost::mutex> receiptLock(entry->second->mConditionMutex);
+                if(entry->second->mPendingFlag)
+                {
+                    entry->second->mPendingFlag = false;
+                    expired.push_back(entry->second);
+                }
+            }
+        }
+    }
+    Receipt::List::iterator receipt;
+    for(receipt = expired.begin(); receipt != expired.end(); receipt++)
+    {
+        FinishAsyncReceipt(*receipt, true);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Removes an asynchronous receipt that is no longer pending from
+///          the Transport, gives the response to the callback, and deletes it.
+///
+///   \param[in] receipt Receipt completed (mpResponse is NULL on timeout).
+///   \param[in] callback If true, the callback is made.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Transport::FinishAsyncReceipt(Receipt* receipt, const bool callback) const
+{
+    RemovePendingReceipt(receipt);
+    {
+        Mutex::ScopedLock lock(&MEMBER->mAsyncReceiptsMutex);
+        MEMBER->mAsyncReceipts.erase(receipt->mAsyncID);
+    }
+    if(callback)
+    {
+        receipt->mpCallback->ProcessResponse(receipt->mAsyncID, receipt->mpResponse);
+    }
+    delete receipt;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Process all data as it arrives and assignes to packet handling
+///          queues for processing by other methods.
+///
+///   \param[in] jausPacket JAUS Packet data without the transport header.
+///   \param[in] jausHeader JAUS General Header information for the packet.
+///   \param[in] connection Pointer to the connection the data was received by.
+///   \param[in] sourceInfo Additional information about the source of the packet
+///                         like the address it came in on.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Transport::ProcessPacket(const Packet& jausPacket,
+                              const Header& jausHeader,
+                              const Connection* connection,
+                              const Connection::Info* sourceInfo)
+{
+    // Ignore message not destined for this component.
+    if(Address::DestinationMatch(jausHeader.mDestinationID, mComponentID) == false)
+    {
+        return;
+    }
+
+    UShort messageCode = 0;
+
+    // Read the message code.
+    jausPacket.SetReadPos(Header::PayloadOffset);
+    jausPacket.Read(messageCode);
+    jausPacket.SetReadPos(0);   // Reset the read position.
+
+    // Negative acknowledge for large data set packets, resend the packets.
+    if(jausHeader.mAckNackFlag == Header::AckNack::Nack)
+    {
+        ProcessNack(jausPacket, jausHeader);
+        return;
+    }
+
+    // Send Acknowledge if requested.
+    if(jausHeader.mAckNackFlag == Header::AckNack::Request)
+    {
+        Header ackHeader = jausHeader;
+        ackHeader.mSourceID = mComponentID;
+        ackHeader.mDestinationID = jausHeader.mSourceID;
+        ackHeader.mSize = Header::MinSize;
+        ackHeader.mAckNackFlag = Header::AckNack::Ack;
+        ackHeader.mSequenceNumber = jausHeader.mSequenceNumber;
+        PacketPool::Buffer ackPacket(MEMBER->mPacketPool);
+        if(ackHeader.Write(*ackPacket))
+        {
+            SendPacket(*ackPacket, ackHeader);
         }
     }
 
@@ -1297,14 +2389,37 @@ void Transport::ProcessPacket(const Packet& jausPacket,
 #ifdef USE_MESSAGE_QUEUE
         this->ProcessSinglePackets((Packet *)&jausPacket);
 #else
-        WriteLock wLock(MEMBER->mSinglePacketQueueMutex);
-
-        // Check for need to resize.
-        if(MEMBER->mSinglePacketQueue.size() >= MEMBER->mSinglePacketQueue.capacity())
+        // Only one packet of a conflated report type is queued per source,
+        // newer data is stored and swapped in when it is processed.
+        ConflationTable::Key key;
+        bool conflated = MEMBER->mConflation.GetKey(jausPacket, jausHeader, key);
+        if(conflated && MEMBER->mConflation.Update(key, jausPacket) == false)
         {
-            MEMBER->mSinglePacketQueue.resize(MEMBER->mSinglePacketQueue.capacity()*2);
+            return;
+        }
+        // With multiple processing threads, packets from a source always go
+        // to the same worker to keep them in order.
+        if(MEMBER->mProcessingWorkers.size() > 0)
+        {
+            ProcessingWorker* worker = MEMBER->mProcessingWorkers[GetProcessingWorker(jausHeader.mSourceID,
+                                                                                      (unsigned int)MEMBER->mProcessingWorkers.size())];
+            if(worker->mQueue.Push(jausPacket, jausHeader.mPriorityFlag))
+            {
+                worker->Signal();
+            }
+            else if(conflated)
+            {
+                MEMBER->mConflation.Cancel(key);
+            }
+        }
+        else if(MEMBER->mSinglePacketQueue.Push(jausPacket, jausHeader.mPriorityFlag))
+        {
+            SignalServiceUpdate();
+        }
+        else if(conflated)
+        {
+            MEMBER->mConflation.Cancel(key);
         }
-        MEMBER->mSinglePacketQueue.push_back(jausPacket);
 #endif
     }
     else
@@ -1312,14 +2427,21 @@ void Transport::ProcessPacket(const Packet& jausPacket,
 #ifdef USE_MESSAGE_QUEUE
         this->ProcessMultiPackets((Packet *)&jausPacket);
 #else
-        WriteLock wLock(MEMBER->mMultiPacketQueueMutex);
-
-        // Check for need to resize.
-        if(MEMBER->mMultiPacketQueue.size() >= MEMBER->mMultiPacketQueue.capacity())
+        // Large data sets go to the same worker as single packets from the
+        // source, so they are processed in the order sent.
+        if(MEMBER->mProcessingWorkers.size() > 0)
+        {
+            ProcessingWorker* worker = MEMBER->mProcessingWorkers[GetProcessingWorker(jausHeader.mSourceID,
+                                                                                      (unsigned int)MEMBER->mProcessingWorkers.size())];
+            if(worker->mQueue.Push(jausPacket, jausHeader.mPriorityFlag))
+            {
+                worker->Signal();
+            }
+        }
+        else if(MEMBER->mMultiPacketQueue.Push(jausPacket, jausHeader.mPriorityFlag))
         {
-            MEMBER->mMultiPacketQueue.resize(MEMBER->mMultiPacketQueue.capacity()*2);
+            SignalServiceUpdate();
         }
-        MEMBER->mMultiPacketQueue.push_back(jausPacket);
 #endif
     }
 }
@@ -1337,41 +2459,39 @@ void Transport::ProcessPacket(const Packet& jausPacket,
 ////////////////////////////////////////////////////////////////////////////////////
 void Transport::ProcessSinglePackets(Packet* packet)
 {
-    bool dataToProcess = false;
-    bool multithreaded = false;
-    Packet mtPacket;
-
-    MEMBER->mSinglePacketCache.Clear();
+    Packet* queuedPacket = NULL;
 
-    Packet* packetPtr = packet;
     // If not given a packet, get one to read
-    if(packetPtr == NULL)
+    if(packet == NULL)
     {
-        packetPtr = &MEMBER->mSinglePacketCache;
-
-        if(MEMBER->mProcessingThreads.size() > 0)
-        {
-            // We have more than one thread, can't use
-            // the single cache.
-            packetPtr = &mtPacket;
-            multithreaded = true;
-        }
-
+        queuedPacket = packet = PopSinglePacket(MEMBER, MEMBER->mSinglePacketQueue);
         if(packet == NULL)
-        {
-            {
-
-                WriteLock wLock(MEMBER->mSinglePacketQueueMutex);
-                dataToProcess = MEMBER->mSinglePacketQueue.pop_front(&(*packetPtr));
-            }
-        }
-
-        if((packet == NULL && false == dataToProcess) || MEMBER->mStopMessageProcessingFlag)
         {
             return;
         }
     }
 
+    ProcessSinglePacket(*packet, NULL);
+
+    // Return buffer to the queue so it can be re-used.
+    MEMBER->mSinglePacketQueue.Release(queuedPacket);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief De-serializes a single packet and passes it to any pending
+///          receipt or neededing services.
+///
+///   \param[in] packet Packet to process.
+///   \param[in] messageCache Messages for de-serializing owned by the calling
+///                           thread, if NULL the shared cache is used.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Transport::ProcessSinglePacket(Packet& packet, std::map<UShort, Message*>* messageCache)
+{
+    Packet* packetPtr = &packet;
+
     // De-serialize the data
     Header header;
     UShort messageCode = 0;
@@ -1393,14 +2513,7 @@ void Transport::ProcessSinglePackets(Packet* packet)
             // share the data.
 
             // Create message.
-            if(false == multithreaded)
-            {
-                message = GetCachedMessage(messageCode);
-            }
-            else
-            {
-                message = CreateMessage(messageCode);
-            }
+            message = GetCachedMessage(messageCode, messageCache);
             // If supported, de-serialize data and receive.
             if(message && message->Read(*packetPtr) > 0)
             {
@@ -1416,11 +2529,6 @@ void Transport::ProcessSinglePackets(Packet* packet)
                 WriteLock printLock(mDebugMessagesMutex);
                 std::cout << "[" << GetServiceID().ToString() << "-" << mComponentID.ToString() << "] - Received Unsupported Message Type [0x" << std::setbase(16) << messageCode << std::setbase(10) << "]\n";
             }
-            
-            if(multithreaded && message)
-            {
-                delete message;
-            }
 #else
             message = CreateMessage(messageCode);
             // If supported, de-serialize data and receive.
@@ -1434,6 +2542,7 @@ void Transport::ProcessSinglePackets(Packet* packet)
                 MEMBER->mMessageQueueMutex.Lock();
                 MEMBER->mMessageQueue.push(message);
                 MEMBER->mMessageQueueMutex.Unlock();
+                SignalServiceUpdate();
                 message = NULL;
             }
             else if(message == NULL)
@@ -1451,45 +2560,101 @@ void Transport::ProcessSinglePackets(Packet* packet)
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Thread function for a ProcessingWorker, processes the single
+///          and multi-packet stream packets given to the worker until the
+///          thread is stopped.
+///
+///   \param[in] workerPointer Pointer to the ProcessingWorker.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Transport::ProcessingWorkerThread(void* workerPointer)
+{
+    ProcessingWorker* worker = (ProcessingWorker*)workerPointer;
+    Transport* transport = worker->mpTransport;
+    Data* data = (Data*)transport->mpData;
+
+    while(worker->mThread.QuitThreadFlag() == false)
+    {
+        Packet* packet = PopSinglePacket(data, worker->mQueue);
+        if(packet == NULL)
+        {
+            worker->Wait(DefaultSignaledUpdatePeriodMs);
+            continue;
+        }
+        Header header;
+        packet->SetReadPos(0);
+        if(header.Read(*packet) > 0 && header.mControlFlag != Header::DataControl::Single)
+        {
+            transport->ProcessMultiPacket(*packet, &worker->mMessageCache);
+        }
+        else
+        {
+            transport->ProcessSinglePacket(*packet, &worker->mMessageCache);
+        }
+        worker->mQueue.Release(packet);
+    }
+}
+
+
 /** Goes the through the multi packets queue and de-serializes the data
     and passes it to any neededing services. */
 void Transport::ProcessMultiPackets(Packet* packet)
 {
-    bool dataToProcess = false;
-    bool multithreaded = false;
-
-    MEMBER->mMultiPacketCache.Clear();
-
-    Packet mtPacket;
+    Packet* queuedPacket = NULL;
 
     Packet* packetPtr = packet;
 
     // If not provided a packet, get one to process.
     if(packetPtr == NULL)
     {
-        packetPtr = &MEMBER->mMultiPacketCache;
-
-        if(MEMBER->mProcessingThreads.size() > 0)
-        {
-            packetPtr = &mtPacket;
-            multithreaded = true;
-        }
-
-        {
-            WriteLock wLock(MEMBER->mMultiPacketQueueMutex);
-            dataToProcess = MEMBER->mMultiPacketQueue.pop_front(&(*packetPtr));
-        }
+        Byte priority = 0;
+        double pushTimeSeconds = 0;
+        queuedPacket = packetPtr = MEMBER->mMultiPacketQueue.Pop(&priority, &pushTimeSeconds);
 
-        if(false == dataToProcess || MEMBER->mStopMessageProcessingFlag)
+        if(packetPtr == NULL || MEMBER->mStopMessageProcessingFlag)
         {
+            MEMBER->mMultiPacketQueue.Release(queuedPacket);
+            // Nothing new received, see if anything is lost.
+            if(packetPtr == NULL && MEMBER->mRetransmitFlag && MEMBER->mStopMessageProcessingFlag == false)
+            {
+                Mutex::ScopedLock lock(&MEMBER->mLargeDataSetsMutex);
+                RequestMissingPackets();
+            }
             return;
         }
+        MEMBER->mLatency[priority].Add(CxUtils::Timer::GetTimeSeconds() - pushTimeSeconds);
     }
 
+    ProcessMultiPacket(*packetPtr, NULL);
+
+    // Return buffer to the queue so it can be re-used.
+    MEMBER->mMultiPacketQueue.Release(queuedPacket);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Adds a multi-packet stream packet to its large data set, and
+///          processes any data sets completed.
+///
+///   Completed data sets are processed the same as a single packet by the
+///   calling thread, so with multiple processing threads they stay in order
+///   with the single packets from the same source.
+///
+///   \param[in] packet Packet to process.
+///   \param[in] messageCache Messages for de-serializing owned by the calling
+///                           thread, if NULL the shared cache is used.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void Transport::ProcessMultiPacket(Packet& packet, std::map<UShort, Message*>* messageCache)
+{
+    Packet* packetPtr = &packet;
+
     // De-serialize the data
     Header header;
     UShort messageCode = 0;
-    Message* message = NULL;
     // Read the message type.
     packetPtr->SetReadPos(0);
     if(header.Read((*packetPtr)) > 0 &&
@@ -1497,166 +2662,337 @@ void Transport::ProcessMultiPackets(Packet* packet)
     {
         packetPtr->SetReadPos(0);
 
-        // Multi-packet stream handling.
-        UInt presenceVector = 0;
-        LargeDataSet::Key key(header.mSourceID,
-                              messageCode,
-                              presenceVector);
+        std::vector<LargeDataSet*> completed;
+        {
+            Mutex::ScopedLock lock(&MEMBER->mLargeDataSetsMutex);
 
-        bool added = false;
-        LargeDataSet::Map::iterator ld;
+            // Multi-packet stream handling.
+            UInt presenceVector = 0;
+            LargeDataSet::Key key(header.mSourceID,
+                                  messageCode,
+                                  presenceVector);
 
-        for(ld = MEMBER->mLargeDataSets.begin();
-            ld != MEMBER->mLargeDataSets.end() && added == false;
-            ld++)
-        {
-            if(ld->second->mCompleteFlag == false &&
-               ld->first.mMessageCode == key.mMessageCode &&
-               ld->first.mSourceID == key.mSourceID)
+            bool added = false;
+            LargeDataSet::Map::iterator ld;
+
+            // Memory used by the source, so a data set can't reserve more
+            // than what is left of the limit.
+            unsigned int sourceUsage = 0;
+            if(MEMBER->mLargeDataSetMemoryLimit > 0)
             {
-                // If the first in the sequendce, flush out the old data
-                // and start over.
-                if(header.mControlFlag == Header::DataControl::First)
-                {
-                    delete ld->second;
-                    MEMBER->mLargeDataSets.erase(ld);
-                }
-                else if(ld->second->AddPacket(header, messageCode, (*packetPtr)))
+                for(ld = MEMBER->mLargeDataSets.begin(); ld != MEMBER->mLargeDataSets.end(); ld++)
                 {
-                    added = true;
+                    if(ld->first.mSourceID == header.mSourceID)
+                    {
+                        sourceUsage += ld->second->GetMemoryUsage();
+                    }
                 }
-                break;
-            }
-        }
-
-        if(added == false)
-        {
-            LargeDataSet* newStream = new LargeDataSet();
-            if(newStream->AddPacket(header, messageCode, (*packetPtr)))
-            {
-                MEMBER->mLargeDataSets[key] = newStream;
             }
-            else
-            {
-                delete newStream;
-            }
-            newStream = NULL;
-        }
 
-        // Check for pending receipts/and or completed data.
-        ld = MEMBER->mLargeDataSets.begin();
-        while(ld != MEMBER->mLargeDataSets.end())
-        {
-            if(ld->second->mCompleteFlag == true)
+            for(ld = MEMBER->mLargeDataSets.begin();
+                ld != MEMBER->mLargeDataSets.end() && added == false;
+                ld++)
             {
-                LargeDataSet* stream = ld->second;
-                Message* message = NULL;
-
-                // Remove from map
-                MEMBER->mLargeDataSets.erase(ld);
-                ld = MEMBER->mLargeDataSets.begin();
-
-                    if(multithreaded)
+                if(ld->second->mCompleteFlag == false &&
+                   ld->first.mMessageCode == key.mMessageCode &&
+                   ld->first.mSourceID == key.mSourceID)
+                {
+                    // If the first in the sequendce, flush out the old data
+                    // and start over.
+                    if(header.mControlFlag == Header::DataControl::First && ld->second->mHaveFirstFlag)
                     {
-                         packetPtr = &mtPacket;
+                        sourceUsage -= ld->second->GetMemoryUsage();
+                        delete ld->second;
+                        MEMBER->mLargeDataSets.erase(ld);
                     }
                     else
                     {
-                         packetPtr = &MEMBER->mLargeDataSetCache;
-                         // Reset values in cache packet.
-                         MEMBER->mLargeDataSetCache.Clear();
+                        ld->second->mMemoryLimit = GetLargeDataSetMemoryLimit(MEMBER->mLargeDataSetMemoryLimit,
+                                                                              sourceUsage - ld->second->GetMemoryUsage());
+                        if(ld->second->AddPacket(header, messageCode, (*packetPtr)))
+                        {
+                            added = true;
+                        }
                     }
-                // Try merge the stream into a single packet.
-                if(LargeDataSet::MergeLargeDataSet(stream->mHeader,
-                                                   stream->mMessageCode,
-                                                   *packetPtr,
-                                                   stream->mStream,
-                                                   NULL))
+                    break;
+                }
+            }
+
+            if(added == false)
+            {
+                LargeDataSet* newStream = new LargeDataSet();
+                newStream->mMemoryLimit = GetLargeDataSetMemoryLimit(MEMBER->mLargeDataSetMemoryLimit, sourceUsage);
+                if(newStream->AddPacket(header, messageCode, (*packetPtr)))
                 {
-                    // If we merged the packet, then use the same methods as if
-                    // this was a single packet.
+                    MEMBER->mLargeDataSets[key] = newStream;
+                }
+                else
+                {
+                    delete newStream;
+                }
+                newStream = NULL;
+            }
 
-                    // See if there is a receipt already waiting for this packet
-                    // as a response
-                    if(CheckPendingReceipts(stream->mHeader, stream->mMessageCode, *packetPtr) == false)
+            // Make sure a single source can't use up all our memory (e.g. lots of
+            // incomplete data sets from packet loss), dropping the oldest first.
+            if(MEMBER->mLargeDataSetMemoryLimit > 0)
+            {
+                for(;;)
+                {
+                    unsigned int used = 0;
+                    LargeDataSet::Map::iterator oldest = MEMBER->mLargeDataSets.end();
+                    for(ld = MEMBER->mLargeDataSets.begin(); ld != MEMBER->mLargeDataSets.end(); ld++)
                     {
-#ifndef USE_MESSAGE_QUEUE
-                        // If no pending match, then we must de-serialize and
-                        // share the data.
-
-                        // Create message.
-                        if(false == multithreaded)
-                        {
-                            message = GetCachedMessage(messageCode);
-                        }
-                        else
-                        {
-                            message = CreateMessage(messageCode);
-                        }
-                        // If supported, de-serialize data and receive.
-                        if(message && message->Read(*packetPtr) > 0)
-                        {
-                            if(mDebugMessagesFlag)
-                            {
-                                WriteLock printLock(mDebugMessagesMutex);
-                                std::cout << "[" << GetServiceID().ToString() << "-" << mComponentID.ToString() << "] - Processing " << message->GetMessageName() << " Message\n";
-                            }
-                            PushMessageToChildren(message);
-                        }
-                        else if(message == NULL)
-                        {
-                            WriteLock printLock(mDebugMessagesMutex);
-                            std::cout << "[" << GetServiceID().ToString() << "-" << mComponentID.ToString() << "] - Received Unsupported Message Type [0x" << std::setbase(16) << stream->mMessageCode << std::setbase(10) << "]\n";
-                        }
-
-                        if(multithreaded && message)
-                        {
-                            delete message;
-                        }
-#else
-                        message = CreateMessage(messageCode);
-                        // If supported, de-serialize data and receive.
-                        if(message && message->Read(*packetPtr) > 0)
+                        if(ld->first.mSourceID == header.mSourceID)
                         {
-                            if(mDebugMessagesFlag)
+                            used += ld->second->GetMemoryUsage();
+                            if(oldest == MEMBER->mLargeDataSets.end() ||
+                               ld->second->mUpdateTimeMs < oldest->second->mUpdateTimeMs)
                             {
-                                WriteLock printLock(mDebugMessagesMutex);
-                                std::cout << "[" << GetServiceID().ToString() << "-" << mComponentID.ToString() << "] - Processing " << message->GetMessageName() << " Message\n";
+                                oldest = ld;
                             }
-                            MEMBER->mMessageQueueMutex.Lock();
-                            MEMBER->mMessageQueue.push(message);
-                            MEMBER->mMessageQueueMutex.Unlock();
-                            message = NULL;
-                        }
-                        else if(message == NULL)
-                        {
-                            WriteLock printLock(mDebugMessagesMutex);
-                            std::cout << "[" << GetServiceID().ToString() << "-" << mComponentID.ToString() << "] - Received Unsupported Message Type [0x" << std::setbase(16) << stream->mMessageCode << std::setbase(10) << "]\n";
-                        }
-
-                        if(message)
-                        {
-                            delete message;
                         }
-#endif
                     }
+                    if(used <= MEMBER->mLargeDataSetMemoryLimit || oldest == MEMBER->mLargeDataSets.end())
+                    {
+                        break;
+                    }
+                    if(mDebugMessagesFlag)
+                    {
+                        WriteLock printLock(mDebugMessagesMutex);
+                        std::cout << "[" << GetServiceID().ToString() << "-" << mComponentID.ToString() << "] - Large Data Set Memory Limit Reached for " << header.mSourceID.ToString() << "\n";
+                    }
+                    delete oldest->second;
+                    MEMBER->mLargeDataSets.erase(oldest);
+                }
+            }
+
+            // Check for completed or expired data.
+            ld = MEMBER->mLargeDataSets.begin();
+            while(ld != MEMBER->mLargeDataSets.end())
+            {
+                if(ld->second->mCompleteFlag == true)
+                {
+                    // Remove from map, processed after releasing the mutex.
+                    completed.push_back(ld->second);
+                    MEMBER->mLargeDataSets.erase(ld);
+                    ld = MEMBER->mLargeDataSets.begin();
+                }
+                else if(Time::GetUtcTimeMs() - ld->second->mUpdateTimeMs > MEMBER->mLargeDataSetTimeoutMs)
+                {
+                    delete ld->second;
+                    MEMBER->mLargeDataSets.erase(ld);
+                    ld = MEMBER->mLargeDataSets.begin();
+                }
+                else
+                {
+                    ld++;
                 }
+            }
+            // Ask for any packets that appear to be lost.
+            if(MEMBER->mRetransmitFlag)
+            {
+                RequestMissingPackets();
+            }
+        }
 
-                delete stream;
-                stream = NULL;
+        // Completed data sets contain the merged message with a single
+        // packet header, so they are processed like a single packet.
+        std::vector<LargeDataSet*>::iterator c;
+        for(c = completed.begin(); c != completed.end(); c++)
+        {
+            if((*c)->mBuffer.Length() > LargeDataSet::DataOffset)
+            {
+                ProcessSinglePacket((*c)->mBuffer, messageCache);
             }
-            else if(Time::GetUtcTimeMs() - ld->second->mUpdateTimeMs > 500)
+            delete *c;
+        }
+    }
+}
+
+
+/** Keeps a copy of a multi-packet stream sent, so that packets can be 
+    re-sent if the receiver reports them missing.  Oldest streams are
+    removed when the cache is full or they are too old. */
+void Transport::CacheSentStream(const UShort messageCode,
+                                const Packet::List& stream,
+                                const Header::List& streamHeaders) const
+{
+    if(MEMBER->mRetransmitFlag == false || stream.size() == 0 || stream.size() != streamHeaders.size())
+    {
+        return;
+    }
+
+    Time::Stamp timeMs = Time::GetUtcTimeMs();
+    Mutex::ScopedLock lock(&MEMBER->mSentStreamsMutex);
+
+    MEMBER->mSentStreams.push_back(SentStream());
+    SentStream& sent = MEMBER->mSentStreams.back();
+    sent.mDestinationID = streamHeaders.front().mDestinationID;
+    sent.mMessageCode = messageCode;
+    sent.mFirstSequenceNumber = streamHeaders.front().mSequenceNumber;
+    sent.mPackets = stream;
+    sent.mHeaders = streamHeaders;
+    sent.mSendTimeMs = timeMs;
+    Packet::List::const_iterator packet;
+    for(packet = stream.begin(); packet != stream.end(); packet++)
+    {
+        sent.mSizeBytes += packet->Length();
+    }
+    MEMBER->mSentStreamsBytes += sent.mSizeBytes;
+
+    while(MEMBER->mSentStreams.size() > 0 &&
+          (MEMBER->mSentStreamsBytes > MEMBER->mRetransmitCacheSize ||
+           timeMs - MEMBER->mSentStreams.front().mSendTimeMs > RETRANSMIT_CACHE_TIME_MS))
+    {
+        MEMBER->mSentStreamsBytes -= MEMBER->mSentStreams.front().mSizeBytes;
+        MEMBER->mSentStreams.pop_front();
+    }
+}
+
+
+/** Processes a negative acknowledge (NACK) for large data set packets. The 
+    NACK payload is the message code, the number of ranges, then pairs of
+    sequence numbers [from, to] missing.  The header sequence number is
+    a packet the receiver has, which identifies the stream. */
+void Transport::ProcessNack(const Packet& packet, const Header& header)
+{
+    if(MEMBER->mRetransmitFlag == false)
+    {
+        return;
+    }
+
+    UShort messageCode = 0;
+    UShort numRanges = 0;
+    std::vector<UShort> ranges;
+    packet.SetReadPos(Header::PayloadOffset);
+    if(packet.Read(messageCode) <= 0 || packet.Read(numRanges) <= 0)
+    {
+        return;
+    }
+    for(UShort r = 0; r < numRanges; r++)
+    {
+        UShort from = 0, to = 0;
+        if(packet.Read(from) <= 0 || packet.Read(to) <= 0)
+        {
+            return;
+        }
+        ranges.push_back(from);
+        ranges.push_back(to);
+    }
+    packet.SetReadPos(0);
+
+    Mutex::ScopedLock lock(&MEMBER->mSentStreamsMutex);
+    SentStream::List::reverse_iterator sent;
+    for(sent = MEMBER->mSentStreams.rbegin(); sent != MEMBER->mSentStreams.rend(); sent++)
+    {
+        if(sent->mMessageCode == messageCode &&
+           Address::DestinationMatch(sent->mDestinationID, header.mSourceID) &&
+           (UShort)(header.mSequenceNumber - sent->mFirstSequenceNumber) < (UShort)sent->mPackets.size())
+        {
+            for(unsigned int i = 0; i < (unsigned int)sent->mPackets.size(); i++)
             {
-                delete ld->second;
-                MEMBER->mLargeDataSets.erase(ld);
-                ld = MEMBER->mLargeDataSets.begin();
+                UShort sequenceNumber = sent->mHeaders[i].mSequenceNumber;
+                for(unsigned int r = 0; r + 1 < (unsigned int)ranges.size(); r += 2)
+                {
+                    if((UShort)(sequenceNumber - ranges[r]) <= (UShort)(ranges[r + 1] - ranges[r]))
+                    {
+                        SendPacket(sent->mPackets[i], sent->mHeaders[i]);
+                        break;
+                    }
+                }
             }
-            else
+            break;
+        }
+    }
+}
+
+
+/** Sends a negative acknowledge (NACK) to the source of incomplete large data
+    sets that have stopped receiving data, listing the packets missing so
+    only they are re-sent.  Must be called with the large data sets mutex 
+    locked. */
+void Transport::RequestMissingPackets()
+{
+    Time::Stamp timeMs = Time::GetUtcTimeMs();
+    LargeDataSet::Map::iterator ld;
+    for(ld = MEMBER->mLargeDataSets.begin(); ld != MEMBER->mLargeDataSets.end(); ld++)
+    {
+        LargeDataSet* stream = ld->second;
+        Time::Stamp lastTimeMs = stream->mUpdateTimeMs > stream->mNackTimeMs ? stream->mUpdateTimeMs : stream->mNackTimeMs;
+        if(stream->mCompleteFlag || 
+           stream->mNumNacks >= MAX_NACKS ||
+           timeMs - lastTimeMs < MEMBER->mNackDelayMs)
+        {
+            continue;
+        }
+
+        UShort reference = 0;
+        std::vector<UShort> ranges;
+        if(stream->GetMissingPackets(reference, ranges) == false)
+        {
+            continue;
+        }
+
+        Header nackHeader;
+        nackHeader.mSourceID = mComponentID;
+        nackHeader.mDestinationID = stream->mHeader.mSourceID;
+        nackHeader.mAckNackFlag = Header::AckNack::Nack;
+        nackHeader.mControlFlag = Header::DataControl::Single;
+        nackHeader.mPriorityFlag = Header::Priority::High;
+        nackHeader.mSequenceNumber = reference;
+        nackHeader.mSize = (UShort)(Header::MinSize + USHORT_SIZE*2 + USHORT_SIZE*ranges.size());
+
+        PacketPool::Buffer nackPacket(MEMBER->mPacketPool);
+        const Packet& transportHeader = MEMBER->mpSharedMemory->GetTransportHeader();
+        if(transportHeader.Length() > 0)
+        {
+            nackPacket->Write(transportHeader);
+        }
+        if(nackHeader.Write(*nackPacket))
+        {
+            nackPacket->Write(stream->mMessageCode);
+            nackPacket->Write((UShort)(ranges.size()/2));
+            std::vector<UShort>::iterator r;
+            for(r = ranges.begin(); r != ranges.end(); r++)
             {
-                ld++;
+                nackPacket->Write(*r);
             }
+            SendPacket(*nackPacket, nackHeader);
         }
+        stream->mNackTimeMs = timeMs;
+        stream->mNumNacks++;
+    }
+}
+
+
+/** Blocks until a large data set packet can be sent without exceeding the
+    rate limit of network connections (see NodeManager::Parameters::SetRateLimit),
+    so the stream is paced instead of overflowing the Node Manager.  Packets for
+    components on this node are not paced. */
+void Transport::PaceLargeDataSet(const Address& destination, const unsigned int bytes) const
+{
+    if(MEMBER->mLargeDataSetPacer.IsLimited() == false ||
+       (destination.mSubsystem == mComponentID.mSubsystem && destination.mNode == mComponentID.mNode))
+    {
+        return;
+    }
+    MEMBER->mLargeDataSetPacer.Wait(bytes, &MEMBER->mStopMessageProcessingFlag);
+}
+
+
+/** Gets the minimum payload size compressed for a message type sent to
+    a destination, 0 if compression is not enabled. */
+unsigned int Transport::GetCompressionThreshold(const UShort messageCode, const Address& destination) const
+{
+    ReadLock rLock(*((SharedMutex*)&MEMBER->mCompressionMutex));
+    std::map<std::pair<UShort, UInt>, unsigned int>::const_iterator threshold;
+    threshold = MEMBER->mCompressionThresholds.find(std::pair<UShort, UInt>(messageCode, destination.ToUInt()));
+    if(threshold != MEMBER->mCompressionThresholds.end())
+    {
+        return threshold->second;
     }
+    return 0;
 }
 
 
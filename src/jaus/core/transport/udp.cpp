@@ -43,6 +43,14 @@
 #include <cxutils/networking/udpclient.h>
 #include <cxutils/networking/udpserver.h>
 #include <tinyxml/tinyxml.h>
+#include <string.h>
+#include <sstream>
+#include <algorithm>
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
 
 using namespace JAUS;
 
@@ -60,6 +68,8 @@ UDP::Parameters::Parameters()
     mMulticastIP = std::string("239.255.0.1");
     mTimeToLive = 16;
     mUseBroadcastingFlag = false;
+    mBatchSize = 0;
+    mHeaderCompressionFlag = false;
     this->mTransportType = Connection::Transport::JUDP;
 }
 
@@ -135,6 +145,8 @@ UDP::Parameters& UDP::Parameters::operator=(const UDP::Parameters& params)
         mUseBroadcastingFlag = params.mUseBroadcastingFlag;
         mMulticastIP = params.mMulticastIP;
         mTimeToLive = params.mTimeToLive;
+        mBatchSize = params.mBatchSize;
+        mHeaderCompressionFlag = params.mHeaderCompressionFlag;
     }
     return *this;
 }
@@ -153,6 +165,10 @@ UDP::UDP(const bool singleThread) : Connection(singleThread)
     mTransportType = Connection::Transport::JUDP;
     mTransportHeader.Write(Version);
     mSendCache.Write(Version);
+    mPendingBuffer.Write(Version);
+    mPendingCount = 0;
+    mFlushCount = 0;
+    mpHeaderCompression.reset(new HeaderCompression());
 }
 
 
@@ -163,6 +179,7 @@ UDP::UDP(const bool singleThread) : Connection(singleThread)
 ////////////////////////////////////////////////////////////////////////////////////
 UDP::~UDP()
 {
+    mpShaper->Remove(this);
 }
 
 
@@ -320,6 +337,7 @@ void UDP::Shutdown()
 {
     CloseSocket();
     mUpdateConnectionThread.StopThread();
+    mpShaper->Remove(this);
     DeleteSocket();
 }
 
@@ -348,6 +366,8 @@ Connection::Statistics UDP::GetStatistics()
         stats = mStats;
         mStats.mConnectionNumber = stats.mConnectionNumber = mConnectionNumber;
         mStats.mBytesReceived = mStats.mBytesSent = mStats.mMessagesReceived = mStats.mMessagesSent = 0;
+        mStats.mHeaderBytesSaved = 0;
+        mStats.mPacketsDropped = 0;
     }
     return stats;
 }
@@ -374,10 +394,19 @@ bool UDP::CanBroadcast(const int transportType) const
 ///   \brief Sends the packet over the connection, adding any transport
 ///          information as needed.
 ///
+///   If batching is enabled, small packets are queued into a single JUDP
+///   datagram which is sent when full or by SendBatch.  High and Safety
+///   Critical packets are never queued, they are sent right away (ahead of
+///   any queued packets).  If header compression is enabled, packets are
+///   written using HeaderCompression.
+///
+///   If a rate limit is set, packets the limit holds back are sent later by
+///   the TrafficShaper, and batching is not used.
+///
 ///   \param[in] packet JAUS packet with no additional transport overhead.
 ///   \param[in] packetHeader JAUS general header data.
 ///
-///   \return True on success, false on failure.
+///   \return True on success (or queued), false on failure.
 ///
 ////////////////////////////////////////////////////////////////////////////////////
 bool UDP::SendPacket(const Packet& packet,
@@ -385,6 +414,80 @@ bool UDP::SendPacket(const Packet& packet,
 {
     bool result = false;
 
+    // Apply the rate limit (if any).
+    int shaping = ShapeTraffic(packet, packetHeader);
+    if(shaping != TrafficShaper::Send)
+    {
+        return shaping == TrafficShaper::Queued;
+    }
+
+    // Packets sent by the shaper aren't batched, so don't batch while
+    // limited to keep packets in order.
+    if(mParameters.mBatchSize > 1 &&
+       packetHeader.mPriorityFlag < Header::Priority::High &&
+       mpShaper->IsLimited() == false)
+    {
+        SharedMutex* m = (SharedMutex*)&mSendMutex;
+        UDP* udp = (UDP*)this;
+        Packet* pending = (Packet *)&mPendingBuffer;
+        unsigned int* pendingCount = (unsigned int *)&mPendingCount;
+        unsigned int packetSize = packet.Length();
+        if(mParameters.mHeaderCompressionFlag)
+        {
+            // Requesting header compression adds HC fields.
+            packetSize += HeaderCompression::FieldsSize;
+        }
+        for(unsigned int attempt = 0; attempt < 2; attempt++)
+        {
+            if(attempt > 0)
+            {
+                // No room left, send what is queued first.  This goes through
+                // the flush buffer under mFlushMutex like SendBatch, so it can't
+                // pass a datagram SendBatch has taken but not yet sent.
+                WriteLock fLock(udp->mFlushMutex);
+                if(udp->TakePendingPackets())
+                {
+                    udp->SendDatagram(udp->mFlushBuffer, udp->mFlushCount);
+                }
+            }
+
+            WriteLock wLock(*m);
+            if(mpSocket == NULL)
+            {
+                return result;
+            }
+            if(pending->Length() + packetSize <= mParameters.mMaxPacketSizeBytes)
+            {
+                WriteJausPacket(packet, *pending);
+                (*pendingCount)++;
+                return true;
+            }
+            if(*pendingCount == 0)
+            {
+                // Packet is too large to share a datagram, send by itself.
+                break;
+            }
+        }
+    }
+
+    return TransmitPacket(packet, packetHeader);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Sends the packet in its own JUDP datagram.
+///
+///   \param[in] packet JAUS packet with no additional transport overhead.
+///   \param[in] packetHeader JAUS general header data.
+///
+///   \return True on success, false on failure.
+///
+////////////////////////////////////////////////////////////////////////////////////
+bool UDP::TransmitPacket(const Packet& packet,
+                         const Header& packetHeader) const
+{
+    bool result = false;
     Packet* ptr;
     int size = 0;
     ptr = (Packet *)&mSendCache;
@@ -393,8 +496,9 @@ bool UDP::SendPacket(const Packet& packet,
         WriteLock wLock(*m);
 
         // Send JUDP Header and packet
-        ptr->SetWritePos(sizeof(Version));
-        ptr->Write(packet);
+        ptr->Clear(false);
+        ptr->Write(Version);
+        WriteJausPacket(packet, *ptr);
 
         CxUtils::Socket* socket = (CxUtils::Socket*)mpSocket;
 
@@ -407,14 +511,7 @@ bool UDP::SendPacket(const Packet& packet,
     }
     if(size > 0)
     {
-        // Update stats.
-        WriteLock wLock(*((SharedMutex *)&mConnectionMutex));
-        Connection::Statistics* stats = (Connection::Statistics*)&mStats;
-        stats->mMessagesSent++;
-        stats->mTotalMessagesSent++;
-        stats->mBytesSent += (unsigned int)size;
-        stats->mTotalBytesSent += (unsigned int)size;
-
+        UpdateSendStatistics(1, size);
         result = true;
     }
 
@@ -422,6 +519,231 @@ bool UDP::SendPacket(const Packet& packet,
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Sends the datagrams queued by batching connections.
+///
+///   On Linux, datagrams for connections that share a socket are sent with
+///   a single system call.  Safe to call from multiple threads, each connection
+///   is locked from taking its queued packets until they are sent so datagrams
+///   stay in order.
+///
+///   \param[in] connections Connections to send queued datagrams for.
+///
+///   \return Number of datagrams sent.
+///
+////////////////////////////////////////////////////////////////////////////////////
+unsigned int UDP::SendBatch(const std::vector<UDP*>& connections)
+{
+    unsigned int total = 0;
+    // Lock in address order so threads flushing the same connections
+    // can't deadlock.
+    std::vector<UDP*> locked(connections);
+    std::sort(locked.begin(), locked.end());
+    locked.erase(std::unique(locked.begin(), locked.end()), locked.end());
+
+    std::vector<UDP*> ready;
+    std::vector<UDP*>::iterator c;
+    for(c = locked.begin();
+        c != locked.end();
+        c++)
+    {
+        if((*c) == NULL)
+        {
+            continue;
+        }
+        (*c)->mFlushMutex.lock();
+        if((*c)->TakePendingPackets())
+        {
+            ready.push_back(*c);
+        }
+        else
+        {
+            (*c)->mFlushMutex.unlock();
+        }
+    }
+    // Keep connections that share a socket next to each other.
+    std::stable_sort(ready.begin(), ready.end(), UDP::CompareSocket);
+
+    unsigned int index = 0;
+#if defined(__linux__)
+    struct mmsghdr messages[MaxBatchSize];
+    struct iovec vectors[MaxBatchSize];
+    struct sockaddr_in addresses[MaxBatchSize];
+    UDP* senders[MaxBatchSize];
+
+    while(index < (unsigned int)ready.size())
+    {
+        // Group client connections using the same socket, each
+        // with their own destination address.
+        unsigned int count = 0;
+        int descriptor = -1;
+        while(index + count < (unsigned int)ready.size() && count < MaxBatchSize)
+        {
+            UDP* udp = ready[index + count];
+            CxUtils::UdpSocket* socket = (CxUtils::UdpSocket*)udp->mpSocket;
+            if(socket == NULL || udp->mParameters.mClientFlag == false ||
+               (count > 0 && socket->GetSocket() != descriptor))
+            {
+                break;
+            }
+            memset(&addresses[count], 0, sizeof(struct sockaddr_in));
+            addresses[count].sin_family = AF_INET;
+            addresses[count].sin_port = htons(socket->GetDestinationPort());
+            if(inet_pton(AF_INET, socket->GetDestinationAddress().mString.c_str(), &addresses[count].sin_addr) != 1)
+            {
+                break;
+            }
+            descriptor = socket->GetSocket();
+            memset(&messages[count], 0, sizeof(struct mmsghdr));
+            vectors[count].iov_base = udp->mFlushBuffer.Ptr();
+            vectors[count].iov_len = udp->mFlushBuffer.Length();
+            messages[count].msg_hdr.msg_iov = &vectors[count];
+            messages[count].msg_hdr.msg_iovlen = 1;
+            messages[count].msg_hdr.msg_name = &addresses[count];
+            messages[count].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+            senders[count] = udp;
+            count++;
+        }
+
+        if(count == 0)
+        {
+            // Server (multicast) or unknown destination, let the socket
+            // send to its default destination.
+            UDP* udp = ready[index++];
+            if(udp->SendDatagram(udp->mFlushBuffer, udp->mFlushCount) > 0)
+            {
+                total++;
+            }
+            continue;
+        }
+
+        int sent = sendmmsg(descriptor, messages, count, 0);
+        for(unsigned int i = 0; i < count; i++)
+        {
+            if((int)i < sent)
+            {
+                senders[i]->UpdateSendStatistics(senders[i]->mFlushCount, (int)messages[i].msg_len);
+                total++;
+            }
+            else if(senders[i]->SendDatagram(senders[i]->mFlushBuffer, senders[i]->mFlushCount) > 0)
+            {
+                total++;
+            }
+        }
+        index += count;
+    }
+#endif
+    for(; index < (unsigned int)ready.size(); index++)
+    {
+        if(ready[index]->SendDatagram(ready[index]->mFlushBuffer, ready[index]->mFlushCount) > 0)
+        {
+            total++;
+        }
+    }
+    for(c = ready.begin();
+        c != ready.end();
+        c++)
+    {
+        (*c)->mFlushMutex.unlock();
+    }
+    return total;
+}
+
+
+/** Orders connections by socket descriptor, client connections first, so
+    those sharing a socket are grouped when sending a batch. */
+bool UDP::CompareSocket(const UDP* first, const UDP* second)
+{
+    if(first->mParameters.mClientFlag != second->mParameters.mClientFlag)
+    {
+        return first->mParameters.mClientFlag;
+    }
+    int a = first->mpSocket ? ((CxUtils::Socket*)first->mpSocket)->GetSocket() : -1;
+    int b = second->mpSocket ? ((CxUtils::Socket*)second->mpSocket)->GetSocket() : -1;
+    return a < b;
+}
+
+
+/** Moves queued packets into the flush buffer for sending, returns false
+    if nothing was queued. */
+bool UDP::TakePendingPackets()
+{
+    WriteLock wLock(mSendMutex);
+    if(mPendingCount == 0)
+    {
+        return false;
+    }
+    mFlushBuffer.Clear(false);
+    mFlushBuffer.Write(mPendingBuffer.Ptr(), mPendingBuffer.Length());
+    mFlushCount = mPendingCount;
+    mPendingBuffer.Clear(false);
+    mPendingBuffer.Write(Version);
+    mPendingCount = 0;
+    return true;
+}
+
+
+/** Sends a JUDP datagram containing one or more packets, and updates
+    statistics.  Returns number of bytes sent. */
+int UDP::SendDatagram(const Packet& datagram, const unsigned int numPackets) const
+{
+    CxUtils::Socket* socket = (CxUtils::Socket*)mpSocket;
+    int size = 0;
+    if(socket)
+    {
+        size = socket->Send(datagram);
+    }
+    if(size > 0)
+    {
+        UpdateSendStatistics(numPackets, size);
+    }
+    return size;
+}
+
+
+/** Adds sent packets and bytes to connection statistics. */
+void UDP::UpdateSendStatistics(const unsigned int numPackets, const int bytes) const
+{
+    WriteLock wLock(*((SharedMutex *)&mConnectionMutex));
+    Connection::Statistics* stats = (Connection::Statistics*)&mStats;
+    stats->mMessagesSent += numPackets;
+    stats->mTotalMessagesSent += numPackets;
+    stats->mBytesSent += (unsigned int)bytes;
+    stats->mTotalBytesSent += (unsigned int)bytes;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Writes a JAUS packet to a JUDP datagram, using header compression
+///          if enabled.
+///
+///   \param[in] packet JAUS packet to write.
+///   \param[out] datagram JUDP datagram to append packet to.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void UDP::WriteJausPacket(const Packet& packet, Packet& datagram) const
+{
+    unsigned int start = datagram.Length();
+    if(mParameters.mHeaderCompressionFlag == false ||
+       !mpHeaderCompression ||
+       mpHeaderCompression->Compress(packet, datagram) == false)
+    {
+        datagram.Write(packet);
+        return;
+    }
+    unsigned int written = datagram.Length() - start;
+    if(written < packet.Length())
+    {
+        WriteLock wLock(*((SharedMutex *)&mConnectionMutex));
+        Connection::Statistics* stats = (Connection::Statistics*)&mStats;
+        stats->mHeaderBytesSaved += packet.Length() - written;
+        stats->mTotalHeaderBytesSaved += packet.Length() - written;
+    }
+}
+
+
 /** Updates the current state of the connection. */
 void UDP::UpdateConnection()
 {
@@ -482,6 +804,11 @@ Connection* UDP::CreateConnection(const Address& id,
     newUDP->mParameters = mParameters;
     newUDP->mParameters = *destination;
     newUDP->mParameters.mClientFlag = true;
+    // Receivers identify header templates by source address, so all
+    // connections sending from the same socket share one table.
+    newUDP->mpHeaderCompression = mpHeaderCompression;
+    // The rate limit is for the socket, so it is shared also.
+    newUDP->mpShaper = mpShaper;
 
     newUDP->mpSocket = primary->CreateNewDestination(destination->mDestIP, destination->mDestPortNumber);
 
@@ -504,6 +831,17 @@ const Packet& UDP::GetTransportHeader() const
 }
 
 
+/** Gets the socket descriptor data is received on (-1 if none or client). */
+int UDP::GetDescriptor() const
+{
+    if(mpSocket && mParameters.mClientFlag == false)
+    {
+        return ((CxUtils::Socket*)mpSocket)->GetSocket();
+    }
+    return -1;
+}
+
+
 /** Closes the current socket safely. */
 void UDP::CloseSocket()
 {
@@ -552,7 +890,12 @@ void UDP::ReceiveIncommingData()
     }
 
     long int timeoutMs = 0;
-    if(mSingleThreadModeFlag)
+    if(mpReactor)
+    {
+        // A Reactor only updates the connection when data is ready.
+        timeoutMs = 1;
+    }
+    else if(mSingleThreadModeFlag)
     {
         timeoutMs = 50;
     }
@@ -580,76 +923,213 @@ void UDP::ReceiveIncommingData()
                      &sourceInfo.mDestIP,
                      &sourceInfo.mDestPortNumber) > 0)
     {
-        unsigned char* ptr = mRecvBuffer.Ptr();
+        ProcessDatagram(mRecvBuffer, sourceInfo);
+
+        // Get any other datagrams already waiting.
+        if(mParameters.mBatchSize > 1)
+        {
+            ReceiveBatch(sourceInfo);
+        }
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Receives up to mBatchSize datagrams already waiting on the socket
+///          using a single system call (Linux only, otherwise does nothing).
+///
+///   \param[in] sourceInfo Source information, updated with the address of
+///                         each datagram.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void UDP::ReceiveBatch(Info& sourceInfo)
+{
+#if defined(__linux__)
+    int descriptor = GetDescriptor();
+    if(descriptor < 0)
+    {
+        return;
+    }
+
+    unsigned int count = mParameters.mBatchSize > MaxBatchSize ? MaxBatchSize : mParameters.mBatchSize;
+    const unsigned int slotSize = JAUS_USHORT_MAX;
+    if(mBatchBuffer.size() < count*slotSize)
+    {
+        mBatchBuffer.resize(count*slotSize);
+    }
 
-        // Check for JUDP Version header and make sure that this is not
-        // a UDP message sent from this Node Manager (loop back of multicast/broadcast data).
-        if((CxUtils::Socket::IsHostAddress(sourceInfo.mDestIP) == false || sourceInfo.mSourcePortNumber != sourceInfo.mDestPortNumber)
-            &&
-            mRecvBuffer.Length() > Header::MinSize + BYTE_SIZE && ptr[0] == Version)
+    struct mmsghdr messages[MaxBatchSize];
+    struct iovec vectors[MaxBatchSize];
+    struct sockaddr_in addresses[MaxBatchSize];
+    memset(messages, 0, sizeof(struct mmsghdr)*count);
+    for(unsigned int i = 0; i < count; i++)
+    {
+        vectors[i].iov_base = &mBatchBuffer[i*slotSize];
+        vectors[i].iov_len = slotSize;
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+        messages[i].msg_hdr.msg_name = &addresses[i];
+        messages[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+    }
+
+    int received = recvmmsg(descriptor, messages, count, MSG_DONTWAIT, NULL);
+    for(int i = 0; i < received && GetGlobalShutdownSignal() == false; i++)
+    {
+        char address[INET_ADDRSTRLEN];
+        if((messages[i].msg_hdr.msg_flags & MSG_TRUNC) ||
+           inet_ntop(AF_INET, &addresses[i].sin_addr, address, sizeof(address)) == NULL)
         {
-            // There may be multiple JAUS messages within each UDP packet
-            unsigned int position = sizeof(Version);
-            while(position < mRecvBuffer.Length())
+            continue;
+        }
+        sourceInfo.mDestIP.SetAddress(address);
+        sourceInfo.mDestPortNumber = ntohs(addresses[i].sin_port);
+
+        Packet::Wrapper datagram(&mBatchBuffer[i*slotSize], messages[i].msg_len);
+        ProcessDatagram(*datagram.GetData(), sourceInfo);
+    }
+#endif
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Extracts the JAUS packets within a JUDP datagram and sends them to
+///          callbacks.
+///
+///   \param[in] datagram JUDP datagram (transport header followed by one or
+///                       more JAUS packets).
+///   \param[in] sourceInfo Information about the source of the datagram.
+///
+////////////////////////////////////////////////////////////////////////////////////
+void UDP::ProcessDatagram(const Packet& datagram, Info& sourceInfo)
+{
+    unsigned char* ptr = (unsigned char*)datagram.Ptr();
+
+    // Check for JUDP Version header and make sure that this is not
+    // a UDP message sent from this Node Manager (loop back of multicast/broadcast data).
+    if((CxUtils::Socket::IsHostAddress(sourceInfo.mDestIP) == false || sourceInfo.mSourcePortNumber != sourceInfo.mDestPortNumber)
+        &&
+        datagram.Length() > sizeof(Version) && ptr[0] == Version)
+    {
+        // There may be multiple JAUS messages within each UDP packet
+        unsigned int position = sizeof(Version);
+        std::string source;
+        while(position < datagram.Length())
+        {
+            unsigned int remaining = datagram.Length() - position;
+            int bytesRead = 0;
+            if((ptr[position] >> 6) != Header::Compression::None)
             {
-                // Try read message data.
-                JAUS::Header jausHeader;
-                Packet::Wrapper subPacket(&ptr[position], mRecvBuffer.Length() - position);
-                std::string errorMessage;
-                int bytesRead = 0;
-                // Try read JAUS General Header data to check if there is a valid
-                // JAUS packet here.
-                if( (bytesRead = jausHeader.Read(*subPacket.GetData())) > 0 &&
-                    jausHeader.IsValid(&errorMessage) &&
-                    subPacket->Length() >= jausHeader.mSize)
+                // Restore the full general header before processing.
+                if(source.empty())
                 {
-                    // Wrap the extracted packet
-                    Packet::Wrapper jausPacket(&ptr[position],
-                                                (unsigned int)jausHeader.mSize);
-
-                    mID = jausHeader.mSourceID;
-
-                    // Update stats.
-                    {
-                        WriteLock wLock(mConnectionMutex);
-                        Connection::Statistics* stats = (Connection::Statistics*)&mStats;
-                        stats->mMessagesReceived++;
-                        stats->mTotalMessagesReceived++;
-                        stats->mBytesReceived += jausPacket->Length();
-                        stats->mTotalBytesReceived += jausPacket->Length();
-                    }
-
-                    // Check for internal discovery message.
-                    if(jausHeader.mSourceID == jausHeader.mDestinationID)
-                    {
-                        ReportTime reportTime;
-                        jausPacket.GetData()->SetReadPos(0);
-                        if(reportTime.Read(*jausPacket.GetData()))
-                        {
-                            SharedMemory::Parameters smParams;
-                            smParams.mComponentID = jausHeader.mSourceID;
-                            smParams.mSharedConnectionType = SharedMemory::Parameters::Client;
-                            smParams.mCreationTime = reportTime.GetTimeStamp();
-                            smParams.mDestPortNumber = smParams.mSourcePortNumber = mParameters.mSourcePortNumber;
-                            mpManager->CreateConnection(jausHeader.mSourceID, smParams, false);
-                        }
-                    }
-                    else
-                    {
-                        // Process data
-                        SendToCallbacks(*jausPacket.GetData(),
-                                        jausHeader,
-                                        &sourceInfo);
-                    }
-                    position += jausPacket->Length();
+                    std::stringstream str;
+                    str << sourceInfo.mDestIP.mString << ":" << sourceInfo.mDestPortNumber;
+                    source = str.str();
                 }
-                else
+                bytesRead = mpHeaderCompression->Expand(&ptr[position],
+                                                        remaining,
+                                                        source,
+                                                        mExpandBuffer,
+                                                        mReplyBuffer);
+                if(bytesRead <= 0)
                 {
                     break;
                 }
+                if(mExpandBuffer.Length() > 0)
+                {
+                    ProcessJausPacket((unsigned char*)mExpandBuffer.Ptr(), mExpandBuffer.Length(), sourceInfo);
+                }
+                if(mReplyBuffer.Length() > 0 && mpManager)
+                {
+                    // Tell the sender the header template was stored.
+                    Header replyHeader;
+                    UInt id = 0;
+                    mReplyBuffer.Read(id, HeaderCompression::CompressedHeaderSize + BYTE_SIZE);
+                    replyHeader.mDestinationID = Address(id);
+                    mReplyBuffer.Read(id, HeaderCompression::CompressedHeaderSize + BYTE_SIZE + UINT_SIZE);
+                    replyHeader.mSourceID = Address(id);
+                    replyHeader.mCompressionFlag = Header::Compression::Engaged;
+                    replyHeader.mSize = (UShort)mReplyBuffer.Length();
+                    mpManager->RoutePacket(mReplyBuffer, replyHeader, this, &sourceInfo);
+                }
+            }
+            else if(remaining < Header::MinSize ||
+                    (bytesRead = ProcessJausPacket(&ptr[position], remaining, sourceInfo)) <= 0)
+            {
+                break;
             }
+            position += (unsigned int)bytesRead;
+        }
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Reads a JAUS packet from a JUDP datagram and sends it to
+///          callbacks.
+///
+///   \param[in] data Pointer to the JAUS packet.
+///   \param[in] length Number of bytes available at data.
+///   \param[in] sourceInfo Information about the source of the datagram.
+///
+///   \return Size of the JAUS packet read, 0 if not a valid JAUS packet.
+///
+////////////////////////////////////////////////////////////////////////////////////
+int UDP::ProcessJausPacket(unsigned char* data, const unsigned int length, Info& sourceInfo)
+{
+    // Try read message data.
+    JAUS::Header jausHeader;
+    Packet::Wrapper subPacket(data, length);
+    std::string errorMessage;
+    // Try read JAUS General Header data to check if there is a valid
+    // JAUS packet here.
+    if(jausHeader.Read(*subPacket.GetData()) > 0 &&
+       jausHeader.IsValid(&errorMessage) &&
+       subPacket->Length() >= jausHeader.mSize)
+    {
+        // Wrap the extracted packet
+        Packet::Wrapper jausPacket(data, (unsigned int)jausHeader.mSize);
+
+        mID = jausHeader.mSourceID;
+
+        // Update stats.
+        {
+            WriteLock wLock(mConnectionMutex);
+            Connection::Statistics* stats = (Connection::Statistics*)&mStats;
+            stats->mMessagesReceived++;
+            stats->mTotalMessagesReceived++;
+            stats->mBytesReceived += jausPacket->Length();
+            stats->mTotalBytesReceived += jausPacket->Length();
+        }
+
+        // Check for internal discovery message.
+        if(jausHeader.mSourceID == jausHeader.mDestinationID)
+        {
+            ReportTime reportTime;
+            jausPacket.GetData()->SetReadPos(0);
+            if(reportTime.Read(*jausPacket.GetData()))
+            {
+                SharedMemory::Parameters smParams;
+                smParams.mComponentID = jausHeader.mSourceID;
+                smParams.mSharedConnectionType = SharedMemory::Parameters::Client;
+                smParams.mCreationTime = reportTime.GetTimeStamp();
+                smParams.mDestPortNumber = smParams.mSourcePortNumber = mParameters.mSourcePortNumber;
+                mpManager->CreateConnection(jausHeader.mSourceID, smParams, false);
+            }
+        }
+        else
+        {
+            // Process data
+            SendToCallbacks(*jausPacket.GetData(),
+                            jausHeader,
+                            &sourceInfo);
         }
+        return (int)jausPacket->Length();
     }
+    return 0;
 }
 
 
@@ -100,6 +100,33 @@ bool RangeSubscriber::CreateRangeSubscription(const Address& id,
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Creates a range data subscription without blocking.
+///
+///   \param[in] id The component ID to get range data from.
+///   \param[in] deviceID The ID of the range sensor to get data from.
+///   \param[in] callback Optional callback made when the request is done.
+///   \param[in] waitTimeMs How long to wait in ms before timeout on request.
+///
+///   \return Handle to the request, IsSuccessful is true once the
+///           subscription is created.
+///
+////////////////////////////////////////////////////////////////////////////////////
+AsyncResponse::Ptr RangeSubscriber::CreateRangeSubscriptionAsync(const Address& id, 
+                                                                 const Byte deviceID,
+                                                                 AsyncResponse::Callback* callback,
+                                                                 const unsigned int waitTimeMs)
+{
+    QueryRangeSensorConfiguration queryConfig(id, GetComponentID());
+    Send(&queryConfig);
+
+    QueryLocalRangeScan queryEvent;
+    queryEvent.SetSensorID(deviceID);
+    return EventsService()->RequestEveryChangeEventAsync(id, &queryEvent, callback, waitTimeMs);
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Query a component with a Range Sensor service for number
@@ -127,6 +154,30 @@ bool RangeSubscriber::GetRangeSensorInfo(const Address& id,
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////
+///
+///   \brief Query a component with a Range Sensor service for number
+///          of devices, without blocking.
+///
+///   \param[in] id The component ID to get range data from.
+///   \param[in] callback Optional callback made when the request is done.
+///   \param[in] waitTimeMs How long to wait in ms before timeout on request.
+///
+///   \return Handle to the request, the response is a
+///           ReportRangeSensorConfiguration message.
+///
+////////////////////////////////////////////////////////////////////////////////////
+AsyncResponse::Ptr RangeSubscriber::GetRangeSensorInfoAsync(const Address& id,
+                                                            AsyncResponse::Callback* callback,
+                                                            const unsigned int waitTimeMs) const
+{
+    QueryRangeSensorConfiguration query(id, GetComponentID());
+    AsyncResponse::Ptr handle(new AsyncResponse(callback));
+    AsyncResponse::Send(GetTransportService(), handle, &query, waitTimeMs);
+    return handle;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////
 ///
 ///   \brief Method to check if a video subscription is present.
@@ -520,7 +520,7 @@ void DiscoveryPanel::UpdateSubsystemTree(const bool force)
                     service != component->mServices.end();
                     service++)
                 {
-                    mSubsystemTree->AppendItem(cNode, wxString(service->mName.c_str(), wxConvUTF8));
+                    mSubsystemTree->AppendItem(cNode, wxString(service->GetName().c_str(), wxConvUTF8));
                 }
             }
         }
@@ -70,6 +70,7 @@ enum Columns
     BYTES_RECEIVED,
     TOTAL_BYTES_SENT,
     TOTAL_BYTES_RECEIVED,
+    TOTAL_BYTES_SAVED,
     COLUMNS
 };
 
@@ -465,6 +466,7 @@ void NodeManagerFrame::OnUpdateMainPanel( wxCommandEvent& event)
         this->mRemoteConnections->InsertColumn(BYTES_RECEIVED, wxT("KB Received"));
         this->mRemoteConnections->InsertColumn(TOTAL_BYTES_SENT, wxT("Total KB Sent"));
         this->mRemoteConnections->InsertColumn(TOTAL_BYTES_RECEIVED, wxT("Total KB Received"));
+        this->mRemoteConnections->InsertColumn(TOTAL_BYTES_SAVED, wxT("Total KB Saved"));
     }
 
     for(stat = remote.begin();
@@ -593,6 +595,15 @@ void NodeManagerFrame::OnUpdateMainPanel( wxCommandEvent& event)
                                          wxString( str.str().c_str(), wxConvUTF8));
         if(str.str().size() > std::string("Total KB Received").size()) { this->mRemoteConnections->SetColumnWidth(IP, wxLIST_AUTOSIZE); }
         else { this->mRemoteConnections->SetColumnWidth(TOTAL_BYTES_RECEIVED, wxLIST_AUTOSIZE_USEHEADER); }
+
+        // Bytes not sent because of header compression.
+        str.clear();
+        str.str(std::string());
+        str << stat->mTotalHeaderBytesSaved*.00098;
+        this->mRemoteConnections->SetItem(index, TOTAL_BYTES_SAVED,
+                                         wxString( str.str().c_str(), wxConvUTF8));
+        if(str.str().size() > std::string("Total KB Saved").size()) { this->mRemoteConnections->SetColumnWidth(IP, wxLIST_AUTOSIZE); }
+        else { this->mRemoteConnections->SetColumnWidth(TOTAL_BYTES_SAVED, wxLIST_AUTOSIZE_USEHEADER); }
     }
 
     ((DiscoveryPanel*)mpDiscoveryPanel)->OnUpdateMainPanel(event);
@@ -71,12 +71,12 @@ int main(int argc, char* argv[])
 
     std::cout << "Component Initialized!\n";
     bool finished = false;
+    JAUS::Address::List componentsWithPrimitiveDrivers;
     while(!finished)
     {
         // Find robots with primitive driver service.
-        JAUS::Address::List componentsWithPrimitiveDrivers;
-        
-        componentsWithPrimitiveDrivers = component.DiscoveryService()->GetComponentsWithService(JAUS::PrimitiveDriver::Name);
+        component.DiscoveryService()->GetComponentsWithService(JAUS::PrimitiveDriver::Name,
+                                                               componentsWithPrimitiveDrivers);
 
         if(componentsWithPrimitiveDrivers.size() > 0)
         {
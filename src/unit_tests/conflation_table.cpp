@@ -0,0 +1,211 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file conflation_table.cpp
+///  \brief This file is a unit test program to verify the keys and
+///          latest value replacement of ConflationTable.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#include "jaus/core/transport/conflationtable.h"
+#include "jaus/core/corecodes.h"
+#include "unit_test.h"
+#include <iostream>
+#include <cstring>
+
+
+#ifdef VLD_ENABLED
+#include <vld.h>
+#endif
+
+using namespace JAUS;
+using namespace UnitTest;
+
+static const UShort ReportCode = 0x4402;
+static const UShort OtherReportCode = 0x4403;
+
+
+/** Creates a single packet message, or an Event message containing the
+    report if eventID is not negative. */
+void CreatePacket(const Address& source,
+                  const UShort messageCode,
+                  const Byte value,
+                  Packet& packet,
+                  Header& header,
+                  const int eventID = -1)
+{
+    Packet payload;
+    if(eventID >= 0)
+    {
+        // Event ID, sequence number, report size, and report.
+        payload.Write(EVENT);
+        payload.Write((Byte)eventID);
+        payload.Write((Byte)0);
+        payload.Write((UInt)(USHORT_SIZE + BYTE_SIZE));
+    }
+    payload.Write(messageCode);
+    payload.Write(value);
+
+    header = Header();
+    header.mSourceID = source;
+    header.mDestinationID = Address(2, 1, 1);
+    header.mSize = Header::PayloadOffset + payload.Length() + USHORT_SIZE;
+    packet.Clear();
+    header.Write(packet);
+    packet.Write(payload.Ptr(), payload.Length());
+}
+
+
+/** Returns true if the keys are the same. */
+bool IsSame(const ConflationTable::Key& first, const ConflationTable::Key& second)
+{
+    return (first < second) == false && (second < first) == false;
+}
+
+
+int main(int argc, char* argv[])
+{
+    int failures = 0;
+    Packet packet;
+    Header header;
+
+    // Keys are made for enabled message types only.
+    {
+        ConflationTable table;
+        ConflationTable::Key key, other;
+        CreatePacket(Address(1, 1, 1), ReportCode, 1, packet, header);
+        bool disabled = table.GetKey(packet, header, key) == false;
+        table.Enable(ReportCode);
+        bool enabled = table.GetKey(packet, header, key);
+        bool fields = key.mSource == Address(1, 1, 1).ToUInt() &&
+                      key.mMessageCode == ReportCode &&
+                      key.mEventFlag == false;
+        CreatePacket(Address(1, 1, 1), OtherReportCode, 1, packet, header);
+        bool otherCode = table.GetKey(packet, header, other) == false;
+        CreatePacket(Address(1, 1, 2), ReportCode, 1, packet, header);
+        bool otherSource = table.GetKey(packet, header, other) && IsSame(key, other) == false;
+        table.Enable(ReportCode, false);
+        CreatePacket(Address(1, 1, 1), ReportCode, 1, packet, header);
+        bool off = table.GetKey(packet, header, key) == false;
+        failures += Check(disabled && enabled && fields && otherCode && otherSource && off, "Keys");
+    }
+
+    // Multi-packet streams are not conflated.
+    {
+        ConflationTable table;
+        ConflationTable::Key key;
+        table.Enable(ReportCode);
+        CreatePacket(Address(1, 1, 1), ReportCode, 1, packet, header);
+        header.mControlFlag = Header::DataControl::First;
+        failures += Check(table.GetKey(packet, header, key) == false, "Multi-Packet");
+    }
+
+    // Event messages are keyed by the report and event ID.
+    {
+        ConflationTable table;
+        ConflationTable::Key report, first, second, again;
+        table.Enable(ReportCode);
+        CreatePacket(Address(1, 1, 1), ReportCode, 1, packet, header);
+        table.GetKey(packet, header, report);
+        CreatePacket(Address(1, 1, 1), ReportCode, 1, packet, header, 1);
+        bool event = table.GetKey(packet, header, first) &&
+                     first.mEventFlag &&
+                     first.mEventID == 1 &&
+                     first.mMessageCode == ReportCode;
+        CreatePacket(Address(1, 1, 1), ReportCode, 2, packet, header, 2);
+        table.GetKey(packet, header, second);
+        CreatePacket(Address(1, 1, 1), ReportCode, 3, packet, header, 1);
+        table.GetKey(packet, header, again);
+        bool unique = IsSame(first, second) == false &&
+                      IsSame(first, report) == false &&
+                      IsSame(first, again);
+        CreatePacket(Address(1, 1, 1), OtherReportCode, 1, packet, header, 1);
+        bool otherCode = table.GetKey(packet, header, again) == false;
+        // Too short to contain the report code.
+        CreatePacket(Address(1, 1, 1), ReportCode, 1, packet, header, 1);
+        header.mSize = Header::MinSize + BYTE_SIZE*2;
+        packet.SetLength(header.mSize);
+        bool tooShort = table.GetKey(packet, header, again) == false;
+        failures += Check(event && unique && otherCode && tooShort, "Event Keys");
+    }
+
+    // Newer data replaces the queued packet, per key.
+    {
+        ConflationTable table;
+        ConflationTable::Key first, second;
+        Packet queued, other, latest;
+        table.Enable(ReportCode);
+        CreatePacket(Address(1, 1, 1), ReportCode, 1, queued, header, 1);
+        table.GetKey(queued, header, first);
+        CreatePacket(Address(1, 1, 1), ReportCode, 1, other, header, 2);
+        table.GetKey(other, header, second);
+        bool queue = table.Update(first, queued) && table.Update(second, other);
+        CreatePacket(Address(1, 1, 1), ReportCode, 2, packet, header, 1);
+        bool replaced = table.Update(first, packet) == false;
+        CreatePacket(Address(1, 1, 1), ReportCode, 3, latest, header, 1);
+        replaced &= table.Update(first, latest) == false;
+        bool taken = table.Take(first, queued) &&
+                     queued.Length() == latest.Length() &&
+                     memcmp(queued.Ptr(), latest.Ptr(), latest.Length()) == 0;
+        // Other event was not replaced.
+        bool untouched = table.Take(second, other) == false;
+        // Once taken, the next packet is queued.
+        bool requeue = table.Update(first, packet);
+        failures += Check(queue && replaced && taken && untouched && requeue &&
+                          table.GetConflatedCount() == 2 &&
+                          table.GetKeyCount() == 2, "Latest Value");
+        table.Clear();
+        failures += Check(table.GetKeyCount() == 0, "Clear");
+    }
+
+    // Cancelled and timed out packets are not waited on.
+    {
+        ConflationTable table;
+        ConflationTable::Key key;
+        table.Enable(ReportCode);
+        CreatePacket(Address(1, 1, 1), ReportCode, 1, packet, header);
+        table.GetKey(packet, header, key);
+        table.Update(key, packet);
+        table.Cancel(key);
+        bool cancelled = table.Update(key, packet);
+        table.SetTimeoutMs(0);
+        bool timedOut = table.Update(key, packet);
+        failures += Check(cancelled && timedOut && table.GetConflatedCount() == 0, "Cancel and Timeout");
+    }
+
+    return Report(failures);
+}
+
+
+/* End of File */
@@ -0,0 +1,226 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file large_data_set.cpp
+///  \brief This file is a unit test program to verify reassembly of
+///          multi-packet streams by LargeDataSet.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#include "jaus/core/transport/largedataset.h"
+#include "unit_test.h"
+#include <iostream>
+#include <algorithm>
+
+
+#ifdef VLD_ENABLED
+#include <vld.h>
+#endif
+
+using namespace JAUS;
+using namespace UnitTest;
+
+static const UShort MessageCode = 0x4001;
+
+
+/** Creates a multi-packet stream for a payload of the size given. */
+void CreateStream(const unsigned int payloadSize,
+                  const UShort startingSequenceNumber,
+                  Packet& payload,
+                  Packet::List& stream,
+                  Header::List& headers)
+{
+    payload.Clear();
+    for(unsigned int i = 0; i < payloadSize; i++)
+    {
+        payload.Write((Byte)(i*7 + 3));
+    }
+    Header header;
+    header.mSourceID = Address(1, 1, 1);
+    header.mDestinationID = Address(2, 1, 1);
+    LargeDataSet::CreateLargeDataSet(header, MessageCode, payload, stream, headers, NULL, 500, startingSequenceNumber);
+}
+
+
+/** Returns true if the data set is complete and contains the payload. */
+bool IsMerged(const LargeDataSet& dataSet, const Packet& payload)
+{
+    if(dataSet.mCompleteFlag == false ||
+       dataSet.mBuffer.Length() != LargeDataSet::DataOffset + payload.Length())
+    {
+        return false;
+    }
+    return std::equal(payload.Ptr(), payload.Ptr() + payload.Length(), dataSet.mBuffer.Ptr() + LargeDataSet::DataOffset);
+}
+
+
+int main(int argc, char* argv[])
+{
+    int failures = 0;
+    Packet payload;
+    Packet::List stream;
+    Header::List headers;
+
+    // Out of order, with the first packet received last.
+    {
+        CreateStream(5000, 0, payload, stream, headers);
+        LargeDataSet dataSet;
+        bool added = true;
+        for(int i = (int)stream.size() - 1; i >= 0; i--)
+        {
+            added &= dataSet.AddPacket(stream[i]);
+        }
+        failures += Check(stream.size() == 10 && added && IsMerged(dataSet, payload), "Out of Order");
+    }
+
+    // Duplicates are only counted once.
+    {
+        CreateStream(5000, 0, payload, stream, headers);
+        LargeDataSet dataSet;
+        std::vector<unsigned int> order;
+        for(unsigned int i = 0; i < (unsigned int)stream.size() - 1; i++)
+        {
+            order.push_back(i);
+            order.push_back(i);
+        }
+        std::swap(order[1], order[5]);
+        order.push_back((unsigned int)stream.size() - 1);
+        for(unsigned int i = 0; i < (unsigned int)order.size(); i++)
+        {
+            dataSet.AddPacket(stream[order[i]]);
+        }
+        failures += Check(dataSet.mNumReceived == (unsigned int)stream.size() &&
+                          IsMerged(dataSet, payload), "Duplicates");
+    }
+
+    // Sequence numbers wrap around, packets are held until the first arrives.
+    {
+        CreateStream(5000, 65530, payload, stream, headers);
+        LargeDataSet dataSet;
+        bool added = true;
+        for(unsigned int i = 1; i < (unsigned int)stream.size(); i++)
+        {
+            added &= dataSet.AddPacket(stream[i]);
+        }
+        bool held = dataSet.mHaveFirstFlag == false && dataSet.mStream.size() == stream.size() - 1;
+        added &= dataSet.AddPacket(stream[0]);
+        failures += Check(added && held && IsMerged(dataSet, payload), "Sequence Wrap");
+    }
+
+    // Missing packets are reported across the wrap.
+    {
+        CreateStream(5000, 65533, payload, stream, headers);
+        LargeDataSet dataSet;
+        for(unsigned int i = 0; i < (unsigned int)stream.size(); i++)
+        {
+            if(i != 4)
+            {
+                dataSet.AddPacket(stream[i]);
+            }
+        }
+        UShort reference = 0;
+        std::vector<UShort> ranges;
+        bool missing = dataSet.GetMissingPackets(reference, ranges);
+        failures += Check(missing && 
+                          ranges.size() == 2 &&
+                          ranges[0] == 1 && ranges[1] == 1 &&
+                          dataSet.mCompleteFlag == false, "Missing Packets");
+        dataSet.AddPacket(stream[4]);
+        failures += Check(IsMerged(dataSet, payload), "Missing Packets Received");
+    }
+
+    // A sequence number far from the first can't allocate past the limit.
+    {
+        CreateStream(5000, 0, payload, stream, headers);
+        LargeDataSet dataSet;
+        dataSet.mMemoryLimit = 4096;
+        bool first = dataSet.AddPacket(stream[0]);
+        Packet far = stream[1];
+        Header farHeader = headers[1];
+        farHeader.mSequenceNumber = 30000;
+        far.SetWritePos(0);
+        farHeader.Write(far);
+        bool rejected = dataSet.AddPacket(far) == false;
+        failures += Check(first && rejected && 
+                          dataSet.GetMemoryUsage() <= dataSet.mMemoryLimit, "Memory Limit");
+    }
+
+    // Packets held before the first can't use more than the limit.
+    {
+        CreateStream(20000, 0, payload, stream, headers);
+        LargeDataSet dataSet;
+        dataSet.mMemoryLimit = 4096;
+        unsigned int added = 0;
+        for(unsigned int i = 1; i < (unsigned int)stream.size(); i++)
+        {
+            if(dataSet.AddPacket(stream[i]))
+            {
+                added++;
+            }
+        }
+        failures += Check(added > 0 && added < (unsigned int)stream.size() - 1 &&
+                          dataSet.GetMemoryUsage() <= dataSet.mMemoryLimit, "Memory Limit Held");
+    }
+
+    // Compressed streams are decompressed once complete.
+    {
+        CreateStream(20000, 0, payload, stream, headers);
+        Header header = headers[0];
+        header.mControlFlag = Header::DataControl::Single;
+        LargeDataSet::CreateLargeDataSet(header, MessageCode, payload, stream, headers, NULL, 500, 0, 1000);
+        LargeDataSet dataSet;
+        for(unsigned int i = 0; i < (unsigned int)stream.size(); i++)
+        {
+            dataSet.AddPacket(stream[i]);
+        }
+        failures += Check(headers[0].mMessageType == Header::MessageType::Compressed &&
+                          IsMerged(dataSet, payload), "Decompress");
+    }
+
+    // The uncompressed size from the sender is limited.
+    {
+        Packet compressed, decompressed;
+        LargeDataSet::CompressPayload(payload, compressed);
+        bool limited = LargeDataSet::DecompressPayload(compressed, 0, decompressed, payload.Length() - 1) == false;
+        // Claim a larger size than the data decompresses to.
+        compressed.Write((UInt)(payload.Length()*100), 0);
+        bool wrongSize = LargeDataSet::DecompressPayload(compressed, 0, decompressed) == false;
+        failures += Check(limited && wrongSize && decompressed.Reserved() < payload.Length()*100, "Decompress Limit");
+    }
+
+    return Report(failures);
+}
+
+
+/* End of File */
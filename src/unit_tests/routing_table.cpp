@@ -0,0 +1,162 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file routing_table.cpp
+///  \brief This file is a unit test program to verify the RoutingTable
+///          used to route packets.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#include "jaus/core/transport/routingtable.h"
+#include "unit_test.h"
+#include <iostream>
+
+
+#ifdef VLD_ENABLED
+#include <vld.h>
+#endif
+
+using namespace JAUS;
+using namespace UnitTest;
+
+
+/** Returns true if the route found for a component has the transport type given. */
+bool HasRoute(const RoutingTable& table, const Address& id, const int transportType)
+{
+    const RoutingTable::Route* route = table.GetRoute(id);
+    return route != NULL && route->mID == id && route->mTransportType == transportType;
+}
+
+
+int main(int argc, char* argv[])
+{
+    int failures = 0;
+
+    // An empty table has no routes.
+    {
+        RoutingTable table;
+        bool result = table.Find(Address(1, 1, 1)) == NULL && table.GetRoute(Address(1, 1, 1)) == NULL;
+        table.Build(Connection::Map(), Connection::Map(), Connection::Map(), Connection::Ptr());
+        result = result &&
+                 table.Find(Address(1, 1, 1)) == NULL &&
+                 table.mSharedMemory.size() == 0 &&
+                 table.mNetwork.size() == 0;
+        failures += Check(result, "Empty");
+    }
+
+    // Every component added is found, including after collisions in the
+    // hash table, and components not added are not.
+    {
+        Connection::Map sharedMemory, udp, tcp;
+        for(UShort s = 1; s <= 20; s++)
+        {
+            for(Byte c = 1; c <= 10; c++)
+            {
+                udp[Address(s, 1, c).ToUInt()] = Connection::Ptr();
+            }
+        }
+        RoutingTable table;
+        table.Build(sharedMemory, udp, tcp, Connection::Ptr());
+        bool result = table.mNetwork.size() == udp.size();
+        for(UShort s = 1; s <= 20; s++)
+        {
+            for(Byte c = 1; c <= 10; c++)
+            {
+                const RoutingTable::Slot* slot = table.Find(Address(s, 1, c));
+                result = result &&
+                         slot != NULL &&
+                         slot->mID == Address(s, 1, c).ToUInt() &&
+                         slot->mpUdp != NULL &&
+                         slot->mpUdp->mID == Address(s, 1, c) &&
+                         slot->mpSharedMemory == NULL &&
+                         slot->mpTcp == NULL;
+            }
+        }
+        result = result &&
+                 table.Find(Address(21, 1, 1)) == NULL &&
+                 table.Find(Address(1, 2, 1)) == NULL &&
+                 table.Find(Address(1, 1, 11)) == NULL &&
+                 table.Find(Address()) == NULL;
+        failures += Check(result, "Insert and Find");
+    }
+
+    // A component with several routes uses shared memory, then UDP, then TCP.
+    {
+        Connection::Map sharedMemory, udp, tcp;
+        sharedMemory[Address(1, 1, 1).ToUInt()] = Connection::Ptr();
+        udp[Address(1, 1, 1).ToUInt()] = Connection::Ptr();
+        tcp[Address(1, 1, 1).ToUInt()] = Connection::Ptr();
+        udp[Address(2, 1, 1).ToUInt()] = Connection::Ptr();
+        tcp[Address(2, 1, 1).ToUInt()] = Connection::Ptr();
+        tcp[Address(3, 1, 1).ToUInt()] = Connection::Ptr();
+        RoutingTable table;
+        table.Build(sharedMemory, udp, tcp, Connection::Ptr());
+        const RoutingTable::Slot* slot = table.Find(Address(1, 1, 1));
+        bool result = slot != NULL &&
+                      slot->mpSharedMemory != NULL &&
+                      slot->mpUdp != NULL &&
+                      slot->mpTcp != NULL &&
+                      HasRoute(table, Address(1, 1, 1), Connection::Transport::JSharedMemory) &&
+                      HasRoute(table, Address(2, 1, 1), Connection::Transport::JUDP) &&
+                      HasRoute(table, Address(3, 1, 1), Connection::Transport::JTCP) &&
+                      table.mSharedMemory.size() == 1 &&
+                      table.mNetwork.size() == 5;
+        failures += Check(result, "Preferred Route");
+    }
+
+    // Tables are built again when connections change, tables already
+    // published do not change.
+    {
+        Connection::Map sharedMemory, udp, tcp;
+        udp[Address(1, 1, 1).ToUInt()] = Connection::Ptr();
+        RoutingTable first;
+        first.Build(sharedMemory, udp, tcp, Connection::Ptr());
+        sharedMemory[Address(1, 1, 1).ToUInt()] = Connection::Ptr();
+        tcp[Address(2, 1, 1).ToUInt()] = Connection::Ptr();
+        udp.clear();
+        RoutingTable second;
+        second.Build(sharedMemory, udp, tcp, Connection::Ptr());
+        bool result = HasRoute(first, Address(1, 1, 1), Connection::Transport::JUDP) &&
+                      first.Find(Address(2, 1, 1)) == NULL &&
+                      first.mNetwork.size() == 1 &&
+                      HasRoute(second, Address(1, 1, 1), Connection::Transport::JSharedMemory) &&
+                      second.Find(Address(1, 1, 1))->mpUdp == NULL &&
+                      HasRoute(second, Address(2, 1, 1), Connection::Transport::JTCP);
+        failures += Check(result, "Rebuild");
+    }
+
+    return Report(failures);
+}
+
+/* End of File */
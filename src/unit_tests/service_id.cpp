@@ -0,0 +1,193 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file service_id.cpp
+///  \brief This file is a unit test program to verify interning of service
+///          names by Service::ID.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#include "jaus/core/service.h"
+#include "unit_test.h"
+#include <iostream>
+#include <sstream>
+
+
+#ifdef VLD_ENABLED
+#include <vld.h>
+#endif
+
+using namespace JAUS;
+using namespace UnitTest;
+
+
+/** Writes an ID to a packet the way another component would, so the name
+    is not interned before it is read. */
+void WriteRemoteID(Packet& packet, const std::string& name)
+{
+    packet.Write((Byte)name.size());
+    packet.Write(name);
+    packet.Write((Byte)1);
+    packet.Write((Byte)0);
+}
+
+
+int main(int argc, char* argv[])
+{
+    int failures = 0;
+
+    // The same name always gets the same Handle.
+    {
+        Service::ID a("urn:jaus:jss:test:First", 1.0);
+        Service::ID b("urn:jaus:jss:test:First", 1.1);
+        Service::ID c("urn:jaus:jss:test:Second");
+        bool result = a.GetHandle() != Service::ID::NoHandle &&
+                      a.GetHandle() == b.GetHandle() &&
+                      a.GetHandle() != c.GetHandle() &&
+                      Service::ID::Intern("urn:jaus:jss:test:First") == a.GetHandle() &&
+                      Service::ID::Find("urn:jaus:jss:test:Second") == c.GetHandle() &&
+                      Service::ID::GetName(c.GetHandle()) == "urn:jaus:jss:test:Second";
+        failures += Check(result, "Same Name");
+    }
+
+    // Names never interned, and empty names, have no Handle.
+    {
+        Service::ID empty;
+        bool result = empty.GetHandle() == Service::ID::NoHandle &&
+                      Service::ID::Find("urn:jaus:jss:test:Unknown") == Service::ID::NoHandle &&
+                      Service::ID::GetName(Service::ID::NoHandle).empty();
+        Service::ID cleared("urn:jaus:jss:test:First");
+        cleared.Clear();
+        result = result && cleared.GetHandle() == Service::ID::NoHandle;
+        failures += Check(result, "No Handle");
+    }
+
+    // Comparisons use the Handle, so IDs order by when names were first
+    // interned and a Set keeps one ID per name.
+    {
+        Service::ID later("urn:jaus:jss:test:A");
+        Service::ID earlier("urn:jaus:jss:test:First");
+        Service::ID::Set services;
+        services.insert(later);
+        services.insert(earlier);
+        services.insert(Service::ID("urn:jaus:jss:test:First", 2.0));
+        bool result = earlier < later && !(later < earlier) &&
+                      services.size() == 2 &&
+                      services.begin()->GetHandle() == earlier.GetHandle() &&
+                      services.find(Service::ID("urn:jaus:jss:test:A")) != services.end();
+        failures += Check(result, "Ordering");
+    }
+
+    // SetName and assignment keep the Handle in sync with the name.
+    {
+        Service::ID id("urn:jaus:jss:test:First");
+        id.SetName("urn:jaus:jss:test:Second");
+        Service::ID copy;
+        copy = id;
+        Service::ID constructed(id);
+        bool result = id.GetHandle() == Service::ID::Find("urn:jaus:jss:test:Second") &&
+                      copy.GetHandle() == id.GetHandle() &&
+                      constructed.GetHandle() == id.GetHandle();
+        failures += Check(result, "Set Name");
+    }
+
+    // Reading an ID from a packet interns the name read, including
+    // names not seen before.
+    {
+        Service::ID written("urn:jaus:jss:test:Written", 1.5);
+        Packet packet;
+        written.Write(packet);
+        WriteRemoteID(packet, "urn:jaus:jss:test:Remote");
+
+        Service::ID first("urn:jaus:jss:test:First");
+        Service::ID second;
+        packet.SetReadPos(0);
+        bool result = Service::ID::Find("urn:jaus:jss:test:Remote") == Service::ID::NoHandle;
+        result = result && first.Read(packet) > 0 && second.Read(packet) > 0;
+        result = result &&
+                 first.GetName() == written.GetName() &&
+                 first.GetHandle() == written.GetHandle() &&
+                 first.mVersion == 1.5 &&
+                 second.GetName() == "urn:jaus:jss:test:Remote" &&
+                 second.GetHandle() != Service::ID::NoHandle &&
+                 second.GetHandle() == Service::ID::Find("urn:jaus:jss:test:Remote");
+        failures += Check(result, "Read");
+    }
+
+    // Only MaxReadNames names read are interned.  IDs read after that have
+    // no Handle, and are compared by name.
+    {
+        Packet packet;
+        for(unsigned int i = 0; i <= Service::ID::MaxReadNames + 1; i++)
+        {
+            std::stringstream name;
+            name << "urn:jaus:jss:test:Read" << i;
+            WriteRemoteID(packet, name.str());
+        }
+        WriteRemoteID(packet, "urn:jaus:jss:test:Read0");
+        packet.SetReadPos(0);
+
+        unsigned int interned = 0;
+        Service::ID::List read;
+        Service::ID id;
+        while(packet.GetReadPos() < packet.Length() && id.Read(packet) > 0)
+        {
+            if(id.GetHandle() != Service::ID::NoHandle)
+            {
+                interned++;
+            }
+            read.push_back(id);
+        }
+        const Service::ID& last = read[read.size() - 2];
+        const Service::ID& beforeLast = read[read.size() - 3];
+        Service::ID::Set services(read.begin(), read.end());
+        Service::ID local("urn:jaus:jss:test:Local");
+        bool result = read.size() == Service::ID::MaxReadNames + 3 &&
+                      interned <= Service::ID::MaxReadNames &&
+                      last.GetHandle() == Service::ID::NoHandle &&
+                      beforeLast.GetHandle() == Service::ID::NoHandle &&
+                      last != beforeLast &&
+                      last == Service::ID(last) &&
+                      read.back().GetHandle() == read.front().GetHandle() &&
+                      services.size() == Service::ID::MaxReadNames + 2 &&
+                      local.GetHandle() != Service::ID::NoHandle &&
+                      local < last &&
+                      !(last < local);
+        failures += Check(result, "Read Limit");
+    }
+
+    return Report(failures);
+}
+
+/* End of File */
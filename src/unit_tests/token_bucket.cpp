@@ -0,0 +1,148 @@
+////////////////////////////////////////////////////////////////////////////////////
+///
+///  \file token_bucket.cpp
+///  \brief This file is a unit test program to verify the rate limit of
+///          TokenBucket.
+///
+///  <br>Author(s): Daniel Barber
+///  <br>Created: 16 October 2026
+///  <br>Copyright (c) 2026
+///  <br>Applied Cognition and Training in Immersive Virtual Environments
+///  <br>(ACTIVE) Laboratory
+///  <br>Institute for Simulation and Training (IST)
+///  <br>University of Central Florida (UCF)
+///  <br>All rights reserved.
+///  <br>Email: dbarber@ist.ucf.edu
+///  <br>Web:  http://active.ist.ucf.edu
+///
+///  Redistribution and use in source and binary forms, with or without
+///  modification, are permitted provided that the following conditions are met:
+///      * Redistributions of source code must retain the above copyright
+///        notice, this list of conditions and the following disclaimer.
+///      * Redistributions in binary form must reproduce the above copyright
+///        notice, this list of conditions and the following disclaimer in the
+///        documentation and/or other materials provided with the distribution.
+///      * Neither the name of the ACTIVE LAB, IST, UCF, nor the
+///        names of its contributors may be used to endorse or promote products
+///        derived from this software without specific prior written permission.
+/// 
+///  THIS SOFTWARE IS PROVIDED BY THE ACTIVE LAB''AS IS'' AND ANY
+///  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+///  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+///  DISCLAIMED. IN NO EVENT SHALL UCF BE LIABLE FOR ANY
+///  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+///  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+///  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+///  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+///  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+////////////////////////////////////////////////////////////////////////////////////
+#include "jaus/core/transport/tokenbucket.h"
+#include "unit_test.h"
+#include <cxutils/timer.h>
+#include <iostream>
+#include <boost/thread.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+
+#ifdef VLD_ENABLED
+#include <vld.h>
+#endif
+
+using namespace JAUS;
+using namespace UnitTest;
+
+
+/** Sets the abort flag after a delay. */
+void SetAbortFlag(volatile bool* flag)
+{
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+    *flag = true;
+}
+
+
+int main(int argc, char* argv[])
+{
+    int failures = 0;
+
+    // No limit never waits.
+    {
+        TokenBucket bucket;
+        bool result = bucket.IsLimited() == false;
+        for(unsigned int i = 0; i < 1000; i++)
+        {
+            result &= bucket.Take(1000000);
+        }
+        failures += Check(result, "No Limit");
+    }
+
+    // The bucket starts full, then must wait for the rate.
+    {
+        TokenBucket bucket(10000, 1000);
+        double waitTimeSeconds = 0;
+        bool full = bucket.Take(1000);
+        bool empty = bucket.Take(500, &waitTimeSeconds) == false;
+        failures += Check(full && empty && waitTimeSeconds > 0.0 && waitTimeSeconds <= 0.05, "Burst");
+    }
+
+    // Packets larger than the burst size can go once the bucket is full.
+    {
+        TokenBucket bucket(10000, 1000);
+        bool large = bucket.Take(5000);
+        bool borrowed = bucket.Take(1) == false;
+        failures += Check(large && borrowed, "Larger Than Burst");
+    }
+
+    // Forced data is paid back before more can be sent.
+    {
+        TokenBucket bucket(10000, 1000);
+        bucket.Force(3000);
+        double waitTimeSeconds = 0;
+        bool waits = bucket.Take(100, &waitTimeSeconds) == false;
+        failures += Check(waits && waitTimeSeconds > 0.2, "Force");
+    }
+
+    // Setting the same rate keeps tokens already taken.
+    {
+        TokenBucket bucket(10000, 1000);
+        bucket.Take(1000);
+        bucket.SetRate(10000, 1000);
+        bool kept = bucket.Take(1000) == false;
+        bucket.SetRate(20000, 1000);
+        bool reset = bucket.Take(1000);
+        failures += Check(kept && reset, "Set Same Rate");
+    }
+
+    // Data is sent at the rate.
+    {
+        TokenBucket bucket(100000, 1000);
+        double start = CxUtils::Timer::GetTimeSeconds();
+        bool result = true;
+        for(unsigned int i = 0; i < 40; i++)
+        {
+            result &= bucket.Wait(500);
+        }
+        double elapsed = CxUtils::Timer::GetTimeSeconds() - start;
+        // 20000 bytes, less the first 1000 in the bucket.
+        failures += Check(result && elapsed >= 0.18 && elapsed < 0.5, "Rate");
+    }
+
+    // Waiting stops when the abort flag is set (e.g. on shutdown).
+    {
+        TokenBucket bucket(10, 10);
+        bucket.Force(1000000);
+        volatile bool abortFlag = false;
+        boost::thread thread(SetAbortFlag, &abortFlag);
+        double start = CxUtils::Timer::GetTimeSeconds();
+        bool aborted = bucket.Wait(10, &abortFlag) == false;
+        double elapsed = CxUtils::Timer::GetTimeSeconds() - start;
+        thread.join();
+        failures += Check(aborted && elapsed < 0.5, "Abort Wait");
+    }
+
+    return Report(failures);
+}
+
+
+/* End of File */